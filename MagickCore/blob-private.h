@@ -57,9 +57,18 @@ typedef enum
   BZipStream,
   FifoStream,
   BlobStream,
-  CustomStream
+  CustomStream,
+  ZstdStream,
+  Lz4Stream
 } StreamType;
 
+typedef struct _BlobWindow
+{
+  const unsigned char
+    *next,
+    *limit;
+} BlobWindow;
+
 extern MagickExport BlobInfo
   *CloneBlobInfo(const BlobInfo *),
   *ReferenceBlob(BlobInfo *);
@@ -82,8 +91,7 @@ extern MagickExport float
 
 extern MagickExport int
   EOFBlob(const Image *),
-  ErrorBlob(const Image *),
-  ReadBlobByte(Image *);
+  ErrorBlob(const Image *);
 
 extern MagickExport MagickBooleanType
   CloseBlob(Image *),
@@ -128,6 +136,51 @@ extern MagickExport ssize_t
   WriteBlobMSBSignedShort(Image *,const signed short),
   WriteBlobString(Image *,const char *);
 
+extern MagickExport void
+  AttachBlob(BlobInfo *,const void *,const size_t),
+  AttachCustomStream(BlobInfo *,CustomStreamInfo *),
+  *DetachBlob(BlobInfo *),
+  DisassociateBlob(Image *),
+  GetBlobInfo(BlobInfo *),
+  *MapBlob(int,const MapMode,const MagickOffsetType,const size_t),
+  MSBOrderLong(unsigned char *,const size_t),
+  MSBOrderShort(unsigned char *,const size_t);
+
+static inline const unsigned char *ReadBlobWindow(Image *image,
+  const size_t length,unsigned char *buffer)
+{
+  BlobWindow
+    *magick_restrict window;
+
+  const unsigned char
+    *p;
+
+  ssize_t
+    count;
+
+  /*
+    Consume bytes from the blob read window, refill it on a miss.
+  */
+  assert(image != (Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  assert(image->blob != (BlobInfo *) NULL);
+  window=(BlobWindow *) image->blob;
+  p=window->next;
+  if ((size_t) (window->limit-p) >= length)
+    {
+      window->next=p+length;
+      return(p);
+    }
+  p=(const unsigned char *) ReadBlobStream(image,length,buffer,&count);
+  if (count != (ssize_t) length)
+    return((const unsigned char *) NULL);
+  return(p);
+}
+
+#if defined(MAGICKCORE_BLOB_IMPLEMENTATION)
+extern MagickExport int
+  ReadBlobByte(Image *);
+
 extern MagickExport unsigned int
   ReadBlobLong(Image *),
   ReadBlobLSBLong(Image *),
@@ -137,16 +190,132 @@ extern MagickExport unsigned short
   ReadBlobShort(Image *),
   ReadBlobLSBShort(Image *),
   ReadBlobMSBShort(Image *);
+#else
+static inline int ReadBlobByte(Image *image)
+{
+  BlobWindow
+    *magick_restrict window;
 
-extern MagickExport void
-  AttachBlob(BlobInfo *,const void *,const size_t),
-  AttachCustomStream(BlobInfo *,CustomStreamInfo *),
-  *DetachBlob(BlobInfo *),
-  DisassociateBlob(Image *),
-  GetBlobInfo(BlobInfo *),
-  *MapBlob(int,const MapMode,const MagickOffsetType,const size_t),
-  MSBOrderLong(unsigned char *,const size_t),
-  MSBOrderShort(unsigned char *,const size_t);
+  const unsigned char
+    *p;
+
+  unsigned char
+    buffer[1];
+
+  assert(image != (Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  assert(image->blob != (BlobInfo *) NULL);
+  window=(BlobWindow *) image->blob;
+  if (window->next < window->limit)
+    return((int) *window->next++);
+  p=ReadBlobWindow(image,1,buffer);
+  if (p == (const unsigned char *) NULL)
+    return(EOF);
+  return((int) *p);
+}
+
+static inline unsigned int ReadBlobLSBLong(Image *image)
+{
+  const unsigned char
+    *p;
+
+  unsigned char
+    buffer[4];
+
+  unsigned int
+    value;
+
+  assert(image != (Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  p=ReadBlobWindow(image,4,buffer);
+  if (p == (const unsigned char *) NULL)
+    return(0U);
+  value=(unsigned int) (*p++);
+  value|=(unsigned int) (*p++) << 8;
+  value|=(unsigned int) (*p++) << 16;
+  value|=(unsigned int) (*p++) << 24;
+  return(value);
+}
+
+static inline unsigned int ReadBlobMSBLong(Image *image)
+{
+  const unsigned char
+    *p;
+
+  unsigned char
+    buffer[4];
+
+  unsigned int
+    value;
+
+  assert(image != (Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  p=ReadBlobWindow(image,4,buffer);
+  if (p == (const unsigned char *) NULL)
+    return(0U);
+  value=(unsigned int) (*p++) << 24;
+  value|=(unsigned int) (*p++) << 16;
+  value|=(unsigned int) (*p++) << 8;
+  value|=(unsigned int) (*p++);
+  return(value);
+}
+
+static inline unsigned int ReadBlobLong(Image *image)
+{
+  if (image->endian == LSBEndian)
+    return(ReadBlobLSBLong(image));
+  return(ReadBlobMSBLong(image));
+}
+
+static inline unsigned short ReadBlobLSBShort(Image *image)
+{
+  const unsigned char
+    *p;
+
+  unsigned char
+    buffer[2];
+
+  unsigned short
+    value;
+
+  assert(image != (Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  p=ReadBlobWindow(image,2,buffer);
+  if (p == (const unsigned char *) NULL)
+    return((unsigned short) 0U);
+  value=(unsigned short) (*p++);
+  value|=(unsigned short) (*p++) << 8;
+  return(value);
+}
+
+static inline unsigned short ReadBlobMSBShort(Image *image)
+{
+  const unsigned char
+    *p;
+
+  unsigned char
+    buffer[2];
+
+  unsigned short
+    value;
+
+  assert(image != (Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  p=ReadBlobWindow(image,2,buffer);
+  if (p == (const unsigned char *) NULL)
+    return((unsigned short) 0U);
+  value=(unsigned short) ((unsigned short) (*p++) << 8);
+  value|=(unsigned short) (*p++);
+  return(value);
+}
+
+static inline unsigned short ReadBlobShort(Image *image)
+{
+  if (image->endian == LSBEndian)
+    return(ReadBlobLSBShort(image));
+  return(ReadBlobMSBShort(image));
+}
+#endif
 
 #if defined(__cplusplus) || defined(c_plusplus)
 }
@@ -40,6 +40,7 @@
 /*
   Include declarations.
 */
+#define MAGICKCORE_BLOB_IMPLEMENTATION  1
 #ifdef __VMS
 #include  <types.h>
 #include  <mman.h>
@@ -78,6 +79,12 @@
 #if defined(MAGICKCORE_BZLIB_DELEGATE)
 #include "bzlib.h"
 #endif
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+#include "zstd.h"
+#endif
+#if defined(MAGICKCORE_LZ4_DELEGATE)
+#include "lz4frame.h"
+#endif
 
 /*
   Define declarations.
@@ -116,6 +123,31 @@
 /*
   Typedef declarations.
 */
+typedef struct _WriteBehindInfo
+  WriteBehindInfo;
+
+typedef struct _CodecInfo
+{
+  FILE
+    *file;
+
+  void
+    *context;
+
+  unsigned char
+    *buffer;
+
+  size_t
+    extent,
+    offset,
+    length,
+    pending;
+
+  MagickBooleanType
+    compress,
+    eof;
+} CodecInfo;
+
 typedef union FileInfo
 {
   FILE
@@ -130,10 +162,16 @@ typedef union FileInfo
   BZFILE
     *bzfile;
 #endif
+
+  CodecInfo
+    *codec;
 } FileInfo;
 
 struct _BlobInfo
 {
+  BlobWindow
+    window;  /* must remain the first member, see blob-private.h */
+
   size_t
     length,
     extent,
@@ -179,7 +217,14 @@ struct _BlobInfo
   CustomStreamInfo
     *custom_stream;
 
+  WriteBehindInfo
+    *write_behind;
+
+  MagickBooleanType
+    buffered;
+
   unsigned char
+    *buffer,
     *data;
 
   MagickBooleanType
@@ -195,6 +240,13 @@ struct _BlobInfo
     signature;
 };
 
+/*
+  The inline readers in blob-private.h reach the read window by casting
+  image->blob to a BlobWindow, so it must stay the first member.
+*/
+typedef char
+  BlobWindowIsFirstMember[(offsetof(BlobInfo,window) == 0) ? 1 : -1];
+
 struct _CustomStreamInfo
 {
   CustomStreamHandler
@@ -213,6 +265,46 @@ struct _CustomStreamInfo
   size_t
     signature;
 };
+
+struct _WriteBehindInfo
+{
+  BlobInfo
+    *blob_info;
+
+  unsigned char
+    *buffers[2];
+
+  size_t
+    active,
+    extent,
+    length,
+    pending;
+
+  MagickOffsetType
+    offset;
+
+  MagickSizeType
+    size;
+
+  MagickBooleanType
+    terminate;
+
+  int
+    status,
+    error_number;
+
+#if defined(MAGICKCORE_THREAD_SUPPORT)
+  pthread_mutex_t
+    mutex;
+
+  pthread_cond_t
+    request,
+    reply;
+
+  pthread_t
+    thread;
+#endif
+};
 
 /*
   Forward declarations.
@@ -297,6 +389,9 @@ MagickExport void AttachBlob(BlobInfo *blob_info,const void *blob,
   blob_info->file_info.file=(FILE *) NULL;
   blob_info->data=(unsigned char *) blob;
   blob_info->mapped=MagickFalse;
+  blob_info->window.next=(const unsigned char *) NULL;
+  blob_info->window.limit=(const unsigned char *) NULL;
+  blob_info->buffered=MagickFalse;
 }
 
 /*
@@ -583,6 +678,15 @@ MagickExport BlobInfo *CloneBlobInfo(const BlobInfo *blob_info)
   if (blob_info->mapped != MagickFalse)
     (void) AcquireMagickResource(MapResource,blob_info->length);
   clone_info->semaphore=semaphore;
+  clone_info->write_behind=(WriteBehindInfo *) NULL;
+  if ((blob_info->type == BlobStream) &&
+      (blob_info->window.next != (const unsigned char *) NULL))
+    clone_info->offset=(MagickOffsetType) (blob_info->window.next-
+      blob_info->data);
+  clone_info->window.next=(const unsigned char *) NULL;
+  clone_info->window.limit=(const unsigned char *) NULL;
+  clone_info->buffered=MagickFalse;
+  clone_info->buffer=(unsigned char *) NULL;
   LockSemaphoreInfo(clone_info->semaphore);
   clone_info->reference_count=1;
   UnlockSemaphoreInfo(clone_info->semaphore);
@@ -600,7 +704,9 @@ MagickExport BlobInfo *CloneBlobInfo(const BlobInfo *blob_info)
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  CloseBlob() closes a stream associated with the image.
+%  CloseBlob() closes a stream associated with the image.  Any output still
+%  pending in the flush thread is written first, and MagickFalse is returned
+%  if any write to the stream failed.
 %
 %  The format of the CloseBlob method is:
 %
@@ -619,6 +725,661 @@ static inline void ThrowBlobException(BlobInfo *blob_info)
   blob_info->status=(-1);
 }
 
+/*
+  The read window (see blob-private.h) holds bytes that have been read from
+  the underlying stream but not yet consumed.  For blob streams it is a view
+  of the blob and the blob offset points past its limit; for buffered files
+  it is part of the read-ahead buffer and the file position points past its
+  limit.  ResetBlobWindow() returns the unread bytes to the stream.
+*/
+
+static void ResetBlobWindow(BlobInfo *blob_info)
+{
+  size_t
+    extent;
+
+  extent=(size_t) (blob_info->window.limit-blob_info->window.next);
+  switch (blob_info->type)
+  {
+    case FileStream:
+    {
+      if (extent != 0)
+        (void) fseek(blob_info->file_info.file,-((off_t) extent),SEEK_CUR);
+      break;
+    }
+    case ZipStream:
+    {
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+      if (extent != 0)
+        (void) gzseek(blob_info->file_info.gzfile,-((z_off_t) extent),
+          SEEK_CUR);
+#endif
+      break;
+    }
+    case BlobStream:
+    {
+      if (blob_info->window.next != (const unsigned char *) NULL)
+        blob_info->offset=(MagickOffsetType) (blob_info->window.next-
+          blob_info->data);
+      break;
+    }
+    default:
+      break;
+  }
+  blob_info->window.next=(const unsigned char *) NULL;
+  blob_info->window.limit=(const unsigned char *) NULL;
+}
+
+#if defined(MAGICKCORE_ZSTD_DELEGATE) || defined(MAGICKCORE_LZ4_DELEGATE)
+/*
+  Zstandard and LZ4 streams layer a frame codec over a stdio file.  When
+  decoding, the codec buffer holds compressed bytes read from the file but not
+  yet consumed; when encoding, it receives the codec output on its way to the
+  file.  The pending member is the decoder hint from the last call that made
+  progress: zero once a frame is complete, so a stream that ends with it
+  non-zero is truncated.
+*/
+
+static CodecInfo *RelinquishCodecInfo(CodecInfo *codec,
+  const StreamType type)
+{
+  if (codec->context != (void *) NULL)
+    switch (type)
+    {
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+      case ZstdStream:
+      {
+        if (codec->compress != MagickFalse)
+          (void) ZSTD_freeCCtx((ZSTD_CCtx *) codec->context);
+        else
+          (void) ZSTD_freeDCtx((ZSTD_DCtx *) codec->context);
+        break;
+      }
+#endif
+#if defined(MAGICKCORE_LZ4_DELEGATE)
+      case Lz4Stream:
+      {
+        if (codec->compress != MagickFalse)
+          (void) LZ4F_freeCompressionContext((LZ4F_cctx *) codec->context);
+        else
+          (void) LZ4F_freeDecompressionContext((LZ4F_dctx *) codec->context);
+        break;
+      }
+#endif
+      default:
+        break;
+    }
+  if (codec->buffer != (unsigned char *) NULL)
+    codec->buffer=(unsigned char *) RelinquishMagickMemory(codec->buffer);
+  return((CodecInfo *) RelinquishMagickMemory(codec));
+}
+
+static int FlushCodecStream(BlobInfo *blob_info,const MagickBooleanType end)
+{
+  CodecInfo
+    *codec;
+
+  size_t
+    count;
+
+  codec=blob_info->file_info.codec;
+  if (codec->compress == MagickFalse)
+    return(0);
+  count=0;
+  switch (blob_info->type)
+  {
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+    case ZstdStream:
+    {
+      size_t
+        remaining;
+
+      ZSTD_inBuffer
+        input;
+
+      ZSTD_outBuffer
+        output;
+
+      input.src=(const void *) NULL;
+      input.size=0;
+      input.pos=0;
+      do
+      {
+        output.dst=codec->buffer;
+        output.size=codec->extent;
+        output.pos=0;
+        remaining=ZSTD_compressStream2((ZSTD_CCtx *) codec->context,&output,
+          &input,end != MagickFalse ? ZSTD_e_end : ZSTD_e_flush);
+        if (ZSTD_isError(remaining) != 0)
+          return(-1);
+        if (fwrite(codec->buffer,1,output.pos,codec->file) != output.pos)
+          return(-1);
+      } while (remaining != 0);
+      break;
+    }
+#endif
+#if defined(MAGICKCORE_LZ4_DELEGATE)
+    case Lz4Stream:
+    {
+      if (end != MagickFalse)
+        count=LZ4F_compressEnd((LZ4F_cctx *) codec->context,codec->buffer,
+          codec->extent,(const LZ4F_compressOptions_t *) NULL);
+      else
+        count=LZ4F_flush((LZ4F_cctx *) codec->context,codec->buffer,
+          codec->extent,(const LZ4F_compressOptions_t *) NULL);
+      if (LZ4F_isError(count) != 0)
+        return(-1);
+      break;
+    }
+#endif
+    default:
+      break;
+  }
+  if ((count != 0) && (fwrite(codec->buffer,1,count,codec->file) != count))
+    return(-1);
+  return(0);
+}
+
+static int CloseCodecStream(BlobInfo *blob_info)
+{
+  CodecInfo
+    *codec;
+
+  int
+    status;
+
+  codec=blob_info->file_info.codec;
+  status=FlushCodecStream(blob_info,MagickTrue);
+  if (fclose(codec->file) != 0)
+    status=(-1);
+  blob_info->file_info.codec=RelinquishCodecInfo(codec,blob_info->type);
+  return(status);
+}
+
+static MagickBooleanType OpenCodecStream(const ImageInfo *image_info,
+  BlobInfo *blob_info,FILE *file,const StreamType type,
+  const MagickBooleanType compress)
+{
+  CodecInfo
+    *codec;
+
+  magick_unreferenced(image_info);
+  codec=(CodecInfo *) AcquireMagickMemory(sizeof(*codec));
+  if (codec == (CodecInfo *) NULL)
+    return(MagickFalse);
+  (void) memset(codec,0,sizeof(*codec));
+  codec->file=file;
+  codec->compress=compress;
+  switch (type)
+  {
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+    case ZstdStream:
+    {
+      ZSTD_CCtx
+        *context;
+
+      if (compress == MagickFalse)
+        {
+          codec->context=(void *) ZSTD_createDCtx();
+          codec->extent=ZSTD_DStreamInSize();
+          break;
+        }
+      context=ZSTD_createCCtx();
+      codec->context=(void *) context;
+      codec->extent=ZSTD_CStreamOutSize();
+      if (context != (ZSTD_CCtx *) NULL)
+        {
+          MagickSizeType
+            threads;
+
+          if (image_info->quality != UndefinedCompressionQuality)
+            (void) ZSTD_CCtx_setParameter(context,ZSTD_c_compressionLevel,
+              (int) MagickMax(22*image_info->quality/100,1));
+          threads=GetMagickResourceLimit(ThreadResource);
+          if (threads > 1)
+            (void) ZSTD_CCtx_setParameter(context,ZSTD_c_nbWorkers,(int)
+              threads);
+        }
+      break;
+    }
+#endif
+#if defined(MAGICKCORE_LZ4_DELEGATE)
+    case Lz4Stream:
+    {
+      if (compress == MagickFalse)
+        {
+          LZ4F_dctx
+            *context;
+
+          if (LZ4F_isError(LZ4F_createDecompressionContext(&context,
+                LZ4F_VERSION)) != 0)
+            context=(LZ4F_dctx *) NULL;
+          codec->context=(void *) context;
+          codec->extent=MagickMaxBlobExtent;
+        }
+      else
+        {
+          LZ4F_cctx
+            *context;
+
+          if (LZ4F_isError(LZ4F_createCompressionContext(&context,
+                LZ4F_VERSION)) != 0)
+            context=(LZ4F_cctx *) NULL;
+          codec->context=(void *) context;
+          codec->extent=LZ4F_compressBound(MagickMaxBlobExtent,
+            (const LZ4F_preferences_t *) NULL);
+        }
+      break;
+    }
+#endif
+    default:
+      break;
+  }
+  if (codec->context != (void *) NULL)
+    codec->buffer=(unsigned char *) AcquireQuantumMemory(codec->extent,
+      sizeof(*codec->buffer));
+  if (codec->buffer == (unsigned char *) NULL)
+    {
+      codec=RelinquishCodecInfo(codec,type);
+      return(MagickFalse);
+    }
+#if defined(MAGICKCORE_LZ4_DELEGATE)
+  if ((type == Lz4Stream) && (compress != MagickFalse))
+    {
+      size_t
+        count;
+
+      /*
+        LZ4 writes its frame header up front.
+      */
+      count=LZ4F_compressBegin((LZ4F_cctx *) codec->context,codec->buffer,
+        codec->extent,(const LZ4F_preferences_t *) NULL);
+      if ((LZ4F_isError(count) != 0) ||
+          (fwrite(codec->buffer,1,count,file) != count))
+        {
+          codec=RelinquishCodecInfo(codec,type);
+          return(MagickFalse);
+        }
+    }
+#endif
+  blob_info->file_info.codec=codec;
+  blob_info->type=type;
+  return(MagickTrue);
+}
+
+static ssize_t ReadCodecStream(BlobInfo *blob_info,const size_t length,
+  unsigned char *data)
+{
+  CodecInfo
+    *codec;
+
+  size_t
+    count;
+
+  codec=blob_info->file_info.codec;
+  count=0;
+  while (count < length)
+  {
+    size_t
+      consumed,
+      hint,
+      produced;
+
+    if ((codec->offset == codec->length) && (codec->eof == MagickFalse))
+      {
+        codec->offset=0;
+        codec->length=fread(codec->buffer,1,codec->extent,codec->file);
+        if (codec->length == 0)
+          {
+            if (ferror(codec->file) != 0)
+              {
+                ThrowBlobException(blob_info);
+                break;
+              }
+            codec->eof=MagickTrue;
+          }
+      }
+    consumed=0;
+    hint=0;
+    produced=0;
+    switch (blob_info->type)
+    {
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+      case ZstdStream:
+      {
+        ZSTD_inBuffer
+          input;
+
+        ZSTD_outBuffer
+          output;
+
+        input.src=codec->buffer+codec->offset;
+        input.size=codec->length-codec->offset;
+        input.pos=0;
+        output.dst=data+count;
+        output.size=length-count;
+        output.pos=0;
+        hint=ZSTD_decompressStream((ZSTD_DCtx *) codec->context,&output,
+          &input);
+        if (ZSTD_isError(hint) != 0)
+          {
+            ThrowBlobException(blob_info);
+            return((ssize_t) count);
+          }
+        consumed=input.pos;
+        produced=output.pos;
+        break;
+      }
+#endif
+#if defined(MAGICKCORE_LZ4_DELEGATE)
+      case Lz4Stream:
+      {
+        consumed=codec->length-codec->offset;
+        produced=length-count;
+        hint=LZ4F_decompress((LZ4F_dctx *) codec->context,data+count,
+          &produced,codec->buffer+codec->offset,&consumed,
+          (const LZ4F_decompressOptions_t *) NULL);
+        if (LZ4F_isError(hint) != 0)
+          {
+            ThrowBlobException(blob_info);
+            return((ssize_t) count);
+          }
+        break;
+      }
+#endif
+      default:
+        break;
+    }
+    codec->offset+=consumed;
+    count+=produced;
+    if ((consumed != 0) || (produced != 0))
+      codec->pending=hint;
+    else
+      {
+        if ((codec->eof != MagickFalse) && (codec->pending != 0))
+          ThrowBlobException(blob_info);
+        if ((codec->eof != MagickFalse) || (codec->offset != codec->length))
+          break;
+      }
+  }
+  return((ssize_t) count);
+}
+
+static ssize_t WriteCodecStream(BlobInfo *blob_info,const size_t length,
+  const unsigned char *data)
+{
+  CodecInfo
+    *codec;
+
+  size_t
+    i;
+
+  codec=blob_info->file_info.codec;
+  for (i=0; i < length; )
+  {
+    size_t
+      count;
+
+    count=0;
+    switch (blob_info->type)
+    {
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+      case ZstdStream:
+      {
+        ZSTD_inBuffer
+          input;
+
+        ZSTD_outBuffer
+          output;
+
+        input.src=data+i;
+        input.size=length-i;
+        input.pos=0;
+        output.dst=codec->buffer;
+        output.size=codec->extent;
+        output.pos=0;
+        if (ZSTD_isError(ZSTD_compressStream2((ZSTD_CCtx *) codec->context,
+              &output,&input,ZSTD_e_continue)) != 0)
+          return(-1);
+        i+=input.pos;
+        count=output.pos;
+        break;
+      }
+#endif
+#if defined(MAGICKCORE_LZ4_DELEGATE)
+      case Lz4Stream:
+      {
+        size_t
+          extent;
+
+        extent=MagickMin(length-i,MagickMaxBlobExtent);
+        count=LZ4F_compressUpdate((LZ4F_cctx *) codec->context,
+          codec->buffer,codec->extent,data+i,extent,
+          (const LZ4F_compressOptions_t *) NULL);
+        if (LZ4F_isError(count) != 0)
+          return(-1);
+        i+=extent;
+        break;
+      }
+#endif
+      default:
+        return(-1);
+    }
+    if ((count != 0) && (fwrite(codec->buffer,1,count,codec->file) != count))
+      return(-1);
+  }
+  return((ssize_t) i);
+}
+#endif
+
+/*
+  Encoders may defer output to a flush thread (see -define stream:write-behind)
+  so encoding overlaps with file I/O.  Bytes accumulate in the active buffer;
+  when it fills, it is handed to the thread and the encoder continues in the
+  other buffer.  Errors raised by the thread are recorded here and reported
+  by the next hand-off, SyncBlob(), or CloseBlob().
+*/
+
+static ssize_t WriteBehindFile(BlobInfo *blob_info,const size_t length,
+  const unsigned char *data)
+{
+  ssize_t
+    count;
+
+  size_t
+    i;
+
+  count=0;
+  for (i=0; i < length; i+=(size_t) count)
+  {
+    switch (blob_info->type)
+    {
+      case ZipStream:
+      {
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+        count=(ssize_t) gzwrite(blob_info->file_info.gzfile,data+i,
+          (unsigned int) MagickMin(length-i,MagickMaxBufferExtent));
+#endif
+        break;
+      }
+      case BZipStream:
+      {
+#if defined(MAGICKCORE_BZLIB_DELEGATE)
+        count=(ssize_t) BZ2_bzwrite(blob_info->file_info.bzfile,(void *)
+          (data+i),(int) MagickMin(length-i,MagickMaxBufferExtent));
+#endif
+        break;
+      }
+      case ZstdStream:
+      case Lz4Stream:
+      {
+#if defined(MAGICKCORE_ZSTD_DELEGATE) || defined(MAGICKCORE_LZ4_DELEGATE)
+        count=WriteCodecStream(blob_info,length-i,data+i);
+#endif
+        break;
+      }
+      default:
+      {
+        count=(ssize_t) fwrite(data+i,1,length-i,blob_info->file_info.file);
+        break;
+      }
+    }
+    if (count <= 0)
+      {
+        count=0;
+        if (errno != EINTR)
+          break;
+      }
+  }
+  return((ssize_t) i);
+}
+
+#if defined(MAGICKCORE_THREAD_SUPPORT)
+static void *WriteBehindThread(void *context)
+{
+  WriteBehindInfo
+    *write_behind;
+
+  write_behind=(WriteBehindInfo *) context;
+  (void) pthread_mutex_lock(&write_behind->mutex);
+  for ( ; ; )
+  {
+    const unsigned char
+      *data;
+
+    size_t
+      length;
+
+    ssize_t
+      count;
+
+    while ((write_behind->pending == 0) &&
+           (write_behind->terminate == MagickFalse))
+      (void) pthread_cond_wait(&write_behind->request,&write_behind->mutex);
+    if (write_behind->pending == 0)
+      break;
+    data=write_behind->buffers[1-write_behind->active];
+    length=write_behind->pending;
+    (void) pthread_mutex_unlock(&write_behind->mutex);
+    errno=0;
+    count=WriteBehindFile(write_behind->blob_info,length,data);
+    (void) pthread_mutex_lock(&write_behind->mutex);
+    if ((count != (ssize_t) length) && (write_behind->status == 0))
+      {
+        write_behind->error_number=errno;
+        write_behind->status=(-1);
+      }
+    write_behind->pending=0;
+    (void) pthread_cond_signal(&write_behind->reply);
+  }
+  (void) pthread_mutex_unlock(&write_behind->mutex);
+  return((void *) NULL);
+}
+#endif
+
+static int SyncWriteBehind(BlobInfo *blob_info,const MagickBooleanType wait)
+{
+  int
+    error_number,
+    status;
+
+  WriteBehindInfo
+    *write_behind;
+
+  /*
+    Hand the active buffer to the flush thread once the previous one is
+    written; optionally wait until it is written too.
+  */
+  write_behind=blob_info->write_behind;
+#if defined(MAGICKCORE_THREAD_SUPPORT)
+  (void) pthread_mutex_lock(&write_behind->mutex);
+  while (write_behind->pending != 0)
+    (void) pthread_cond_wait(&write_behind->reply,&write_behind->mutex);
+  if ((write_behind->length != 0) && (write_behind->status == 0))
+    {
+      write_behind->pending=write_behind->length;
+      write_behind->active=1-write_behind->active;
+      (void) pthread_cond_signal(&write_behind->request);
+      if (wait != MagickFalse)
+        while (write_behind->pending != 0)
+          (void) pthread_cond_wait(&write_behind->reply,&write_behind->mutex);
+    }
+  status=write_behind->status;
+  error_number=write_behind->error_number;
+  (void) pthread_mutex_unlock(&write_behind->mutex);
+#else
+  (void) wait;
+  status=write_behind->status;
+  error_number=write_behind->error_number;
+#endif
+  write_behind->length=0;
+  if (status != 0)
+    {
+      if (blob_info->status == 0)
+        blob_info->error_number=error_number;
+      blob_info->status=(-1);
+    }
+  return(status);
+}
+
+static ssize_t WriteBehindBlob(BlobInfo *blob_info,const size_t length,
+  const unsigned char *data)
+{
+  size_t
+    count;
+
+  WriteBehindInfo
+    *write_behind;
+
+  write_behind=blob_info->write_behind;
+  for (count=0; count < length; )
+  {
+    size_t
+      extent;
+
+    if ((write_behind->length == write_behind->extent) &&
+        (SyncWriteBehind(blob_info,MagickFalse) != 0))
+      break;
+    extent=MagickMin(write_behind->extent-write_behind->length,length-count);
+    (void) memcpy(write_behind->buffers[write_behind->active]+
+      write_behind->length,data+count,extent);
+    write_behind->length+=extent;
+    count+=extent;
+  }
+  if (write_behind->offset >= 0)
+    {
+      write_behind->offset+=(MagickOffsetType) count;
+      if ((MagickSizeType) write_behind->offset > write_behind->size)
+        write_behind->size=(MagickSizeType) write_behind->offset;
+    }
+  return((ssize_t) count);
+}
+
+static void DestroyWriteBehindInfo(BlobInfo *blob_info)
+{
+  WriteBehindInfo
+    *write_behind;
+
+  write_behind=blob_info->write_behind;
+  (void) SyncWriteBehind(blob_info,MagickTrue);
+#if defined(MAGICKCORE_THREAD_SUPPORT)
+  (void) pthread_mutex_lock(&write_behind->mutex);
+  write_behind->terminate=MagickTrue;
+  (void) pthread_cond_signal(&write_behind->request);
+  (void) pthread_mutex_unlock(&write_behind->mutex);
+  (void) pthread_join(write_behind->thread,(void **) NULL);
+  (void) pthread_cond_destroy(&write_behind->reply);
+  (void) pthread_cond_destroy(&write_behind->request);
+  (void) pthread_mutex_destroy(&write_behind->mutex);
+#endif
+  write_behind->buffers[1]=(unsigned char *) RelinquishMagickMemory(
+    write_behind->buffers[1]);
+  write_behind->buffers[0]=(unsigned char *) RelinquishMagickMemory(
+    write_behind->buffers[0]);
+  blob_info->write_behind=(WriteBehindInfo *) RelinquishMagickMemory(
+    write_behind);
+}
+
 MagickExport MagickBooleanType CloseBlob(Image *image)
 {
   BlobInfo
@@ -637,7 +1398,15 @@ MagickExport MagickBooleanType CloseBlob(Image *image)
   blob_info=image->blob;
   if ((blob_info == (BlobInfo *) NULL) || (blob_info->type == UndefinedStream))
     return(MagickTrue);
-  (void) SyncBlob(image);
+  if (blob_info->write_behind != (WriteBehindInfo *) NULL)
+    DestroyWriteBehindInfo(blob_info);
+  if (blob_info->type == BlobStream)
+    ResetBlobWindow(blob_info);
+  blob_info->window.next=(const unsigned char *) NULL;
+  blob_info->window.limit=(const unsigned char *) NULL;
+  blob_info->buffered=MagickFalse;
+  if (SyncBlob(image) != 0)
+    ThrowBlobException(blob_info);
   status=blob_info->status;
   switch (blob_info->type)
   {
@@ -677,6 +1446,15 @@ MagickExport MagickBooleanType CloseBlob(Image *image)
       (void) BZ2_bzerror(blob_info->file_info.bzfile,&status);
       if (status != BZ_OK)
         ThrowBlobException(blob_info);
+#endif
+      break;
+    }
+    case ZstdStream:
+    case Lz4Stream:
+    {
+#if defined(MAGICKCORE_ZSTD_DELEGATE) || defined(MAGICKCORE_LZ4_DELEGATE)
+      if (ferror(blob_info->file_info.codec->file) != 0)
+        ThrowBlobException(blob_info);
 #endif
       break;
     }
@@ -750,6 +1528,16 @@ MagickExport MagickBooleanType CloseBlob(Image *image)
     {
 #if defined(MAGICKCORE_BZLIB_DELEGATE)
       BZ2_bzclose(blob_info->file_info.bzfile);
+#endif
+      break;
+    }
+    case ZstdStream:
+    case Lz4Stream:
+    {
+#if defined(MAGICKCORE_ZSTD_DELEGATE) || defined(MAGICKCORE_LZ4_DELEGATE)
+      status=CloseCodecStream(blob_info);
+      if (status != 0)
+        ThrowBlobException(blob_info);
 #endif
       break;
     }
@@ -987,6 +1775,9 @@ MagickExport void DestroyBlob(Image *image)
       (void) UnmapBlob(blob_info->data,blob_info->length);
       RelinquishMagickResource(MapResource,blob_info->length);
     }
+  if (blob_info->buffer != (unsigned char *) NULL)
+    blob_info->buffer=(unsigned char *) RelinquishMagickMemory(
+      blob_info->buffer);
   if (blob_info->semaphore != (SemaphoreInfo *) NULL)
     RelinquishSemaphoreInfo(&blob_info->semaphore);
   blob_info->signature=(~MagickCoreSignature);
@@ -1066,6 +1857,9 @@ MagickExport void *DetachBlob(BlobInfo *blob_info)
     }
   blob_info->mapped=MagickFalse;
   blob_info->length=0;
+  blob_info->window.next=(const unsigned char *) NULL;
+  blob_info->window.limit=(const unsigned char *) NULL;
+  blob_info->buffered=MagickFalse;
   /*
     We should not reset blob_info->extent because we use it to check if the
     blob was opened inside ImagesToBlob and ImagesToBlob.
@@ -1267,6 +2061,8 @@ MagickExport int EOFBlob(const Image *image)
   if (IsEventLogging() != MagickFalse)
     (void) LogMagickEvent(TraceEvent,GetMagickModule(),"...");
   blob_info=image->blob;
+  if (blob_info->write_behind != (WriteBehindInfo *) NULL)
+    (void) SyncWriteBehind(blob_info,MagickTrue);
   switch (blob_info->type)
   {
     case UndefinedStream:
@@ -1275,6 +2071,8 @@ MagickExport int EOFBlob(const Image *image)
     case FileStream:
     case PipeStream:
     {
+      if (blob_info->buffered != MagickFalse)
+        break;
       blob_info->eof=feof(blob_info->file_info.file) != 0 ? MagickTrue :
         MagickFalse;
       break;
@@ -1282,6 +2080,8 @@ MagickExport int EOFBlob(const Image *image)
     case ZipStream:
     {
 #if defined(MAGICKCORE_ZLIB_DELEGATE)
+      if (blob_info->buffered != MagickFalse)
+        break;
       blob_info->eof=gzeof(blob_info->file_info.gzfile) != 0 ? MagickTrue :
         MagickFalse;
 #endif
@@ -1299,6 +2099,9 @@ MagickExport int EOFBlob(const Image *image)
 #endif
       break;
     }
+    case ZstdStream:
+    case Lz4Stream:
+      break;
     case FifoStream:
     {
       blob_info->eof=MagickFalse;
@@ -1347,6 +2150,8 @@ MagickExport int ErrorBlob(const Image *image)
   if (IsEventLogging() != MagickFalse)
     (void) LogMagickEvent(TraceEvent,GetMagickModule(),"...");
   blob_info=image->blob;
+  if (blob_info->write_behind != (WriteBehindInfo *) NULL)
+    (void) SyncWriteBehind(blob_info,MagickTrue);
   switch (blob_info->type)
   {
     case UndefinedStream:
@@ -1369,6 +2174,14 @@ MagickExport int ErrorBlob(const Image *image)
     {
 #if defined(MAGICKCORE_BZLIB_DELEGATE)
       (void) BZ2_bzerror(blob_info->file_info.bzfile,&blob_info->error);
+#endif
+      break;
+    }
+    case ZstdStream:
+    case Lz4Stream:
+    {
+#if defined(MAGICKCORE_ZSTD_DELEGATE) || defined(MAGICKCORE_LZ4_DELEGATE)
+      blob_info->error=ferror(blob_info->file_info.codec->file);
 #endif
       break;
     }
@@ -1627,6 +2440,8 @@ static inline ssize_t WriteBlobStream(Image *image,const size_t length,
   blob_info=image->blob;
   if (blob_info->type != BlobStream)
     return(WriteBlob(image,length,(const unsigned char *) data));
+  if (blob_info->window.next != (const unsigned char *) NULL)
+    ResetBlobWindow(blob_info);
   extent=(MagickSizeType) (blob_info->offset+(MagickOffsetType) length);
   if (extent >= blob_info->extent)
     {
@@ -1767,6 +2582,8 @@ MagickExport MagickBooleanType GetBlobError(const Image *image)
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
 %  GetBlobFileHandle() returns the file handle associated with the image blob.
+%  Pending output is written first and later writes bypass the flush thread,
+%  so callers may write to the handle directly.
 %
 %  The format of the GetBlobFile method is:
 %
@@ -1781,6 +2598,11 @@ MagickExport FILE *GetBlobFileHandle(const Image *image)
 {
   assert(image != (const Image *) NULL);
   assert(image->signature == MagickCoreSignature);
+  if (image->blob->write_behind != (WriteBehindInfo *) NULL)
+    DestroyWriteBehindInfo(image->blob);
+  if (image->blob->window.next != (const unsigned char *) NULL)
+    ResetBlobWindow(image->blob);
+  image->blob->buffered=MagickFalse;
   return(image->blob->file_info.file);
 }
 
@@ -1888,6 +2710,8 @@ MagickExport MagickSizeType GetBlobSize(const Image *image)
   if (IsEventLogging() != MagickFalse)
     (void) LogMagickEvent(TraceEvent,GetMagickModule(),"%s",image->filename);
   blob_info=image->blob;
+  if (blob_info->write_behind != (WriteBehindInfo *) NULL)
+    (void) SyncWriteBehind(blob_info,MagickTrue);
   extent=0;
   switch (blob_info->type)
   {
@@ -1918,6 +2742,8 @@ MagickExport MagickSizeType GetBlobSize(const Image *image)
       break;
     }
     case ZipStream:
+    case ZstdStream:
+    case Lz4Stream:
     case BZipStream:
     {
       MagickBooleanType
@@ -2926,6 +3752,8 @@ MagickExport MagickBooleanType IsBlobSeekable(const Image *image)
   if (IsEventLogging() != MagickFalse)
     (void) LogMagickEvent(TraceEvent,GetMagickModule(),"%s",image->filename);
   blob_info=image->blob;
+  if (blob_info->write_behind != (WriteBehindInfo *) NULL)
+    (void) SyncWriteBehind(blob_info,MagickTrue);
   switch (blob_info->type)
   {
     case BlobStream:
@@ -2956,6 +3784,8 @@ MagickExport MagickBooleanType IsBlobSeekable(const Image *image)
     }
     case UndefinedStream:
     case BZipStream:
+    case ZstdStream:
+    case Lz4Stream:
     case FifoStream:
     case PipeStream:
     case StandardStream:
@@ -3188,38 +4018,166 @@ MagickExport void MSBOrderShort(unsigned char *p,const size_t length)
     *p++=(unsigned char) c;
   }
 }
-
-/*
-%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
-%                                                                             %
-%                                                                             %
-%                                                                             %
-+   O p e n B l o b                                                           %
-%                                                                             %
-%                                                                             %
-%                                                                             %
-%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
-%
-%  OpenBlob() opens a file associated with the image.  A file name of '-' sets
-%  the file to stdin for type 'r' and stdout for type 'w'.  If the filename
-%  suffix is '.gz', the image is decompressed for type 'r' and compressed for
-%  type 'w'.  If the filename prefix is '|', it is piped to or from a system
-%  command.
-%
-%  The format of the OpenBlob method is:
-%
-%       MagickBooleanType OpenBlob(const ImageInfo *image_info,Image *image,
-%        const BlobMode mode,ExceptionInfo *exception)
-%
-%  A description of each parameter follows:
-%
-%    o image_info: the image info.
-%
-%    o image: the image.
-%
-%    o mode: the mode for opening the file.
-%
-*/
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   O p e n B l o b                                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  OpenBlob() opens a file associated with the image.  A file name of '-' sets
+%  the file to stdin for type 'r' and stdout for type 'w'.  If the filename
+%  suffix is '.gz', the image is decompressed for type 'r' and compressed for
+%  type 'w'.  If the filename prefix is '|', it is piped to or from a system
+%  command.  Regular files read by a coder that supports blobs may be
+%  memory-mapped (see -define stream:memory-map) so ReadBlobStream() returns
+%  pointers into the page cache rather than copies.  Output files may instead
+%  be written behind the encoder by a flush thread (see -define
+%  stream:write-behind).
+%
+%  The format of the OpenBlob method is:
+%
+%       MagickBooleanType OpenBlob(const ImageInfo *image_info,Image *image,
+%        const BlobMode mode,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o image_info: the image info.
+%
+%    o image: the image.
+%
+%    o mode: the mode for opening the file.
+%
+*/
+
+static WriteBehindInfo *AcquireWriteBehindInfo(const ImageInfo *image_info,
+  BlobInfo *blob_info)
+{
+#if defined(MAGICKCORE_THREAD_SUPPORT)
+  char
+    *value;
+
+  const char
+    *option;
+
+  size_t
+    extent;
+
+  WriteBehindInfo
+    *write_behind;
+
+  /*
+    A define (e.g. -define stream:write-behind=1MiB) overrides the policy;
+    true selects a 512KiB buffer, false or 0 writes synchronously.
+  */
+  option=GetImageOption(image_info,"stream:write-behind");
+  if (option != (const char *) NULL)
+    value=ConstantString(option);
+  else
+    value=GetPolicyValue("system:stream-write-behind");
+  if (value == (char *) NULL)
+    return((WriteBehindInfo *) NULL);
+  if (IsStringTrue(value) != MagickFalse)
+    extent=MagickMaxBufferExtent;
+  else
+    extent=IsStringFalse(value) != MagickFalse ? 0 :
+      StringToSizeType(value,100.0);
+  value=DestroyString(value);
+  if (extent == 0)
+    return((WriteBehindInfo *) NULL);
+  write_behind=(WriteBehindInfo *) AcquireMagickMemory(sizeof(*write_behind));
+  if (write_behind == (WriteBehindInfo *) NULL)
+    return((WriteBehindInfo *) NULL);
+  (void) memset(write_behind,0,sizeof(*write_behind));
+  write_behind->blob_info=blob_info;
+  write_behind->extent=extent;
+  write_behind->buffers[0]=(unsigned char *) AcquireQuantumMemory(extent,
+    sizeof(**write_behind->buffers));
+  write_behind->buffers[1]=(unsigned char *) AcquireQuantumMemory(extent,
+    sizeof(**write_behind->buffers));
+  if ((write_behind->buffers[0] == (unsigned char *) NULL) ||
+      (write_behind->buffers[1] == (unsigned char *) NULL))
+    {
+      write_behind->buffers[1]=(unsigned char *) RelinquishMagickMemory(
+        write_behind->buffers[1]);
+      write_behind->buffers[0]=(unsigned char *) RelinquishMagickMemory(
+        write_behind->buffers[0]);
+      return((WriteBehindInfo *) RelinquishMagickMemory(write_behind));
+    }
+  /*
+    Track the logical position of seekable streams so TellBlob() and no-op
+    seeks need not wait for pending output.
+  */
+  write_behind->offset=(-1);
+  if (blob_info->type == FileStream)
+    write_behind->offset=(MagickOffsetType) ftell(blob_info->file_info.file);
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+  if (blob_info->type == ZipStream)
+    write_behind->offset=(MagickOffsetType) gztell(
+      blob_info->file_info.gzfile);
+#endif
+  write_behind->size=blob_info->size;
+  (void) pthread_mutex_init(&write_behind->mutex,
+    (const pthread_mutexattr_t *) NULL);
+  (void) pthread_cond_init(&write_behind->request,
+    (const pthread_condattr_t *) NULL);
+  (void) pthread_cond_init(&write_behind->reply,
+    (const pthread_condattr_t *) NULL);
+  if (pthread_create(&write_behind->thread,(const pthread_attr_t *) NULL,
+        WriteBehindThread,write_behind) != 0)
+    {
+      (void) pthread_cond_destroy(&write_behind->reply);
+      (void) pthread_cond_destroy(&write_behind->request);
+      (void) pthread_mutex_destroy(&write_behind->mutex);
+      write_behind->buffers[1]=(unsigned char *) RelinquishMagickMemory(
+        write_behind->buffers[1]);
+      write_behind->buffers[0]=(unsigned char *) RelinquishMagickMemory(
+        write_behind->buffers[0]);
+      return((WriteBehindInfo *) RelinquishMagickMemory(write_behind));
+    }
+  return(write_behind);
+#else
+  (void) image_info;
+  (void) blob_info;
+  return((WriteBehindInfo *) NULL);
+#endif
+}
+
+static inline MagickBooleanType IsBlobMappable(const ImageInfo *image_info,
+  const size_t length)
+{
+  char
+    *value;
+
+  const char
+    *option;
+
+  MagickBooleanType
+    status;
+
+  /*
+    By default only files larger than the stream buffer are memory-mapped.  A
+    define (e.g. -define stream:memory-map=true) overrides the policy: true
+    maps any non-empty regular file, false never maps.
+  */
+  if (length == 0)
+    return(MagickFalse);
+  option=GetImageOption(image_info,"stream:memory-map");
+  if (option != (const char *) NULL)
+    value=ConstantString(option);
+  else
+    value=GetPolicyValue("system:stream-memory-map");
+  if (value == (char *) NULL)
+    return(length > MagickMaxBufferExtent ? MagickTrue : MagickFalse);
+  status=IsStringTrue(value);
+  value=DestroyString(value);
+  return(status);
+}
 
 static inline MagickBooleanType SetStreamBuffering(const ImageInfo *image_info,
   const BlobInfo *blob_info)
@@ -3305,6 +4263,8 @@ MagickExport MagickBooleanType OpenBlob(const ImageInfo *image_info,
       blob_info->custom_stream=image_info->custom_stream;
       return(MagickTrue);
     }
+  if (blob_info->write_behind != (WriteBehindInfo *) NULL)
+    DestroyWriteBehindInfo(blob_info);
   (void) DetachBlob(blob_info);
   blob_info->mode=mode;
   switch (mode)
@@ -3353,6 +4313,8 @@ MagickExport MagickBooleanType OpenBlob(const ImageInfo *image_info,
 #endif
       blob_info->type=StandardStream;
       blob_info->exempt=MagickTrue;
+      if (*type == 'w')
+        blob_info->write_behind=AcquireWriteBehindInfo(image_info,blob_info);
       return(SetStreamBuffering(image_info,blob_info));
     }
   if ((LocaleNCompare(filename,"fd:",3) == 0) &&
@@ -3403,6 +4365,8 @@ MagickExport MagickBooleanType OpenBlob(const ImageInfo *image_info,
         }
       blob_info->type=PipeStream;
       blob_info->exempt=MagickTrue;
+      if (*type == 'w')
+        blob_info->write_behind=AcquireWriteBehindInfo(image_info,blob_info);
       return(SetStreamBuffering(image_info,blob_info));
     }
 #endif
@@ -3418,6 +4382,8 @@ MagickExport MagickBooleanType OpenBlob(const ImageInfo *image_info,
         }
       blob_info->type=FileStream;
       blob_info->exempt=MagickTrue;
+      if (*type == 'w')
+        blob_info->write_behind=AcquireWriteBehindInfo(image_info,blob_info);
       return(SetStreamBuffering(image_info,blob_info));
     }
 #endif
@@ -3467,7 +4433,7 @@ MagickExport MagickBooleanType OpenBlob(const ImageInfo *image_info,
               count;
 
             unsigned char
-              magick[3];
+              magick[4];
 
             blob_info->type=FileStream;
             (void) SetStreamBuffering(image_info,blob_info);
@@ -3511,6 +4477,18 @@ MagickExport MagickBooleanType OpenBlob(const ImageInfo *image_info,
                     blob_info->type=BZipStream;
                   }
               }
+#endif
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+            if (((int) magick[0] == 0x28) && ((int) magick[1] == 0xB5) &&
+                ((int) magick[2] == 0x2F) && ((int) magick[3] == 0xFD))
+              (void) OpenCodecStream(image_info,blob_info,
+                blob_info->file_info.file,ZstdStream,MagickFalse);
+#endif
+#if defined(MAGICKCORE_LZ4_DELEGATE)
+            if (((int) magick[0] == 0x04) && ((int) magick[1] == 0x22) &&
+                ((int) magick[2] == 0x4D) && ((int) magick[3] == 0x18))
+              (void) OpenCodecStream(image_info,blob_info,
+                blob_info->file_info.file,Lz4Stream,MagickFalse);
 #endif
             if (blob_info->type == FileStream)
               {
@@ -3529,7 +4507,8 @@ MagickExport MagickBooleanType OpenBlob(const ImageInfo *image_info,
                 length=(size_t) blob_info->properties.st_size;
                 if ((magick_info != (const MagickInfo *) NULL) &&
                     (GetMagickBlobSupport(magick_info) != MagickFalse) &&
-                    (length > MagickMaxBufferExtent) &&
+                    (S_ISREG(blob_info->properties.st_mode) != 0) &&
+                    (IsBlobMappable(image_info,length) != MagickFalse) &&
                     (AcquireMagickResource(MapResource,length) != MagickFalse))
                   {
                     void
@@ -3578,6 +4557,36 @@ MagickExport MagickBooleanType OpenBlob(const ImageInfo *image_info,
               blob_info->type=BZipStream;
           }
         else
+#endif
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+        if (LocaleCompare(extension,"zst") == 0)
+          {
+            blob_info->file_info.file=(FILE *) fopen_utf8(filename,type);
+            if ((blob_info->file_info.file != (FILE *) NULL) &&
+                (OpenCodecStream(image_info,blob_info,
+                   blob_info->file_info.file,ZstdStream,MagickTrue) ==
+                 MagickFalse))
+              {
+                (void) fclose(blob_info->file_info.file);
+                blob_info->file_info.file=(FILE *) NULL;
+              }
+          }
+        else
+#endif
+#if defined(MAGICKCORE_LZ4_DELEGATE)
+        if (LocaleCompare(extension,"lz4") == 0)
+          {
+            blob_info->file_info.file=(FILE *) fopen_utf8(filename,type);
+            if ((blob_info->file_info.file != (FILE *) NULL) &&
+                (OpenCodecStream(image_info,blob_info,
+                   blob_info->file_info.file,Lz4Stream,MagickTrue) ==
+                 MagickFalse))
+              {
+                (void) fclose(blob_info->file_info.file);
+                blob_info->file_info.file=(FILE *) NULL;
+              }
+          }
+        else
 #endif
           {
             blob_info->file_info.file=(FILE *) fopen_utf8(filename,type);
@@ -3596,6 +4605,14 @@ MagickExport MagickBooleanType OpenBlob(const ImageInfo *image_info,
       ThrowFileException(exception,BlobError,"UnableToOpenBlob",filename);
       return(MagickFalse);
     }
+  if (*type == 'w')
+    blob_info->write_behind=AcquireWriteBehindInfo(image_info,blob_info);
+  if ((*type == 'r') && (image_info->file == (FILE *) NULL) &&
+      (((blob_info->type == FileStream) &&
+        (S_ISREG(blob_info->properties.st_mode) != 0)) ||
+       (blob_info->type == ZipStream) || (blob_info->type == ZstdStream) ||
+       (blob_info->type == Lz4Stream)))
+    blob_info->buffered=MagickTrue;
   return(MagickTrue);
 }
 
@@ -3804,8 +4821,32 @@ MagickExport ssize_t ReadBlob(Image *image,const size_t length,void *data)
     return(0);
   assert(data != (void *) NULL);
   blob_info=image->blob;
-  count=0;
+  if (blob_info->write_behind != (WriteBehindInfo *) NULL)
+    (void) SyncWriteBehind(blob_info,MagickTrue);
   q=(unsigned char *) data;
+  if (blob_info->window.next != (const unsigned char *) NULL)
+    {
+      size_t
+        extent;
+
+      /*
+        Consume the read window first.
+      */
+      extent=(size_t) (blob_info->window.limit-blob_info->window.next);
+      if (extent >= length)
+        {
+          (void) memcpy(q,blob_info->window.next,length);
+          blob_info->window.next+=length;
+          return((ssize_t) length);
+        }
+      if (extent != 0)
+        (void) memcpy(q,blob_info->window.next,extent);
+      blob_info->window.next=(const unsigned char *) NULL;
+      blob_info->window.limit=(const unsigned char *) NULL;
+      count=ReadBlob(image,length-extent,q+extent);
+      return((ssize_t) extent+MagickMax(count,0));
+    }
+  count=0;
   switch (blob_info->type)
   {
     case UndefinedStream:
@@ -3863,6 +4904,8 @@ MagickExport ssize_t ReadBlob(Image *image,const size_t length,void *data)
       if ((count != (ssize_t) length) &&
           (ferror(blob_info->file_info.file) != 0))
         ThrowBlobException(blob_info);
+      if ((count != (ssize_t) length) && (blob_info->buffered != MagickFalse))
+        blob_info->eof=MagickTrue;
       break;
     }
     case ZipStream:
@@ -3965,6 +5008,16 @@ MagickExport ssize_t ReadBlob(Image *image,const size_t length,void *data)
       (void) BZ2_bzerror(blob_info->file_info.bzfile,&status);
       if ((count != (ssize_t) length) && (status != BZ_OK))
         ThrowBlobException(blob_info);
+#endif
+      break;
+    }
+    case ZstdStream:
+    case Lz4Stream:
+    {
+#if defined(MAGICKCORE_ZSTD_DELEGATE) || defined(MAGICKCORE_LZ4_DELEGATE)
+      count=ReadCodecStream(blob_info,length,q);
+      if (count != (ssize_t) length)
+        blob_info->eof=MagickTrue;
 #endif
       break;
     }
@@ -4027,56 +5080,23 @@ MagickExport int ReadBlobByte(Image *image)
   BlobInfo
     *magick_restrict blob_info;
 
-  int
-    c;
+  const unsigned char
+    *p;
+
+  unsigned char
+    buffer[1];
 
   assert(image != (Image *) NULL);
   assert(image->signature == MagickCoreSignature);
   assert(image->blob != (BlobInfo *) NULL);
   assert(image->blob->type != UndefinedStream);
   blob_info=image->blob;
-  switch (blob_info->type)
-  {
-    case StandardStream:
-    case FileStream:
-    case PipeStream:
-    {
-      c=getc(blob_info->file_info.file);
-      if (c == EOF)
-        {
-          if (ferror(blob_info->file_info.file) != 0)
-            ThrowBlobException(blob_info);
-          return(EOF);
-        }
-      break;
-    }
-    case BlobStream:
-    {
-      if (blob_info->offset >= (MagickOffsetType) blob_info->length)
-        {
-          blob_info->eof=MagickTrue;
-          return(EOF);
-        }
-      c=(int) (*((unsigned char *) blob_info->data+blob_info->offset));
-      blob_info->offset++;
-      break;
-    }
-    default:
-    {
-      ssize_t
-        count;
-
-      unsigned char
-        buffer[1];
-
-      count=ReadBlob(image,1,buffer);
-      if (count != 1)
-        return(EOF);
-      c=(int) *buffer;
-      break;
-    }
-  }
-  return(c);
+  if (blob_info->window.next < blob_info->window.limit)
+    return((int) *blob_info->window.next++);
+  p=ReadBlobWindow(image,1,buffer);
+  if (p == (const unsigned char *) NULL)
+    return(EOF);
+  return((int) *p);
 }
 
 /*
@@ -4848,37 +5868,148 @@ MagickExport signed short ReadBlobSignedShort(Image *image)
 %      file.
 %
 */
+
+static size_t FillBlobWindow(BlobInfo *blob_info)
+{
+  size_t
+    extent;
+
+  ssize_t
+    count;
+
+  /*
+    Move the unread bytes to the front of the read-ahead buffer and top it up
+    from the stream.
+  */
+  if (blob_info->buffer == (unsigned char *) NULL)
+    {
+      blob_info->buffer=(unsigned char *) AcquireQuantumMemory(
+        MagickMinBufferExtent,sizeof(*blob_info->buffer));
+      if (blob_info->buffer == (unsigned char *) NULL)
+        {
+          blob_info->buffered=MagickFalse;
+          return(0);
+        }
+    }
+  extent=(size_t) (blob_info->window.limit-blob_info->window.next);
+  if (extent != 0)
+    (void) memmove(blob_info->buffer,blob_info->window.next,extent);
+  count=0;
+  switch (blob_info->type)
+  {
+    case FileStream:
+    {
+      count=(ssize_t) fread(blob_info->buffer+extent,1,MagickMinBufferExtent-
+        extent,blob_info->file_info.file);
+      if ((count != (ssize_t) (MagickMinBufferExtent-extent)) &&
+          (ferror(blob_info->file_info.file) != 0))
+        ThrowBlobException(blob_info);
+      break;
+    }
+    case ZipStream:
+    {
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+      int
+        status;
+
+      count=(ssize_t) gzread(blob_info->file_info.gzfile,blob_info->buffer+
+        extent,(unsigned int) (MagickMinBufferExtent-extent));
+      if (count < 0)
+        count=0;
+      status=Z_OK;
+      (void) gzerror(blob_info->file_info.gzfile,&status);
+      if ((count != (ssize_t) (MagickMinBufferExtent-extent)) &&
+          (status != Z_OK))
+        ThrowBlobException(blob_info);
+#endif
+      break;
+    }
+    case ZstdStream:
+    case Lz4Stream:
+    {
+#if defined(MAGICKCORE_ZSTD_DELEGATE) || defined(MAGICKCORE_LZ4_DELEGATE)
+      count=ReadCodecStream(blob_info,MagickMinBufferExtent-extent,
+        blob_info->buffer+extent);
+#endif
+      break;
+    }
+    default:
+      break;
+  }
+  blob_info->window.next=blob_info->buffer;
+  blob_info->window.limit=blob_info->buffer+extent+count;
+  return(extent+(size_t) count);
+}
+
 MagickExport magick_hot_spot const void *ReadBlobStream(Image *image,
   const size_t length,void *magick_restrict data,ssize_t *count)
 {
   BlobInfo
     *magick_restrict blob_info;
 
+  const unsigned char
+    *p;
+
   assert(image != (Image *) NULL);
   assert(image->signature == MagickCoreSignature);
   assert(image->blob != (BlobInfo *) NULL);
   assert(image->blob->type != UndefinedStream);
   assert(count != (ssize_t *) NULL);
   blob_info=image->blob;
+  p=blob_info->window.next;
+  if ((size_t) (blob_info->window.limit-p) >= length)
+    {
+      blob_info->window.next=p+length;
+      *count=(ssize_t) length;
+      return(p);
+    }
+  if ((blob_info->buffered != MagickFalse) &&
+      (length <= MagickMinBufferExtent))
+    {
+      size_t
+        extent;
+
+      extent=FillBlobWindow(blob_info);
+      if (blob_info->buffered != MagickFalse)
+        {
+          p=blob_info->window.next;
+          *count=(ssize_t) MagickMin(length,extent);
+          blob_info->window.next=p+(*count);
+          if (*count != (ssize_t) length)
+            blob_info->eof=MagickTrue;
+          return(p);
+        }
+    }
   if (blob_info->type != BlobStream)
     {
       assert(data != NULL);
       *count=ReadBlob(image,length,(unsigned char *) data);
       return(data);
     }
+  if (blob_info->window.next != (const unsigned char *) NULL)
+    ResetBlobWindow(blob_info);
   if (blob_info->offset >= (MagickOffsetType) blob_info->length)
     {
       *count=0;
       blob_info->eof=MagickTrue;
       return(data);
     }
-  data=blob_info->data+blob_info->offset;
+  p=blob_info->data+blob_info->offset;
   *count=(ssize_t) MagickMin((MagickOffsetType) length,(MagickOffsetType)
     blob_info->length-blob_info->offset);
-  blob_info->offset+=(*count);
   if (*count != (ssize_t) length)
-    blob_info->eof=MagickTrue;
-  return(data);
+    {
+      blob_info->offset+=(*count);
+      blob_info->eof=MagickTrue;
+      return(p);
+    }
+  /*
+    Expose the rest of the blob as the read window.
+  */
+  blob_info->window.next=p+length;
+  blob_info->window.limit=blob_info->data+blob_info->length;
+  blob_info->offset=(MagickOffsetType) blob_info->length;
+  return(p);
 }
 
 /*
@@ -4906,6 +6037,50 @@ MagickExport magick_hot_spot const void *ReadBlobStream(Image *image,
 %    o string: the address of a character buffer.
 %
 */
+
+static size_t ReadBlobLine(Image *image,char *string)
+{
+  BlobInfo
+    *magick_restrict blob_info;
+
+  size_t
+    i;
+
+  /*
+    Read a line through the read window, as fgets() would.
+  */
+  blob_info=image->blob;
+  for (i=0; i < (MagickPathExtent-1); )
+  {
+    const unsigned char
+      *p,
+      *q;
+
+    size_t
+      extent;
+
+    if (blob_info->window.next >= blob_info->window.limit)
+      if (FillBlobWindow(blob_info) == 0)
+        {
+          blob_info->eof=MagickTrue;
+          break;
+        }
+    p=blob_info->window.next;
+    extent=MagickMin((size_t) (blob_info->window.limit-p),
+      MagickPathExtent-1-i);
+    q=(const unsigned char *) memchr(p,'\n',extent);
+    if (q != (const unsigned char *) NULL)
+      extent=(size_t) (q-p)+1;
+    (void) memcpy(string+i,p,extent);
+    blob_info->window.next=p+extent;
+    i+=extent;
+    if (q != (const unsigned char *) NULL)
+      break;
+  }
+  string[i]='\0';
+  return(i);
+}
+
 MagickExport char *ReadBlobString(Image *image,char *string)
 {
   BlobInfo
@@ -4925,6 +6100,8 @@ MagickExport char *ReadBlobString(Image *image,char *string)
     (void) LogMagickEvent(TraceEvent,GetMagickModule(),"%s",image->filename);
   *string='\0';
   blob_info=image->blob;
+  if (blob_info->write_behind != (WriteBehindInfo *) NULL)
+    (void) SyncWriteBehind(blob_info,MagickTrue);
   switch (blob_info->type)
   {
     case UndefinedStream:
@@ -4932,6 +6109,13 @@ MagickExport char *ReadBlobString(Image *image,char *string)
     case StandardStream:
     case FileStream:
     {
+      if (blob_info->buffered != MagickFalse)
+        {
+          i=ReadBlobLine(image,string);
+          if (i == 0)
+            return((char *) NULL);
+          break;
+        }
       char *p = fgets(string,MagickPathExtent,blob_info->file_info.file);
       if (p == (char *) NULL)
         {
@@ -4945,6 +6129,13 @@ MagickExport char *ReadBlobString(Image *image,char *string)
     case ZipStream:
     {
 #if defined(MAGICKCORE_ZLIB_DELEGATE)
+      if (blob_info->buffered != MagickFalse)
+        {
+          i=ReadBlobLine(image,string);
+          if (i == 0)
+            return((char *) NULL);
+          break;
+        }
       char *p = gzgets(blob_info->file_info.gzfile,string,MagickPathExtent);
       if (p == (char *) NULL)
         {
@@ -4958,6 +6149,18 @@ MagickExport char *ReadBlobString(Image *image,char *string)
       break;
 #endif
     }
+    case ZstdStream:
+    case Lz4Stream:
+    {
+      if (blob_info->buffered != MagickFalse)
+        {
+          i=ReadBlobLine(image,string);
+          if (i == 0)
+            return((char *) NULL);
+          break;
+        }
+      magick_fallthrough;
+    }
     default:
     {
       do
@@ -5070,6 +6273,76 @@ MagickExport MagickOffsetType SeekBlob(Image *image,
   if (IsEventLogging() != MagickFalse)
     (void) LogMagickEvent(TraceEvent,GetMagickModule(),"%s",image->filename);
   blob_info=image->blob;
+  if (blob_info->write_behind != (WriteBehindInfo *) NULL)
+    {
+      MagickOffsetType
+        position;
+
+      WriteBehindInfo
+        *write_behind;
+
+      /*
+        Seeking to the current position (e.g. libtiff locating the next strip)
+        need not wait for pending output.
+      */
+      write_behind=blob_info->write_behind;
+      position=(-1);
+      if (write_behind->offset >= 0)
+        switch (whence)
+        {
+          case SEEK_SET:
+          default:
+          {
+            position=offset;
+            break;
+          }
+          case SEEK_CUR:
+          {
+            position=write_behind->offset+offset;
+            break;
+          }
+          case SEEK_END:
+          {
+            if (blob_info->type == FileStream)
+              position=(MagickOffsetType) write_behind->size+offset;
+            break;
+          }
+        }
+      if ((position >= 0) && (position == write_behind->offset))
+        {
+          blob_info->offset=position;
+          return(position);
+        }
+      (void) SyncWriteBehind(blob_info,MagickTrue);
+      write_behind->offset=(-1);
+    }
+  if (blob_info->window.next != (const unsigned char *) NULL)
+    {
+      if (blob_info->type == BlobStream)
+        ResetBlobWindow(blob_info);
+      else if ((blob_info->type == ZstdStream) ||
+               (blob_info->type == Lz4Stream))
+        return(-1);
+      else
+        {
+          MagickOffsetType
+            position;
+
+          /*
+            Discard the read window; a relative seek is from the logical
+            position.
+          */
+          position=offset;
+          if (whence == SEEK_CUR)
+            position+=TellBlob(image);
+          if ((whence != SEEK_END) && (position < 0))
+            return(-1);
+          blob_info->window.next=(const unsigned char *) NULL;
+          blob_info->window.limit=(const unsigned char *) NULL;
+          if (whence == SEEK_CUR)
+            return(SeekBlob(image,position,SEEK_SET));
+        }
+    }
   switch (blob_info->type)
   {
     case UndefinedStream:
@@ -5084,6 +6357,8 @@ MagickExport MagickOffsetType SeekBlob(Image *image,
       if (fseek(blob_info->file_info.file,offset,whence) < 0)
         return(-1);
       blob_info->offset=TellBlob(image);
+      if (blob_info->buffered != MagickFalse)
+        blob_info->eof=MagickFalse;
       break;
     }
     case ZipStream:
@@ -5093,10 +6368,15 @@ MagickExport MagickOffsetType SeekBlob(Image *image,
         return(-1);
 #endif
       blob_info->offset=TellBlob(image);
+      if (blob_info->buffered != MagickFalse)
+        blob_info->eof=MagickFalse;
       break;
     }
     case BZipStream:
       return(-1);
+    case ZstdStream:
+    case Lz4Stream:
+      return(-1);
     case FifoStream:
       return(-1);
     case BlobStream:
@@ -5148,6 +6428,9 @@ MagickExport MagickOffsetType SeekBlob(Image *image,
       break;
     }
   }
+  if ((blob_info->write_behind != (WriteBehindInfo *) NULL) &&
+      ((blob_info->type == FileStream) || (blob_info->type == ZipStream)))
+    blob_info->write_behind->offset=blob_info->offset;
   return(blob_info->offset);
 }
 
@@ -5224,6 +6507,8 @@ MagickExport MagickBooleanType SetBlobExtent(Image *image,
   if (IsEventLogging() != MagickFalse)
     (void) LogMagickEvent(TraceEvent,GetMagickModule(),"%s",image->filename);
   blob_info=image->blob;
+  if (blob_info->window.next != (const unsigned char *) NULL)
+    ResetBlobWindow(blob_info);
   switch (blob_info->type)
   {
     case UndefinedStream:
@@ -5240,6 +6525,8 @@ MagickExport MagickBooleanType SetBlobExtent(Image *image,
 
       if (extent != (MagickSizeType) ((off_t) extent))
         return(MagickFalse);
+      if (blob_info->write_behind != (WriteBehindInfo *) NULL)
+        DestroyWriteBehindInfo(blob_info);
       offset=SeekBlob(image,0,SEEK_END);
       if (offset < 0)
         return(MagickFalse);
@@ -5272,6 +6559,9 @@ MagickExport MagickBooleanType SetBlobExtent(Image *image,
       return(MagickFalse);
     case BZipStream:
       return(MagickFalse);
+    case ZstdStream:
+    case Lz4Stream:
+      return(MagickFalse);
     case FifoStream:
       return(MagickFalse);
     case BlobStream:
@@ -5540,9 +6830,11 @@ static int SyncBlob(const Image *image)
   assert(image->blob != (BlobInfo *) NULL);
   if (IsEventLogging() != MagickFalse)
     (void) LogMagickEvent(TraceEvent,GetMagickModule(),"%s",image->filename);
+  blob_info=image->blob;
+  if (blob_info->write_behind != (WriteBehindInfo *) NULL)
+    (void) SyncWriteBehind(blob_info,MagickTrue);
   if (EOFBlob(image) != 0)
     return(0);
-  blob_info=image->blob;
   status=0;
   switch (blob_info->type)
   {
@@ -5566,6 +6858,16 @@ static int SyncBlob(const Image *image)
     {
 #if defined(MAGICKCORE_BZLIB_DELEGATE)
       status=BZ2_bzflush(blob_info->file_info.bzfile);
+#endif
+      break;
+    }
+    case ZstdStream:
+    case Lz4Stream:
+    {
+#if defined(MAGICKCORE_ZSTD_DELEGATE) || defined(MAGICKCORE_LZ4_DELEGATE)
+      status=FlushCodecStream(blob_info,MagickFalse);
+      if (status == 0)
+        status=fflush(blob_info->file_info.codec->file);
 #endif
       break;
     }
@@ -5616,6 +6918,12 @@ MagickExport MagickOffsetType TellBlob(const Image *image)
   if (IsEventLogging() != MagickFalse)
     (void) LogMagickEvent(TraceEvent,GetMagickModule(),"%s",image->filename);
   blob_info=image->blob;
+  if (blob_info->write_behind != (WriteBehindInfo *) NULL)
+    {
+      if (blob_info->write_behind->offset >= 0)
+        return(blob_info->write_behind->offset);
+      (void) SyncWriteBehind(blob_info,MagickTrue);
+    }
   offset=(-1);
   switch (blob_info->type)
   {
@@ -5638,6 +6946,9 @@ MagickExport MagickOffsetType TellBlob(const Image *image)
     }
     case BZipStream:
       break;
+    case ZstdStream:
+    case Lz4Stream:
+      break;
     case FifoStream:
       break;
     case BlobStream:
@@ -5652,6 +6963,9 @@ MagickExport MagickOffsetType TellBlob(const Image *image)
       break;
     }
   }
+  if (offset >= 0)
+    offset-=(MagickOffsetType) (blob_info->window.limit-
+      blob_info->window.next);
   return(offset);
 }
 
@@ -5749,6 +7063,10 @@ MagickExport ssize_t WriteBlob(Image *image,const size_t length,
     return(0);
   assert(data != (const void *) NULL);
   blob_info=image->blob;
+  if (blob_info->window.next != (const unsigned char *) NULL)
+    ResetBlobWindow(blob_info);
+  if (blob_info->write_behind != (WriteBehindInfo *) NULL)
+    return(WriteBehindBlob(blob_info,length,(const unsigned char *) data));
   count=0;
   p=(const unsigned char *) data;
   q=(unsigned char *) data;
@@ -5902,6 +7220,16 @@ MagickExport ssize_t WriteBlob(Image *image,const size_t length,
       (void) BZ2_bzerror(blob_info->file_info.bzfile,&status);
       if ((count != (ssize_t) length) && (status != BZ_OK))
         ThrowBlobException(blob_info);
+#endif
+      break;
+    }
+    case ZstdStream:
+    case Lz4Stream:
+    {
+#if defined(MAGICKCORE_ZSTD_DELEGATE) || defined(MAGICKCORE_LZ4_DELEGATE)
+      count=WriteCodecStream(blob_info,length,q);
+      if (count != (ssize_t) length)
+        ThrowBlobException(blob_info);
 #endif
       break;
     }
@@ -5985,6 +7313,10 @@ MagickExport ssize_t WriteBlobByte(Image *image,const unsigned char value)
   assert(image->blob != (BlobInfo *) NULL);
   assert(image->blob->type != UndefinedStream);
   blob_info=image->blob;
+  if (blob_info->window.next != (const unsigned char *) NULL)
+    ResetBlobWindow(blob_info);
+  if (blob_info->write_behind != (WriteBehindInfo *) NULL)
+    return(WriteBehindBlob(blob_info,1,&value));
   count=0;
   switch (blob_info->type)
   {
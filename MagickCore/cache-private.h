@@ -20,6 +20,7 @@
 
 #include "MagickCore/cache.h"
 #include "MagickCore/distribute-cache.h"
+#include "MagickCore/memory-private.h"
 #include "MagickCore/opencl-private.h"
 #include "MagickCore/pixel.h"
 #include "MagickCore/random_.h"
@@ -127,8 +128,70 @@ typedef struct _NexusInfo
 
   struct _NexusInfo
     *virtual_nexus;
+
+  ssize_t
+    read_y,
+    read_ahead_y,
+    write_y,
+    write_behind_y;
+
+  MagickSizeType
+    direct_requests,
+    buffered_requests,
+    virtual_requests,
+    read_ahead_requests,
+    write_behind_requests;
+
+  struct _CacheInfo
+    *pinned_cache;
+
+  size_t
+    pinned_serial;
 } NexusInfo;
 
+typedef struct _CacheBlockInfo
+{
+  unsigned char
+    *blob;
+
+  size_t
+    length;
+
+  MagickBooleanType
+    on_disk;
+} CacheBlockInfo;
+
+typedef struct _CacheHotBlockInfo
+{
+  unsigned char
+    *pixels;
+
+  ssize_t
+    block;
+
+  MagickBooleanType
+    dirty;
+} CacheHotBlockInfo;
+
+typedef enum
+{
+  UndefinedNumaPolicy,
+  FirstTouchNumaPolicy,
+  InterleaveNumaPolicy
+} NumaPolicy;
+
+typedef struct _CacheWindowInfo
+{
+  unsigned char
+    *map;
+
+  MagickOffsetType
+    offset;
+
+  size_t
+    length;
+} CacheWindowInfo;
+
 typedef struct _CacheInfo
 {
   ClassType
@@ -233,6 +296,86 @@ typedef struct _CacheInfo
   MagickSizeType
     width_limit,
     height_limit;
+
+  size_t
+    tile_width,
+    tile_height;
+
+  MemoryAdvice
+    memory_advice;
+
+  NumaPolicy
+    numa_policy;
+
+  CacheWindowInfo
+    *windows;
+
+  size_t
+    number_windows,
+    window_size;
+
+  size_t
+    read_ahead,
+    write_behind;
+
+  CacheBlockInfo
+    *blocks;
+
+  CacheHotBlockInfo
+    *hot_blocks;
+
+  size_t
+    block_size,
+    number_blocks,
+    number_hot_blocks;
+
+  MagickSizeType
+    compressed_length,
+    block_file_length;
+
+  size_t
+    storage_depth;
+
+  MagickBooleanType
+    block_compress;
+
+  unsigned char
+    *block_buffer;
+
+  struct _CacheInfo
+    *shared_cache,
+    *clones,
+    *next_clone;
+
+  unsigned char
+    *shared_bands;
+
+  size_t
+    band_rows,
+    number_bands,
+    number_shared_bands,
+    number_clones;
+
+  SemaphoreInfo
+    *clone_semaphore;
+
+  CacheStatistics
+    statistics;
+
+  MagickBooleanType
+    spilled,
+    exported;
+
+  struct _CacheInfo
+    *previous_cache,
+    *next_cache;
+
+  size_t
+    serial,
+    pins;
+
+  MagickSizeType
+    last_use;
 } CacheInfo;
 
 static inline MagickBooleanType IsValidPixelOffset(const ssize_t x,
@@ -268,11 +411,18 @@ extern MagickPrivate const void
   *GetVirtualMetacontentFromNexus(const Cache,NexusInfo *magick_restrict);
 
 extern MagickPrivate MagickBooleanType
+  ApplyPixelCacheOperation(Image *,const Image *,const char *,const ssize_t,
+    ExceptionInfo *),
   CacheComponentGenesis(void),
+  ResetPixelCachePixels(Image *),
   SyncAuthenticPixelCacheNexus(Image *,NexusInfo *magick_restrict,
     ExceptionInfo *) magick_hot_spot,
   SyncImagePixelCache(Image *,ExceptionInfo *);
 
+extern MagickPrivate int
+  GetPixelCacheRegionFile(const Image *,const RectangleInfo *,
+    MagickOffsetType *);
+
 extern MagickPrivate MagickSizeType
   GetPixelCacheNexusExtent(const Cache,NexusInfo *magick_restrict);
 
@@ -299,6 +449,8 @@ extern MagickPrivate void
   ClonePixelCacheMethods(Cache,const Cache),
   GetPixelCacheTileSize(const Image *,size_t *,size_t *),
   GetPixelCacheMethods(CacheMethods *),
+  MergePixelCacheNexusStatistics(const Cache,NexusInfo **,const size_t),
+  PromotePixelCache(const Cache),
   ResetCacheAnonymousMemory(void),
   ResetPixelCacheChannels(Image *),
   SetPixelCacheMethods(Cache,CacheMethods *);
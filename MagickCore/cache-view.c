@@ -62,6 +62,19 @@
 /*
   Typedef declarations.
 */
+typedef struct _CacheViewPlane
+{
+  Quantum
+    *pixels;
+
+  size_t
+    extent,
+    number_pixels;
+
+  PixelChannel
+    channel;
+} CacheViewPlane;
+
 struct _CacheView
 {
   Image
@@ -74,7 +87,11 @@ struct _CacheView
     number_threads;
 
   NexusInfo
-    **nexus_info;
+    **nexus_info,
+    **channel_nexus_info;
+
+  CacheViewPlane
+    *planes;
 
   MagickBooleanType
     debug;
@@ -172,6 +189,14 @@ MagickExport CacheView *AcquireVirtualCacheView(const Image *image,
   if (cache_view->number_threads == 0)
     cache_view->number_threads=1;
   cache_view->nexus_info=AcquirePixelCacheNexus(cache_view->number_threads);
+  cache_view->channel_nexus_info=AcquirePixelCacheNexus(
+    cache_view->number_threads);
+  cache_view->planes=(CacheViewPlane *) AcquireQuantumMemory(2*
+    cache_view->number_threads,sizeof(*cache_view->planes));
+  if (cache_view->planes == (CacheViewPlane *) NULL)
+    ThrowFatalException(ResourceLimitFatalError,"MemoryAllocationFailed");
+  (void) memset(cache_view->planes,0,2*cache_view->number_threads*
+    sizeof(*cache_view->planes));
   cache_view->virtual_pixel_method=GetImageVirtualPixelMethod(image);
   cache_view->debug=(GetLogEventMask() & CacheEvent) != 0 ? MagickTrue :
     MagickFalse;
@@ -219,6 +244,14 @@ MagickExport CacheView *CloneCacheView(const CacheView *cache_view)
   clone_view->image=ReferenceImage(cache_view->image);
   clone_view->number_threads=cache_view->number_threads;
   clone_view->nexus_info=AcquirePixelCacheNexus(cache_view->number_threads);
+  clone_view->channel_nexus_info=AcquirePixelCacheNexus(
+    cache_view->number_threads);
+  clone_view->planes=(CacheViewPlane *) AcquireQuantumMemory(2*
+    clone_view->number_threads,sizeof(*clone_view->planes));
+  if (clone_view->planes == (CacheViewPlane *) NULL)
+    ThrowFatalException(ResourceLimitFatalError,"MemoryAllocationFailed");
+  (void) memset(clone_view->planes,0,2*clone_view->number_threads*
+    sizeof(*clone_view->planes));
   clone_view->virtual_pixel_method=cache_view->virtual_pixel_method;
   clone_view->debug=cache_view->debug;
   clone_view->signature=MagickCoreSignature;
@@ -256,14 +289,155 @@ MagickExport CacheView *DestroyCacheView(CacheView *cache_view)
     (void) LogMagickEvent(TraceEvent,GetMagickModule(),"%s",
       cache_view->image->filename);
   if (cache_view->nexus_info != (NexusInfo **) NULL)
-    cache_view->nexus_info=DestroyPixelCacheNexus(cache_view->nexus_info,
-      cache_view->number_threads);
+    {
+      MergePixelCacheNexusStatistics(cache_view->image->cache,
+        cache_view->nexus_info,cache_view->number_threads);
+      cache_view->nexus_info=DestroyPixelCacheNexus(cache_view->nexus_info,
+        cache_view->number_threads);
+    }
+  if (cache_view->channel_nexus_info != (NexusInfo **) NULL)
+    {
+      MergePixelCacheNexusStatistics(cache_view->image->cache,
+        cache_view->channel_nexus_info,cache_view->number_threads);
+      cache_view->channel_nexus_info=DestroyPixelCacheNexus(
+        cache_view->channel_nexus_info,cache_view->number_threads);
+    }
+  if (cache_view->planes != (CacheViewPlane *) NULL)
+    {
+      ssize_t
+        i;
+
+      for (i=0; i < (ssize_t) (2*cache_view->number_threads); i++)
+        cache_view->planes[i].pixels=(Quantum *) RelinquishAlignedMemory(
+          cache_view->planes[i].pixels);
+      cache_view->planes=(CacheViewPlane *) RelinquishMagickMemory(
+        cache_view->planes);
+    }
   cache_view->image=DestroyImage(cache_view->image);
   cache_view->signature=(~MagickCoreSignature);
   cache_view=(CacheView *) RelinquishAlignedMemory(cache_view);
   return(cache_view);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t C a c h e V i e w A u t h e n t i c C h a n n e l                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetCacheViewAuthenticChannel() gets one channel of the pixels from the
+%  in-memory or disk pixel cache as defined by the geometry parameters.  The
+%  channel is returned as a contiguous plane of columns*rows quantums, in row
+%  order, if the pixels are transferred, otherwise a NULL is returned.  Call
+%  SyncCacheViewAuthenticChannel() to save the plane back to the cache.
+%
+%  The format of the GetCacheViewAuthenticChannel method is:
+%
+%      Quantum *GetCacheViewAuthenticChannel(CacheView *cache_view,
+%        const PixelChannel channel,const ssize_t x,const ssize_t y,
+%        const size_t columns,const size_t rows,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o cache_view: the cache view.
+%
+%    o channel: the pixel channel.
+%
+%    o x,y,columns,rows:  These values define the perimeter of a region of
+%      pixels.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+static Quantum *ExportCacheViewPlane(const CacheView *cache_view,
+  CacheViewPlane *magick_restrict plane,const PixelChannel channel,
+  const Quantum *magick_restrict p,const size_t columns,const size_t rows,
+  ExceptionInfo *exception)
+{
+  Quantum
+    *magick_restrict q;
+
+  size_t
+    number_channels,
+    number_pixels;
+
+  ssize_t
+    i,
+    offset;
+
+  /*
+    Gather the channel of the nexus pixels into the plane of this thread.
+  */
+  if (p == (const Quantum *) NULL)
+    return((Quantum *) NULL);
+  if (GetPixelChannelTraits(cache_view->image,channel) == UndefinedPixelTrait)
+    {
+      (void) ThrowMagickException(exception,GetMagickModule(),OptionError,
+        "NoSuchImageChannel","`%s'",cache_view->image->filename);
+      return((Quantum *) NULL);
+    }
+  number_pixels=columns*rows;
+  if (plane->extent < number_pixels)
+    {
+      plane->pixels=(Quantum *) RelinquishAlignedMemory(plane->pixels);
+      plane->extent=0;
+      plane->pixels=(Quantum *) AcquireAlignedMemory(number_pixels,
+        sizeof(*plane->pixels));
+      if (plane->pixels == (Quantum *) NULL)
+        {
+          (void) ThrowMagickException(exception,GetMagickModule(),
+            ResourceLimitError,"MemoryAllocationFailed","`%s'",
+            cache_view->image->filename);
+          return((Quantum *) NULL);
+        }
+      plane->extent=number_pixels;
+    }
+  plane->number_pixels=number_pixels;
+  plane->channel=channel;
+  number_channels=GetPixelChannels(cache_view->image);
+  offset=GetPixelChannelOffset(cache_view->image,channel);
+  q=plane->pixels;
+  for (i=0; i < (ssize_t) number_pixels; i++)
+    q[i]=p[(size_t) i*number_channels+(size_t) offset];
+  return(plane->pixels);
+}
+
+MagickExport Quantum *GetCacheViewAuthenticChannel(CacheView *cache_view,
+  const PixelChannel channel,const ssize_t x,const ssize_t y,
+  const size_t columns,const size_t rows,ExceptionInfo *exception)
+{
+  const int
+    id = GetOpenMPThreadId();
+
+  CacheViewPlane
+    *magick_restrict plane;
+
+  Quantum
+    *magick_restrict pixels;
+
+  assert(cache_view != (CacheView *) NULL);
+  assert(cache_view->signature == MagickCoreSignature);
+  assert(id < (int) cache_view->number_threads);
+  /*
+    A failed request leaves no plane for SyncCacheViewAuthenticChannel().
+  */
+  plane=cache_view->planes+id;
+  plane->number_pixels=0;
+  pixels=GetAuthenticPixelCacheNexus(cache_view->image,x,y,columns,rows,
+    cache_view->nexus_info[id],exception);
+  pixels=ExportCacheViewPlane(cache_view,plane,channel,pixels,columns,rows,
+    exception);
+  if (pixels == (Quantum *) NULL)
+    plane->number_pixels=0;
+  return(pixels);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -529,6 +703,65 @@ MagickExport ClassType GetCacheViewStorageClass(const CacheView *cache_view)
   return(GetPixelCacheStorageClass(cache_view->image->cache));
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t C a c h e V i e w V i r t u a l C h a n n e l                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetCacheViewVirtualChannel() gets one channel of the virtual pixels from
+%  the in-memory or disk pixel cache as defined by the geometry parameters.
+%  The channel is returned as a contiguous plane of columns*rows quantums, in
+%  row order, if the pixels are transferred, otherwise a NULL is returned.
+%
+%  The format of the GetCacheViewVirtualChannel method is:
+%
+%      const Quantum *GetCacheViewVirtualChannel(const CacheView *cache_view,
+%        const PixelChannel channel,const ssize_t x,const ssize_t y,
+%        const size_t columns,const size_t rows,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o cache_view: the cache view.
+%
+%    o channel: the pixel channel.
+%
+%    o x,y,columns,rows:  These values define the perimeter of a region of
+%      pixels.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+MagickExport const Quantum *GetCacheViewVirtualChannel(
+  const CacheView *cache_view,const PixelChannel channel,const ssize_t x,
+  const ssize_t y,const size_t columns,const size_t rows,
+  ExceptionInfo *exception)
+{
+  const int
+    id = GetOpenMPThreadId();
+
+  const Quantum
+    *magick_restrict pixels;
+
+  assert(cache_view != (CacheView *) NULL);
+  assert(cache_view->signature == MagickCoreSignature);
+  assert(id < (int) cache_view->number_threads);
+  /*
+    Virtual channels have their own nexus and plane so they do not disturb
+    a pending authentic channel.
+  */
+  pixels=GetVirtualPixelCacheNexus(cache_view->image,
+    cache_view->virtual_pixel_method,x,y,columns,rows,
+    cache_view->channel_nexus_info[id],exception);
+  return(ExportCacheViewPlane(cache_view,cache_view->planes+
+    cache_view->number_threads+id,channel,pixels,columns,rows,exception));
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -1069,6 +1302,76 @@ MagickExport MagickBooleanType SetCacheViewVirtualPixelMethod(
   return(MagickTrue);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   S y n c C a c h e V i e w A u t h e n t i c C h a n n e l                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SyncCacheViewAuthenticChannel() scatters the plane returned by the last
+%  call to GetCacheViewAuthenticChannel() back into the cache view pixels and
+%  saves them to the in-memory or disk cache.  Virtual channels read in
+%  between do not disturb the plane.  It returns MagickTrue if the pixel
+%  region is flushed, otherwise MagickFalse, including when the last
+%  GetCacheViewAuthenticChannel() failed.
+%
+%  The format of the SyncCacheViewAuthenticChannel method is:
+%
+%      MagickBooleanType SyncCacheViewAuthenticChannel(CacheView *cache_view,
+%        ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o cache_view: the cache view.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+MagickExport MagickBooleanType SyncCacheViewAuthenticChannel(
+  CacheView *magick_restrict cache_view,ExceptionInfo *exception)
+{
+  const int
+    id = GetOpenMPThreadId();
+
+  const CacheViewPlane
+    *magick_restrict plane;
+
+  MagickBooleanType
+    status;
+
+  Quantum
+    *magick_restrict q;
+
+  size_t
+    number_channels;
+
+  ssize_t
+    i,
+    offset;
+
+  assert(cache_view != (CacheView *) NULL);
+  assert(cache_view->signature == MagickCoreSignature);
+  assert(id < (int) cache_view->number_threads);
+  plane=cache_view->planes+id;
+  q=cache_view->nexus_info[id]->pixels;
+  if ((plane->number_pixels == 0) || (q == (Quantum *) NULL) ||
+      (plane->number_pixels != ((size_t) cache_view->nexus_info[id]->
+       region.width*cache_view->nexus_info[id]->region.height)))
+    return(MagickFalse);
+  number_channels=GetPixelChannels(cache_view->image);
+  offset=GetPixelChannelOffset(cache_view->image,plane->channel);
+  for (i=0; i < (ssize_t) plane->number_pixels; i++)
+    q[(size_t) i*number_channels+(size_t) offset]=plane->pixels[i];
+  status=SyncAuthenticPixelCacheNexus(cache_view->image,
+    cache_view->nexus_info[id],exception);
+  return(status);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
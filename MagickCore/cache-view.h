@@ -64,6 +64,9 @@ extern MagickExport const Image
   *GetCacheViewImage(const CacheView *) magick_attribute((__pure__));
 
 extern MagickExport const Quantum
+  *GetCacheViewVirtualChannel(const CacheView *,const PixelChannel,
+    const ssize_t,const ssize_t,const size_t,const size_t,ExceptionInfo *)
+    magick_hot_spot,
   *GetCacheViewVirtualPixels(const CacheView *,const ssize_t,const ssize_t,
     const size_t,const size_t,ExceptionInfo *) magick_hot_spot,
   *GetCacheViewVirtualPixelQueue(const CacheView *) magick_hot_spot;
@@ -84,6 +87,8 @@ extern MagickExport MagickBooleanType
   SetCacheViewStorageClass(CacheView *,const ClassType,ExceptionInfo *),
   SetCacheViewVirtualPixelMethod(CacheView *magick_restrict,
     const VirtualPixelMethod),
+  SyncCacheViewAuthenticChannel(CacheView *magick_restrict,ExceptionInfo *)
+    magick_hot_spot,
   SyncCacheViewAuthenticPixels(CacheView *magick_restrict,ExceptionInfo *)
     magick_hot_spot;
 
@@ -91,6 +96,8 @@ extern MagickExport MagickSizeType
   GetCacheViewExtent(const CacheView *) magick_attribute((__pure__));
 
 extern MagickExport Quantum
+  *GetCacheViewAuthenticChannel(CacheView *,const PixelChannel,const ssize_t,
+    const ssize_t,const size_t,const size_t,ExceptionInfo *) magick_hot_spot,
   *GetCacheViewAuthenticPixelQueue(CacheView *) magick_hot_spot,
   *GetCacheViewAuthenticPixels(CacheView *,const ssize_t,const ssize_t,
     const size_t,const size_t,ExceptionInfo *) magick_hot_spot,
@@ -107,6 +107,9 @@ static Cache
   GetImagePixelCache(Image *,const MagickBooleanType,ExceptionInfo *)
     magick_hot_spot;
 
+static char
+  *GetPixelCacheSetting(const Image *,const char *);
+
 static const Quantum
   *GetVirtualPixelCache(const Image *,const VirtualPixelMethod,const ssize_t,
     const ssize_t,const size_t,const size_t,ExceptionInfo *),
@@ -142,6 +145,17 @@ static Quantum
     const MagickBooleanType,NexusInfo *magick_restrict,ExceptionInfo *)
     magick_hot_spot;
 
+static void
+  CopyPixelCacheBands(CacheInfo *magick_restrict,const ssize_t,const size_t),
+  DestroyImagePixelCache(Image *);
+
+static inline MagickOffsetType
+  ReadPixelCacheRegion(const CacheInfo *magick_restrict,const MagickBooleanType,
+    const MagickOffsetType,const MagickSizeType,unsigned char *magick_restrict),
+  WritePixelCacheRegion(const CacheInfo *magick_restrict,
+    const MagickBooleanType,const MagickOffsetType,const MagickSizeType,
+    const unsigned char *magick_restrict);
+
 #if defined(MAGICKCORE_OPENCL_SUPPORT)
 static void
   CopyOpenCLBuffer(CacheInfo *magick_restrict);
@@ -159,6 +173,140 @@ static SemaphoreInfo
 
 static ssize_t
   cache_anonymous_memory = (-1);
+
+static CacheInfo
+  *cache_list = (CacheInfo *) NULL;
+
+static MagickSizeType
+  cache_clock = 0;
+
+static size_t
+  cache_serial = 0;
+
+static CacheStatistics
+  cache_statistics;
+
+static SemaphoreInfo
+  *statistics_semaphore = (SemaphoreInfo *) NULL;
+
+static inline void UpdatePixelCacheStatistic(MagickSizeType *statistic,
+  const MagickSizeType value)
+{
+  /*
+    Clones, promotions, and demotions are rare; the nexus request counters are
+    kept per nexus and merged when the nexus is destroyed.
+  */
+  LockSemaphoreInfo(statistics_semaphore);
+  *statistic+=value;
+  UnlockSemaphoreInfo(statistics_semaphore);
+}
+
+/*
+  A pixel cache is pinned while it may not move to another tier: while a nexus
+  points into it, and while it is opened, cloned, or shared.  The registry of
+  pinned caches, their pin counts, and their last use are guarded by the cache
+  semaphore.  Only caches that DestroyPixelCache() frees are registered; a
+  pixel stream owns its pixels and frees itself.
+*/
+static void PinPixelCache(CacheInfo *magick_restrict cache_info)
+{
+  LockSemaphoreInfo(cache_semaphore);
+  if ((cache_info->serial == 0) &&
+      ((cache_info->methods.destroy_pixel_handler ==
+        (DestroyPixelHandler) NULL) ||
+       (cache_info->methods.destroy_pixel_handler == DestroyImagePixelCache)))
+    {
+      cache_info->serial=(++cache_serial);
+      cache_info->previous_cache=(CacheInfo *) NULL;
+      cache_info->next_cache=cache_list;
+      if (cache_list != (CacheInfo *) NULL)
+        cache_list->previous_cache=cache_info;
+      cache_list=cache_info;
+    }
+  cache_info->pins++;
+  UnlockSemaphoreInfo(cache_semaphore);
+}
+
+static inline void ReleasePixelCachePin(CacheInfo *magick_restrict cache_info)
+{
+  cache_info->pins--;
+  if (cache_info->pins == 0)
+    cache_info->last_use=(++cache_clock);
+}
+
+static void UnpinPixelCache(CacheInfo *magick_restrict cache_info)
+{
+  LockSemaphoreInfo(cache_semaphore);
+  ReleasePixelCachePin(cache_info);
+  UnlockSemaphoreInfo(cache_semaphore);
+}
+
+static void ReleasePixelCacheNexusPin(const CacheInfo *magick_restrict owner,
+  NexusInfo *magick_restrict nexus_info)
+{
+  CacheInfo
+    *magick_restrict p;
+
+  /*
+    Release the pin of a nexus; the caller holds the cache semaphore.  Unless
+    the caller owns the pinned cache, it may be gone, so only a cache still
+    registered under the same serial is released.
+  */
+  p=nexus_info->pinned_cache;
+  if ((p != owner) || (p->serial != nexus_info->pinned_serial))
+    for (p=cache_list; p != (CacheInfo *) NULL; p=p->next_cache)
+      if ((p == nexus_info->pinned_cache) &&
+          (p->serial == nexus_info->pinned_serial))
+        break;
+  if (p != (CacheInfo *) NULL)
+    ReleasePixelCachePin(p);
+  nexus_info->pinned_cache=(CacheInfo *) NULL;
+  nexus_info->pinned_serial=0;
+}
+
+static void UnpinPixelCacheNexus(const CacheInfo *magick_restrict owner,
+  NexusInfo *magick_restrict nexus_info)
+{
+  if (nexus_info->pinned_cache == (CacheInfo *) NULL)
+    return;
+  LockSemaphoreInfo(cache_semaphore);
+  ReleasePixelCacheNexusPin(owner,nexus_info);
+  UnlockSemaphoreInfo(cache_semaphore);
+}
+
+static inline void PinPixelCacheNexus(CacheInfo *magick_restrict cache_info,
+  NexusInfo *magick_restrict nexus_info)
+{
+  /*
+    A nexus keeps its pin from one request to the next, so a loop over the
+    same cache takes the cache semaphore only on its first request.
+  */
+  if ((nexus_info->pinned_cache == cache_info) &&
+      (nexus_info->pinned_serial == cache_info->serial))
+    return;
+  LockSemaphoreInfo(cache_semaphore);
+  if (nexus_info->pinned_cache != (CacheInfo *) NULL)
+    ReleasePixelCacheNexusPin(cache_info,nexus_info);
+  if (cache_info->serial != 0)
+    {
+      cache_info->pins++;
+      nexus_info->pinned_cache=cache_info;
+      nexus_info->pinned_serial=cache_info->serial;
+    }
+  UnlockSemaphoreInfo(cache_semaphore);
+}
+
+static inline void UnpinBufferedPixelCacheNexus(
+  const CacheInfo *magick_restrict cache_info,
+  NexusInfo *magick_restrict nexus_info)
+{
+  /*
+    Once a request of the image nexus is served from its own buffer, no
+    pointer into the cache remains.
+  */
+  if (nexus_info->authentic_pixel_cache == MagickFalse)
+    UnpinPixelCacheNexus(cache_info,nexus_info);
+}
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -225,6 +373,7 @@ MagickPrivate Cache AcquirePixelCache(const size_t number_threads)
   cache_info->semaphore=AcquireSemaphoreInfo();
   cache_info->reference_count=1;
   cache_info->file_semaphore=AcquireSemaphoreInfo();
+  cache_info->clone_semaphore=AcquireSemaphoreInfo();
   cache_info->debug=(GetLogEventMask() & CacheEvent) != 0 ? MagickTrue :
     MagickFalse;
   cache_info->signature=MagickCoreSignature;
@@ -258,24 +407,36 @@ MagickPrivate NexusInfo **AcquirePixelCacheNexus(const size_t number_threads)
   NexusInfo
     **magick_restrict nexus_info;
 
+  size_t
+    extent;
+
   ssize_t
     i;
 
+  unsigned char
+    *magick_restrict nexus;
+
   nexus_info=(NexusInfo **) MagickAssumeAligned(AcquireAlignedMemory(2*
     number_threads,sizeof(*nexus_info)));
   if (nexus_info == (NexusInfo **) NULL)
     ThrowFatalException(ResourceLimitFatalError,"MemoryAllocationFailed");
-  *nexus_info=(NexusInfo *) AcquireQuantumMemory(number_threads,
-    2*sizeof(**nexus_info));
-  if (*nexus_info == (NexusInfo *) NULL)
+  /*
+    Each thread's nexus and its virtual nexus are cache line aligned so
+    threads updating their own nexus do not contend for the same line.
+  */
+  extent=CACHE_ALIGNED(sizeof(**nexus_info));
+  nexus=(unsigned char *) AcquireAlignedMemory(2*number_threads,extent);
+  if (nexus == (unsigned char *) NULL)
     ThrowFatalException(ResourceLimitFatalError,"MemoryAllocationFailed");
-  (void) memset(*nexus_info,0,2*number_threads*sizeof(**nexus_info));
-  for (i=0; i < (ssize_t) (2*number_threads); i++)
+  (void) memset(nexus,0,2*number_threads*extent);
+  for (i=0; i < (ssize_t) number_threads; i++)
   {
-    nexus_info[i]=(*nexus_info+i);
-    if (i < (ssize_t) number_threads)
-      nexus_info[i]->virtual_nexus=(*nexus_info+number_threads+i);
+    nexus_info[i]=(NexusInfo *) (nexus+2*(size_t) i*extent);
+    nexus_info[(ssize_t) number_threads+i]=(NexusInfo *) (nexus+(2*(size_t)
+      i+1)*extent);
+    nexus_info[i]->virtual_nexus=nexus_info[(ssize_t) number_threads+i];
     nexus_info[i]->signature=MagickCoreSignature;
+    nexus_info[i]->virtual_nexus->signature=MagickCoreSignature;
   }
   return(nexus_info);
 }
@@ -323,12 +484,109 @@ MagickExport void *AcquirePixelCachePixels(const Image *image,size_t *length,
   cache_info=(CacheInfo *) image->cache;
   assert(cache_info->signature == MagickCoreSignature);
   *length=0;
+  LockSemaphoreInfo(cache_semaphore);
+  cache_info->exported=MagickTrue;  /* the caller keeps a pointer */
+  UnlockSemaphoreInfo(cache_semaphore);
   if ((cache_info->type != MemoryCache) && (cache_info->type != MapCache))
     return((void *) NULL);
+  CopyPixelCacheBands(cache_info,0,cache_info->rows);
   *length=(size_t) cache_info->length;
   return(cache_info->pixels);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   A p p l y P i x e l C a c h e O p e r a t i o n                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ApplyPixelCacheOperation() applies an operation to the pixels of the source
+%  image and stores the result in the image pixel cache, on the servers that
+%  hold both distributed pixel caches rather than by moving the pixels to this
+%  host.  It returns MagickFalse, and leaves the image pixels undefined unless
+%  the image is the source, if either cache is not distributed or the servers
+%  cannot perform the operation; the caller is then expected to compute the
+%  pixels itself.
+%
+%  The format of the ApplyPixelCacheOperation() method is:
+%
+%      MagickBooleanType ApplyPixelCacheOperation(Image *image,
+%        const Image *source,const char *operation,const ssize_t halo,
+%        ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o image: the image.
+%
+%    o source: the source image, either the image or one that shares its
+%      pixel cache.
+%
+%    o operation: the operation (e.g. negate false).
+%
+%    o halo: the rows above and below a pixel the operation reads, or -1 if
+%      it may read any pixel of the image.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+MagickPrivate MagickBooleanType ApplyPixelCacheOperation(Image *image,
+  const Image *source,const char *operation,const ssize_t halo,
+  ExceptionInfo *exception)
+{
+  CacheInfo
+    *magick_restrict cache_info,
+    *magick_restrict source_info;
+
+  assert(image != (Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  assert(source != (const Image *) NULL);
+  assert(source->signature == MagickCoreSignature);
+  assert(operation != (const char *) NULL);
+  source_info=(CacheInfo *) source->cache;
+  if ((source_info->type != DistributedCache) ||
+      (source_info->metacontent_extent != 0) ||
+      (source_info->columns != image->columns) ||
+      (source_info->rows != image->rows) ||
+      (source_info->number_channels != image->number_channels))
+    return(MagickFalse);
+  if (halo != 0)
+    switch (GetPixelCacheVirtualMethod(source))
+    {
+      case UndefinedVirtualPixelMethod:
+      case EdgeVirtualPixelMethod:
+      case BlackVirtualPixelMethod:
+      case GrayVirtualPixelMethod:
+      case WhiteVirtualPixelMethod:
+        break;
+      default:
+        return(MagickFalse);
+    }
+  /*
+    Detach the image from the source without copying pixels the operation
+    will replace.
+  */
+  if (GetImagePixelCache(image,image == source ? MagickTrue : MagickFalse,
+       exception) == (Cache) NULL)
+    return(MagickFalse);
+  cache_info=(CacheInfo *) image->cache;
+  source_info=(CacheInfo *) source->cache;
+  if ((cache_info->type != DistributedCache) ||
+      (cache_info->metacontent_extent != 0) ||
+      (cache_info->number_channels != source_info->number_channels))
+    return(MagickFalse);
+  if (cache_info->debug != MagickFalse)
+    (void) LogMagickEvent(CacheEvent,GetMagickModule(),"%s: %s",
+      cache_info->filename,operation);
+  return(ApplyDistributePixelCacheOperation((DistributeCacheInfo *)
+    cache_info->server_info,(DistributeCacheInfo *) source_info->server_info,
+    source,operation,halo));
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -351,6 +609,8 @@ MagickPrivate MagickBooleanType CacheComponentGenesis(void)
 {
   if (cache_semaphore == (SemaphoreInfo *) NULL)
     cache_semaphore=AcquireSemaphoreInfo();
+  if (statistics_semaphore == (SemaphoreInfo *) NULL)
+    statistics_semaphore=AcquireSemaphoreInfo();
   return(MagickTrue);
 }
 
@@ -378,6 +638,9 @@ MagickPrivate void CacheComponentTerminus(void)
     ActivateSemaphoreInfo(&cache_semaphore);
   /* no op-- nothing to destroy */
   RelinquishSemaphoreInfo(&cache_semaphore);
+  if (statistics_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&statistics_semaphore);
+  RelinquishSemaphoreInfo(&statistics_semaphore);
 }
 
 /*
@@ -701,6 +964,7 @@ static MagickBooleanType ClonePixelCacheRepository(
   assert(exception != (ExceptionInfo *) NULL);
   if (cache_info->type == PingCache)
     return(MagickTrue);
+  CopyPixelCacheBands(cache_info,0,cache_info->rows);
   length=cache_info->number_channels*sizeof(*cache_info->channel_map);
   if ((cache_info->storage_class == clone_info->storage_class) &&
       (cache_info->colorspace == clone_info->colorspace) &&
@@ -729,7 +993,9 @@ static MagickBooleanType ClonePixelCacheRepository(
               clone_info->metacontent_extent*sizeof(unsigned char));
           return(MagickTrue);
         }
-      if ((cache_info->type == DiskCache) && (clone_info->type == DiskCache))
+      if ((cache_info->type == DiskCache) && (clone_info->type == DiskCache) &&
+          (cache_info->tile_width == clone_info->tile_width) &&
+          (cache_info->tile_height == clone_info->tile_height))
         return(ClonePixelCacheOnDisk(cache_info,clone_info));
     }
   /*
@@ -874,6 +1140,129 @@ static MagickBooleanType ClonePixelCacheRepository(
   return(status);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   C o p y P i x e l C a c h e B a n d s                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  CopyPixelCacheBands() copies the bands of a copy-on-write clone that overlap
+%  the rows y through y+rows-1 and are still shared with its source pixel
+%  cache.  Once every band is copied, the clone releases the source cache.
+%
+%  The format of the CopyPixelCacheBands() method is:
+%
+%      void CopyPixelCacheBands(CacheInfo *cache_info,const ssize_t y,
+%        const size_t rows)
+%
+%  A description of each parameter follows:
+%
+%    o cache_info: the pixel cache.
+%
+%    o y: the first row.
+%
+%    o rows: the number of rows.
+%
+*/
+
+static void CopyPixelCacheBand(CacheInfo *magick_restrict cache_info,
+  const size_t band)
+{
+  const CacheInfo
+    *magick_restrict source_info;
+
+  MagickOffsetType
+    offset;
+
+  size_t
+    rows;
+
+  source_info=cache_info->shared_cache;
+  rows=MagickMin(cache_info->band_rows,cache_info->rows-band*
+    cache_info->band_rows);
+  offset=(MagickOffsetType) (band*cache_info->band_rows*cache_info->columns);
+  (void) memcpy(cache_info->pixels+offset*(MagickOffsetType)
+    cache_info->number_channels,source_info->pixels+offset*(MagickOffsetType)
+    cache_info->number_channels,rows*cache_info->columns*
+    cache_info->number_channels*sizeof(*cache_info->pixels));
+  if (cache_info->metacontent_extent != 0)
+    (void) memcpy((unsigned char *) cache_info->metacontent+offset*
+      (MagickOffsetType) cache_info->metacontent_extent,(unsigned char *)
+      source_info->metacontent+offset*(MagickOffsetType)
+      cache_info->metacontent_extent,rows*cache_info->columns*
+      cache_info->metacontent_extent*sizeof(unsigned char));
+  cache_info->shared_bands[band]=0;
+  cache_info->number_shared_bands--;
+}
+
+static void ReleasePixelCacheSource(CacheInfo *magick_restrict cache_info,
+  CacheInfo *magick_restrict source_info)
+{
+  CacheInfo
+    **p;
+
+  /*
+    Remove the clone from the clones of its source and release the source.
+  */
+  LockSemaphoreInfo(source_info->clone_semaphore);
+  for (p=(&source_info->clones); *p != (CacheInfo *) NULL; )
+  {
+    if (*p == cache_info)
+      {
+        *p=cache_info->next_clone;
+        source_info->number_clones--;
+        break;
+      }
+    p=(&(*p)->next_clone);
+  }
+  UnlockSemaphoreInfo(source_info->clone_semaphore);
+  cache_info->next_clone=(CacheInfo *) NULL;
+  cache_info->shared_bands=(unsigned char *) RelinquishMagickMemory(
+    cache_info->shared_bands);
+  (void) DestroyPixelCache(source_info);
+}
+
+static void CopyPixelCacheBands(CacheInfo *magick_restrict cache_info,
+  const ssize_t y,const size_t rows)
+{
+  CacheInfo
+    *magick_restrict source_info;
+
+  ssize_t
+    band,
+    first,
+    last;
+
+  if (cache_info->shared_cache == (CacheInfo *) NULL)
+    return;
+  first=MagickMax(y,0);
+  last=MagickMin(y+(ssize_t) rows,(ssize_t) cache_info->rows)-1;
+  if (last < first)
+    return;
+  source_info=(CacheInfo *) NULL;
+  LockSemaphoreInfo(cache_info->clone_semaphore);
+  if (cache_info->shared_cache != (CacheInfo *) NULL)
+    {
+      for (band=first/(ssize_t) cache_info->band_rows;
+           band <= (last/(ssize_t) cache_info->band_rows); band++)
+        if (cache_info->shared_bands[band] != 0)
+          CopyPixelCacheBand(cache_info,(size_t) band);
+      if (cache_info->number_shared_bands == 0)
+        {
+          source_info=cache_info->shared_cache;
+          cache_info->shared_cache=(CacheInfo *) NULL;
+        }
+    }
+  UnlockSemaphoreInfo(cache_info->clone_semaphore);
+  if (source_info != (CacheInfo *) NULL)
+    ReleasePixelCacheSource(cache_info,source_info);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -986,69 +1375,578 @@ static MagickBooleanType ClosePixelCacheOnDisk(CacheInfo *cache_info)
   return(status == -1 ? MagickFalse : MagickTrue);
 }
 
-static inline void RelinquishPixelCachePixels(CacheInfo *cache_info)
+static inline size_t GetPixelCacheBlockExtent(
+  const CacheInfo *magick_restrict cache_info)
 {
-  switch (cache_info->type)
-  {
-    case MemoryCache:
-    {
-      (void) ShredMagickMemory(cache_info->pixels,(size_t) cache_info->length);
-#if defined(MAGICKCORE_OPENCL_SUPPORT)
-      if (cache_info->opencl != (MagickCLCacheInfo) NULL)
-        {
-          cache_info->opencl=RelinquishMagickCLCacheInfo(cache_info->opencl,
-            MagickTrue);
-          cache_info->pixels=(Quantum *) NULL;
-          break;
-        }
+  return(cache_info->block_size*cache_info->block_size*
+    (cache_info->number_channels*sizeof(Quantum)+
+    cache_info->metacontent_extent));
+}
+
+static inline size_t GetPixelCachePackedExtent(
+  const CacheInfo *magick_restrict cache_info)
+{
+  if (cache_info->storage_depth == 0)
+    return(GetPixelCacheBlockExtent(cache_info));
+  return(cache_info->block_size*cache_info->block_size*
+    (cache_info->number_channels*(cache_info->storage_depth/8)+
+    cache_info->metacontent_extent));
+}
+
+static inline size_t GetPixelCacheBlobExtent(
+  const CacheInfo *magick_restrict cache_info)
+{
+  /*
+    The largest blob of a block, and the size of its slot in the block file.
+  */
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+  if (cache_info->block_compress != MagickFalse)
+    return((size_t) compressBound((uLong) GetPixelCachePackedExtent(
+      cache_info)));
 #endif
-      if (cache_info->mapped == MagickFalse)
-        cache_info->pixels=(Quantum *) RelinquishAlignedMemory(
-          cache_info->pixels);
-      else
-        {
-          (void) UnmapBlob(cache_info->pixels,(size_t) cache_info->length);
-          cache_info->pixels=(Quantum *) NULL;
-        }
-      RelinquishMagickResource(MemoryResource,cache_info->length);
-      break;
+  return(GetPixelCachePackedExtent(cache_info));
+}
+
+static inline size_t GetPixelCacheBufferExtent(
+  const CacheInfo *magick_restrict cache_info)
+{
+  size_t
+    extent;
+
+  /*
+    The buffer stages a packed block and then its compressed blob.
+  */
+  extent=0;
+  if (cache_info->storage_depth != 0)
+    extent=GetPixelCachePackedExtent(cache_info);
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+  if (cache_info->block_compress != MagickFalse)
+    extent+=compressBound((uLong) GetPixelCachePackedExtent(cache_info));
+#endif
+  return(extent);
+}
+
+static inline MagickSizeType GetPixelCacheBlocksLength(
+  const CacheInfo *magick_restrict cache_info)
+{
+  /*
+    Return the length of the hot blocks and the block buffer.
+  */
+  return((MagickSizeType) cache_info->number_hot_blocks*
+    GetPixelCacheBlockExtent(cache_info)+GetPixelCacheBufferExtent(
+    cache_info));
+}
+
+static void RelinquishPixelCacheBlocks(CacheInfo *cache_info)
+{
+  ssize_t
+    i;
+
+  if (cache_info->block_size == 0)
+    return;
+  if (cache_info->blocks != (CacheBlockInfo *) NULL)
+    {
+      for (i=0; i < (ssize_t) cache_info->number_blocks; i++)
+        if (cache_info->blocks[i].blob != (unsigned char *) NULL)
+          cache_info->blocks[i].blob=(unsigned char *) RelinquishMagickMemory(
+            cache_info->blocks[i].blob);
+      cache_info->blocks=(CacheBlockInfo *) RelinquishMagickMemory(
+        cache_info->blocks);
     }
-    case MapCache:
+  if (cache_info->hot_blocks != (CacheHotBlockInfo *) NULL)
     {
-      (void) UnmapBlob(cache_info->pixels,(size_t) cache_info->length);
-      cache_info->pixels=(Quantum *) NULL;
-      if ((cache_info->mode != ReadMode) && (cache_info->mode != PersistMode))
-        (void) RelinquishUniqueFileResource(cache_info->cache_filename);
-      *cache_info->cache_filename='\0';
-      RelinquishMagickResource(MapResource,cache_info->length);
-      magick_fallthrough;
+      for (i=0; i < (ssize_t) cache_info->number_hot_blocks; i++)
+        if (cache_info->hot_blocks[i].pixels != (unsigned char *) NULL)
+          cache_info->hot_blocks[i].pixels=(unsigned char *)
+            RelinquishAlignedMemory(cache_info->hot_blocks[i].pixels);
+      cache_info->hot_blocks=(CacheHotBlockInfo *) RelinquishMagickMemory(
+        cache_info->hot_blocks);
     }
-    case DiskCache:
+  if (cache_info->block_buffer != (unsigned char *) NULL)
+    cache_info->block_buffer=(unsigned char *) RelinquishMagickMemory(
+      cache_info->block_buffer);
+  RelinquishMagickResource(MemoryResource,cache_info->compressed_length+
+    GetPixelCacheBlocksLength(cache_info));
+  if (cache_info->block_file_length != 0)
     {
       if (cache_info->file != -1)
         (void) ClosePixelCacheOnDisk(cache_info);
-      if ((cache_info->mode != ReadMode) && (cache_info->mode != PersistMode))
+      if (*cache_info->cache_filename != '\0')
         (void) RelinquishUniqueFileResource(cache_info->cache_filename);
       *cache_info->cache_filename='\0';
-      RelinquishMagickResource(DiskResource,cache_info->length);
-      break;
-    }
-    case DistributedCache:
-    {
-      *cache_info->cache_filename='\0';
-      (void) RelinquishDistributePixelCache((DistributeCacheInfo *)
-        cache_info->server_info);
-      break;
+      RelinquishMagickResource(DiskResource,cache_info->block_file_length);
+      cache_info->block_file_length=0;
     }
-    default:
-      break;
-  }
-  cache_info->type=UndefinedCache;
-  cache_info->mapped=MagickFalse;
-  cache_info->metacontent=(void *) NULL;
+  cache_info->block_size=0;
+  cache_info->number_blocks=0;
+  cache_info->number_hot_blocks=0;
+  cache_info->compressed_length=0;
 }
 
-MagickPrivate Cache DestroyPixelCache(Cache cache)
+static void PackPixelCacheBlock(const CacheInfo *magick_restrict cache_info,
+  const unsigned char *magick_restrict pixels,unsigned char *magick_restrict
+  packed)
+{
+  const Quantum
+    *magick_restrict p;
+
+  size_t
+    number_pixels,
+    number_samples;
+
+  ssize_t
+    i;
+
+  /*
+    Store the samples of a block at the storage depth, followed by its
+    metacontent.
+  */
+  number_pixels=cache_info->block_size*cache_info->block_size;
+  number_samples=number_pixels*cache_info->number_channels;
+  p=(const Quantum *) pixels;
+  if (cache_info->storage_depth == 8)
+    for (i=0; i < (ssize_t) number_samples; i++)
+      packed[i]=ScaleQuantumToChar(p[i]);
+  else
+    {
+      unsigned short
+        *magick_restrict q;
+
+      q=(unsigned short *) packed;
+      for (i=0; i < (ssize_t) number_samples; i++)
+        q[i]=ScaleQuantumToShort(p[i]);
+    }
+  if (cache_info->metacontent_extent != 0)
+    (void) memcpy(packed+number_samples*(cache_info->storage_depth/8),
+      pixels+number_samples*sizeof(Quantum),number_pixels*
+      cache_info->metacontent_extent);
+}
+
+static void UnpackPixelCacheBlock(const CacheInfo *magick_restrict cache_info,
+  const unsigned char *magick_restrict packed,unsigned char *magick_restrict
+  pixels)
+{
+  Quantum
+    *magick_restrict q;
+
+  size_t
+    number_pixels,
+    number_samples;
+
+  ssize_t
+    i;
+
+  number_pixels=cache_info->block_size*cache_info->block_size;
+  number_samples=number_pixels*cache_info->number_channels;
+  q=(Quantum *) pixels;
+  if (cache_info->storage_depth == 8)
+    for (i=0; i < (ssize_t) number_samples; i++)
+      q[i]=ScaleCharToQuantum(packed[i]);
+  else
+    {
+      const unsigned short
+        *magick_restrict p;
+
+      p=(const unsigned short *) packed;
+      for (i=0; i < (ssize_t) number_samples; i++)
+        q[i]=ScaleShortToQuantum(p[i]);
+    }
+  if (cache_info->metacontent_extent != 0)
+    (void) memcpy(pixels+number_samples*sizeof(Quantum),packed+number_samples*
+      (cache_info->storage_depth/8),number_pixels*
+      cache_info->metacontent_extent);
+}
+
+static MagickBooleanType WritePixelCacheBlob(CacheInfo *cache_info,
+  const ssize_t block,const unsigned char *blob,const size_t length)
+{
+  MagickOffsetType
+    count;
+
+  size_t
+    extent;
+
+  /*
+    A blob the memory resource cannot hold is written to the slot of its
+    block in a block file, so the cache degrades to disk rather than fail.
+  */
+  extent=GetPixelCacheBlobExtent(cache_info);
+  if (cache_info->block_file_length == 0)
+    {
+      if (AcquireMagickResource(DiskResource,(MagickSizeType)
+            cache_info->number_blocks*extent) == MagickFalse)
+        return(MagickFalse);
+      cache_info->block_file_length=(MagickSizeType) cache_info->number_blocks*
+        extent;
+      if (cache_info->debug != MagickFalse)
+        (void) LogMagickEvent(CacheEvent,GetMagickModule(),
+          "spill %s blocks to disk",cache_info->filename);
+    }
+  if (OpenPixelCacheOnDisk(cache_info,IOMode) == MagickFalse)
+    return(MagickFalse);
+  count=WritePixelCacheRegion(cache_info,MagickFalse,(MagickOffsetType)
+    block*(MagickOffsetType) extent,(MagickSizeType) length,blob);
+  return(count == (MagickOffsetType) length ? MagickTrue : MagickFalse);
+}
+
+static MagickBooleanType CompressPixelCacheBlock(CacheInfo *cache_info,
+  const CacheHotBlockInfo *hot_block)
+{
+  CacheBlockInfo
+    *block;
+
+  const unsigned char
+    *source;
+
+  size_t
+    length;
+
+  unsigned char
+    *blob;
+
+  /*
+    Pack and compress a hot block, replacing its previous blob.
+  */
+  block=cache_info->blocks+hot_block->block;
+  source=hot_block->pixels;
+  length=GetPixelCacheBlockExtent(cache_info);
+  if (cache_info->storage_depth != 0)
+    {
+      PackPixelCacheBlock(cache_info,hot_block->pixels,
+        cache_info->block_buffer);
+      source=cache_info->block_buffer;
+      length=GetPixelCachePackedExtent(cache_info);
+    }
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+  if (cache_info->block_compress != MagickFalse)
+    {
+      uLongf
+        extent;
+
+      unsigned char
+        *compressed;
+
+      compressed=cache_info->block_buffer;
+      if (cache_info->storage_depth != 0)
+        compressed+=GetPixelCachePackedExtent(cache_info);
+      extent=compressBound((uLong) length);
+      if (compress2(compressed,&extent,source,(uLong) length,Z_BEST_SPEED) !=
+          Z_OK)
+        return(MagickFalse);
+      source=compressed;
+      length=(size_t) extent;
+    }
+#endif
+  if (block->blob != (unsigned char *) NULL)
+    {
+      block->blob=(unsigned char *) RelinquishMagickMemory(block->blob);
+      RelinquishMagickResource(MemoryResource,(MagickSizeType) block->length);
+      cache_info->compressed_length-=block->length;
+    }
+  blob=(unsigned char *) NULL;
+  if (AcquireMagickResource(MemoryResource,(MagickSizeType) length) !=
+      MagickFalse)
+    {
+      blob=(unsigned char *) AcquireQuantumMemory(length,sizeof(*blob));
+      if (blob == (unsigned char *) NULL)
+        RelinquishMagickResource(MemoryResource,(MagickSizeType) length);
+    }
+  block->blob=blob;
+  block->length=length;
+  block->on_disk=MagickFalse;
+  if (blob != (unsigned char *) NULL)
+    {
+      (void) memcpy(blob,source,length);
+      cache_info->compressed_length+=block->length;
+      return(MagickTrue);
+    }
+  block->on_disk=MagickTrue;
+  return(WritePixelCacheBlob(cache_info,hot_block->block,source,length));
+}
+
+static MagickBooleanType DecompressPixelCacheBlock(
+  CacheInfo *magick_restrict cache_info,const ssize_t block,
+  unsigned char *magick_restrict pixels)
+{
+  const unsigned char
+    *source;
+
+  size_t
+    length;
+
+  if ((cache_info->blocks[block].blob == (unsigned char *) NULL) &&
+      (cache_info->blocks[block].on_disk == MagickFalse))
+    {
+      (void) memset(pixels,0,GetPixelCacheBlockExtent(cache_info));
+      return(MagickTrue);  /* block was never written */
+    }
+  source=cache_info->blocks[block].blob;
+  length=cache_info->blocks[block].length;
+  if (cache_info->blocks[block].on_disk != MagickFalse)
+    {
+      MagickOffsetType
+        count;
+
+      unsigned char
+        *blob;
+
+      /*
+        Read the blob from the block file into the part of the block buffer
+        where it would have been compressed.
+      */
+      blob=cache_info->block_buffer;
+      if ((cache_info->storage_depth != 0) &&
+          (cache_info->block_compress != MagickFalse))
+        blob+=GetPixelCachePackedExtent(cache_info);
+      if (OpenPixelCacheOnDisk(cache_info,IOMode) == MagickFalse)
+        return(MagickFalse);
+      count=ReadPixelCacheRegion(cache_info,MagickFalse,(MagickOffsetType)
+        block*(MagickOffsetType) GetPixelCacheBlobExtent(cache_info),
+        (MagickSizeType) length,blob);
+      if (count != (MagickOffsetType) length)
+        return(MagickFalse);
+      source=blob;
+    }
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+  if (cache_info->block_compress != MagickFalse)
+    {
+      uLongf
+        extent;
+
+      unsigned char
+        *target;
+
+      target=pixels;
+      if (cache_info->storage_depth != 0)
+        target=cache_info->block_buffer;
+      extent=(uLongf) GetPixelCachePackedExtent(cache_info);
+      if (uncompress(target,&extent,source,(uLong) length) != Z_OK)
+        return(MagickFalse);
+      source=target;
+      length=(size_t) extent;
+    }
+#endif
+  if (length != GetPixelCachePackedExtent(cache_info))
+    return(MagickFalse);
+  if (cache_info->storage_depth != 0)
+    UnpackPixelCacheBlock(cache_info,source,pixels);
+  else
+    if (source != pixels)
+      (void) memcpy(pixels,source,length);
+  return(MagickTrue);
+}
+
+static unsigned char *GetPixelCacheBlock(CacheInfo *magick_restrict cache_info,
+  const ssize_t block,const MagickBooleanType dirty)
+{
+  CacheHotBlockInfo
+    *magick_restrict hot_blocks,
+    hot_block;
+
+  ssize_t
+    i;
+
+  /*
+    Return the decompressed pixels of a block, replacing the least recently
+    used hot block on a miss.  The hot blocks are kept in most recently used
+    order.
+  */
+  hot_blocks=cache_info->hot_blocks;
+  for (i=0; i < (ssize_t) cache_info->number_hot_blocks; i++)
+    if (hot_blocks[i].block == block)
+      break;
+  if (i >= (ssize_t) cache_info->number_hot_blocks)
+    {
+      i=(ssize_t) cache_info->number_hot_blocks-1;
+      if ((hot_blocks[i].block >= 0) && (hot_blocks[i].dirty != MagickFalse))
+        {
+          if (CompressPixelCacheBlock(cache_info,hot_blocks+i) == MagickFalse)
+            return((unsigned char *) NULL);
+          hot_blocks[i].dirty=MagickFalse;
+        }
+      hot_blocks[i].block=(-1);
+      if (DecompressPixelCacheBlock(cache_info,block,hot_blocks[i].pixels) ==
+          MagickFalse)
+        return((unsigned char *) NULL);
+      hot_blocks[i].block=block;
+    }
+  if (dirty != MagickFalse)
+    hot_blocks[i].dirty=MagickTrue;
+  if (i != 0)
+    {
+      hot_block=hot_blocks[i];
+      (void) memmove(hot_blocks+1,hot_blocks,(size_t) i*sizeof(*hot_blocks));
+      hot_blocks[0]=hot_block;
+    }
+  return(hot_blocks[0].pixels);
+}
+
+static MagickBooleanType TransferPixelCacheBlocks(
+  CacheInfo *magick_restrict cache_info,const RectangleInfo *region,
+  const size_t packet_size,const size_t offset,unsigned char *buffer,
+  const MagickBooleanType write)
+{
+  size_t
+    blocks_across,
+    length;
+
+  ssize_t
+    block_size,
+    x,
+    y;
+
+  /*
+    Copy a region from (or to, if write is true) the pixels of the blocks
+    or, at offset, their metacontent.
+  */
+  if ((region->x < 0) || (region->y < 0) ||
+      ((region->x+(ssize_t) region->width) > (ssize_t) cache_info->columns) ||
+      ((region->y+(ssize_t) region->height) > (ssize_t) cache_info->rows))
+    return(MagickFalse);
+  block_size=(ssize_t) cache_info->block_size;
+  blocks_across=(cache_info->columns+cache_info->block_size-1)/
+    cache_info->block_size;
+  for (y=region->y; y < (region->y+(ssize_t) region->height); )
+  {
+    ssize_t
+      y_end;
+
+    y_end=MagickMin((y/block_size+1)*block_size,region->y+(ssize_t)
+      region->height);
+    for (x=region->x; x < (region->x+(ssize_t) region->width); )
+    {
+      ssize_t
+        i,
+        x_end;
+
+      unsigned char
+        *magick_restrict p,
+        *magick_restrict q;
+
+      x_end=MagickMin((x/block_size+1)*block_size,region->x+(ssize_t)
+        region->width);
+      p=GetPixelCacheBlock(cache_info,(y/block_size)*(ssize_t) blocks_across+
+        x/block_size,write);
+      if (p == (unsigned char *) NULL)
+        return(MagickFalse);
+      p+=offset+(size_t) ((y % block_size)*block_size+(x % block_size))*
+        packet_size;
+      q=buffer+(size_t) ((y-region->y)*(ssize_t) region->width+(x-
+        region->x))*packet_size;
+      length=(size_t) (x_end-x)*packet_size;
+      for (i=y; i < y_end; i++)
+      {
+        if (write == MagickFalse)
+          (void) memcpy(q,p,length);
+        else
+          (void) memcpy(p,q,length);
+        p+=(size_t) block_size*packet_size;
+        q+=region->width*packet_size;
+      }
+      x=x_end;
+    }
+    y=y_end;
+  }
+  return(MagickTrue);
+}
+
+static void RelinquishPixelCacheWindows(CacheInfo *cache_info)
+{
+  ssize_t
+    i;
+
+  if (cache_info->windows == (CacheWindowInfo *) NULL)
+    return;
+  for (i=0; i < (ssize_t) cache_info->number_windows; i++)
+    if (cache_info->windows[i].map != (unsigned char *) NULL)
+      (void) UnmapBlob(cache_info->windows[i].map,
+        cache_info->windows[i].length);
+  cache_info->windows=(CacheWindowInfo *) RelinquishMagickMemory(
+    cache_info->windows);
+  RelinquishMagickResource(MapResource,(MagickSizeType)
+    cache_info->number_windows*cache_info->window_size);
+  cache_info->number_windows=0;
+  cache_info->window_size=0;
+}
+
+static inline void RelinquishPixelCachePixels(CacheInfo *cache_info)
+{
+  CacheInfo
+    *source_info;
+
+  source_info=cache_info->shared_cache;
+  if (source_info != (CacheInfo *) NULL)
+    {
+      cache_info->shared_cache=(CacheInfo *) NULL;
+      ReleasePixelCacheSource(cache_info,source_info);
+    }
+  RelinquishPixelCacheWindows(cache_info);
+  switch (cache_info->type)
+  {
+    case MemoryCache:
+    {
+      (void) ShredMagickMemory(cache_info->pixels,(size_t) cache_info->length);
+#if defined(MAGICKCORE_OPENCL_SUPPORT)
+      if (cache_info->opencl != (MagickCLCacheInfo) NULL)
+        {
+          cache_info->opencl=RelinquishMagickCLCacheInfo(cache_info->opencl,
+            MagickTrue);
+          cache_info->pixels=(Quantum *) NULL;
+          break;
+        }
+#endif
+      if (cache_info->mapped == MagickFalse)
+        cache_info->pixels=(Quantum *) RelinquishAlignedMemory(
+          cache_info->pixels);
+      else
+        {
+          (void) UnmapBlob(cache_info->pixels,(size_t) cache_info->length);
+          cache_info->pixels=(Quantum *) NULL;
+        }
+      RelinquishMagickResource(MemoryResource,cache_info->length);
+      break;
+    }
+    case MapCache:
+    {
+      (void) UnmapBlob(cache_info->pixels,(size_t) cache_info->length);
+      cache_info->pixels=(Quantum *) NULL;
+      if ((cache_info->mode != ReadMode) && (cache_info->mode != PersistMode))
+        (void) RelinquishUniqueFileResource(cache_info->cache_filename);
+      *cache_info->cache_filename='\0';
+      RelinquishMagickResource(MapResource,cache_info->length);
+      magick_fallthrough;
+    }
+    case DiskCache:
+    {
+      if (cache_info->file != -1)
+        (void) ClosePixelCacheOnDisk(cache_info);
+      if ((cache_info->mode != ReadMode) && (cache_info->mode != PersistMode))
+        (void) RelinquishUniqueFileResource(cache_info->cache_filename);
+      *cache_info->cache_filename='\0';
+      RelinquishMagickResource(DiskResource,cache_info->length);
+      break;
+    }
+    case DistributedCache:
+    {
+      *cache_info->cache_filename='\0';
+      (void) RelinquishDistributePixelCache((DistributeCacheInfo *)
+        cache_info->server_info);
+      break;
+    }
+    case CompressedCache:
+    {
+      RelinquishPixelCacheBlocks(cache_info);
+      break;
+    }
+    default:
+      break;
+  }
+  cache_info->type=UndefinedCache;
+  cache_info->mapped=MagickFalse;
+  cache_info->metacontent=(void *) NULL;
+}
+
+MagickPrivate Cache DestroyPixelCache(Cache cache)
 {
   CacheInfo
     *magick_restrict cache_info;
@@ -1067,15 +1965,64 @@ MagickPrivate Cache DestroyPixelCache(Cache cache)
       return((Cache) NULL);
     }
   UnlockSemaphoreInfo(cache_info->semaphore);
+  if (cache_info->nexus_info != (NexusInfo **) NULL)
+    MergePixelCacheNexusStatistics(cache_info,cache_info->nexus_info,
+      cache_info->number_threads);
+  LockSemaphoreInfo(statistics_semaphore);
+  cache_statistics.direct_requests+=cache_info->statistics.direct_requests;
+  cache_statistics.buffered_requests+=cache_info->statistics.buffered_requests;
+  cache_statistics.virtual_requests+=cache_info->statistics.virtual_requests;
+  cache_statistics.disk_bytes_read+=cache_info->statistics.disk_bytes_read;
+  cache_statistics.disk_bytes_written+=
+    cache_info->statistics.disk_bytes_written;
+  cache_statistics.read_ahead_requests+=
+    cache_info->statistics.read_ahead_requests;
+  cache_statistics.write_behind_requests+=
+    cache_info->statistics.write_behind_requests;
+  cache_statistics.clones+=cache_info->statistics.clones;
+  cache_statistics.promotions+=cache_info->statistics.promotions;
+  cache_statistics.demotions+=cache_info->statistics.demotions;
+  UnlockSemaphoreInfo(statistics_semaphore);
   if (cache_info->debug != MagickFalse)
     {
       char
-        message[MagickPathExtent];
-
-      (void) FormatLocaleString(message,MagickPathExtent,"destroy %s",
-        cache_info->filename);
+        message[MagickPathExtent],
+        read[MagickPathExtent],
+        written[MagickPathExtent];
+
+      (void) FormatMagickSize(cache_info->statistics.disk_bytes_read,
+        MagickTrue,"B",MagickPathExtent,read);
+      (void) FormatMagickSize(cache_info->statistics.disk_bytes_written,
+        MagickTrue,"B",MagickPathExtent,written);
+      (void) FormatLocaleString(message,MagickPathExtent,
+        "destroy %s (requests %.20g direct, %.20g buffered, %.20g virtual; "
+        "disk %s read, %s written, %.20g read-ahead, %.20g write-behind; "
+        "%.20g clones, %.20g promotions, %.20g demotions)",
+        cache_info->filename,(double) cache_info->statistics.direct_requests,
+        (double) cache_info->statistics.buffered_requests,(double)
+        cache_info->statistics.virtual_requests,read,written,(double)
+        cache_info->statistics.read_ahead_requests,(double)
+        cache_info->statistics.write_behind_requests,(double)
+        cache_info->statistics.clones,(double)
+        cache_info->statistics.promotions,(double)
+        cache_info->statistics.demotions);
       (void) LogMagickEvent(CacheEvent,GetMagickModule(),"%s",message);
     }
+  if (cache_info->serial != 0)
+    {
+      /*
+        Unregister the cache; this waits for a spill of the cache to finish.
+      */
+      LockSemaphoreInfo(cache_semaphore);
+      if (cache_info->previous_cache != (CacheInfo *) NULL)
+        cache_info->previous_cache->next_cache=cache_info->next_cache;
+      else
+        cache_list=cache_info->next_cache;
+      if (cache_info->next_cache != (CacheInfo *) NULL)
+        cache_info->next_cache->previous_cache=cache_info->previous_cache;
+      cache_info->serial=0;
+      UnlockSemaphoreInfo(cache_semaphore);
+    }
   RelinquishPixelCachePixels(cache_info);
   if (cache_info->server_info != (DistributeCacheInfo *) NULL)
     cache_info->server_info=DestroyDistributeCacheInfo((DistributeCacheInfo *)
@@ -1087,6 +2034,8 @@ MagickPrivate Cache DestroyPixelCache(Cache cache)
     cache_info->random_info=DestroyRandomInfo(cache_info->random_info);
   if (cache_info->file_semaphore != (SemaphoreInfo *) NULL)
     RelinquishSemaphoreInfo(&cache_info->file_semaphore);
+  if (cache_info->clone_semaphore != (SemaphoreInfo *) NULL)
+    RelinquishSemaphoreInfo(&cache_info->clone_semaphore);
   if (cache_info->semaphore != (SemaphoreInfo *) NULL)
     RelinquishSemaphoreInfo(&cache_info->semaphore);
   cache_info->signature=(~MagickCoreSignature);
@@ -1143,11 +2092,12 @@ MagickPrivate NexusInfo **DestroyPixelCacheNexus(NexusInfo **nexus_info,
   assert(nexus_info != (NexusInfo **) NULL);
   for (i=0; i < (ssize_t) (2*number_threads); i++)
   {
+    UnpinPixelCacheNexus((const CacheInfo *) NULL,nexus_info[i]);
     if (nexus_info[i]->cache != (Quantum *) NULL)
       RelinquishCacheNexusPixels(nexus_info[i]);
     nexus_info[i]->signature=(~MagickCoreSignature);
   }
-  *nexus_info=(NexusInfo *) RelinquishMagickMemory(*nexus_info);
+  *nexus_info=(NexusInfo *) RelinquishAlignedMemory(*nexus_info);
   nexus_info=(NexusInfo **) RelinquishAlignedMemory(nexus_info);
   return(nexus_info);
 }
@@ -1288,8 +2238,13 @@ MagickPrivate cl_mem GetAuthenticOpenCLBuffer(const Image *image,
       SyncImagePixelCache((Image *) image,exception);
       cache_info=(CacheInfo *) image->cache;
     }
+  PinPixelCache(cache_info);
   if ((cache_info->type != MemoryCache) || (cache_info->mapped != MagickFalse))
-    return((cl_mem) NULL);
+    {
+      UnpinPixelCache(cache_info);
+      return((cl_mem) NULL);
+    }
+  CopyPixelCacheBands(cache_info,0,cache_info->rows);
   LockSemaphoreInfo(cache_info->semaphore);
   if ((cache_info->opencl != (MagickCLCacheInfo) NULL) &&
       (cache_info->opencl->device->context != device->context))
@@ -1303,6 +2258,7 @@ MagickPrivate cl_mem GetAuthenticOpenCLBuffer(const Image *image,
   if (cache_info->opencl != (MagickCLCacheInfo) NULL)
     RetainOpenCLMemObject(cache_info->opencl->buffer);
   UnlockSemaphoreInfo(cache_info->semaphore);
+  UnpinPixelCache(cache_info);
   if (cache_info->opencl == (MagickCLCacheInfo) NULL)
     return((cl_mem) NULL);
   assert(cache_info->opencl->pixels == cache_info->pixels);
@@ -1695,12 +2651,143 @@ static inline MagickBooleanType ValidatePixelCacheMorphology(
   return(MagickTrue);
 }
 
-static Cache GetImagePixelCache(Image *image,const MagickBooleanType clone,
-  ExceptionInfo *exception)
+static MagickBooleanType SharePixelCacheBands(const Image *image,
+  CacheInfo *magick_restrict clone_info,CacheInfo *magick_restrict cache_info)
 {
-  CacheInfo
-    *magick_restrict cache_info;
-
+  char
+    *value;
+
+  MagickBooleanType
+    status;
+
+  size_t
+    extent;
+
+  /*
+    Share the pixels of a memory cache with its clone until each band of the
+    clone is first accessed.  The caller holds the source cache semaphore.
+  */
+  if ((cache_info->type != MemoryCache) || (clone_info->type != MemoryCache) ||
+      (cache_info->shared_cache != (CacheInfo *) NULL) ||
+      (cache_info->columns != clone_info->columns) ||
+      (cache_info->rows != clone_info->rows) ||
+      (cache_info->number_channels != clone_info->number_channels) ||
+      (memcmp(cache_info->channel_map,clone_info->channel_map,
+       cache_info->number_channels*sizeof(*cache_info->channel_map)) != 0) ||
+      (cache_info->metacontent_extent != clone_info->metacontent_extent))
+    return(MagickFalse);
+  status=MagickTrue;
+  value=GetPixelCacheSetting(image,"cache:copy-on-write");
+  if (value != (char *) NULL)
+    {
+      status=IsStringFalse(value) == MagickFalse ? MagickTrue : MagickFalse;
+      value=DestroyString(value);
+    }
+  if (status == MagickFalse)
+    return(MagickFalse);
+  extent=clone_info->columns*(clone_info->number_channels*
+    sizeof(*clone_info->pixels)+clone_info->metacontent_extent);
+  clone_info->band_rows=MagickMax((256*1024)/extent,1);
+  clone_info->number_bands=(clone_info->rows+clone_info->band_rows-1)/
+    clone_info->band_rows;
+  if (clone_info->number_bands < 2)
+    return(MagickFalse);
+  clone_info->shared_bands=(unsigned char *) AcquireQuantumMemory(
+    clone_info->number_bands,sizeof(*clone_info->shared_bands));
+  if (clone_info->shared_bands == (unsigned char *) NULL)
+    return(MagickFalse);
+  (void) memset(clone_info->shared_bands,1,clone_info->number_bands*
+    sizeof(*clone_info->shared_bands));
+  clone_info->number_shared_bands=clone_info->number_bands;
+  cache_info->reference_count++;
+  clone_info->shared_cache=cache_info;
+  LockSemaphoreInfo(cache_info->clone_semaphore);
+  clone_info->next_clone=cache_info->clones;
+  cache_info->clones=clone_info;
+  cache_info->number_clones++;
+  UnlockSemaphoreInfo(cache_info->clone_semaphore);
+  if (cache_info->debug != MagickFalse)
+    {
+      char
+        message[MagickPathExtent];
+
+      (void) FormatLocaleString(message,MagickPathExtent,
+        "copy-on-write %s => %s (%.20g bands of %.20g rows)",
+        cache_info->filename,clone_info->filename,(double)
+        clone_info->number_bands,(double) clone_info->band_rows);
+      (void) LogMagickEvent(CacheEvent,GetMagickModule(),"%s",message);
+    }
+  return(MagickTrue);
+}
+
+static void UnsharePixelCacheClones(CacheInfo *magick_restrict cache_info)
+{
+  CacheInfo
+    *magick_restrict clone_info;
+
+  MagickBooleanType
+    owner;
+
+  ssize_t
+    band;
+
+  /*
+    Copy the bands the clones still share before the source cache is
+    modified.  The caller holds the source cache semaphore.
+  */
+  LockSemaphoreInfo(cache_info->clone_semaphore);
+  while (cache_info->clones != (CacheInfo *) NULL)
+  {
+    clone_info=cache_info->clones;
+    LockSemaphoreInfo(clone_info->clone_semaphore);
+    owner=clone_info->shared_cache == cache_info ? MagickTrue : MagickFalse;
+    if (owner != MagickFalse)
+      {
+        for (band=0; band < (ssize_t) clone_info->number_bands; band++)
+          if (clone_info->shared_bands[band] != 0)
+            CopyPixelCacheBand(clone_info,(size_t) band);
+        clone_info->shared_cache=(CacheInfo *) NULL;
+      }
+    UnlockSemaphoreInfo(clone_info->clone_semaphore);
+    if (owner == MagickFalse)
+      break;  /* the clone is releasing the source itself */
+    cache_info->clones=clone_info->next_clone;
+    cache_info->number_clones--;
+    clone_info->next_clone=(CacheInfo *) NULL;
+    clone_info->shared_bands=(unsigned char *) RelinquishMagickMemory(
+      clone_info->shared_bands);
+    cache_info->reference_count--;
+  }
+  UnlockSemaphoreInfo(cache_info->clone_semaphore);
+}
+
+static inline MagickBooleanType IsPixelCacheExclusive(
+  const Image *magick_restrict image)
+{
+  const CacheInfo
+    *magick_restrict cache_info;
+
+  /*
+    Is the pixel cache referenced only by this image, resident, and does it
+    match the image morphology?  If so, it can be returned without locking.
+  */
+  cache_info=(const CacheInfo *) image->cache;
+  if ((cache_info->reference_count != 1) || (cache_info->mode == ReadMode) ||
+      (cache_info->spilled != MagickFalse) || (image->type != UndefinedType))
+    return(MagickFalse);
+#if defined(MAGICKCORE_OPENCL_SUPPORT)
+  if (cache_info->opencl != (MagickCLCacheInfo) NULL)
+    return(MagickFalse);
+#endif
+  return(ValidatePixelCacheMorphology(image));
+}
+
+static Cache GetImagePixelCache(Image *image,const MagickBooleanType clone,
+  ExceptionInfo *exception)
+{
+  CacheInfo
+    *magick_restrict cache_info;
+
   MagickBooleanType
     destroy,
     status = MagickTrue;
@@ -1722,16 +2809,25 @@ static Cache GetImagePixelCache(Image *image,const MagickBooleanType clone,
     cpu_throttle=GetMagickResourceLimit(ThrottleResource);
   if ((cpu_throttle != 0) && ((cycles++ % 4096) == 0))
     MagickDelay(cpu_throttle);
-  LockSemaphoreInfo(image->semaphore);
   assert(image->cache != (Cache) NULL);
+  if (IsPixelCacheExclusive(image) != MagickFalse)
+    return(image->cache);
+  LockSemaphoreInfo(image->semaphore);
   cache_info=(CacheInfo *) image->cache;
 #if defined(MAGICKCORE_OPENCL_SUPPORT)
   CopyOpenCLBuffer(cache_info);
 #endif
+  if (cache_info->spilled != MagickFalse)
+    PromotePixelCache(cache_info);
+  PinPixelCache(cache_info);
   destroy=MagickFalse;
   if ((cache_info->reference_count > 1) || (cache_info->mode == ReadMode))
     {
       LockSemaphoreInfo(cache_info->semaphore);
+      if ((cache_info->clones != (CacheInfo *) NULL) &&
+          (cache_info->reference_count == ((ssize_t)
+           cache_info->number_clones+1)))
+        UnsharePixelCacheClones(cache_info);
       if ((cache_info->reference_count > 1) || (cache_info->mode == ReadMode))
         {
           CacheInfo
@@ -1748,28 +2844,35 @@ static Cache GetImagePixelCache(Image *image,const MagickBooleanType clone,
           clone_image.reference_count=1;
           clone_image.cache=ClonePixelCache(cache_info);
           clone_info=(CacheInfo *) clone_image.cache;
+          PinPixelCache(clone_info);
           status=OpenPixelCache(&clone_image,IOMode,exception);
-          if (status == MagickFalse)
-            clone_info=(CacheInfo *) DestroyPixelCache(clone_info);
-          else
+          if (status != MagickFalse)
             {
-              if (clone != MagickFalse)
+              if ((clone != MagickFalse) && (SharePixelCacheBands(image,
+                   clone_info,cache_info) == MagickFalse))
                 status=ClonePixelCacheRepository(clone_info,cache_info,
                   exception);
-              if (status == MagickFalse)
-                clone_info=(CacheInfo *) DestroyPixelCache(clone_info);
-              else
-                {
-                  destroy=MagickTrue;
-                  image->cache=clone_info;
-                }
+            }
+          if (status == MagickFalse)
+            {
+              UnpinPixelCache(clone_info);
+              clone_info=(CacheInfo *) DestroyPixelCache(clone_info);
+            }
+          else
+            {
+              UpdatePixelCacheStatistic(&cache_info->statistics.clones,1);
+              destroy=MagickTrue;
+              image->cache=clone_info;
             }
           RelinquishSemaphoreInfo(&clone_image.semaphore);
         }
       UnlockSemaphoreInfo(cache_info->semaphore);
     }
   if (destroy != MagickFalse)
-    cache_info=(CacheInfo *) DestroyPixelCache(cache_info);
+    {
+      UnpinPixelCache(cache_info);
+      cache_info=(CacheInfo *) DestroyPixelCache(cache_info);
+    }
   if (status != MagickFalse)
     {
       /*
@@ -1785,12 +2888,85 @@ static Cache GetImagePixelCache(Image *image,const MagickBooleanType clone,
             (void) ClosePixelCacheOnDisk(cache_info);
         }
     }
+  UnpinPixelCache((CacheInfo *) image->cache);
   UnlockSemaphoreInfo(image->semaphore);
   if (status == MagickFalse)
     return((Cache) NULL);
   return(image->cache);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t I m a g e P i x e l C a c h e S t a t i s t i c s                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetImagePixelCacheStatistics() returns the counters of the image pixel
+%  cache: the nexus requests served directly from cache memory or buffered,
+%  the requests that fell back to virtual pixels, the bytes read from and
+%  written to disk, the number of times the cache was cloned, and the number
+%  of times it was opened in a faster (promotion) or slower (demotion) tier
+%  than before.
+%  Requests made through a cache view are counted once the view is
+%  destroyed.
+%
+%  The format of the GetImagePixelCacheStatistics() method is:
+%
+%      MagickBooleanType GetImagePixelCacheStatistics(const Image *image,
+%        CacheStatistics *statistics)
+%
+%  A description of each parameter follows:
+%
+%    o image: the image.
+%
+%    o statistics: return the pixel cache counters in this structure.
+%
+*/
+MagickExport MagickBooleanType GetImagePixelCacheStatistics(const Image *image,
+  CacheStatistics *statistics)
+{
+  CacheInfo
+    *magick_restrict cache_info;
+
+  ssize_t
+    i;
+
+  assert(image != (Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  assert(statistics != (CacheStatistics *) NULL);
+  (void) memset(statistics,0,sizeof(*statistics));
+  if (image->cache == (Cache) NULL)
+    return(MagickFalse);
+  cache_info=(CacheInfo *) image->cache;
+  assert(cache_info->signature == MagickCoreSignature);
+  LockSemaphoreInfo(statistics_semaphore);
+  *statistics=cache_info->statistics;
+  if (cache_info->nexus_info != (NexusInfo **) NULL)
+    for (i=0; i < (ssize_t) (2*cache_info->number_threads); i++)
+    {
+      statistics->direct_requests+=cache_info->nexus_info[i]->direct_requests;
+      statistics->buffered_requests+=
+        cache_info->nexus_info[i]->buffered_requests;
+      statistics->virtual_requests+=
+        cache_info->nexus_info[i]->virtual_requests;
+      statistics->read_ahead_requests+=
+        cache_info->nexus_info[i]->read_ahead_requests;
+      statistics->write_behind_requests+=
+        cache_info->nexus_info[i]->write_behind_requests;
+    }
+  UnlockSemaphoreInfo(statistics_semaphore);
+  LockSemaphoreInfo(cache_info->file_semaphore);
+  statistics->disk_bytes_read=cache_info->statistics.disk_bytes_read;
+  statistics->disk_bytes_written=cache_info->statistics.disk_bytes_written;
+  UnlockSemaphoreInfo(cache_info->file_semaphore);
+  return(MagickTrue);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -1803,7 +2979,7 @@ static Cache GetImagePixelCache(Image *image,const MagickBooleanType clone,
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
 %  GetImagePixelCacheType() returns the pixel cache type: UndefinedCache,
-%  DiskCache, MemoryCache, MapCache, or PingCache.
+%  CompressedCache, DiskCache, MemoryCache, MapCache, or PingCache.
 %
 %  The format of the GetImagePixelCacheType() method is:
 %
@@ -1958,6 +3134,7 @@ static MagickBooleanType GetOneAuthenticPixelFromCache(Image *image,
   (void) memset(pixel,0,MaxPixelChannels*sizeof(*pixel));
   q=GetAuthenticPixelCacheNexus(image,x,y,1UL,1UL,cache_info->nexus_info[id],
     exception);
+  UnpinBufferedPixelCacheNexus(cache_info,cache_info->nexus_info[id]);
   return(CopyPixel(image,q,pixel));
 }
 
@@ -2017,6 +3194,7 @@ MagickExport MagickBooleanType GetOneVirtualPixel(const Image *image,
   assert(id < (int) cache_info->number_threads);
   p=GetVirtualPixelCacheNexus(image,GetPixelCacheVirtualMethod(image),x,y,
     1UL,1UL,cache_info->nexus_info[id],exception);
+  UnpinBufferedPixelCacheNexus(cache_info,cache_info->nexus_info[id]);
   return(CopyPixel(image,p,pixel));
 }
 
@@ -2076,6 +3254,7 @@ static MagickBooleanType GetOneVirtualPixelFromCache(const Image *image,
   (void) memset(pixel,0,MaxPixelChannels*sizeof(*pixel));
   p=GetVirtualPixelCacheNexus(image,virtual_pixel_method,x,y,1UL,1UL,
     cache_info->nexus_info[id],exception);
+  UnpinBufferedPixelCacheNexus(cache_info,cache_info->nexus_info[id]);
   return(CopyPixel(image,p,pixel));
 }
 
@@ -2135,6 +3314,7 @@ MagickExport MagickBooleanType GetOneVirtualPixelInfo(const Image *image,
   GetPixelInfo(image,pixel);
   p=GetVirtualPixelCacheNexus(image,virtual_pixel_method,x,y,1UL,1UL,
     cache_info->nexus_info[id],exception);
+  UnpinBufferedPixelCacheNexus(cache_info,cache_info->nexus_info[id]);
   if (p == (const Quantum *) NULL)
     return(MagickFalse);
   GetPixelInfoPixel(image,p,pixel);
@@ -2339,11 +3519,113 @@ MagickExport void *GetPixelCachePixels(Image *image,MagickSizeType *length,
   cache_info=(CacheInfo *) image->cache;
   assert(cache_info->signature == MagickCoreSignature);
   *length=cache_info->length;
+  LockSemaphoreInfo(cache_semaphore);
+  cache_info->exported=MagickTrue;  /* the caller keeps a pointer */
+  UnlockSemaphoreInfo(cache_semaphore);
   if ((cache_info->type != MemoryCache) && (cache_info->type != MapCache))
     return((void *) NULL);
+  CopyPixelCacheBands(cache_info,0,cache_info->rows);
   return((void *) cache_info->pixels);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   G e t P i x e l C a c h e R e g i o n F i l e                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetPixelCacheRegionFile() returns the descriptor of the disk cache file when
+%  the pixels of the specified region are stored there as one contiguous span,
+%  otherwise -1.  The file offset of the span is returned in offset.
+%
+%  The format of the GetPixelCacheRegionFile() method is:
+%
+%      int GetPixelCacheRegionFile(const Image *image,
+%        const RectangleInfo *region,MagickOffsetType *offset)
+%
+%  A description of each parameter follows:
+%
+%    o image: the image.
+%
+%    o region: the region of the image.
+%
+%    o offset: the offset of the region pixels in the cache file.
+%
+*/
+MagickPrivate int GetPixelCacheRegionFile(const Image *image,
+  const RectangleInfo *region,MagickOffsetType *offset)
+{
+  CacheInfo
+    *magick_restrict cache_info;
+
+  int
+    file;
+
+  assert(image != (const Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  assert(image->cache != (Cache) NULL);
+  assert(region != (const RectangleInfo *) NULL);
+  assert(offset != (MagickOffsetType *) NULL);
+  cache_info=(CacheInfo *) image->cache;
+  assert(cache_info->signature == MagickCoreSignature);
+  *offset=0;
+  if ((cache_info->type != DiskCache) || (cache_info->tile_width != 0) ||
+      (cache_info->shared_cache != (CacheInfo *) NULL))
+    return(-1);
+  if ((region->x < 0) || (region->y < 0) || (region->width == 0) ||
+      (region->height == 0) ||
+      (((size_t) region->x+region->width) > cache_info->columns) ||
+      (((size_t) region->y+region->height) > cache_info->rows))
+    return(-1);
+  if ((region->height != 1) && (region->width != cache_info->columns))
+    return(-1);
+  file=(-1);
+  LockSemaphoreInfo(cache_info->file_semaphore);
+  if (OpenPixelCacheOnDisk(cache_info,IOMode) != MagickFalse)
+    file=cache_info->file;
+  UnlockSemaphoreInfo(cache_info->file_semaphore);
+  *offset=cache_info->offset+((MagickOffsetType) region->y*(MagickOffsetType)
+    cache_info->columns+region->x)*(MagickOffsetType)
+    cache_info->number_channels*(MagickOffsetType) sizeof(Quantum);
+  return(file);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t P i x e l C a c h e S t a t i s t i c s                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetPixelCacheStatistics() returns the pixel cache counters accumulated
+%  over the pixel caches this process has destroyed.
+%
+%  The format of the GetPixelCacheStatistics() method is:
+%
+%      void GetPixelCacheStatistics(CacheStatistics *statistics)
+%
+%  A description of each parameter follows:
+%
+%    o statistics: return the pixel cache counters in this structure.
+%
+*/
+MagickExport void GetPixelCacheStatistics(CacheStatistics *statistics)
+{
+  assert(statistics != (CacheStatistics *) NULL);
+  LockSemaphoreInfo(statistics_semaphore);
+  *statistics=cache_statistics;
+  UnlockSemaphoreInfo(statistics_semaphore);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -2421,6 +3703,24 @@ MagickPrivate void GetPixelCacheTileSize(const Image *image,size_t *width,
     (void) LogMagickEvent(TraceEvent,GetMagickModule(),"%s",image->filename);
   cache_info=(CacheInfo *) image->cache;
   assert(cache_info->signature == MagickCoreSignature);
+  if (cache_info->tile_width != 0)
+    {
+      /*
+        Tile-major pixel cache: access pixels one cache tile at a time.
+      */
+      *width=cache_info->tile_width;
+      *height=cache_info->tile_height;
+      return;
+    }
+  if (cache_info->type == CompressedCache)
+    {
+      /*
+        Compressed pixel cache: access pixels one cache block at a time.
+      */
+      *width=cache_info->block_size;
+      *height=cache_info->block_size;
+      return;
+    }
   *width=2048UL/(MagickMax(cache_info->number_channels,1)*sizeof(Quantum));
   if (GetImagePixelCacheType(image) == DiskCache)
     *width=8192UL/(MagickMax(cache_info->number_channels,1)*sizeof(Quantum));
@@ -2830,6 +4130,7 @@ MagickPrivate const Quantum *GetVirtualPixelCacheNexus(const Image *image,
   /*
     Pixel request is outside cache extents.
   */
+  nexus_info->virtual_requests++;
   virtual_nexus=nexus_info->virtual_nexus;
   q=pixels;
   s=(unsigned char *) nexus_info->metacontent;
@@ -2918,46 +4219,73 @@ MagickPrivate const Quantum *GetVirtualPixelCacheNexus(const Image *image,
   }
   for (v=0; v < (ssize_t) rows; v++)
   {
+    MagickModulo
+      y_modulo;
+
     ssize_t
-      y_offset;
+      y_offset,
+      y_source;
 
+    /*
+      Map the row to its source row, out of range if it is a virtual color.
+    */
     y_offset=y+v;
-    if ((virtual_pixel_method == EdgeVirtualPixelMethod) ||
-        (virtual_pixel_method == UndefinedVirtualPixelMethod))
-      y_offset=EdgeY(y_offset,cache_info->rows);
+    y_modulo=VirtualPixelModulo(y_offset,cache_info->rows);
+    y_source=y_offset;
+    switch (virtual_pixel_method)
+    {
+      case EdgeVirtualPixelMethod:
+      case HorizontalTileEdgeVirtualPixelMethod:
+      case UndefinedVirtualPixelMethod:
+      {
+        y_source=EdgeY(y_offset,cache_info->rows);
+        break;
+      }
+      case CheckerTileVirtualPixelMethod:
+      case TileVirtualPixelMethod:
+      case VerticalTileEdgeVirtualPixelMethod:
+      case VerticalTileVirtualPixelMethod:
+      {
+        y_source=y_modulo.remainder;
+        break;
+      }
+      case MirrorVirtualPixelMethod:
+      {
+        y_source=y_modulo.remainder;
+        if ((y_modulo.quotient & 0x01) == 1L)
+          y_source=(ssize_t) cache_info->rows-y_modulo.remainder-1L;
+        break;
+      }
+      default:
+        break;
+    }
     for (u=0; u < (ssize_t) columns; u+=(ssize_t) length)
     {
+      MagickModulo
+        x_modulo;
+
       ssize_t
-        x_offset;
+        step,
+        x_offset,
+        x_source;
 
       x_offset=x+u;
-      length=(MagickSizeType) MagickMin((ssize_t) cache_info->columns-
-        x_offset,(ssize_t) columns-u);
-      if (((x_offset < 0) || (x_offset >= (ssize_t) cache_info->columns)) ||
-          ((y_offset < 0) || (y_offset >= (ssize_t) cache_info->rows)) ||
-          (length == 0))
+      length=(MagickSizeType) columns-(MagickSizeType) u;
+      if (((virtual_pixel_method == DitherVirtualPixelMethod) ||
+           (virtual_pixel_method == RandomVirtualPixelMethod)) &&
+          (((x_offset < 0) || (x_offset >= (ssize_t) cache_info->columns)) ||
+           ((y_offset < 0) || (y_offset >= (ssize_t) cache_info->rows))))
         {
-          MagickModulo
-            x_modulo,
-            y_modulo;
-
           /*
             Transfer a single pixel.
           */
           length=(MagickSizeType) 1;
-          switch (virtual_pixel_method)
-          {
-            case EdgeVirtualPixelMethod:
-            default:
-            {
-              p=GetVirtualPixelCacheNexus(image,virtual_pixel_method,
-                EdgeX(x_offset,cache_info->columns),
-                EdgeY(y_offset,cache_info->rows),1UL,1UL,virtual_nexus,
-                exception);
-              r=GetVirtualMetacontentFromNexus(cache_info,virtual_nexus);
-              break;
-            }
-            case RandomVirtualPixelMethod:
+          if (virtual_pixel_method == DitherVirtualPixelMethod)
+            p=GetVirtualPixelCacheNexus(image,virtual_pixel_method,
+              DitherX(x_offset,cache_info->columns),
+              DitherY(y_offset,cache_info->rows),1UL,1UL,virtual_nexus,
+              exception);
+          else
             {
               if (cache_info->random_info == (RandomInfo *) NULL)
                 cache_info->random_info=AcquireRandomInfo();
@@ -2965,150 +4293,138 @@ MagickPrivate const Quantum *GetVirtualPixelCacheNexus(const Image *image,
                 RandomX(cache_info->random_info,cache_info->columns),
                 RandomY(cache_info->random_info,cache_info->rows),1UL,1UL,
                 virtual_nexus,exception);
-              r=GetVirtualMetacontentFromNexus(cache_info,virtual_nexus);
-              break;
             }
-            case DitherVirtualPixelMethod:
+          if (p == (const Quantum *) NULL)
+            break;
+          r=GetVirtualMetacontentFromNexus(cache_info,virtual_nexus);
+          (void) memcpy(q,p,(size_t) (cache_info->number_channels*
+            sizeof(*p)));
+          q+=(ptrdiff_t) cache_info->number_channels;
+          if ((s != (void *) NULL) && (r != (const void *) NULL))
             {
-              p=GetVirtualPixelCacheNexus(image,virtual_pixel_method,
-                DitherX(x_offset,cache_info->columns),
-                DitherY(y_offset,cache_info->rows),1UL,1UL,virtual_nexus,
-                exception);
-              r=GetVirtualMetacontentFromNexus(cache_info,virtual_nexus);
-              break;
+              (void) memcpy(s,r,(size_t) cache_info->metacontent_extent);
+              s+=(ptrdiff_t) cache_info->metacontent_extent;
             }
+          continue;
+        }
+      /*
+        Map the span to its source columns: a run (step 1), a mirrored run
+        (step -1), or a replicated edge pixel (step 0).
+      */
+      x_modulo=VirtualPixelModulo(x_offset,cache_info->columns);
+      x_source=x_offset;
+      step=1;
+      if ((x_offset >= 0) && (x_offset < (ssize_t) cache_info->columns))
+        length=MagickMin(length,(MagickSizeType) cache_info->columns-
+          (MagickSizeType) x_offset);
+      else
+        {
+          if (x_offset < 0)
+            length=MagickMin(length,(MagickSizeType) -x_offset);
+          switch (virtual_pixel_method)
+          {
+            case BackgroundVirtualPixelMethod:
+            case BlackVirtualPixelMethod:
+            case GrayVirtualPixelMethod:
+            case TransparentVirtualPixelMethod:
+            case MaskVirtualPixelMethod:
+            case WhiteVirtualPixelMethod:
+            case VerticalTileVirtualPixelMethod:
+              break;
+            case CheckerTileVirtualPixelMethod:
+            case HorizontalTileEdgeVirtualPixelMethod:
+            case HorizontalTileVirtualPixelMethod:
             case TileVirtualPixelMethod:
             {
-              x_modulo=VirtualPixelModulo(x_offset,cache_info->columns);
-              y_modulo=VirtualPixelModulo(y_offset,cache_info->rows);
-              p=GetVirtualPixelCacheNexus(image,virtual_pixel_method,
-                x_modulo.remainder,y_modulo.remainder,1UL,1UL,virtual_nexus,
-                exception);
-              r=GetVirtualMetacontentFromNexus(cache_info,virtual_nexus);
+              x_source=x_modulo.remainder;
+              length=MagickMin(length,(MagickSizeType) cache_info->columns-
+                (MagickSizeType) x_modulo.remainder);
               break;
             }
             case MirrorVirtualPixelMethod:
             {
-              x_modulo=VirtualPixelModulo(x_offset,cache_info->columns);
+              x_source=x_modulo.remainder;
+              length=MagickMin(length,(MagickSizeType) cache_info->columns-
+                (MagickSizeType) x_modulo.remainder);
               if ((x_modulo.quotient & 0x01) == 1L)
-                x_modulo.remainder=(ssize_t) cache_info->columns-
-                  x_modulo.remainder-1L;
-              y_modulo=VirtualPixelModulo(y_offset,cache_info->rows);
-              if ((y_modulo.quotient & 0x01) == 1L)
-                y_modulo.remainder=(ssize_t) cache_info->rows-
-                  y_modulo.remainder-1L;
-              p=GetVirtualPixelCacheNexus(image,virtual_pixel_method,
-                x_modulo.remainder,y_modulo.remainder,1UL,1UL,virtual_nexus,
-                exception);
-              r=GetVirtualMetacontentFromNexus(cache_info,virtual_nexus);
-              break;
-            }
-            case HorizontalTileEdgeVirtualPixelMethod:
-            {
-              x_modulo=VirtualPixelModulo(x_offset,cache_info->columns);
-              p=GetVirtualPixelCacheNexus(image,virtual_pixel_method,
-                x_modulo.remainder,EdgeY(y_offset,cache_info->rows),1UL,1UL,
-                virtual_nexus,exception);
-              r=GetVirtualMetacontentFromNexus(cache_info,virtual_nexus);
+                {
+                  x_source=(ssize_t) cache_info->columns-x_modulo.remainder-
+                    1L;
+                  step=(-1);
+                }
               break;
             }
-            case VerticalTileEdgeVirtualPixelMethod:
+            case EdgeVirtualPixelMethod:
+            default:
             {
-              y_modulo=VirtualPixelModulo(y_offset,cache_info->rows);
-              p=GetVirtualPixelCacheNexus(image,virtual_pixel_method,
-                EdgeX(x_offset,cache_info->columns),y_modulo.remainder,1UL,1UL,
-                virtual_nexus,exception);
-              r=GetVirtualMetacontentFromNexus(cache_info,virtual_nexus);
-              break;
-            }
-            case BackgroundVirtualPixelMethod:
-            case BlackVirtualPixelMethod:
-            case GrayVirtualPixelMethod:
-            case TransparentVirtualPixelMethod:
-            case MaskVirtualPixelMethod:
-            case WhiteVirtualPixelMethod:
-            {
-              p=virtual_pixel;
-              r=virtual_metacontent;
-              break;
-            }
-            case CheckerTileVirtualPixelMethod:
-            {
-              x_modulo=VirtualPixelModulo(x_offset,cache_info->columns);
-              y_modulo=VirtualPixelModulo(y_offset,cache_info->rows);
-              if (((x_modulo.quotient ^ y_modulo.quotient) & 0x01) != 0L)
-                {
-                  p=virtual_pixel;
-                  r=virtual_metacontent;
-                  break;
-                }
-              p=GetVirtualPixelCacheNexus(image,virtual_pixel_method,
-                x_modulo.remainder,y_modulo.remainder,1UL,1UL,virtual_nexus,
-                exception);
-              r=GetVirtualMetacontentFromNexus(cache_info,virtual_nexus);
-              break;
-            }
-            case HorizontalTileVirtualPixelMethod:
-            {
-              if ((y_offset < 0) || (y_offset >= (ssize_t) cache_info->rows))
-                {
-                  p=virtual_pixel;
-                  r=virtual_metacontent;
-                  break;
-                }
-              x_modulo=VirtualPixelModulo(x_offset,cache_info->columns);
-              y_modulo=VirtualPixelModulo(y_offset,cache_info->rows);
-              p=GetVirtualPixelCacheNexus(image,virtual_pixel_method,
-                x_modulo.remainder,y_modulo.remainder,1UL,1UL,virtual_nexus,
-                exception);
-              r=GetVirtualMetacontentFromNexus(cache_info,virtual_nexus);
-              break;
-            }
-            case VerticalTileVirtualPixelMethod:
-            {
-              if ((x_offset < 0) || (x_offset >= (ssize_t) cache_info->columns))
-                {
-                  p=virtual_pixel;
-                  r=virtual_metacontent;
-                  break;
-                }
-              x_modulo=VirtualPixelModulo(x_offset,cache_info->columns);
-              y_modulo=VirtualPixelModulo(y_offset,cache_info->rows);
-              p=GetVirtualPixelCacheNexus(image,virtual_pixel_method,
-                x_modulo.remainder,y_modulo.remainder,1UL,1UL,virtual_nexus,
-                exception);
-              r=GetVirtualMetacontentFromNexus(cache_info,virtual_nexus);
+              x_source=EdgeX(x_offset,cache_info->columns);
+              step=0;
               break;
             }
           }
-          if (p == (const Quantum *) NULL)
-            break;
-          (void) memcpy(q,p,(size_t) (cache_info->number_channels*length*
-            sizeof(*p)));
-          q+=(ptrdiff_t) cache_info->number_channels;
-          if ((s != (void *) NULL) && (r != (const void *) NULL))
-            {
-              (void) memcpy(s,r,(size_t) cache_info->metacontent_extent);
-              s+=(ptrdiff_t) cache_info->metacontent_extent;
-            }
+        }
+      if (((x_source < 0) || (x_source >= (ssize_t) cache_info->columns)) ||
+          ((y_source < 0) || (y_source >= (ssize_t) cache_info->rows)) ||
+          ((virtual_pixel_method == CheckerTileVirtualPixelMethod) &&
+           (((x_modulo.quotient ^ y_modulo.quotient) & 0x01) != 0L)))
+        {
+          /*
+            Fill the span with the virtual pixel color.
+          */
+          for (i=0; i < (ssize_t) length; i++)
+          {
+            (void) memcpy(q,virtual_pixel,(size_t) (cache_info->number_channels*
+              sizeof(*q)));
+            q+=(ptrdiff_t) cache_info->number_channels;
+            if ((s != (void *) NULL) && (virtual_metacontent != (void *) NULL))
+              {
+                (void) memcpy(s,virtual_metacontent,(size_t)
+                  cache_info->metacontent_extent);
+                s+=(ptrdiff_t) cache_info->metacontent_extent;
+              }
+          }
           continue;
         }
       /*
-        Transfer a run of pixels.
+        Transfer the span from its source columns.
       */
-      p=GetVirtualPixelCacheNexus(image,virtual_pixel_method,x_offset,y_offset,
-        (size_t) length,1UL,virtual_nexus,exception);
+      if (step < 0)
+        x_source-=(ssize_t) length-1;
+      p=GetVirtualPixelCacheNexus(image,virtual_pixel_method,x_source,y_source,
+        step == 0 ? 1UL : (size_t) length,1UL,virtual_nexus,exception);
       if (p == (const Quantum *) NULL)
         break;
       r=GetVirtualMetacontentFromNexus(cache_info,virtual_nexus);
-      (void) memcpy(q,p,(size_t) (cache_info->number_channels*length*
-        sizeof(*p)));
-      q+=(ptrdiff_t) cache_info->number_channels*length;
-      if ((r != (void *) NULL) && (s != (const void *) NULL))
+      if (step > 0)
         {
-          (void) memcpy(s,r,(size_t) length);
-          s+=(ptrdiff_t) length*cache_info->metacontent_extent;
+          (void) memcpy(q,p,(size_t) (cache_info->number_channels*length*
+            sizeof(*p)));
+          q+=(ptrdiff_t) cache_info->number_channels*length;
+          if ((s != (void *) NULL) && (r != (const void *) NULL))
+            {
+              (void) memcpy(s,r,(size_t) (length*
+                cache_info->metacontent_extent));
+              s+=(ptrdiff_t) length*cache_info->metacontent_extent;
+            }
+          continue;
         }
+      for (i=0; i < (ssize_t) length; i++)
+      {
+        ssize_t
+          j;
+
+        j=step == 0 ? 0 : (ssize_t) length-i-1;
+        (void) memcpy(q,p+j*(ssize_t) cache_info->number_channels,(size_t)
+          (cache_info->number_channels*sizeof(*p)));
+        q+=(ptrdiff_t) cache_info->number_channels;
+        if ((s != (void *) NULL) && (r != (const void *) NULL))
+          {
+            (void) memcpy(s,(const unsigned char *) r+j*(ssize_t)
+              cache_info->metacontent_extent,(size_t)
+              cache_info->metacontent_extent);
+            s+=(ptrdiff_t) cache_info->metacontent_extent;
+          }
+      }
     }
     if (u < (ssize_t) columns)
       break;
@@ -3178,6 +4494,7 @@ static const Quantum *GetVirtualPixelCache(const Image *image,
   assert(id < (int) cache_info->number_threads);
   p=GetVirtualPixelCacheNexus(image,virtual_pixel_method,x,y,columns,rows,
     cache_info->nexus_info[id],exception);
+  UnpinBufferedPixelCacheNexus(cache_info,cache_info->nexus_info[id]);
   return(p);
 }
 
@@ -3297,6 +4614,7 @@ MagickExport const Quantum *GetVirtualPixels(const Image *image,
   assert(id < (int) cache_info->number_threads);
   p=GetVirtualPixelCacheNexus(image,GetPixelCacheVirtualMethod(image),x,y,
     columns,rows,cache_info->nexus_info[id],exception);
+  UnpinBufferedPixelCacheNexus(cache_info,cache_info->nexus_info[id]);
   return(p);
 }
 
@@ -3483,6 +4801,68 @@ static MagickBooleanType MaskPixelCacheNexus(Image *image,NexusInfo *nexus_info,
   return(MagickTrue);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   M e r g e P i x e l C a c h e N e x u s S t a t i s t i c s               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  MergePixelCacheNexusStatistics() adds the request counters of a nexus
+%  array to the pixel cache statistics.  Each thread counts its requests in
+%  its own nexus; call this method before the nexus array is destroyed.
+%
+%  The format of the MergePixelCacheNexusStatistics() method is:
+%
+%      void MergePixelCacheNexusStatistics(const Cache cache,
+%        NexusInfo **nexus_info,const size_t number_threads)
+%
+%  A description of each parameter follows:
+%
+%    o cache: the pixel cache.
+%
+%    o nexus_info: the nexus to merge.
+%
+%    o number_threads: the number of nexus threads.
+%
+*/
+MagickPrivate void MergePixelCacheNexusStatistics(const Cache cache,
+  NexusInfo **nexus_info,const size_t number_threads)
+{
+  CacheInfo
+    *magick_restrict cache_info;
+
+  ssize_t
+    i;
+
+  assert(cache != (Cache) NULL);
+  assert(nexus_info != (NexusInfo **) NULL);
+  cache_info=(CacheInfo *) cache;
+  assert(cache_info->signature == MagickCoreSignature);
+  LockSemaphoreInfo(statistics_semaphore);
+  for (i=0; i < (ssize_t) (2*number_threads); i++)
+  {
+    cache_info->statistics.direct_requests+=nexus_info[i]->direct_requests;
+    cache_info->statistics.buffered_requests+=
+      nexus_info[i]->buffered_requests;
+    cache_info->statistics.virtual_requests+=nexus_info[i]->virtual_requests;
+    cache_info->statistics.read_ahead_requests+=
+      nexus_info[i]->read_ahead_requests;
+    cache_info->statistics.write_behind_requests+=
+      nexus_info[i]->write_behind_requests;
+    nexus_info[i]->direct_requests=0;
+    nexus_info[i]->buffered_requests=0;
+    nexus_info[i]->virtual_requests=0;
+    nexus_info[i]->read_ahead_requests=0;
+    nexus_info[i]->write_behind_requests=0;
+  }
+  UnlockSemaphoreInfo(statistics_semaphore);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -3563,21 +4943,159 @@ static MagickBooleanType OpenPixelCacheOnDisk(CacheInfo *cache_info,
   return(MagickTrue);
 }
 
-static inline MagickOffsetType WritePixelCacheRegion(
+static unsigned char *GetPixelCacheWindow(
+  const CacheInfo *magick_restrict cache_info,const MagickOffsetType offset,
+  MagickSizeType *extent)
+{
+  CacheWindowInfo
+    *magick_restrict windows,
+    window;
+
+  MagickSizeType
+    length;
+
+  ssize_t
+    i;
+
+  /*
+    Return the mapped address of the cache file offset, mapping a new window
+    in place of the least recently used one on a miss.  The window list is
+    kept in most recently used order.
+  */
+  if (cache_info->disk_mode != IOMode)
+    return((unsigned char *) NULL);
+  windows=cache_info->windows;
+  for (i=0; i < (ssize_t) cache_info->number_windows; i++)
+  {
+    if (windows[i].map == (unsigned char *) NULL)
+      break;
+    if ((offset >= windows[i].offset) &&
+        (offset < (windows[i].offset+(MagickOffsetType) windows[i].length)))
+      break;
+  }
+  if ((i >= (ssize_t) cache_info->number_windows) ||
+      (windows[i].map == (unsigned char *) NULL))
+    {
+      length=(MagickSizeType) cache_info->offset+cache_info->length;
+      if ((offset < 0) || ((MagickSizeType) offset >= length))
+        return((unsigned char *) NULL);
+      i=MagickMin(i,(ssize_t) cache_info->number_windows-1);
+      if (windows[i].map != (unsigned char *) NULL)
+        (void) UnmapBlob(windows[i].map,windows[i].length);
+      windows[i].offset=offset-(offset % (MagickOffsetType)
+        cache_info->window_size);
+      windows[i].length=(size_t) MagickMin((MagickSizeType)
+        cache_info->window_size,length-(MagickSizeType) windows[i].offset);
+      windows[i].map=(unsigned char *) MapBlob(cache_info->file,IOMode,
+        windows[i].offset,windows[i].length);
+      if (windows[i].map == (unsigned char *) NULL)
+        return((unsigned char *) NULL);  /* fall back to pread()/pwrite() */
+    }
+  if (i != 0)
+    {
+      window=windows[i];
+      (void) memmove(windows+1,windows,(size_t) i*sizeof(*windows));
+      windows[0]=window;
+    }
+  *extent=(MagickSizeType) windows[0].length-(MagickSizeType) (offset-
+    windows[0].offset);
+  return(windows[0].map+(offset-windows[0].offset));
+}
+
+static MagickOffsetType ReadPixelCacheWindows(
+  const CacheInfo *magick_restrict cache_info,const MagickOffsetType offset,
+  const MagickSizeType length,unsigned char *magick_restrict buffer)
+{
+  const unsigned char
+    *magick_restrict p;
+
+  MagickOffsetType
+    i;
+
+  MagickSizeType
+    extent;
+
+  for (i=0; i < (MagickOffsetType) length; i+=(MagickOffsetType) extent)
+  {
+    p=GetPixelCacheWindow(cache_info,offset+i,&extent);
+    if (p == (const unsigned char *) NULL)
+      break;
+    extent=MagickMin(extent,length-(MagickSizeType) i);
+    (void) memcpy(buffer+i,p,(size_t) extent);
+  }
+  return(i);
+}
+
+static MagickOffsetType WritePixelCacheWindows(
   const CacheInfo *magick_restrict cache_info,const MagickOffsetType offset,
   const MagickSizeType length,const unsigned char *magick_restrict buffer)
 {
   MagickOffsetType
     i;
 
+  MagickSizeType
+    extent;
+
+  unsigned char
+    *magick_restrict q;
+
+  for (i=0; i < (MagickOffsetType) length; i+=(MagickOffsetType) extent)
+  {
+    q=GetPixelCacheWindow(cache_info,offset+i,&extent);
+    if (q == (unsigned char *) NULL)
+      break;
+    extent=MagickMin(extent,length-(MagickSizeType) i);
+    (void) memcpy(q,buffer+i,(size_t) extent);
+  }
+  return(i);
+}
+
+static inline MagickBooleanType IsPixelCacheWindowed(
+  const CacheInfo *magick_restrict cache_info,const MagickSizeType span)
+{
+  /*
+    Map windows only if the file span of the request fits in the window list,
+    column-wise requests would otherwise remap a window for every row.
+  */
+  if (cache_info->windows == (CacheWindowInfo *) NULL)
+    return(MagickFalse);
+  if (span > ((MagickSizeType) (cache_info->number_windows-1)*
+      cache_info->window_size))
+    return(MagickFalse);
+  return(MagickTrue);
+}
+
+static inline MagickOffsetType WritePixelCacheRegion(
+  const CacheInfo *magick_restrict cache_info,const MagickBooleanType windowed,
+  const MagickOffsetType offset,const MagickSizeType length,
+  const unsigned char *magick_restrict buffer)
+{
+  MagickOffsetType
+    i;
+
   ssize_t
     count = 0;
 
+  /*
+    Callers hold the file semaphore, or own a cache they are opening; this
+    also guards the disk byte counter.
+  */
+  i=0;
+  if (windowed != MagickFalse)
+    {
+      i=WritePixelCacheWindows(cache_info,offset,length,buffer);
+      if (i == (MagickOffsetType) length)
+        {
+          ((CacheInfo *) cache_info)->statistics.disk_bytes_written+=
+            (MagickSizeType) i;
+          return(i);
+        }
+    }
 #if !defined(MAGICKCORE_HAVE_PWRITE)
-  if (lseek(cache_info->file,offset,SEEK_SET) < 0)
+  if (lseek(cache_info->file,offset+i,SEEK_SET) < 0)
     return((MagickOffsetType) -1);
 #endif
-  for (i=0; i < (MagickOffsetType) length; i+=count)
+  for ( ; i < (MagickOffsetType) length; i+=count)
   {
 #if !defined(MAGICKCORE_HAVE_PWRITE)
     count=write(cache_info->file,buffer+i,(size_t) MagickMin(length-
@@ -3593,6 +5111,7 @@ static inline MagickOffsetType WritePixelCacheRegion(
           break;
       }
   }
+  ((CacheInfo *) cache_info)->statistics.disk_bytes_written+=(MagickSizeType) i;
   return(i);
 }
 
@@ -3629,7 +5148,7 @@ static MagickBooleanType SetPixelCacheExtent(Image *image,MagickSizeType length)
         extent;
 
       extent=(MagickOffsetType) length-1;
-      count=WritePixelCacheRegion(cache_info,extent,1,(const unsigned char *)
+      count=WritePixelCacheRegion(cache_info,MagickFalse,extent,1,(const unsigned char *)
         "");
       if (count != 1)
         return(MagickFalse);
@@ -3645,6 +5164,631 @@ static MagickBooleanType SetPixelCacheExtent(Image *image,MagickSizeType length)
   return(MagickTrue);
 }
 
+static char *GetPixelCacheSetting(const Image *image,const char *key)
+{
+  const char
+    *option;
+
+  /*
+    A cache define (e.g. -define cache:layout=tiled) overrides the policy.
+  */
+  option=GetImageArtifact(image,key);
+  if (option != (const char *) NULL)
+    return(ConstantString(option));
+  return(GetPolicyValue(key));
+}
+
+static MemoryAdvice GetPixelCacheMemoryAdvice(const Image *image,
+  const MapMode mode)
+{
+  char
+    *value;
+
+  MemoryAdvice
+    advice;
+
+  advice=UndefinedMemoryAdvice;
+  value=GetPixelCacheSetting(image,"cache:hugepages");
+  if (value != (char *) NULL)
+    {
+      if (IsStringTrue(value) != MagickFalse)
+        advice=(MemoryAdvice) (advice | HugePageMemoryAdvice);
+      value=DestroyString(value);
+    }
+  value=GetPixelCacheSetting(image,"cache:access");
+  if (value != (char *) NULL)
+    {
+      if (LocaleCompare(value,"sequential") == 0)
+        advice=(MemoryAdvice) (advice | SequentialMemoryAdvice);
+      if (LocaleCompare(value,"random") == 0)
+        advice=(MemoryAdvice) (advice | RandomMemoryAdvice);
+      value=DestroyString(value);
+    }
+  value=GetPixelCacheSetting(image,"cache:populate");
+  if (value != (char *) NULL)
+    {
+      if ((IsStringTrue(value) != MagickFalse) && (mode != ReadMode))
+        advice=(MemoryAdvice) (advice | PopulateMemoryAdvice);
+      value=DestroyString(value);
+    }
+  return(advice);
+}
+
+static const char *GetPixelCacheMemoryAdviceDescription(
+  const CacheInfo *cache_info,char *description)
+{
+  *description='\0';
+  if ((cache_info->memory_advice & HugePageMemoryAdvice) != 0)
+    (void) ConcatenateMagickString(description,", hugepage",MagickPathExtent);
+  if ((cache_info->memory_advice & SequentialMemoryAdvice) != 0)
+    (void) ConcatenateMagickString(description,", sequential",
+      MagickPathExtent);
+  if ((cache_info->memory_advice & RandomMemoryAdvice) != 0)
+    (void) ConcatenateMagickString(description,", random",MagickPathExtent);
+  if ((cache_info->memory_advice & PopulateMemoryAdvice) != 0)
+    (void) ConcatenateMagickString(description,", populate",MagickPathExtent);
+  if (cache_info->numa_policy == FirstTouchNumaPolicy)
+    (void) ConcatenateMagickString(description,", first-touch",
+      MagickPathExtent);
+  if (cache_info->numa_policy == InterleaveNumaPolicy)
+    (void) ConcatenateMagickString(description,", interleave",
+      MagickPathExtent);
+  return(description);
+}
+
+static NumaPolicy SetPixelCacheNumaPolicy(const Image *image,
+  CacheInfo *magick_restrict cache_info)
+{
+  char
+    *value;
+
+  NumaPolicy
+    policy;
+
+  /*
+    Fault in the pages of a memory cache from the threads that later access
+    them so each page is homed on the NUMA node of its thread.
+  */
+  value=GetPixelCacheSetting(image,"cache:numa");
+  if (value == (char *) NULL)
+    return(UndefinedNumaPolicy);
+  policy=UndefinedNumaPolicy;
+  if (LocaleCompare(value,"first-touch") == 0)
+    policy=FirstTouchNumaPolicy;
+  else
+    if (LocaleCompare(value,"interleave") == 0)
+      policy=InterleaveNumaPolicy;
+  value=DestroyString(value);
+  if ((cache_info->memory_advice & PopulateMemoryAdvice) != 0)
+    return(UndefinedNumaPolicy);  /* already faulted in by this thread */
+  switch (policy)
+  {
+    case FirstTouchNumaPolicy:
+    {
+      size_t
+        extent;
+
+      ssize_t
+        y;
+
+      /*
+        Touch each row with the static schedule of the pixel loops.
+      */
+      extent=cache_info->columns*cache_info->number_channels*
+        sizeof(*cache_info->pixels);
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp parallel for schedule(static) \
+        magick_number_threads(image,image,cache_info->rows,1)
+#endif
+      for (y=0; y < (ssize_t) cache_info->rows; y++)
+      {
+        (void) memset(cache_info->pixels+(size_t) y*cache_info->columns*
+          cache_info->number_channels,0,extent);
+        if (cache_info->metacontent_extent != 0)
+          (void) memset((unsigned char *) cache_info->metacontent+(size_t) y*
+            cache_info->columns*cache_info->metacontent_extent,0,
+            cache_info->columns*cache_info->metacontent_extent);
+      }
+      break;
+    }
+    case InterleaveNumaPolicy:
+    {
+      size_t
+        page_size;
+
+      ssize_t
+        i,
+        number_pages;
+
+      /*
+        Touch the pages round-robin across the threads.
+      */
+      page_size=(size_t) GetMagickPageSize();
+      number_pages=(ssize_t) ((cache_info->length+page_size-1)/page_size);
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp parallel for schedule(static,1) \
+        magick_number_threads(image,image,cache_info->rows,1)
+#endif
+      for (i=0; i < number_pages; i++)
+        ((unsigned char *) cache_info->pixels)[(size_t) i*page_size]=0;
+      break;
+    }
+    default:
+      break;
+  }
+  return(policy);
+}
+
+static void SetPixelCacheLayout(const Image *image,CacheInfo *cache_info)
+{
+  char
+    *value;
+
+  const char
+    *option;
+
+  GeometryInfo
+    geometry_info;
+
+  MagickStatusType
+    flags;
+
+  MagickSizeType
+    columns,
+    length,
+    rows;
+
+  /*
+    Does the user or policy prefer a tile-major disk pixel cache?
+  */
+  cache_info->tile_width=0;
+  cache_info->tile_height=0;
+  if (cache_info->mode == PersistMode)
+    return;  /* persistent caches are shared with MPC and remain row-major */
+  value=GetPixelCacheSetting(image,"cache:layout");
+  if (value == (char *) NULL)
+    return;
+  if (LocaleCompare(value,"tiled") != 0)
+    {
+      value=DestroyString(value);
+      return;
+    }
+  value=DestroyString(value);
+  cache_info->tile_width=128;
+  cache_info->tile_height=128;
+  option=GetImageArtifact(image,"cache:tile-geometry");
+  if (option != (const char *) NULL)
+    {
+      flags=ParseGeometry(option,&geometry_info);
+      if ((flags & RhoValue) != 0)
+        cache_info->tile_width=(size_t) MagickMax(geometry_info.rho,1.0);
+      cache_info->tile_height=cache_info->tile_width;
+      if ((flags & SigmaValue) != 0)
+        cache_info->tile_height=(size_t) MagickMax(geometry_info.sigma,1.0);
+    }
+  columns=(MagickSizeType) cache_info->tile_width*((cache_info->columns+
+    cache_info->tile_width-1)/cache_info->tile_width);
+  rows=(MagickSizeType) cache_info->tile_height*((cache_info->rows+
+    cache_info->tile_height-1)/cache_info->tile_height);
+  length=columns*rows*cache_info->number_channels*sizeof(Quantum);
+  if ((length/cache_info->number_channels/sizeof(Quantum)/columns) != rows)
+    {
+      cache_info->tile_width=0;
+      cache_info->tile_height=0;
+      return;
+    }
+  /*
+    Partial tiles along the right and bottom edges are padded on disk.
+  */
+  cache_info->length=length+(MagickSizeType) cache_info->columns*
+    cache_info->rows*cache_info->metacontent_extent;
+}
+
+static MagickBooleanType AcquirePixelCacheBlocks(const Image *image,
+  CacheInfo *cache_info)
+{
+  MagickSizeType
+    available;
+
+  size_t
+    blocks_across,
+    blocks_down,
+    extent,
+    minimum;
+
+  ssize_t
+    i;
+
+  /*
+    Does the user or policy prefer a compressed memory pixel cache to a disk
+    pixel cache?
+  */
+  cache_info->block_compress=MagickFalse;
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+  {
+    char
+      *value;
+
+    value=GetPixelCacheSetting(image,"cache:compress");
+    if (value != (char *) NULL)
+      {
+        cache_info->block_compress=IsStringTrue(value);
+        value=DestroyString(value);
+      }
+  }
+#else
+  (void) image;
+#endif
+  if ((cache_info->storage_depth == 0) &&
+      (cache_info->block_compress == MagickFalse))
+    return(MagickFalse);
+  /*
+    Square blocks keep both row and column access local.  Enough of them stay
+    decompressed for each thread to sweep a row or a column of blocks.
+  */
+  cache_info->block_size=256;
+  blocks_across=(cache_info->columns+cache_info->block_size-1)/
+    cache_info->block_size;
+  blocks_down=(cache_info->rows+cache_info->block_size-1)/
+    cache_info->block_size;
+  cache_info->number_blocks=blocks_across*blocks_down;
+  if ((cache_info->number_blocks/blocks_across) != blocks_down)
+    {
+      cache_info->block_size=0;
+      return(MagickFalse);
+    }
+  cache_info->number_hot_blocks=MagickMin((cache_info->number_threads+1)*
+    MagickMax(blocks_across,blocks_down),cache_info->number_blocks);
+  cache_info->compressed_length=0;
+  cache_info->block_file_length=0;
+  /*
+    Leave at least half of the available memory to the cold blocks; those
+    that still do not fit are kept in a block file.  With fewer hot blocks
+    than two rows or columns of blocks, a kernel that straddles a block
+    boundary thrashes, so fall back to a disk cache instead.
+  */
+  minimum=MagickMin(2*MagickMax(blocks_across,blocks_down),
+    cache_info->number_blocks);
+  available=GetMagickResourceLimit(MemoryResource);
+  if (available != MagickResourceInfinity)
+    available-=MagickMin(GetMagickResource(MemoryResource),available);
+  for ( ; ; )
+  {
+    if ((GetPixelCacheBlocksLength(cache_info) <= (available/2)) &&
+        (AcquireMagickResource(MemoryResource,GetPixelCacheBlocksLength(
+          cache_info)) != MagickFalse))
+      break;
+    if (cache_info->number_hot_blocks <= minimum)
+      {
+        cache_info->block_size=0;
+        return(MagickFalse);
+      }
+    cache_info->number_hot_blocks=MagickMax(cache_info->number_hot_blocks/2,
+      minimum);
+  }
+  extent=GetPixelCacheBlockExtent(cache_info);
+  cache_info->blocks=(CacheBlockInfo *) AcquireQuantumMemory(
+    cache_info->number_blocks,sizeof(*cache_info->blocks));
+  cache_info->hot_blocks=(CacheHotBlockInfo *) AcquireQuantumMemory(
+    cache_info->number_hot_blocks,sizeof(*cache_info->hot_blocks));
+  cache_info->block_buffer=(unsigned char *) AcquireQuantumMemory(
+    GetPixelCacheBufferExtent(cache_info),sizeof(*cache_info->block_buffer));
+  if ((cache_info->blocks == (CacheBlockInfo *) NULL) ||
+      (cache_info->hot_blocks == (CacheHotBlockInfo *) NULL) ||
+      (cache_info->block_buffer == (unsigned char *) NULL))
+    {
+      RelinquishPixelCacheBlocks(cache_info);
+      return(MagickFalse);
+    }
+  (void) memset(cache_info->blocks,0,cache_info->number_blocks*
+    sizeof(*cache_info->blocks));
+  (void) memset(cache_info->hot_blocks,0,cache_info->number_hot_blocks*
+    sizeof(*cache_info->hot_blocks));
+  for (i=0; i < (ssize_t) cache_info->number_hot_blocks; i++)
+  {
+    cache_info->hot_blocks[i].block=(-1);
+    cache_info->hot_blocks[i].pixels=(unsigned char *) AcquireAlignedMemory(1,
+      extent);
+    if (cache_info->hot_blocks[i].pixels == (unsigned char *) NULL)
+      {
+        RelinquishPixelCacheBlocks(cache_info);
+        return(MagickFalse);
+      }
+  }
+  return(MagickTrue);
+}
+
+static void SetPixelCacheWindows(const Image *image,CacheInfo *cache_info)
+{
+  char
+    *value;
+
+  MagickSizeType
+    extent;
+
+  size_t
+    number_windows,
+    page_size,
+    window_size;
+
+  /*
+    Does the user or policy prefer to access the disk cache through a few
+    mapped windows of the cache file rather than with pread() / pwrite()?
+  */
+  value=GetPixelCacheSetting(image,"cache:window-size");
+  if (value == (char *) NULL)
+    return;
+  window_size=StringToSizeType(value,100.0);
+  value=DestroyString(value);
+  number_windows=4;
+  value=GetPixelCacheSetting(image,"cache:windows");
+  if (value != (char *) NULL)
+    {
+      number_windows=StringToSizeType(value,100.0);
+      value=DestroyString(value);
+    }
+  page_size=(size_t) MagickMax(GetMagickPageSize(),1);
+  if ((window_size == 0) || (window_size > (MAGICK_SSIZE_MAX/2)) ||
+      (number_windows < 2) || (number_windows > 256))
+    return;
+  window_size=page_size*((window_size+page_size-1)/page_size);
+  extent=(MagickSizeType) cache_info->offset+cache_info->length;
+  if (window_size >= extent)
+    return;  /* a single window would map the whole cache */
+  if (AcquireMagickResource(MapResource,(MagickSizeType) number_windows*
+        window_size) == MagickFalse)
+    return;
+  cache_info->windows=(CacheWindowInfo *) AcquireQuantumMemory(number_windows,
+    sizeof(*cache_info->windows));
+  if (cache_info->windows == (CacheWindowInfo *) NULL)
+    {
+      RelinquishMagickResource(MapResource,(MagickSizeType) number_windows*
+        window_size);
+      return;
+    }
+  (void) memset(cache_info->windows,0,number_windows*
+    sizeof(*cache_info->windows));
+  cache_info->number_windows=number_windows;
+  cache_info->window_size=window_size;
+}
+
+static size_t GetPixelCacheStorageDepth(const Image *image,
+  const CacheInfo *cache_info)
+{
+  char
+    *value;
+
+  size_t
+    blocks_across,
+    blocks_down,
+    depth;
+
+  /*
+    Keep the pixels at the image depth rather than as quantums?
+  */
+  value=GetPixelCacheSetting(image,"cache:storage");
+  if (value == (char *) NULL)
+    return(0);
+  depth=0;
+  if (LocaleCompare(value,"packed") == 0)
+    {
+      if (image->depth <= 8)
+        depth=8;
+      else
+        if (image->depth <= 16)
+          depth=16;
+    }
+  value=DestroyString(value);
+  if (depth >= (8*sizeof(Quantum)))
+    return(0);
+  /*
+    Packing pays off only if most blocks are cold (see
+    AcquirePixelCacheBlocks()).
+  */
+  blocks_across=(image->columns+255)/256;
+  blocks_down=(image->rows+255)/256;
+  if ((2*(cache_info->number_threads+1)*MagickMax(blocks_across,blocks_down)) >=
+      (blocks_across*blocks_down))
+    return(0);
+  return(depth);
+}
+
+static void SetPixelCacheReadAhead(const Image *image,CacheInfo *cache_info)
+{
+  char
+    *value;
+
+  /*
+    How many rows should sequential readers and writers of the disk cache
+    read ahead of, or write behind, the rows they access?
+  */
+  value=GetPixelCacheSetting(image,"cache:read-ahead");
+  if (value != (char *) NULL)
+    {
+      cache_info->read_ahead=MagickMin(StringToSizeType(value,100.0),
+        cache_info->rows);
+      value=DestroyString(value);
+    }
+  value=GetPixelCacheSetting(image,"cache:write-behind");
+  if (value != (char *) NULL)
+    {
+      cache_info->write_behind=MagickMin(StringToSizeType(value,100.0),
+        cache_info->rows);
+      value=DestroyString(value);
+    }
+}
+
+static inline ssize_t GetPixelCacheTier(const CacheType type)
+{
+  switch (type)
+  {
+    case MemoryCache: return(4);
+    case MapCache: return(3);
+    case CompressedCache: return(2);
+    case DiskCache: return(1);
+    default: break;
+  }
+  return(0);
+}
+
+static void UpdatePixelCacheTier(CacheInfo *cache_info,const CacheType type)
+{
+  ssize_t
+    tier;
+
+  /*
+    A cache that lands in a slower tier than it had, or than memory if it is
+    new, is demoted; one that lands in a faster tier is promoted.
+  */
+  tier=GetPixelCacheTier(type);
+  if ((type == UndefinedCache) || (type == PingCache))
+    tier=GetPixelCacheTier(MemoryCache);
+  if (GetPixelCacheTier(cache_info->type) < tier)
+    UpdatePixelCacheStatistic(&cache_info->statistics.demotions,1);
+  if (GetPixelCacheTier(cache_info->type) > tier)
+    UpdatePixelCacheStatistic(&cache_info->statistics.promotions,1);
+}
+
+static inline MagickBooleanType IsPixelCacheIdle(
+  const CacheInfo *magick_restrict cache_info)
+{
+  /*
+    Can the memory cache move to disk?  The caller holds the cache semaphore.
+  */
+  if ((cache_info->pins != 0) || (cache_info->type != MemoryCache) ||
+      (cache_info->mode != IOMode) || (cache_info->exported != MagickFalse) ||
+      (cache_info->reference_count != 1) ||
+      (cache_info->shared_cache != (CacheInfo *) NULL) ||
+      (cache_info->clones != (CacheInfo *) NULL))
+    return(MagickFalse);
+#if defined(MAGICKCORE_OPENCL_SUPPORT)
+  if (cache_info->opencl != (MagickCLCacheInfo) NULL)
+    return(MagickFalse);
+#endif
+  return(MagickTrue);
+}
+
+static MagickBooleanType SpillPixelCacheToDisk(CacheInfo *cache_info)
+{
+  CacheInfo
+    source_info;
+
+  MagickOffsetType
+    count;
+
+  /*
+    Move the pixels of an idle memory cache to a row-major disk cache.  The
+    caller holds the cache semaphore, so no nexus can pin the cache meanwhile.
+  */
+  if (AcquireMagickResource(DiskResource,cache_info->length) == MagickFalse)
+    return(MagickFalse);
+  LockSemaphoreInfo(cache_info->file_semaphore);
+  source_info=(*cache_info);
+  *cache_info->cache_filename='\0';
+  count=(-1);
+  if (OpenPixelCacheOnDisk(cache_info,IOMode) != MagickFalse)
+    {
+      count=WritePixelCacheRegion(cache_info,MagickFalse,cache_info->offset,
+        cache_info->length,(const unsigned char *) cache_info->pixels);
+      (void) ClosePixelCacheOnDisk(cache_info);
+      if (count != (MagickOffsetType) cache_info->length)
+        (void) RelinquishUniqueFileResource(cache_info->cache_filename);
+    }
+  if (count != (MagickOffsetType) cache_info->length)
+    {
+      (void) CopyMagickString(cache_info->cache_filename,
+        source_info.cache_filename,MagickPathExtent);
+      RelinquishMagickResource(DiskResource,cache_info->length);
+      UnlockSemaphoreInfo(cache_info->file_semaphore);
+      return(MagickFalse);
+    }
+  cache_info->type=DiskCache;
+  cache_info->mapped=MagickFalse;
+  cache_info->pixels=(Quantum *) NULL;
+  cache_info->metacontent=(void *) NULL;
+  cache_info->spilled=MagickTrue;
+  RelinquishPixelCachePixels(&source_info);
+  UpdatePixelCacheStatistic(&cache_info->statistics.demotions,1);
+  if (cache_info->debug != MagickFalse)
+    {
+      char
+        format[MagickPathExtent];
+
+      (void) FormatMagickSize(cache_info->length,MagickTrue,"B",
+        MagickPathExtent,format);
+      (void) LogMagickEvent(CacheEvent,GetMagickModule(),"spill %s (%s, %s)",
+        cache_info->filename,cache_info->cache_filename,format);
+    }
+  UnlockSemaphoreInfo(cache_info->file_semaphore);
+  return(MagickTrue);
+}
+
+static MagickBooleanType AcquirePixelCacheMemory(const Image *image,
+  const MagickSizeType length)
+{
+  CacheInfo
+    *magick_restrict p,
+    *magick_restrict victim;
+
+  char
+    *value;
+
+  MagickBooleanType
+    status;
+
+  MagickSizeType
+    idle,
+    limit,
+    needed;
+
+  /*
+    Acquire memory for a pixel cache.  At the memory resource limit, move the
+    least recently used idle caches of other images to disk until it fits,
+    unless -define cache:spill=false.  The cache being opened, and its
+    source, are pinned by the caller.
+  */
+  if (AcquireMagickResource(MemoryResource,length) != MagickFalse)
+    return(MagickTrue);
+  value=GetPixelCacheSetting(image,"cache:spill");
+  if (value != (char *) NULL)
+    {
+      status=IsStringFalse(value);
+      value=DestroyString(value);
+      if (status != MagickFalse)
+        return(MagickFalse);
+    }
+  limit=GetMagickResourceLimit(MemoryResource);
+  if (length > limit)
+    return(MagickFalse);
+  status=MagickFalse;
+  LockSemaphoreInfo(cache_semaphore);
+  idle=0;
+  for (p=cache_list; p != (CacheInfo *) NULL; p=p->next_cache)
+    if (IsPixelCacheIdle(p) != MagickFalse)
+      idle+=p->length;
+  needed=GetMagickResource(MemoryResource)+length;
+  if ((needed <= limit) || ((needed-limit) <= idle))
+    for ( ; ; )
+    {
+      if (AcquireMagickResource(MemoryResource,length) != MagickFalse)
+        {
+          status=MagickTrue;
+          break;
+        }
+      victim=(CacheInfo *) NULL;
+      for (p=cache_list; p != (CacheInfo *) NULL; p=p->next_cache)
+        if ((IsPixelCacheIdle(p) != MagickFalse) &&
+            ((victim == (CacheInfo *) NULL) ||
+             (p->last_use < victim->last_use)))
+          victim=p;
+      if ((victim == (CacheInfo *) NULL) ||
+          (SpillPixelCacheToDisk(victim) == MagickFalse))
+        break;
+    }
+  UnlockSemaphoreInfo(cache_semaphore);
+  return(status);
+}
+
 static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
   ExceptionInfo *exception)
 {
@@ -3653,6 +5797,7 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
     source_info;
 
   char
+    advice[MagickPathExtent],
     format[MagickPathExtent],
     message[MagickPathExtent];
 
@@ -3720,8 +5865,32 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
         ThrowBinaryException(ResourceLimitError,"ListLengthExceedsLimit",
           image->filename);
     }
+  CopyPixelCacheBands(cache_info,0,cache_info->rows);
+  if (cache_info->clones != (CacheInfo *) NULL)
+    {
+      LockSemaphoreInfo(cache_info->semaphore);
+      UnsharePixelCacheClones(cache_info);
+      UnlockSemaphoreInfo(cache_info->semaphore);
+    }
+  RelinquishPixelCacheWindows(cache_info);
   source_info=(*cache_info);
   source_info.file=(-1);
+  cache_info->spilled=MagickFalse;
+  cache_info->exported=MagickFalse;
+  cache_info->blocks=(CacheBlockInfo *) NULL;
+  cache_info->hot_blocks=(CacheHotBlockInfo *) NULL;
+  cache_info->block_buffer=(unsigned char *) NULL;
+  cache_info->block_size=0;
+  if (cache_info->block_file_length != 0)
+    {
+      /*
+        The block file stays with the source until it is cloned.
+      */
+      source_info.file=cache_info->file;
+      cache_info->file=(-1);
+      *cache_info->cache_filename='\0';
+      cache_info->block_file_length=0;
+    }
   (void) FormatLocaleString(cache_info->filename,MagickPathExtent,"%s[%.20g]",
     image->filename,(double) image->scene);
   cache_info->storage_class=image->storage_class;
@@ -3738,6 +5907,13 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
     sizeof(*image->channel_map));
   cache_info->metacontent_extent=image->metacontent_extent;
   cache_info->mode=mode;
+  cache_info->tile_width=0;
+  cache_info->tile_height=0;
+  cache_info->memory_advice=UndefinedMemoryAdvice;
+  cache_info->numa_policy=UndefinedNumaPolicy;
+  cache_info->storage_depth=GetPixelCacheStorageDepth(image,cache_info);
+  cache_info->read_ahead=0;
+  cache_info->write_behind=0;
   number_pixels=(MagickSizeType) cache_info->columns*cache_info->rows;
   packet_size=MagickMax(cache_info->number_channels,1)*sizeof(Quantum);
   if (image->metacontent_extent != 0)
@@ -3760,12 +5936,13 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
     status=MagickFalse;
   length=number_pixels*(cache_info->number_channels*sizeof(Quantum)+
     cache_info->metacontent_extent);
-  if ((status != MagickFalse) &&
+  if ((status != MagickFalse) && (cache_info->storage_depth == 0) &&
       (length == (MagickSizeType) ((size_t) length)) &&
       ((cache_info->type == UndefinedCache) ||
-       (cache_info->type == MemoryCache)))
+       (cache_info->type == MemoryCache) ||
+       (source_info.spilled != MagickFalse)))
     {
-      status=AcquireMagickResource(MemoryResource,cache_info->length);
+      status=AcquirePixelCacheMemory(image,cache_info->length);
       if (status != MagickFalse)
         {
           status=MagickTrue;
@@ -3791,11 +5968,19 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
               /*
                 Create memory pixel cache.
               */
+              if (cache_info->file != -1)
+                (void) ClosePixelCacheOnDisk(cache_info);
+              *cache_info->cache_filename='\0';
               cache_info->type=MemoryCache;
+              cache_info->memory_advice=AdviseMagickMemory(cache_info->pixels,
+                (size_t) cache_info->length,GetPixelCacheMemoryAdvice(image,
+                mode));
               cache_info->metacontent=(void *) NULL;
               if (cache_info->metacontent_extent != 0)
                 cache_info->metacontent=(void *) (cache_info->pixels+
                   cache_info->number_channels*number_pixels);
+              cache_info->numa_policy=SetPixelCacheNumaPolicy(image,
+                cache_info);
               if ((source_info.storage_class != UndefinedClass) &&
                   (mode != ReadMode))
                 {
@@ -3810,11 +5995,12 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
                   type=CommandOptionToMnemonic(MagickCacheOptions,(ssize_t)
                     cache_info->type);
                   (void) FormatLocaleString(message,MagickPathExtent,
-                    "open %s (%s %s, %.20gx%.20gx%.20g %s)",
+                    "open %s (%s %s%s, %.20gx%.20gx%.20g %s)",
                     cache_info->filename,cache_info->mapped != MagickFalse ?
-                    "Anonymous" : "Heap",type,(double) cache_info->columns,
-                    (double) cache_info->rows,(double)
-                    cache_info->number_channels,format);
+                    "Anonymous" : "Heap",type,
+                    GetPixelCacheMemoryAdviceDescription(cache_info,advice),
+                    (double) cache_info->columns,(double) cache_info->rows,
+                    (double) cache_info->number_channels,format);
                   (void) LogMagickEvent(CacheEvent,GetMagickModule(),"%s",
                     message);
                 }
@@ -3827,10 +6013,61 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
                   cache_info->type=UndefinedCache;
                   return(MagickFalse);
                 }
+              UpdatePixelCacheTier(cache_info,source_info.type);
               return(MagickTrue);
             }
         }
     }
+  if (AcquirePixelCacheBlocks(image,cache_info) != MagickFalse)
+    {
+      /*
+        Create compressed memory pixel cache.
+      */
+      status=MagickTrue;
+      if (cache_info->file != -1)
+        (void) ClosePixelCacheOnDisk(cache_info);
+      *cache_info->cache_filename='\0';
+      cache_info->type=CompressedCache;
+      cache_info->pixels=(Quantum *) NULL;
+      cache_info->metacontent=(void *) NULL;
+      if ((source_info.storage_class != UndefinedClass) && (mode != ReadMode))
+        {
+          status=ClonePixelCacheRepository(cache_info,&source_info,exception);
+          RelinquishPixelCachePixels(&source_info);
+        }
+      if (cache_info->debug != MagickFalse)
+        {
+          (void) FormatMagickSize(cache_info->length,MagickTrue,"B",
+            MagickPathExtent,format);
+          type=CommandOptionToMnemonic(MagickCacheOptions,(ssize_t)
+            cache_info->type);
+          (void) FormatLocaleString(message,MagickPathExtent,
+            "open %s (%s, %.20gx%.20gx%.20g %s, %.20g of %.20g blocks hot",
+            cache_info->filename,type,(double) cache_info->columns,(double)
+            cache_info->rows,(double) cache_info->number_channels,format,
+            (double) cache_info->number_hot_blocks,(double)
+            cache_info->number_blocks);
+          if (cache_info->storage_depth != 0)
+            {
+              (void) FormatLocaleString(advice,MagickPathExtent,
+                ", %.20g-bit packed",(double) cache_info->storage_depth);
+              (void) ConcatenateMagickString(message,advice,MagickPathExtent);
+            }
+          (void) ConcatenateMagickString(message,")",MagickPathExtent);
+          (void) LogMagickEvent(CacheEvent,GetMagickModule(),"%s",message);
+        }
+      if (status == 0)
+        {
+          if ((source_info.storage_class != UndefinedClass) &&
+              (mode != ReadMode))
+            RelinquishPixelCachePixels(&source_info);
+          RelinquishPixelCachePixels(cache_info);
+          return(MagickFalse);
+        }
+      UpdatePixelCacheTier(cache_info,source_info.type);
+      return(MagickTrue);
+    }
+  SetPixelCacheLayout(image,cache_info);
   status=AcquireMagickResource(DiskResource,cache_info->length);
   hosts=(const char *) GetImageRegistry(StringRegistryType,"cache:hosts",
     exception);
@@ -3860,6 +6097,8 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
               status=MagickTrue;
               cache_info->type=DistributedCache;
               cache_info->server_info=server_info;
+              cache_info->tile_width=0;
+              cache_info->tile_height=0;
               (void) FormatLocaleString(cache_info->cache_filename,
                 MagickPathExtent,"%s:%d",GetDistributeCacheHostname(
                 (DistributeCacheInfo *) cache_info->server_info),
@@ -3896,6 +6135,7 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
                   cache_info->type=UndefinedCache;
                   return(MagickFalse);
                 }
+              UpdatePixelCacheTier(cache_info,source_info.type);
               return(MagickTrue);
             }
         }
@@ -3947,7 +6187,8 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
   cache_info->type=DiskCache;
   length=number_pixels*(cache_info->number_channels*sizeof(Quantum)+
     cache_info->metacontent_extent);
-  if (length == (MagickSizeType) ((size_t) length))
+  if ((length == (MagickSizeType) ((size_t) length)) &&
+      (cache_info->tile_width == 0))
     {
       status=AcquireMagickResource(MapResource,cache_info->length);
       if (status != MagickFalse)
@@ -3968,6 +6209,9 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
               (void) ClosePixelCacheOnDisk(cache_info);
               cache_info->type=MapCache;
               cache_info->mapped=MagickTrue;
+              cache_info->memory_advice=AdviseMagickMemory(cache_info->pixels,
+                (size_t) cache_info->length,GetPixelCacheMemoryAdvice(image,
+                mode));
               cache_info->metacontent=(void *) NULL;
               if (cache_info->metacontent_extent != 0)
                 cache_info->metacontent=(void *) (cache_info->pixels+
@@ -3986,11 +6230,12 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
                   type=CommandOptionToMnemonic(MagickCacheOptions,(ssize_t)
                     cache_info->type);
                   (void) FormatLocaleString(message,MagickPathExtent,
-                    "open %s (%s[%d], %s, %.20gx%.20gx%.20g %s)",
+                    "open %s (%s[%d], %s%s, %.20gx%.20gx%.20g %s)",
                     cache_info->filename,cache_info->cache_filename,
-                    cache_info->file,type,(double) cache_info->columns,
-                    (double) cache_info->rows,(double)
-                    cache_info->number_channels,format);
+                    cache_info->file,type,
+                    GetPixelCacheMemoryAdviceDescription(cache_info,advice),
+                    (double) cache_info->columns,(double) cache_info->rows,
+                    (double) cache_info->number_channels,format);
                   (void) LogMagickEvent(CacheEvent,GetMagickModule(),"%s",
                     message);
                 }
@@ -4002,11 +6247,14 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
                   cache_info->type=UndefinedCache;
                   return(MagickFalse);
                 }
+              UpdatePixelCacheTier(cache_info,source_info.type);
               return(MagickTrue);
             }
         }
     }
   status=MagickTrue;
+  SetPixelCacheWindows(image,cache_info);
+  SetPixelCacheReadAhead(image,cache_info);
   if ((source_info.storage_class != UndefinedClass) && (mode != ReadMode))
     {
       status=ClonePixelCacheRepository(cache_info,&source_info,exception);
@@ -4019,10 +6267,33 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
       type=CommandOptionToMnemonic(MagickCacheOptions,(ssize_t)
         cache_info->type);
       (void) FormatLocaleString(message,MagickPathExtent,
-        "open %s (%s[%d], %s, %.20gx%.20gx%.20g %s)",cache_info->filename,
+        "open %s (%s[%d], %s, %.20gx%.20gx%.20g %s",cache_info->filename,
         cache_info->cache_filename,cache_info->file,type,(double)
         cache_info->columns,(double) cache_info->rows,(double)
         cache_info->number_channels,format);
+      if (cache_info->tile_width != 0)
+        {
+          (void) FormatLocaleString(advice,MagickPathExtent,
+            ", %.20gx%.20g tiles",(double) cache_info->tile_width,(double)
+            cache_info->tile_height);
+          (void) ConcatenateMagickString(message,advice,MagickPathExtent);
+        }
+      if (cache_info->windows != (CacheWindowInfo *) NULL)
+        {
+          (void) FormatMagickSize((MagickSizeType) cache_info->window_size,
+            MagickTrue,"B",MagickPathExtent,format);
+          (void) FormatLocaleString(advice,MagickPathExtent,
+            ", %.20gx%s windows",(double) cache_info->number_windows,format);
+          (void) ConcatenateMagickString(message,advice,MagickPathExtent);
+        }
+      if ((cache_info->read_ahead != 0) || (cache_info->write_behind != 0))
+        {
+          (void) FormatLocaleString(advice,MagickPathExtent,
+            ", read-ahead %.20g, write-behind %.20g rows",(double)
+            cache_info->read_ahead,(double) cache_info->write_behind);
+          (void) ConcatenateMagickString(message,advice,MagickPathExtent);
+        }
+      (void) ConcatenateMagickString(message,")",MagickPathExtent);
       (void) LogMagickEvent(CacheEvent,GetMagickModule(),"%s",message);
     }
   if (status == 0)
@@ -4030,6 +6301,7 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
       cache_info->type=UndefinedCache;
       return(MagickFalse);
     }
+  UpdatePixelCacheTier(cache_info,source_info.type);
   return(MagickTrue);
 }
 
@@ -4109,7 +6381,10 @@ MagickExport MagickBooleanType PersistPixelCache(Image *image,
         MagickPathExtent);
       cache_info->type=MapCache;
       cache_info->offset=(*offset);
-      if (OpenPixelCache(image,ReadMode,exception) == MagickFalse)
+      PinPixelCache(cache_info);
+      status=OpenPixelCache(image,ReadMode,exception);
+      UnpinPixelCache(cache_info);
+      if (status == MagickFalse)
         return(MagickFalse);
       *offset=(*offset+(MagickOffsetType) cache_info->length+page_size-
         ((MagickOffsetType) cache_info->length % page_size));
@@ -4144,12 +6419,123 @@ MagickExport MagickBooleanType PersistPixelCache(Image *image,
   clone_info->offset=(*offset);
   status=OpenPixelCacheOnDisk(clone_info,WriteMode);
   if (status != MagickFalse)
-    status=ClonePixelCacheRepository(clone_info,cache_info,exception);
+    {
+      PinPixelCache(cache_info);
+      status=ClonePixelCacheRepository(clone_info,cache_info,exception);
+      UnpinPixelCache(cache_info);
+    }
   *offset=(*offset+(MagickOffsetType) cache_info->length+page_size-
     ((MagickOffsetType) cache_info->length % page_size));
   clone_info=(CacheInfo *) DestroyPixelCache(clone_info);
   return(status);
 }
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   P r o m o t e P i x e l C a c h e                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  PromotePixelCache() moves a pixel cache that was spilled to disk back into
+%  memory.  If the cache is pinned or there is no room, it remains on disk.
+%
+%  The format of the PromotePixelCache() method is:
+%
+%      void PromotePixelCache(const Cache cache)
+%
+%  A description of each parameter follows:
+%
+%    o cache: the pixel cache.
+%
+*/
+MagickPrivate void PromotePixelCache(const Cache cache)
+{
+  CacheInfo
+    *magick_restrict cache_info,
+    source_info;
+
+  MagickOffsetType
+    count;
+
+  MagickBooleanType
+    mapped;
+
+  Quantum
+    *pixels;
+
+  assert(cache != (Cache) NULL);
+  cache_info=(CacheInfo *) cache;
+  assert(cache_info->signature == MagickCoreSignature);
+  if (cache_info->spilled == MagickFalse)
+    return;
+  LockSemaphoreInfo(cache_semaphore);
+  if ((cache_info->spilled == MagickFalse) || (cache_info->pins != 0) ||
+      (AcquireMagickResource(MemoryResource,cache_info->length) ==
+       MagickFalse))
+    {
+      UnlockSemaphoreInfo(cache_semaphore);
+      return;
+    }
+  LockSemaphoreInfo(cache_info->file_semaphore);
+  mapped=cache_anonymous_memory > 0 ? MagickTrue : MagickFalse;
+  if (mapped == MagickFalse)
+    pixels=(Quantum *) MagickAssumeAligned(AcquireAlignedMemory(1,(size_t)
+      cache_info->length));
+  else
+    pixels=(Quantum *) MapBlob(-1,IOMode,0,(size_t) cache_info->length);
+  count=(-1);
+  if ((pixels != (Quantum *) NULL) &&
+      (OpenPixelCacheOnDisk(cache_info,IOMode) != MagickFalse))
+    count=ReadPixelCacheRegion(cache_info,MagickFalse,cache_info->offset,
+      cache_info->length,(unsigned char *) pixels);
+  if (count != (MagickOffsetType) cache_info->length)
+    {
+      if (pixels != (Quantum *) NULL)
+        {
+          if (mapped == MagickFalse)
+            pixels=(Quantum *) RelinquishAlignedMemory(pixels);
+          else
+            (void) UnmapBlob(pixels,(size_t) cache_info->length);
+        }
+      RelinquishMagickResource(MemoryResource,cache_info->length);
+      UnlockSemaphoreInfo(cache_info->file_semaphore);
+      UnlockSemaphoreInfo(cache_semaphore);
+      return;
+    }
+  /*
+    Release the disk cache and switch to the memory pixels.
+  */
+  source_info=(*cache_info);
+  RelinquishPixelCachePixels(&source_info);
+  cache_info->file=(-1);
+  *cache_info->cache_filename='\0';
+  cache_info->mapped=mapped;
+  cache_info->pixels=pixels;
+  cache_info->metacontent=(void *) NULL;
+  if (cache_info->metacontent_extent != 0)
+    cache_info->metacontent=(void *) (cache_info->pixels+
+      cache_info->number_channels*cache_info->columns*cache_info->rows);
+  cache_info->type=MemoryCache;
+  cache_info->spilled=MagickFalse;
+  UpdatePixelCacheStatistic(&cache_info->statistics.promotions,1);
+  if (cache_info->debug != MagickFalse)
+    {
+      char
+        format[MagickPathExtent];
+
+      (void) FormatMagickSize(cache_info->length,MagickTrue,"B",
+        MagickPathExtent,format);
+      (void) LogMagickEvent(CacheEvent,GetMagickModule(),"promote %s (%s)",
+        cache_info->filename,format);
+    }
+  UnlockSemaphoreInfo(cache_info->file_semaphore);
+  UnlockSemaphoreInfo(cache_semaphore);
+}
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -4417,8 +6803,9 @@ MagickExport Quantum *QueueAuthenticPixels(Image *image,const ssize_t x,
 */
 
 static inline MagickOffsetType ReadPixelCacheRegion(
-  const CacheInfo *magick_restrict cache_info,const MagickOffsetType offset,
-  const MagickSizeType length,unsigned char *magick_restrict buffer)
+  const CacheInfo *magick_restrict cache_info,const MagickBooleanType windowed,
+  const MagickOffsetType offset,const MagickSizeType length,
+  unsigned char *magick_restrict buffer)
 {
   MagickOffsetType
     i;
@@ -4426,11 +6813,26 @@ static inline MagickOffsetType ReadPixelCacheRegion(
   ssize_t
     count = 0;
 
+  /*
+    Callers hold the file semaphore, or own a cache they are opening; this
+    also guards the disk byte counter.
+  */
+  i=0;
+  if (windowed != MagickFalse)
+    {
+      i=ReadPixelCacheWindows(cache_info,offset,length,buffer);
+      if (i == (MagickOffsetType) length)
+        {
+          ((CacheInfo *) cache_info)->statistics.disk_bytes_read+=
+            (MagickSizeType) i;
+          return(i);
+        }
+    }
 #if !defined(MAGICKCORE_HAVE_PREAD)
-  if (lseek(cache_info->file,offset,SEEK_SET) < 0)
+  if (lseek(cache_info->file,offset+i,SEEK_SET) < 0)
     return((MagickOffsetType) -1);
 #endif
-  for (i=0; i < (MagickOffsetType) length; i+=count)
+  for ( ; i < (MagickOffsetType) length; i+=count)
   {
 #if !defined(MAGICKCORE_HAVE_PREAD)
     count=read(cache_info->file,buffer+i,(size_t) MagickMin(length-
@@ -4446,13 +6848,300 @@ static inline MagickOffsetType ReadPixelCacheRegion(
           break;
       }
   }
+  ((CacheInfo *) cache_info)->statistics.disk_bytes_read+=(MagickSizeType) i;
   return(i);
 }
 
+static inline MagickOffsetType GetPixelCacheMetacontentOffset(
+  const CacheInfo *magick_restrict cache_info)
+{
+  MagickSizeType
+    columns,
+    rows;
+
+  /*
+    Metacontent follows the pixels on disk, past any padded tiles.
+  */
+  columns=(MagickSizeType) cache_info->columns;
+  rows=(MagickSizeType) cache_info->rows;
+  if (cache_info->tile_width != 0)
+    {
+      columns=cache_info->tile_width*((columns+cache_info->tile_width-1)/
+        cache_info->tile_width);
+      rows=cache_info->tile_height*((rows+cache_info->tile_height-1)/
+        cache_info->tile_height);
+    }
+  return(cache_info->offset+(MagickOffsetType) (columns*rows*
+    cache_info->number_channels*sizeof(Quantum)));
+}
+
+static inline MagickOffsetType GetPixelCacheTileOffset(
+  const CacheInfo *magick_restrict cache_info,const ssize_t x,const ssize_t y)
+{
+  MagickOffsetType
+    offset;
+
+  size_t
+    tiles_across;
+
+  /*
+    Return the disk offset of pixel (x,y) in a tile-major pixel cache.
+  */
+  tiles_across=(cache_info->columns+cache_info->tile_width-1)/
+    cache_info->tile_width;
+  offset=((MagickOffsetType) (y/(ssize_t) cache_info->tile_height)*
+    (MagickOffsetType) tiles_across+(MagickOffsetType) (x/(ssize_t)
+    cache_info->tile_width))*(MagickOffsetType) (cache_info->tile_width*
+    cache_info->tile_height);
+  offset+=(MagickOffsetType) (y % (ssize_t) cache_info->tile_height)*
+    (MagickOffsetType) cache_info->tile_width+(MagickOffsetType) (x %
+    (ssize_t) cache_info->tile_width);
+  return(cache_info->offset+offset*(MagickOffsetType)
+    (cache_info->number_channels*sizeof(Quantum)));
+}
+
+static MagickSizeType GetPixelCacheRowsExtent(
+  const CacheInfo *magick_restrict cache_info,const ssize_t y_begin,
+  const ssize_t y_end,MagickOffsetType *offset)
+{
+  size_t
+    columns,
+    packet_size;
+
+  ssize_t
+    y,
+    rows;
+
+  /*
+    Return the disk extent of rows [y_begin,y_end) and its offset.
+  */
+  packet_size=cache_info->number_channels*sizeof(Quantum);
+  if (cache_info->tile_width == 0)
+    {
+      *offset=cache_info->offset+(MagickOffsetType) y_begin*(MagickOffsetType)
+        (cache_info->columns*packet_size);
+      return((MagickSizeType) (y_end-y_begin)*cache_info->columns*packet_size);
+    }
+  y=y_begin-(y_begin % (ssize_t) cache_info->tile_height);
+  rows=(ssize_t) cache_info->tile_height*((y_end-y+(ssize_t)
+    cache_info->tile_height-1)/(ssize_t) cache_info->tile_height);
+  columns=cache_info->tile_width*((cache_info->columns+cache_info->tile_width-
+    1)/cache_info->tile_width);
+  *offset=GetPixelCacheTileOffset(cache_info,0,y);
+  return((MagickSizeType) rows*columns*packet_size);
+}
+
+static void ReadAheadPixelCache(const CacheInfo *magick_restrict cache_info,
+  NexusInfo *magick_restrict nexus_info)
+{
+#if defined(MAGICKCORE_HAVE_POSIX_FADVISE) && defined(POSIX_FADV_WILLNEED)
+  MagickOffsetType
+    offset;
+
+  MagickSizeType
+    length;
+
+  ssize_t
+    y,
+    y_begin,
+    y_end;
+
+  /*
+    A read that starts at or before the end of the previous read of this
+    nexus and extends past it is sequential, e.g. row by row or a sliding
+    kernel.  Ask the kernel to start reading the rows that follow so the I/O
+    overlaps with the processing of the current rows.  Rows are advised at
+    most once per sequential scan; a read elsewhere restarts the scan.
+  */
+  if (cache_info->read_ahead == 0)
+    return;
+  y=nexus_info->region.y+(ssize_t) nexus_info->region.height;
+  if ((nexus_info->region.y > nexus_info->read_y) ||
+      (y < nexus_info->read_y))
+    {
+      nexus_info->read_y=y;
+      nexus_info->read_ahead_y=y;
+      return;
+    }
+  nexus_info->read_y=y;
+  if ((nexus_info->read_ahead_y-y) > (ssize_t) (cache_info->read_ahead/2))
+    return;  /* enough rows are already in flight */
+  y_begin=MagickMax(nexus_info->read_ahead_y,y);
+  y_end=MagickMin(y+(ssize_t) cache_info->read_ahead,(ssize_t)
+    cache_info->rows);
+  if (y_begin >= y_end)
+    return;
+  length=GetPixelCacheRowsExtent(cache_info,y_begin,y_end,&offset);
+  if (posix_fadvise(cache_info->file,(off_t) offset,(off_t) length,
+        POSIX_FADV_WILLNEED) == 0)
+    nexus_info->read_ahead_requests++;
+  nexus_info->read_ahead_y=y_end;
+#else
+  (void) cache_info;
+  (void) nexus_info;
+#endif
+}
+
+static void WriteBehindPixelCache(const CacheInfo *magick_restrict cache_info,
+  NexusInfo *magick_restrict nexus_info)
+{
+#if defined(SYNC_FILE_RANGE_WRITE)
+  MagickOffsetType
+    offset;
+
+  MagickSizeType
+    length;
+
+  ssize_t
+    y;
+
+  /*
+    Once a nexus has written enough consecutive rows, start their write-back
+    without waiting for it so dirty pages do not pile up and stall a later
+    write.
+  */
+  if (cache_info->write_behind == 0)
+    return;
+  y=nexus_info->region.y+(ssize_t) nexus_info->region.height;
+  if (nexus_info->region.y != nexus_info->write_y)
+    {
+      nexus_info->write_y=y;
+      nexus_info->write_behind_y=nexus_info->region.y;
+      return;
+    }
+  nexus_info->write_y=y;
+  if ((y-nexus_info->write_behind_y) < (ssize_t) cache_info->write_behind)
+    return;
+  length=GetPixelCacheRowsExtent(cache_info,nexus_info->write_behind_y,y,
+    &offset);
+  if (sync_file_range(cache_info->file,(off_t) offset,(off_t) length,
+        SYNC_FILE_RANGE_WRITE) == 0)
+    nexus_info->write_behind_requests++;
+  nexus_info->write_behind_y=y;
+#else
+  (void) cache_info;
+  (void) nexus_info;
+#endif
+}
+
+static inline MagickBooleanType IsPixelCacheTileWindowed(
+  const CacheInfo *magick_restrict cache_info,
+  const NexusInfo *magick_restrict nexus_info)
+{
+  MagickSizeType
+    span;
+
+  if (cache_info->windows == (CacheWindowInfo *) NULL)
+    return(MagickFalse);
+  span=(MagickSizeType) (GetPixelCacheTileOffset(cache_info,
+    nexus_info->region.x+(ssize_t) nexus_info->region.width-1,
+    nexus_info->region.y+(ssize_t) nexus_info->region.height-1)-
+    GetPixelCacheTileOffset(cache_info,nexus_info->region.x,
+    nexus_info->region.y))+(MagickSizeType) cache_info->tile_width*
+    cache_info->tile_height*cache_info->number_channels*sizeof(Quantum);
+  return(IsPixelCacheWindowed(cache_info,span));
+}
+
+static MagickBooleanType ReadPixelCacheTiles(
+  const CacheInfo *magick_restrict cache_info,
+  NexusInfo *magick_restrict nexus_info)
+{
+  MagickBooleanType
+    status,
+    windowed;
+
+  MagickOffsetType
+    count;
+
+  MagickSizeType
+    length;
+
+  Quantum
+    *magick_restrict buffer;
+
+  size_t
+    number_channels;
+
+  ssize_t
+    tile_x,
+    tile_y;
+
+  /*
+    Read the region one tile at a time: each tile contributes a single
+    contiguous read of the tile rows that intersect the region.
+  */
+  number_channels=cache_info->number_channels;
+  windowed=IsPixelCacheTileWindowed(cache_info,nexus_info);
+  buffer=(Quantum *) AcquireQuantumMemory(MagickMin(nexus_info->region.height,
+    cache_info->tile_height)*cache_info->tile_width,number_channels*
+    sizeof(*buffer));
+  if (buffer == (Quantum *) NULL)
+    return(MagickFalse);
+  status=MagickTrue;
+  for (tile_y=nexus_info->region.y-(nexus_info->region.y % (ssize_t)
+       cache_info->tile_height); tile_y < (nexus_info->region.y+(ssize_t)
+       nexus_info->region.height); tile_y+=(ssize_t) cache_info->tile_height)
+  {
+    ssize_t
+      y_begin,
+      y_end;
+
+    y_begin=MagickMax(nexus_info->region.y,tile_y);
+    y_end=MagickMin(nexus_info->region.y+(ssize_t) nexus_info->region.height,
+      tile_y+(ssize_t) cache_info->tile_height);
+    for (tile_x=nexus_info->region.x-(nexus_info->region.x % (ssize_t)
+         cache_info->tile_width); tile_x < (nexus_info->region.x+(ssize_t)
+         nexus_info->region.width); tile_x+=(ssize_t) cache_info->tile_width)
+    {
+      const Quantum
+        *magick_restrict p;
+
+      Quantum
+        *magick_restrict q;
+
+      ssize_t
+        x_begin,
+        x_end,
+        y;
+
+      x_begin=MagickMax(nexus_info->region.x,tile_x);
+      x_end=MagickMin(nexus_info->region.x+(ssize_t) nexus_info->region.width,
+        tile_x+(ssize_t) cache_info->tile_width);
+      length=(MagickSizeType) (y_end-y_begin)*cache_info->tile_width*
+        number_channels*sizeof(*buffer);
+      count=ReadPixelCacheRegion(cache_info,windowed,GetPixelCacheTileOffset(
+        cache_info,tile_x,y_begin),length,(unsigned char *) buffer);
+      if (count != (MagickOffsetType) length)
+        {
+          status=MagickFalse;
+          break;
+        }
+      p=buffer+(x_begin-tile_x)*(ssize_t) number_channels;
+      q=nexus_info->pixels+((y_begin-nexus_info->region.y)*(ssize_t)
+        nexus_info->region.width+(x_begin-nexus_info->region.x))*(ssize_t)
+        number_channels;
+      for (y=y_begin; y < y_end; y++)
+      {
+        (void) memcpy(q,p,(size_t) (x_end-x_begin)*number_channels*
+          sizeof(*q));
+        p+=(ptrdiff_t) cache_info->tile_width*number_channels;
+        q+=(ptrdiff_t) nexus_info->region.width*number_channels;
+      }
+    }
+    if (status == MagickFalse)
+      break;
+  }
+  buffer=(Quantum *) RelinquishMagickMemory(buffer);
+  return(status);
+}
+
 static MagickBooleanType ReadPixelCacheMetacontent(
   CacheInfo *magick_restrict cache_info,NexusInfo *magick_restrict nexus_info,
   ExceptionInfo *exception)
 {
+  MagickBooleanType
+    windowed;
+
   MagickOffsetType
     count,
     offset;
@@ -4524,20 +7213,19 @@ static MagickBooleanType ReadPixelCacheMetacontent(
           UnlockSemaphoreInfo(cache_info->file_semaphore);
           return(MagickFalse);
         }
+      windowed=IsPixelCacheWindowed(cache_info,(MagickSizeType) (rows-1)*
+        cache_info->columns*cache_info->metacontent_extent+length);
       if ((cache_info->columns == nexus_info->region.width) &&
           (extent <= MagickMaxBufferExtent))
         {
           length=extent;
           rows=1UL;
         }
-      extent=(MagickSizeType) cache_info->columns*cache_info->rows;
       for (y=0; y < (ssize_t) rows; y++)
       {
-        count=ReadPixelCacheRegion(cache_info,cache_info->offset+
-          (MagickOffsetType) extent*(MagickOffsetType)
-          cache_info->number_channels*(MagickOffsetType) sizeof(Quantum)+offset*
-          (MagickOffsetType) cache_info->metacontent_extent,length,
-          (unsigned char *) q);
+        count=ReadPixelCacheRegion(cache_info,windowed,
+          GetPixelCacheMetacontentOffset(cache_info)+offset*(MagickOffsetType)
+          cache_info->metacontent_extent,length,(unsigned char *) q);
         if (count != (MagickOffsetType) length)
           break;
         offset+=(MagickOffsetType) cache_info->columns;
@@ -4548,34 +7236,35 @@ static MagickBooleanType ReadPixelCacheMetacontent(
       UnlockSemaphoreInfo(cache_info->file_semaphore);
       break;
     }
-    case DistributedCache:
+    case CompressedCache:
     {
-      RectangleInfo
-        region;
-
       /*
-        Read metacontent from distributed cache.
+        Read metacontent from compressed memory.
       */
       LockSemaphoreInfo(cache_info->file_semaphore);
-      region=nexus_info->region;
-      if ((cache_info->columns != nexus_info->region.width) ||
-          (extent > MagickMaxBufferExtent))
-        region.height=1UL;
-      else
+      if (TransferPixelCacheBlocks(cache_info,&nexus_info->region,
+            cache_info->metacontent_extent,cache_info->block_size*
+            cache_info->block_size*cache_info->number_channels*
+            sizeof(Quantum),(unsigned char *) q,MagickFalse) == MagickFalse)
         {
-          length=extent;
-          rows=1UL;
+          UnlockSemaphoreInfo(cache_info->file_semaphore);
+          ThrowBinaryException(CacheError,"CacheResourcesExhausted",
+            cache_info->filename);
         }
-      for (y=0; y < (ssize_t) rows; y++)
-      {
-        count=ReadDistributePixelCacheMetacontent((DistributeCacheInfo *)
-          cache_info->server_info,&region,length,(unsigned char *) q);
-        if (count != (MagickOffsetType) length)
-          break;
-        q+=(ptrdiff_t) cache_info->metacontent_extent*nexus_info->region.width;
-        region.y++;
-      }
       UnlockSemaphoreInfo(cache_info->file_semaphore);
+      y=(ssize_t) rows;
+      break;
+    }
+    case DistributedCache:
+    {
+      /*
+        Read metacontent from distributed cache.
+      */
+      count=ReadDistributePixelCacheMetacontent((DistributeCacheInfo *)
+        cache_info->server_info,&nexus_info->region,extent,
+        (unsigned char *) q);
+      if (count == (MagickOffsetType) extent)
+        y=(ssize_t) rows;
       break;
     }
     default:
@@ -4628,6 +7317,9 @@ static MagickBooleanType ReadPixelCachePixels(
   CacheInfo *magick_restrict cache_info,NexusInfo *magick_restrict nexus_info,
   ExceptionInfo *exception)
 {
+  MagickBooleanType
+    windowed;
+
   MagickOffsetType
     count,
     offset;
@@ -4705,55 +7397,70 @@ static MagickBooleanType ReadPixelCachePixels(
           UnlockSemaphoreInfo(cache_info->file_semaphore);
           return(MagickFalse);
         }
-      if ((cache_info->columns == nexus_info->region.width) &&
-          (extent <= MagickMaxBufferExtent))
+      if (cache_info->tile_width != 0)
         {
-          length=extent;
-          rows=1UL;
+          /*
+            Read pixels from a tile-major disk cache.
+          */
+          if (ReadPixelCacheTiles(cache_info,nexus_info) != MagickFalse)
+            y=(ssize_t) rows;
         }
-      for (y=0; y < (ssize_t) rows; y++)
-      {
-        count=ReadPixelCacheRegion(cache_info,cache_info->offset+offset*
-          (MagickOffsetType) cache_info->number_channels*(MagickOffsetType)
-          sizeof(*q),length,(unsigned char *) q);
-        if (count != (MagickOffsetType) length)
-          break;
-        offset+=(MagickOffsetType) cache_info->columns;
-        q+=(ptrdiff_t) cache_info->number_channels*nexus_info->region.width;
-      }
+      else
+        {
+          windowed=IsPixelCacheWindowed(cache_info,(MagickSizeType) (rows-1)*
+            cache_info->columns*number_channels*sizeof(*q)+length);
+          if ((cache_info->columns == nexus_info->region.width) &&
+              (extent <= MagickMaxBufferExtent))
+            {
+              length=extent;
+              rows=1UL;
+            }
+          for (y=0; y < (ssize_t) rows; y++)
+          {
+            count=ReadPixelCacheRegion(cache_info,windowed,cache_info->offset+
+              offset*(MagickOffsetType) cache_info->number_channels*
+              (MagickOffsetType) sizeof(*q),length,(unsigned char *) q);
+            if (count != (MagickOffsetType) length)
+              break;
+            offset+=(MagickOffsetType) cache_info->columns;
+            q+=(ptrdiff_t) cache_info->number_channels*
+              nexus_info->region.width;
+          }
+        }
+      if (y >= (ssize_t) rows)
+        ReadAheadPixelCache(cache_info,nexus_info);
       if (IsFileDescriptorLimitExceeded() != MagickFalse)
         (void) ClosePixelCacheOnDisk(cache_info);
       UnlockSemaphoreInfo(cache_info->file_semaphore);
       break;
     }
-    case DistributedCache:
+    case CompressedCache:
     {
-      RectangleInfo
-        region;
-
       /*
-        Read pixels from distributed cache.
+        Read pixels from compressed memory.
       */
       LockSemaphoreInfo(cache_info->file_semaphore);
-      region=nexus_info->region;
-      if ((cache_info->columns != nexus_info->region.width) ||
-          (extent > MagickMaxBufferExtent))
-        region.height=1UL;
-      else
+      if (TransferPixelCacheBlocks(cache_info,&nexus_info->region,
+            number_channels*sizeof(*q),0,(unsigned char *) q,MagickFalse) == MagickFalse)
         {
-          length=extent;
-          rows=1UL;
+          UnlockSemaphoreInfo(cache_info->file_semaphore);
+          ThrowBinaryException(CacheError,"CacheResourcesExhausted",
+            cache_info->filename);
         }
-      for (y=0; y < (ssize_t) rows; y++)
-      {
-        count=ReadDistributePixelCachePixels((DistributeCacheInfo *)
-          cache_info->server_info,&region,length,(unsigned char *) q);
-        if (count != (MagickOffsetType) length)
-          break;
-        q+=(ptrdiff_t) cache_info->number_channels*nexus_info->region.width;
-        region.y++;
-      }
       UnlockSemaphoreInfo(cache_info->file_semaphore);
+      y=(ssize_t) rows;
+      break;
+    }
+    case DistributedCache:
+    {
+      /*
+        Read pixels from distributed cache.
+      */
+      count=ReadDistributePixelCachePixels((DistributeCacheInfo *)
+        cache_info->server_info,&nexus_info->region,extent,
+        (unsigned char *) q);
+      if (count == (MagickOffsetType) extent)
+        y=(ssize_t) rows;
       break;
     }
     default:
@@ -4845,6 +7552,56 @@ MagickPrivate void ResetPixelCacheChannels(Image *image)
   assert(cache_info->signature == MagickCoreSignature);
   cache_info->number_channels=GetPixelChannels(image);
 }
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   R e s e t P i x e l C a c h e P i x e l s                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ResetPixelCachePixels() zeroes the pixels of an in-core pixel cache.  Unlike
+%  AcquirePixelCachePixels(), it keeps no pointer to the pixels, so the cache
+%  may still move to disk later.  It returns MagickFalse if the pixels are not
+%  in core.
+%
+%  The format of the ResetPixelCachePixels method is:
+%
+%      MagickBooleanType ResetPixelCachePixels(Image *)
+%
+%  A description of each parameter follows:
+%
+%    o image: the image.
+%
+*/
+MagickPrivate MagickBooleanType ResetPixelCachePixels(Image *image)
+{
+  CacheInfo
+    *magick_restrict cache_info;
+
+  MagickBooleanType
+    status;
+
+  assert(image != (const Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  assert(image->cache != (Cache) NULL);
+  cache_info=(CacheInfo *) image->cache;
+  assert(cache_info->signature == MagickCoreSignature);
+  PinPixelCache(cache_info);
+  status=MagickFalse;
+  if ((cache_info->type == MemoryCache) || (cache_info->type == MapCache))
+    {
+      CopyPixelCacheBands(cache_info,0,cache_info->rows);
+      (void) memset(cache_info->pixels,0,(size_t) cache_info->length);
+      status=MagickTrue;
+    }
+  UnpinPixelCache(cache_info);
+  return(status);
+}
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -5120,6 +7877,8 @@ static Quantum *SetPixelCacheNexusPixels(
   if (cache_info->type == UndefinedCache)
     return((Quantum *) NULL);
   assert(nexus_info->signature == MagickCoreSignature);
+  if (nexus_info->virtual_nexus != (NexusInfo *) NULL)
+    PinPixelCacheNexus((CacheInfo *) cache_info,nexus_info);  /* not virtual */
   (void) memset(&nexus_info->region,0,sizeof(nexus_info->region));
   if ((width == 0) || (height == 0))
     {
@@ -5141,6 +7900,8 @@ static Quantum *SetPixelCacheNexusPixels(
         "InvalidPixel","`%s'",cache_info->filename);
       return((Quantum *) NULL);
     }
+  if (cache_info->shared_cache != (CacheInfo *) NULL)
+    CopyPixelCacheBands((CacheInfo *) cache_info,y,height);
   if (((cache_info->type == MemoryCache) || (cache_info->type == MapCache)) &&
       (buffered == MagickFalse))
     {
@@ -5170,6 +7931,7 @@ static Quantum *SetPixelCacheNexusPixels(
           nexus_info->region.y=y;
           nexus_info->authentic_pixel_cache=MagickTrue;
           PrefetchPixelCacheNexusPixels(nexus_info,mode);
+          nexus_info->direct_requests++;
           return(nexus_info->pixels);
         }
     }
@@ -5204,6 +7966,8 @@ static Quantum *SetPixelCacheNexusPixels(
   nexus_info->authentic_pixel_cache=cache_info->type == PingCache ?
     MagickTrue : MagickFalse;
   PrefetchPixelCacheNexusPixels(nexus_info,mode);
+  if (cache_info->type != PingCache)
+    nexus_info->buffered_requests++;
   return(nexus_info->pixels);
 }
 
@@ -5331,6 +8095,86 @@ MagickPrivate VirtualPixelMethod SetPixelCacheVirtualMethod(Image *image,
   return(method);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   S p i l l P i x e l C a c h e                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SpillPixelCache() moves the pixels of an image memory cache to a disk cache
+%  to free memory for other images, e.g. the earlier frames of a long image
+%  sequence.  Idle caches are also spilled, least recently used first, when
+%  a new cache reaches the memory resource limit, unless the new image sets
+%  -define cache:spill=false.  The cache returns to memory when the image is
+%  next accessed for authentic pixels, or when its cache is reopened,
+%  provided there is room.
+%
+%  Pixels previously acquired for the image are invalid after this call.  A
+%  cache shared with other images, one a cache view still points into, or one
+%  not in memory is left as is, and the method returns MagickFalse.
+%
+%  The format of the SpillPixelCache() method is:
+%
+%      MagickBooleanType SpillPixelCache(Image *image,
+%        ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o image: the image.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+MagickExport MagickBooleanType SpillPixelCache(Image *image,
+  ExceptionInfo *exception)
+{
+  CacheInfo
+    *magick_restrict cache_info;
+
+  MagickBooleanType
+    status;
+
+  ssize_t
+    i;
+
+  assert(image != (Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  assert(image->cache != (Cache) NULL);
+  assert(exception != (ExceptionInfo *) NULL);
+  assert(exception->signature == MagickCoreSignature);
+  if (IsEventLogging() != MagickFalse)
+    (void) LogMagickEvent(TraceEvent,GetMagickModule(),"%s",image->filename);
+  LockSemaphoreInfo(image->semaphore);
+  cache_info=(CacheInfo *) image->cache;
+  assert(cache_info->signature == MagickCoreSignature);
+  LockSemaphoreInfo(cache_info->semaphore);
+  LockSemaphoreInfo(cache_semaphore);
+  /*
+    Pixels previously acquired for the image are released; those of a cache
+    view still in use keep the cache in memory.
+  */
+  for (i=0; i < (ssize_t) (2*cache_info->number_threads); i++)
+    if (cache_info->nexus_info[i]->pinned_cache == cache_info)
+      ReleasePixelCacheNexusPin(cache_info,cache_info->nexus_info[i]);
+  status=IsPixelCacheIdle(cache_info);
+  if (status != MagickFalse)
+    {
+      status=SpillPixelCacheToDisk(cache_info);
+      if (status == MagickFalse)
+        ThrowFileException(exception,CacheError,"UnableToExtendCache",
+          cache_info->filename);
+    }
+  UnlockSemaphoreInfo(cache_semaphore);
+  UnlockSemaphoreInfo(cache_info->semaphore);
+  UnlockSemaphoreInfo(image->semaphore);
+  return(status);
+}
+
 #if defined(MAGICKCORE_OPENCL_SUPPORT)
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -5503,6 +8347,7 @@ static MagickBooleanType SyncAuthenticPixelsCache(Image *image,
   assert(id < (int) cache_info->number_threads);
   status=SyncAuthenticPixelCacheNexus(image,cache_info->nexus_info[id],
     exception);
+  UnpinPixelCacheNexus(cache_info,cache_info->nexus_info[id]);
   return(status);
 }
 
@@ -5559,6 +8404,7 @@ MagickExport MagickBooleanType SyncAuthenticPixels(Image *image,
   assert(id < (int) cache_info->number_threads);
   status=SyncAuthenticPixelCacheNexus(image,cache_info->nexus_info[id],
     exception);
+  UnpinPixelCacheNexus(cache_info,cache_info->nexus_info[id]);
   return(status);
 }
 
@@ -5632,6 +8478,9 @@ MagickPrivate MagickBooleanType SyncImagePixelCache(Image *image,
 static MagickBooleanType WritePixelCacheMetacontent(CacheInfo *cache_info,
   NexusInfo *magick_restrict nexus_info,ExceptionInfo *exception)
 {
+  MagickBooleanType
+    windowed;
+
   MagickOffsetType
     count,
     offset;
@@ -5705,20 +8554,19 @@ static MagickBooleanType WritePixelCacheMetacontent(CacheInfo *cache_info,
           UnlockSemaphoreInfo(cache_info->file_semaphore);
           return(MagickFalse);
         }
+      windowed=IsPixelCacheWindowed(cache_info,(MagickSizeType) (rows-1)*
+        cache_info->columns*cache_info->metacontent_extent+length);
       if ((cache_info->columns == nexus_info->region.width) &&
           (extent <= MagickMaxBufferExtent))
         {
           length=extent;
           rows=1UL;
         }
-      extent=(MagickSizeType) cache_info->columns*cache_info->rows;
       for (y=0; y < (ssize_t) rows; y++)
       {
-        count=WritePixelCacheRegion(cache_info,cache_info->offset+
-          (MagickOffsetType) extent*(MagickOffsetType)
-          cache_info->number_channels*(MagickOffsetType) sizeof(Quantum)+offset*
-          (MagickOffsetType) cache_info->metacontent_extent,length,
-          (const unsigned char *) p);
+        count=WritePixelCacheRegion(cache_info,windowed,
+          GetPixelCacheMetacontentOffset(cache_info)+offset*(MagickOffsetType)
+          cache_info->metacontent_extent,length,(const unsigned char *) p);
         if (count != (MagickOffsetType) length)
           break;
         p+=(ptrdiff_t) cache_info->metacontent_extent*nexus_info->region.width;
@@ -5729,34 +8577,35 @@ static MagickBooleanType WritePixelCacheMetacontent(CacheInfo *cache_info,
       UnlockSemaphoreInfo(cache_info->file_semaphore);
       break;
     }
-    case DistributedCache:
+    case CompressedCache:
     {
-      RectangleInfo
-        region;
-
       /*
-        Write metacontent to distributed cache.
+        Write metacontent to compressed memory.
       */
       LockSemaphoreInfo(cache_info->file_semaphore);
-      region=nexus_info->region;
-      if ((cache_info->columns != nexus_info->region.width) ||
-          (extent > MagickMaxBufferExtent))
-        region.height=1UL;
-      else
+      if (TransferPixelCacheBlocks(cache_info,&nexus_info->region,
+            cache_info->metacontent_extent,cache_info->block_size*
+            cache_info->block_size*cache_info->number_channels*
+            sizeof(Quantum),(unsigned char *) p,MagickTrue) == MagickFalse)
         {
-          length=extent;
-          rows=1UL;
+          UnlockSemaphoreInfo(cache_info->file_semaphore);
+          ThrowBinaryException(CacheError,"CacheResourcesExhausted",
+            cache_info->filename);
         }
-      for (y=0; y < (ssize_t) rows; y++)
-      {
-        count=WriteDistributePixelCacheMetacontent((DistributeCacheInfo *)
-          cache_info->server_info,&region,length,(const unsigned char *) p);
-        if (count != (MagickOffsetType) length)
-          break;
-        p+=(ptrdiff_t) cache_info->metacontent_extent*nexus_info->region.width;
-        region.y++;
-      }
       UnlockSemaphoreInfo(cache_info->file_semaphore);
+      y=(ssize_t) rows;
+      break;
+    }
+    case DistributedCache:
+    {
+      /*
+        Write metacontent to distributed cache.
+      */
+      count=WriteDistributePixelCacheMetacontent((DistributeCacheInfo *)
+        cache_info->server_info,&nexus_info->region,extent,
+        (const unsigned char *) p);
+      if (count == (MagickOffsetType) extent)
+        y=(ssize_t) rows;
       break;
     }
     default:
@@ -5805,10 +8654,140 @@ static MagickBooleanType WritePixelCacheMetacontent(CacheInfo *cache_info,
 %    o exception: return any errors or warnings in this structure.
 %
 */
+static MagickBooleanType WritePixelCacheTiles(
+  const CacheInfo *magick_restrict cache_info,
+  const NexusInfo *magick_restrict nexus_info)
+{
+  MagickBooleanType
+    status,
+    windowed;
+
+  MagickOffsetType
+    count;
+
+  MagickSizeType
+    length;
+
+  Quantum
+    *magick_restrict buffer;
+
+  size_t
+    extent,
+    number_channels;
+
+  ssize_t
+    tile_x,
+    tile_y;
+
+  /*
+    Write the region one tile at a time.  Whole tile rows are written with a
+    single contiguous write, a tall partial tile with a read-modify-write.
+  */
+  number_channels=cache_info->number_channels;
+  windowed=IsPixelCacheTileWindowed(cache_info,nexus_info);
+  extent=MagickMin(nexus_info->region.height,cache_info->tile_height)*
+    cache_info->tile_width*number_channels;
+  buffer=(Quantum *) AcquireQuantumMemory(extent,sizeof(*buffer));
+  if (buffer == (Quantum *) NULL)
+    return(MagickFalse);
+  (void) memset(buffer,0,extent*sizeof(*buffer));
+  status=MagickTrue;
+  for (tile_y=nexus_info->region.y-(nexus_info->region.y % (ssize_t)
+       cache_info->tile_height); tile_y < (nexus_info->region.y+(ssize_t)
+       nexus_info->region.height); tile_y+=(ssize_t) cache_info->tile_height)
+  {
+    ssize_t
+      y_begin,
+      y_end;
+
+    y_begin=MagickMax(nexus_info->region.y,tile_y);
+    y_end=MagickMin(nexus_info->region.y+(ssize_t) nexus_info->region.height,
+      tile_y+(ssize_t) cache_info->tile_height);
+    for (tile_x=nexus_info->region.x-(nexus_info->region.x % (ssize_t)
+         cache_info->tile_width); tile_x < (nexus_info->region.x+(ssize_t)
+         nexus_info->region.width); tile_x+=(ssize_t) cache_info->tile_width)
+    {
+      const Quantum
+        *magick_restrict p;
+
+      MagickOffsetType
+        offset;
+
+      Quantum
+        *magick_restrict q;
+
+      ssize_t
+        x_begin,
+        x_end,
+        y;
+
+      x_begin=MagickMax(nexus_info->region.x,tile_x);
+      x_end=MagickMin(nexus_info->region.x+(ssize_t) nexus_info->region.width,
+        tile_x+(ssize_t) cache_info->tile_width);
+      p=nexus_info->pixels+((y_begin-nexus_info->region.y)*(ssize_t)
+        nexus_info->region.width+(x_begin-nexus_info->region.x))*(ssize_t)
+        number_channels;
+      offset=GetPixelCacheTileOffset(cache_info,tile_x,y_begin);
+      length=(MagickSizeType) (y_end-y_begin)*cache_info->tile_width*
+        number_channels*sizeof(*buffer);
+      if ((x_begin != tile_x) || ((x_end != (tile_x+(ssize_t)
+           cache_info->tile_width)) && (x_end != (ssize_t) cache_info->columns)))
+        {
+          if ((y_end-y_begin) == 1)
+            {
+              /*
+                A single partial tile row is written in place.
+              */
+              length=(MagickSizeType) (x_end-x_begin)*number_channels*
+                sizeof(*p);
+              count=WritePixelCacheRegion(cache_info,windowed,
+                GetPixelCacheTileOffset(cache_info,x_begin,y_begin),length,
+                (const unsigned char *) p);
+              if (count != (MagickOffsetType) length)
+                {
+                  status=MagickFalse;
+                  break;
+                }
+              continue;
+            }
+          count=ReadPixelCacheRegion(cache_info,windowed,offset,length,
+            (unsigned char *) buffer);
+          if (count != (MagickOffsetType) length)
+            {
+              status=MagickFalse;
+              break;
+            }
+        }
+      q=buffer+(x_begin-tile_x)*(ssize_t) number_channels;
+      for (y=y_begin; y < y_end; y++)
+      {
+        (void) memcpy(q,p,(size_t) (x_end-x_begin)*number_channels*
+          sizeof(*q));
+        p+=(ptrdiff_t) nexus_info->region.width*number_channels;
+        q+=(ptrdiff_t) cache_info->tile_width*number_channels;
+      }
+      count=WritePixelCacheRegion(cache_info,windowed,offset,length,
+        (const unsigned char *) buffer);
+      if (count != (MagickOffsetType) length)
+        {
+          status=MagickFalse;
+          break;
+        }
+    }
+    if (status == MagickFalse)
+      break;
+  }
+  buffer=(Quantum *) RelinquishMagickMemory(buffer);
+  return(status);
+}
+
 static MagickBooleanType WritePixelCachePixels(
   CacheInfo *magick_restrict cache_info,NexusInfo *magick_restrict nexus_info,
   ExceptionInfo *exception)
 {
+  MagickBooleanType
+    windowed;
+
   MagickOffsetType
     count,
     offset;
@@ -5878,55 +8857,71 @@ static MagickBooleanType WritePixelCachePixels(
           UnlockSemaphoreInfo(cache_info->file_semaphore);
           return(MagickFalse);
         }
-      if ((cache_info->columns == nexus_info->region.width) &&
-          (extent <= MagickMaxBufferExtent))
+      if (cache_info->tile_width != 0)
         {
-          length=extent;
-          rows=1UL;
+          /*
+            Write pixels to a tile-major disk cache.
+          */
+          if (WritePixelCacheTiles(cache_info,nexus_info) != MagickFalse)
+            y=(ssize_t) rows;
         }
-      for (y=0; y < (ssize_t) rows; y++)
-      {
-        count=WritePixelCacheRegion(cache_info,cache_info->offset+offset*
-          (MagickOffsetType) cache_info->number_channels*(MagickOffsetType)
-          sizeof(*p),length,(const unsigned char *) p);
-        if (count != (MagickOffsetType) length)
-          break;
-        p+=(ptrdiff_t) cache_info->number_channels*nexus_info->region.width;
-        offset+=(MagickOffsetType) cache_info->columns;
-      }
+      else
+        {
+          windowed=IsPixelCacheWindowed(cache_info,(MagickSizeType) (rows-1)*
+            cache_info->columns*cache_info->number_channels*sizeof(*p)+length);
+          if ((cache_info->columns == nexus_info->region.width) &&
+              (extent <= MagickMaxBufferExtent))
+            {
+              length=extent;
+              rows=1UL;
+            }
+          for (y=0; y < (ssize_t) rows; y++)
+          {
+            count=WritePixelCacheRegion(cache_info,windowed,cache_info->offset+
+              offset*(MagickOffsetType) cache_info->number_channels*
+              (MagickOffsetType) sizeof(*p),length,(const unsigned char *) p);
+            if (count != (MagickOffsetType) length)
+              break;
+            p+=(ptrdiff_t) cache_info->number_channels*
+              nexus_info->region.width;
+            offset+=(MagickOffsetType) cache_info->columns;
+          }
+        }
+      if (y >= (ssize_t) rows)
+        WriteBehindPixelCache(cache_info,nexus_info);
       if (IsFileDescriptorLimitExceeded() != MagickFalse)
         (void) ClosePixelCacheOnDisk(cache_info);
       UnlockSemaphoreInfo(cache_info->file_semaphore);
       break;
     }
-    case DistributedCache:
+    case CompressedCache:
     {
-      RectangleInfo
-        region;
-
       /*
-        Write pixels to distributed cache.
+        Write pixels to compressed memory.
       */
       LockSemaphoreInfo(cache_info->file_semaphore);
-      region=nexus_info->region;
-      if ((cache_info->columns != nexus_info->region.width) ||
-          (extent > MagickMaxBufferExtent))
-        region.height=1UL;
-      else
+      if (TransferPixelCacheBlocks(cache_info,&nexus_info->region,
+            cache_info->number_channels*sizeof(*p),0,(unsigned char *) p,
+            MagickTrue) == MagickFalse)
         {
-          length=extent;
-          rows=1UL;
+          UnlockSemaphoreInfo(cache_info->file_semaphore);
+          ThrowBinaryException(CacheError,"CacheResourcesExhausted",
+            cache_info->filename);
         }
-      for (y=0; y < (ssize_t) rows; y++)
-      {
-        count=WriteDistributePixelCachePixels((DistributeCacheInfo *)
-          cache_info->server_info,&region,length,(const unsigned char *) p);
-        if (count != (MagickOffsetType) length)
-          break;
-        p+=(ptrdiff_t) cache_info->number_channels*nexus_info->region.width;
-        region.y++;
-      }
       UnlockSemaphoreInfo(cache_info->file_semaphore);
+      y=(ssize_t) rows;
+      break;
+    }
+    case DistributedCache:
+    {
+      /*
+        Write pixels to distributed cache.
+      */
+      count=WriteDistributePixelCachePixels((DistributeCacheInfo *)
+        cache_info->server_info,&nexus_info->region,extent,
+        (const unsigned char *) p);
+      if (count == (MagickOffsetType) extent)
+        y=(ssize_t) rows;
       break;
     }
     default:
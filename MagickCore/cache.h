@@ -31,9 +31,25 @@ typedef enum
   DistributedCache,
   MapCache,
   MemoryCache,
-  PingCache
+  PingCache,
+  CompressedCache
 } CacheType;
 
+typedef struct _CacheStatistics
+{
+  MagickSizeType
+    direct_requests,
+    buffered_requests,
+    virtual_requests,
+    disk_bytes_read,
+    disk_bytes_written,
+    read_ahead_requests,
+    write_behind_requests,
+    clones,
+    promotions,
+    demotions;
+} CacheStatistics;
+
 extern MagickExport CacheType
   GetImagePixelCacheType(const Image *);
 
@@ -49,6 +65,7 @@ extern MagickExport const void
   *GetVirtualMetacontent(const Image *);
 
 extern MagickExport MagickBooleanType
+  GetImagePixelCacheStatistics(const Image *,CacheStatistics *),
   GetOneAuthenticPixel(Image *,const ssize_t,const ssize_t,Quantum *,
     ExceptionInfo *),
   GetOneVirtualPixel(const Image *,const ssize_t,const ssize_t,Quantum *,
@@ -58,6 +75,7 @@ extern MagickExport MagickBooleanType
   PersistPixelCache(Image *,const char *,const MagickBooleanType,
     MagickOffsetType *,ExceptionInfo *),
   ReshapePixelCache(Image *,const size_t,const size_t,ExceptionInfo *),
+  SpillPixelCache(Image *,ExceptionInfo *),
   SyncAuthenticPixels(Image *,ExceptionInfo *) magick_hot_spot;
 
 extern MagickExport MagickSizeType
@@ -73,7 +91,8 @@ extern MagickExport Quantum
 extern MagickExport void
   *AcquirePixelCachePixels(const Image *,size_t *,ExceptionInfo *),
   *GetAuthenticMetacontent(const Image *),
-  *GetPixelCachePixels(Image *,MagickSizeType *,ExceptionInfo *);
+  *GetPixelCachePixels(Image *,MagickSizeType *,ExceptionInfo *),
+  GetPixelCacheStatistics(CacheStatistics *);
 
 #if defined(__cplusplus) || defined(c_plusplus)
 }
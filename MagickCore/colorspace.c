@@ -1764,6 +1764,32 @@ MagickExport MagickBooleanType TransformImageColorspace(Image *image,
   (void) DeleteImageProfile(image,"icm");
   if (colorspace == UndefinedColorspace)
     return(SetImageColorspace(image,colorspace,exception));
+  if ((GetImagePixelCacheType(image) == DistributedCache) &&
+      (image->storage_class == DirectClass) &&
+      (IsGrayColorspace(image->colorspace) == IsGrayColorspace(colorspace)) &&
+      (IsCMYKColorspace(image->colorspace) == MagickFalse) &&
+      (IsCMYKColorspace(colorspace) == MagickFalse) &&
+      (image->colorspace != LogColorspace) && (colorspace != LogColorspace) &&
+      (GetImageProperty(image,"white-luminance",exception) ==
+       (const char *) NULL))
+    {
+      char
+        operation[MagickPathExtent];
+
+      const char
+        *artifact;
+
+      /*
+        Transform the pixels on the distributed cache servers.
+      */
+      artifact=GetImageArtifact(image,"color:illuminant");
+      (void) FormatLocaleString(operation,MagickPathExtent,"colorspace %s %s",
+        CommandOptionToMnemonic(MagickColorspaceOptions,(ssize_t) colorspace),
+        artifact != (const char *) NULL ? artifact : "");
+      if (ApplyPixelCacheOperation(image,image,operation,0,exception) !=
+          MagickFalse)
+        return(SetImageColorspace(image,colorspace,exception));
+    }
   /*
     Convert the reference image from an alternate colorspace to sRGB.
   */
@@ -20,6 +20,7 @@
 
 #include "MagickCore/geometry.h"
 #include "MagickCore/exception.h"
+#include "MagickCore/semaphore.h"
 
 #if defined(__cplusplus) || defined(c_plusplus)
 extern "C" {
@@ -42,6 +43,25 @@ typedef struct _DistributeCacheInfo
   MagickBooleanType
     debug;
 
+  size_t
+    version,
+    request,
+    cache_id;
+
+  SemaphoreInfo
+    *send_semaphore,
+    *receive_semaphore;
+
+  int
+    codec;
+
+  size_t
+    number_stripes,
+    stripe_rows;
+
+  struct _DistributeCacheInfo
+    **stripes;
+
   size_t
     signature;
 } DistributeCacheInfo;
@@ -58,6 +78,8 @@ extern MagickPrivate int
   GetDistributeCachePort(const DistributeCacheInfo *);
 
 extern MagickPrivate MagickBooleanType
+  ApplyDistributePixelCacheOperation(DistributeCacheInfo *,
+    DistributeCacheInfo *,const Image *,const char *,const ssize_t),
   OpenDistributePixelCache(DistributeCacheInfo *,Image *),
   RelinquishDistributePixelCache(DistributeCacheInfo *);
 
@@ -52,34 +52,55 @@
   Include declarations.
 */
 #include "MagickCore/studio.h"
+#include "MagickCore/artifact.h"
 #include "MagickCore/cache.h"
 #include "MagickCore/cache-private.h"
+#include "MagickCore/cache-view.h"
+#include "MagickCore/colorspace.h"
 #include "MagickCore/distribute-cache.h"
 #include "MagickCore/distribute-cache-private.h"
 #include "MagickCore/exception.h"
 #include "MagickCore/exception-private.h"
+#include "MagickCore/enhance.h"
+#include "MagickCore/fx.h"
+#include "MagickCore/fx-private.h"
 #include "MagickCore/geometry.h"
 #include "MagickCore/image.h"
 #include "MagickCore/image-private.h"
 #include "MagickCore/list.h"
 #include "MagickCore/locale_.h"
 #include "MagickCore/memory_.h"
+#include "MagickCore/morphology.h"
 #include "MagickCore/nt-base-private.h"
+#include "MagickCore/option.h"
 #include "MagickCore/pixel.h"
+#include "MagickCore/pixel-accessor.h"
 #include "MagickCore/policy.h"
 #include "MagickCore/random_.h"
 #include "MagickCore/registry.h"
+#include "MagickCore/resource_.h"
+#include "MagickCore/semaphore.h"
 #include "MagickCore/splay-tree.h"
+#include "MagickCore/statistic.h"
 #include "MagickCore/string_.h"
 #include "MagickCore/string-private.h"
+#include "MagickCore/timer-private.h"
+#include "MagickCore/token.h"
 #include "MagickCore/utility-private.h"
 #include "MagickCore/version.h"
 #include "MagickCore/version-private.h"
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+#include "zlib.h"
+#endif
+#if defined(MAGICKCORE_LZ4_DELEGATE)
+#include "lz4.h"
+#endif
 #undef MAGICKCORE_HAVE_DISTRIBUTE_CACHE
 #define SOCKET_TYPE int
 #if defined(MAGICKCORE_DPC_SUPPORT)
 #if defined(MAGICKCORE_HAVE_SOCKET) && defined(MAGICKCORE_THREAD_SUPPORT)
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <netdb.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
@@ -89,6 +110,10 @@
 #define SOCKET_TYPE int
 #define LENGTH_TYPE size_t
 #define MAGICKCORE_HAVE_DISTRIBUTE_CACHE 1
+#if defined(MAGICKCORE_HAVE_POLL)
+#include <poll.h>
+#define MAGICKCORE_HAVE_DISTRIBUTE_CACHE_EVENTS 1
+#endif
 #elif defined(_MSC_VER)
 #define CLOSE_SOCKET(socket) (void) closesocket(socket)
 #define HANDLER_RETURN_TYPE DWORD WINAPI
@@ -104,9 +129,15 @@
 /*
   Define declarations.
 */
+#define DPCDeflateCodec  0x01
 #define DPCHostname  "127.0.0.1"
+#define DPCLZ4Codec  0x02
+#define DPCMaxStripes  64
+#define DPCMaxWorkers  256
 #define DPCPendingConnections  10
+#define DPCPipelineDepth  32
 #define DPCPort  6668
+#define DPCProtocolVersion  4
 #define DPCSessionKeyLength  8
 #ifndef MSG_NOSIGNAL
 #  define MSG_NOSIGNAL 0
@@ -122,6 +153,20 @@ static SemaphoreInfo
 static WSADATA
   *wsaData = (WSADATA*) NULL;
 #endif
+
+static SemaphoreInfo
+  *owner_semaphore = (SemaphoreInfo *) NULL;
+
+static size_t
+  cache_owner = 0;
+
+#if defined(MAGICKCORE_HAVE_DISTRIBUTE_CACHE)
+static SemaphoreInfo
+  *cache_semaphore = (SemaphoreInfo *) NULL;
+
+static SplayTreeInfo
+  *cache_registry = (SplayTreeInfo *) NULL;
+#endif
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -180,7 +225,259 @@ static inline MagickOffsetType dpc_read(SOCKET_TYPE file,const MagickSizeType le
   }
   return(i);
 }
+
+static inline void dpc_nodelay(SOCKET_TYPE file)
+{
+#if defined(TCP_NODELAY)
+  int
+    one;
+
+  /*
+    Requests are small and pipelined, don't let them wait on delayed ACKs.
+  */
+  one=1;
+  (void) setsockopt(file,IPPROTO_TCP,TCP_NODELAY,(char *) &one,
+    (socklen_t) sizeof(one));
+#else
+  magick_unreferenced(file);
+#endif
+}
+#endif
+
+#if !defined(MAGICKCORE_HAVE_DISTRIBUTE_CACHE)
+static inline MagickOffsetType dpc_send(SOCKET_TYPE magick_unused(file),
+  const MagickSizeType magick_unused(length),
+  const void *magick_restrict magick_unused(message))
+{
+  magick_unreferenced(file);
+  magick_unreferenced(length);
+  magick_unreferenced(message);
+  return(-1);
+}
+#else
+static inline MagickOffsetType dpc_send(SOCKET_TYPE file,const MagickSizeType length,
+  const void *magick_restrict message)
+{
+  MagickOffsetType
+    i;
+
+  ssize_t
+    count;
+
+  /*
+    Ensure a complete message is sent.
+  */
+  count=0;
+  for (i=0; i < (MagickOffsetType) length; i+=count)
+  {
+    count=(ssize_t) send(file,(char *) message+i,(LENGTH_TYPE)
+      MagickMin(length-(MagickSizeType) i,(MagickSizeType) MagickMaxBufferExtent),
+      MSG_NOSIGNAL);
+    if (count <= 0)
+      {
+        count=0;
+        if (errno != EINTR)
+          break;
+      }
+  }
+  return(i);
+}
+
+#if defined(MAGICKCORE_HAVE_LINUX_SENDFILE)
+static inline MagickOffsetType dpc_sendfile(SOCKET_TYPE file,int cache_file,
+  const MagickOffsetType offset,const MagickSizeType length)
+{
+  MagickOffsetType
+    i;
+
+  off_t
+    position;
+
+  ssize_t
+    count;
+
+  /*
+    Send a span of a cache file without copying it through user space.
+  */
+  count=0;
+  position=(off_t) offset;
+  for (i=0; i < (MagickOffsetType) length; i+=count)
+  {
+    count=sendfile(file,cache_file,&position,(size_t) MagickMin(length-
+      (MagickSizeType) i,0x7ffff000));
+    if (count <= 0)
+      {
+        count=0;
+        if (errno != EINTR)
+          break;
+      }
+  }
+  return(i);
+}
+#endif
+#endif
+
+static size_t dpc_compress_bound(const int codec,const MagickSizeType length)
+{
+  /*
+    Return the largest compressed size of a payload of length bytes, or 0 if
+    the codec is unavailable or cannot compress a payload that large.
+  */
+  if (length > (MagickSizeType) INT_MAX)
+    return(0);
+#if defined(MAGICKCORE_LZ4_DELEGATE)
+  if (codec == DPCLZ4Codec)
+    return((size_t) LZ4_compressBound((int) length));
+#endif
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+  if (codec == DPCDeflateCodec)
+    return((size_t) compressBound((uLong) length));
+#endif
+  return(0);
+}
+
+static int dpc_codecs(void)
+{
+  int
+    codecs;
+
+  /*
+    Return the payload codecs this build speaks.
+  */
+  codecs=0;
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+  codecs|=DPCDeflateCodec;
+#endif
+#if defined(MAGICKCORE_LZ4_DELEGATE)
+  codecs|=DPCLZ4Codec;
+#endif
+  return(codecs);
+}
+
+static int dpc_select_codec(const int codecs)
+{
+  /*
+    Prefer LZ4, which is much faster than deflate at a similar ratio for
+    pixels, and fall back to deflate.
+  */
+  if (((codecs & dpc_codecs()) & DPCLZ4Codec) != 0)
+    return(DPCLZ4Codec);
+  if (((codecs & dpc_codecs()) & DPCDeflateCodec) != 0)
+    return(DPCDeflateCodec);
+  return(0);
+}
+
+static MagickOffsetType dpc_read_compressed(SOCKET_TYPE file,const int codec,
+  const MagickSizeType length,unsigned char *magick_restrict message,
+  unsigned char *magick_restrict buffer)
+{
+  MagickOffsetType
+    count;
+
+  MagickSizeType
+    extent;
+
+  /*
+    Read a compressed payload (its length, then the compressed bytes) and
+    decompress it into message.  Returns the number of bytes on the wire.
+  */
+  count=dpc_read(file,sizeof(extent),(unsigned char *) &extent);
+  if (count != (MagickOffsetType) sizeof(extent))
+    return(-1);
+  if (extent > (MagickSizeType) dpc_compress_bound(codec,length))
+    return(-1);
+  count=dpc_read(file,extent,buffer);
+  if (count != (MagickOffsetType) extent)
+    return(-1);
+  switch (codec)
+  {
+#if defined(MAGICKCORE_LZ4_DELEGATE)
+    case DPCLZ4Codec:
+    {
+      if (LZ4_decompress_safe((const char *) buffer,(char *) message,(int)
+          extent,(int) length) != (int) length)
+        return(-1);
+      break;
+    }
+#endif
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+    case DPCDeflateCodec:
+    {
+      uLongf
+        number_bytes;
+
+      number_bytes=(uLongf) length;
+      if ((uncompress(message,&number_bytes,buffer,(uLong) extent) != Z_OK) ||
+          (number_bytes != (uLongf) length))
+        return(-1);
+      break;
+    }
+#endif
+    default:
+      return(-1);
+  }
+  return((MagickOffsetType) (sizeof(extent)+extent));
+}
+
+static MagickOffsetType dpc_send_compressed(SOCKET_TYPE file,const int codec,
+  const MagickSizeType length,const unsigned char *magick_restrict message,
+  unsigned char *magick_restrict buffer)
+{
+  MagickOffsetType
+    count;
+
+  MagickSizeType
+    extent;
+
+  /*
+    Compress message into buffer with the codec agreed in the handshake, then
+    send its length and the compressed bytes.  Returns the number of bytes on
+    the wire.
+  */
+  extent=(MagickSizeType) dpc_compress_bound(codec,length);
+  if (extent == 0)
+    return(-1);
+  switch (codec)
+  {
+#if defined(MAGICKCORE_LZ4_DELEGATE)
+    case DPCLZ4Codec:
+    {
+      int
+        number_bytes;
+
+      number_bytes=LZ4_compress_default((const char *) message,(char *)
+        buffer,(int) length,(int) extent);
+      if (number_bytes <= 0)
+        return(-1);
+      extent=(MagickSizeType) number_bytes;
+      break;
+    }
+#endif
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+    case DPCDeflateCodec:
+    {
+      uLongf
+        number_bytes;
+
+      number_bytes=(uLongf) extent;
+      if (compress2(buffer,&number_bytes,message,(uLong) length,
+          Z_BEST_SPEED) != Z_OK)
+        return(-1);
+      extent=(MagickSizeType) number_bytes;
+      break;
+    }
 #endif
+    default:
+      return(-1);
+  }
+  count=dpc_send(file,sizeof(extent),&extent);
+  if (count != (MagickOffsetType) sizeof(extent))
+    return(-1);
+  count=dpc_send(file,extent,buffer);
+  if (count != (MagickOffsetType) extent)
+    return(-1);
+  return((MagickOffsetType) (sizeof(extent)+extent));
+}
 
 #if defined(MAGICKCORE_HAVE_WINSOCK2)
 static void InitializeWinsock2(MagickBooleanType use_lock)
@@ -275,6 +572,7 @@ static int ConnectPixelCacheServer(const char *hostname,const int port,
         "DistributedPixelCache","'%s': %s",hostname,GetExceptionMessage(errno));
       return(-1);
     }
+  dpc_nodelay(client_socket);
   count=recv(client_socket,(char *) session_key,sizeof(*session_key),0);
   if (count == -1)
     {
@@ -308,12 +606,11 @@ static int ConnectPixelCacheServer(const char *hostname,const int port,
 }
 #endif
 
-static char *GetHostname(int *port,ExceptionInfo *exception)
+static char **GetHostnames(size_t *number_hosts,ExceptionInfo *exception)
 {
   char
-    *host,
-    *hosts,
-    **hostlist;
+    **hostlist,
+    *hosts;
 
   int
     argc;
@@ -321,49 +618,187 @@ static char *GetHostname(int *port,ExceptionInfo *exception)
   ssize_t
     i;
 
-  static size_t
-    id = 0;
-
   /*
     Parse host list (e.g. 192.168.100.1:6668,192.168.100.2:6668).
   */
+  *number_hosts=0;
   hosts=(char *) GetImageRegistry(StringRegistryType,"cache:hosts",exception);
   if (hosts == (char *) NULL)
-    {
-      *port=DPCPort;
-      return(AcquireString(DPCHostname));
-    }
+    return((char **) NULL);
   (void) SubstituteString(&hosts,","," ");
   hostlist=StringToArgv(hosts,&argc);
   hosts=DestroyString(hosts);
   if (hostlist == (char **) NULL)
+    return((char **) NULL);
+  if (argc < 2)
     {
-      *port=DPCPort;
-      return(AcquireString(DPCHostname));
+      for (i=0; i < (ssize_t) argc; i++)
+        hostlist[i]=DestroyString(hostlist[i]);
+      hostlist=(char **) RelinquishMagickMemory(hostlist);
+      return((char **) NULL);
     }
-  hosts=AcquireString(hostlist[(id++ % ((size_t) argc-1))+1]);
-  for (i=0; i < (ssize_t) argc; i++)
-    hostlist[i]=DestroyString(hostlist[i]);
-  hostlist=(char **) RelinquishMagickMemory(hostlist);
+  *number_hosts=(size_t) argc-1;
+  return(hostlist);
+}
+
+static char *GetHostname(const char *host,int *port)
+{
+  char
+    *hostname,
+    **hostlist,
+    *hosts;
+
+  int
+    argc;
+
+  ssize_t
+    i;
+
+  /*
+    Split a host into its name and port (e.g. 192.168.100.1:6668).
+  */
+  *port=DPCPort;
+  if (host == (const char *) NULL)
+    return(AcquireString(DPCHostname));
+  hosts=AcquireString(host);
   (void) SubstituteString(&hosts,":"," ");
   hostlist=StringToArgv(hosts,&argc);
+  hosts=DestroyString(hosts);
   if (hostlist == (char **) NULL)
-    {
-      *port=DPCPort;
-      return(AcquireString(DPCHostname));
-    }
-  host=AcquireString(hostlist[1]);
-  if (hostlist[2] == (char *) NULL)
-    *port=DPCPort;
-  else
+    return(AcquireString(DPCHostname));
+  hostname=AcquireString(hostlist[1]);
+  if (hostlist[2] != (char *) NULL)
     *port=StringToLong(hostlist[2]);
   for (i=0; i < (ssize_t) argc; i++)
     hostlist[i]=DestroyString(hostlist[i]);
   hostlist=(char **) RelinquishMagickMemory(hostlist);
-  return(host);
+  return(hostname);
 }
 
-MagickPrivate DistributeCacheInfo *AcquireDistributeCacheInfo(
+static inline DistributeCacheInfo *GetDistributeCacheStripe(
+  const DistributeCacheInfo *server_info,const size_t stripe)
+{
+  if (server_info->stripes == (DistributeCacheInfo **) NULL)
+    return((DistributeCacheInfo *) server_info);
+  return(server_info->stripes[stripe]);
+}
+
+static size_t GetDistributeCacheHalo(const size_t rows,const size_t stripe_rows,
+  const size_t band,const size_t halo,size_t *top,size_t *bottom)
+{
+  size_t
+    band_rows,
+    y;
+
+  /*
+    Return the rows of a band, and the rows above and below it that an
+    operation on a neighborhood needs from the bands of the other stripes.
+  */
+  y=band*stripe_rows;
+  band_rows=MagickMin(stripe_rows,rows-y);
+  *top=MagickMin(halo,y);
+  *bottom=MagickMin(halo,rows-y-band_rows);
+  return(band_rows);
+}
+
+static size_t GetDistributeCacheKey(void)
+{
+  RandomInfo
+    *random_info;
+
+  size_t
+    key;
+
+  StringInfo
+    *nonce;
+
+  /*
+    Return a random, non-zero key.
+  */
+  random_info=AcquireRandomInfo();
+  do
+  {
+    nonce=GetRandomKey(random_info,sizeof(key));
+    (void) memcpy(&key,GetStringInfoDatum(nonce),sizeof(key));
+    nonce=DestroyStringInfo(nonce);
+  } while (key == 0);
+  random_info=DestroyRandomInfo(random_info);
+  return(key);
+}
+
+static size_t GetDistributeCacheOwner(void)
+{
+  size_t
+    owner;
+
+  /*
+    The caches this process opens are owned by one random key; a server only
+    lets an operation read a cache with the owner of the connection that
+    sent it.
+  */
+  if (owner_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&owner_semaphore);
+  LockSemaphoreInfo(owner_semaphore);
+  if (cache_owner == 0)
+    cache_owner=GetDistributeCacheKey();
+  owner=cache_owner;
+  UnlockSemaphoreInfo(owner_semaphore);
+  return(owner);
+}
+
+static size_t GetDistributeCacheVersion(DistributeCacheInfo *server_info,
+  const size_t maximum_version,const MagickBooleanType compress)
+{
+  int
+    codec,
+    version;
+
+  MagickOffsetType
+    count;
+
+  size_t
+    owner;
+
+  unsigned char
+    message[MagickPathExtent],
+    *p;
+
+  /*
+    Negotiate the protocol version and, if compression is requested, the
+    payload codec: the client offers the codecs it speaks and the server
+    picks one both ends have.  The client also names the owner of the caches
+    it opens.  Servers that predate the handshake reject the command and
+    close the connection.
+  */
+  p=message;
+  *p++='v';
+  (void) memcpy(p,&server_info->session_key,sizeof(server_info->session_key));
+  p+=(ptrdiff_t) sizeof(server_info->session_key);
+  version=(int) maximum_version;
+  (void) memcpy(p,&version,sizeof(version));
+  p+=(ptrdiff_t) sizeof(version);
+  codec=(compress != MagickFalse) && (maximum_version > 2) ? dpc_codecs() : 0;
+  (void) memcpy(p,&codec,sizeof(codec));
+  p+=(ptrdiff_t) sizeof(codec);
+  owner=GetDistributeCacheOwner();
+  (void) memcpy(p,&owner,sizeof(owner));
+  p+=(ptrdiff_t) sizeof(owner);
+  count=dpc_send(server_info->file,(MagickSizeType) (p-message),message);
+  if (count != (MagickOffsetType) (p-message))
+    return(0);
+  version=0;
+  count=dpc_read(server_info->file,sizeof(version),(unsigned char *) &version);
+  if ((count != (MagickOffsetType) sizeof(version)) || (version < 1))
+    return(0);
+  count=dpc_read(server_info->file,sizeof(codec),(unsigned char *) &codec);
+  if (count != (MagickOffsetType) sizeof(codec))
+    return(0);
+  server_info->codec=dpc_select_codec(codec);
+  return(MagickMin((size_t) version,maximum_version));
+}
+
+static DistributeCacheInfo *ConnectDistributeCache(const char *host,
+  const MagickBooleanType compress,const size_t version,
   ExceptionInfo *exception)
 {
   char
@@ -376,14 +811,14 @@ MagickPrivate DistributeCacheInfo *AcquireDistributeCacheInfo(
     session_key;
 
   /*
-    Connect to the distributed pixel cache server.
+    Connect to one distributed pixel cache server.
   */
   server_info=(DistributeCacheInfo *) AcquireCriticalMemory(
     sizeof(*server_info));
   (void) memset(server_info,0,sizeof(*server_info));
   server_info->signature=MagickCoreSignature;
   server_info->port=0;
-  hostname=GetHostname(&server_info->port,exception);
+  hostname=GetHostname(host,&server_info->port);
   session_key=0;
   server_info->file=ConnectPixelCacheServer(hostname,server_info->port,
     &session_key,exception);
@@ -395,30 +830,440 @@ MagickPrivate DistributeCacheInfo *AcquireDistributeCacheInfo(
       (void) CopyMagickString(server_info->hostname,hostname,MagickPathExtent);
       server_info->debug=(GetLogEventMask() & CacheEvent) != 0 ? MagickTrue :
         MagickFalse;
+      server_info->send_semaphore=AcquireSemaphoreInfo();
+      server_info->receive_semaphore=AcquireSemaphoreInfo();
+      server_info->version=1;
+      if (version > 1)
+        server_info->version=GetDistributeCacheVersion(server_info,version,
+          compress);
+      if (server_info->version == 0)
+        {
+          /*
+            Reconnect to a server that only speaks the original protocol.
+          */
+#if defined(MAGICKCORE_HAVE_DISTRIBUTE_CACHE)
+          CLOSE_SOCKET(server_info->file);
+#endif
+          server_info->version=1;
+          server_info->file=ConnectPixelCacheServer(hostname,server_info->port,
+            &session_key,exception);
+          if (server_info->file == -1)
+            server_info=DestroyDistributeCacheInfo(server_info);
+        }
+    }
+  if (server_info != (DistributeCacheInfo *) NULL)
+    {
+      if (server_info->version < 3)
+        server_info->codec=0;
+      server_info->number_stripes=1;
     }
   hostname=DestroyString(hostname);
   return(server_info);
 }
-
-/*
-%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
-%                                                                             %
-%                                                                             %
-%                                                                             %
-+   D e s t r o y D i s t r i b u t e C a c h e I n f o                       %
-%                                                                             %
-%                                                                             %
-%                                                                             %
-%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
-%
-%  DestroyDistributeCacheInfo() deallocates memory associated with an
-%  DistributeCacheInfo structure.
-%
-%  The format of the DestroyDistributeCacheInfo method is:
-%
-%      DistributeCacheInfo *DestroyDistributeCacheInfo(
-%        DistributeCacheInfo *server_info)
-%
+
+static size_t GetDistributeCacheProtocol(ExceptionInfo *exception)
+{
+  char
+    *value;
+
+  size_t
+    version;
+
+  /*
+    A registry define (e.g. -define registry:cache:protocol=2) caps the
+    protocol version, so the client talks to a server as an older client
+    would.  Version 1 skips the handshake.
+  */
+  value=(char *) GetImageRegistry(StringRegistryType,"cache:protocol",
+    exception);
+  if (value == (char *) NULL)
+    return(DPCProtocolVersion);
+  version=StringToUnsignedLong(value);
+  value=DestroyString(value);
+  return(MagickMax(MagickMin(version,DPCProtocolVersion),1));
+}
+
+static MagickBooleanType IsDistributeCacheOptionTrue(const char *key,
+  ExceptionInfo *exception)
+{
+  char
+    *value;
+
+  MagickBooleanType
+    status;
+
+  value=(char *) GetImageRegistry(StringRegistryType,key,exception);
+  if (value == (char *) NULL)
+    return(MagickFalse);
+  status=IsStringTrue(value);
+  value=DestroyString(value);
+  return(status);
+}
+
+MagickPrivate DistributeCacheInfo *AcquireDistributeCacheInfo(
+  ExceptionInfo *exception)
+{
+  char
+    **hostlist;
+
+  DistributeCacheInfo
+    *server_info;
+
+  MagickBooleanType
+    compress;
+
+  size_t
+    number_hosts,
+    version;
+
+  ssize_t
+    i;
+
+  static size_t
+    id = 0;
+
+  /*
+    Connect to the distributed pixel cache server, or to every listed server
+    when the pixel rows are striped across them.
+  */
+  compress=IsDistributeCacheOptionTrue("cache:compress",exception);
+  version=GetDistributeCacheProtocol(exception);
+  hostlist=GetHostnames(&number_hosts,exception);
+  if (hostlist == (char **) NULL)
+    return(ConnectDistributeCache((const char *) NULL,compress,version,
+      exception));
+  if ((number_hosts == 1) ||
+      (IsDistributeCacheOptionTrue("cache:stripe",exception) == MagickFalse))
+    server_info=ConnectDistributeCache(hostlist[(id++ % number_hosts)+1],
+      compress,version,exception);
+  else
+    {
+      number_hosts=MagickMin(number_hosts,DPCMaxStripes);
+      server_info=ConnectDistributeCache(hostlist[1],compress,version,
+        exception);
+      if (server_info != (DistributeCacheInfo *) NULL)
+        {
+          server_info->stripes=(DistributeCacheInfo **) AcquireQuantumMemory(
+            number_hosts,sizeof(*server_info->stripes));
+          if (server_info->stripes == (DistributeCacheInfo **) NULL)
+            server_info=DestroyDistributeCacheInfo(server_info);
+        }
+      if (server_info != (DistributeCacheInfo *) NULL)
+        {
+          (void) memset(server_info->stripes,0,number_hosts*
+            sizeof(*server_info->stripes));
+          server_info->stripes[0]=server_info;
+          server_info->number_stripes=number_hosts;
+          for (i=1; i < (ssize_t) number_hosts; i++)
+          {
+            server_info->stripes[i]=ConnectDistributeCache(hostlist[i+1],
+              compress,version,exception);
+            if (server_info->stripes[i] == (DistributeCacheInfo *) NULL)
+              {
+                server_info=DestroyDistributeCacheInfo(server_info);
+                break;
+              }
+          }
+        }
+    }
+  for (i=0; hostlist[i] != (char *) NULL; i++)
+    hostlist[i]=DestroyString(hostlist[i]);
+  hostlist=(char **) RelinquishMagickMemory(hostlist);
+  return(server_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   A p p l y D i s t r i b u t e P i x e l C a c h e O p e r a t i o n       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ApplyDistributePixelCacheOperation() has the servers of a distributed pixel
+%  cache apply an operation to their pixels, reading them from the source
+%  cache which must reside on the same servers.  Only the status of the
+%  operation crosses the network, except for the rows a neighborhood
+%  operation needs from the adjacent bands of a striped cache.  Nothing is
+%  changed unless every stripe succeeds.
+%
+%  The format of the ApplyDistributePixelCacheOperation method is:
+%
+%      MagickBooleanType ApplyDistributePixelCacheOperation(
+%        DistributeCacheInfo *server_info,DistributeCacheInfo *source_info,
+%        const Image *image,const char *operation,const ssize_t halo)
+%
+%  A description of each parameter follows:
+%
+%    o server_info: the distributed cache info.
+%
+%    o source_info: the distributed cache info of the pixels the operation
+%      reads.
+%
+%    o image: the source image.
+%
+%    o operation: the operation (e.g. level 0 65535 1).
+%
+%    o halo: the rows above and below a pixel the operation reads, or -1 if
+%      it may read any pixel of the image.
+%
+*/
+MagickPrivate MagickBooleanType ApplyDistributePixelCacheOperation(
+  DistributeCacheInfo *server_info,DistributeCacheInfo *source_info,
+  const Image *image,const char *operation,const ssize_t halo)
+{
+  DistributeCacheInfo
+    *stripe;
+
+  MagickBooleanType
+    status;
+
+  MagickSizeType
+    extent,
+    length[DPCMaxStripes];
+
+  size_t
+    band,
+    bottom,
+    halo_rows,
+    i,
+    number_bands,
+    requests[DPCMaxStripes],
+    rows,
+    top;
+
+  unsigned char
+    message[MagickPathExtent],
+    *p,
+    *pixels[DPCMaxStripes];
+
+  assert(server_info != (DistributeCacheInfo *) NULL);
+  assert(server_info->signature == MagickCoreSignature);
+  assert(source_info != (DistributeCacheInfo *) NULL);
+  assert(source_info->signature == MagickCoreSignature);
+  if ((server_info->number_stripes != source_info->number_stripes) ||
+      (server_info->stripe_rows != source_info->stripe_rows))
+    return(MagickFalse);
+  if ((halo < 0) && (server_info->number_stripes > 1))
+    return(MagickFalse);
+  extent=(MagickSizeType) strlen(operation);
+  if (extent > MagickMaxBufferExtent)
+    return(MagickFalse);
+  for (i=0; i < server_info->number_stripes; i++)
+  {
+    DistributeCacheInfo
+      *source;
+
+    stripe=GetDistributeCacheStripe(server_info,i);
+    source=GetDistributeCacheStripe(source_info,i);
+    if ((stripe->version < 4) || (source->cache_id == 0) ||
+        (stripe->port != source->port) ||
+        (LocaleCompare(stripe->hostname,source->hostname) != 0))
+      return(MagickFalse);
+  }
+  /*
+    Read the rows each stripe needs from the adjacent bands of the others.
+  */
+  halo_rows=0;
+  if ((halo > 0) && (server_info->number_stripes > 1))
+    halo_rows=(size_t) halo;
+  rows=image->columns*image->number_channels*sizeof(Quantum);
+  number_bands=(image->rows+server_info->stripe_rows-1)/
+    server_info->stripe_rows;
+  (void) memset(pixels,0,sizeof(pixels));
+  status=MagickTrue;
+  for (i=0; (status != MagickFalse) && (i < server_info->number_stripes); i++)
+  {
+    length[i]=0;
+    if (halo_rows == 0)
+      continue;
+    for (band=i; band < number_bands; band+=server_info->number_stripes)
+    {
+      (void) GetDistributeCacheHalo(image->rows,server_info->stripe_rows,band,
+        halo_rows,&top,&bottom);
+      length[i]+=(MagickSizeType) (top+bottom)*rows;
+    }
+    pixels[i]=(unsigned char *) AcquireQuantumMemory((size_t) length[i]+1,
+      sizeof(*pixels[i]));
+    if (pixels[i] == (unsigned char *) NULL)
+      {
+        status=MagickFalse;
+        break;
+      }
+    p=pixels[i];
+    for (band=i; band < number_bands; band+=server_info->number_stripes)
+    {
+      RectangleInfo
+        region;
+
+      size_t
+        band_rows;
+
+      band_rows=GetDistributeCacheHalo(image->rows,server_info->stripe_rows,
+        band,halo_rows,&top,&bottom);
+      region.width=image->columns;
+      region.x=0;
+      region.height=top;
+      region.y=(ssize_t) (band*server_info->stripe_rows-top);
+      if (ReadDistributePixelCachePixels(source_info,&region,(MagickSizeType)
+          top*rows,p) != (MagickOffsetType) (top*rows))
+        status=MagickFalse;
+      p+=(ptrdiff_t) top*rows;
+      region.height=bottom;
+      region.y=(ssize_t) (band*server_info->stripe_rows+band_rows);
+      if (ReadDistributePixelCachePixels(source_info,&region,(MagickSizeType)
+          bottom*rows,p) != (MagickOffsetType) (bottom*rows))
+        status=MagickFalse;
+      p+=(ptrdiff_t) bottom*rows;
+    }
+  }
+  /*
+    Send the operation to every stripe, then collect the status of each.
+  */
+  for (i=0; (status != MagickFalse) && (i < server_info->number_stripes); i++)
+  {
+    ChannelType
+      channel_mask;
+
+    ColorspaceType
+      colorspace;
+
+    size_t
+      index;
+
+    VirtualPixelMethod
+      method;
+
+    stripe=GetDistributeCacheStripe(server_info,i);
+    LockSemaphoreInfo(stripe->send_semaphore);
+    requests[i]=stripe->request++;
+    index=i;
+    colorspace=image->colorspace;
+    channel_mask=image->channel_mask;
+    method=GetPixelCacheVirtualMethod(image);
+    p=message;
+    *p++='x';  /* execute */
+    (void) memcpy(p,&stripe->session_key,sizeof(stripe->session_key));
+    p+=(ptrdiff_t) sizeof(stripe->session_key);
+    (void) memcpy(p,&requests[i],sizeof(requests[i]));
+    p+=(ptrdiff_t) sizeof(requests[i]);
+    (void) memcpy(p,&GetDistributeCacheStripe(source_info,i)->cache_id,
+      sizeof(stripe->cache_id));
+    p+=(ptrdiff_t) sizeof(stripe->cache_id);
+    (void) memcpy(p,&image->rows,sizeof(image->rows));
+    p+=(ptrdiff_t) sizeof(image->rows);
+    (void) memcpy(p,&server_info->stripe_rows,sizeof(server_info->stripe_rows));
+    p+=(ptrdiff_t) sizeof(server_info->stripe_rows);
+    (void) memcpy(p,&server_info->number_stripes,
+      sizeof(server_info->number_stripes));
+    p+=(ptrdiff_t) sizeof(server_info->number_stripes);
+    (void) memcpy(p,&index,sizeof(index));
+    p+=(ptrdiff_t) sizeof(index);
+    (void) memcpy(p,&halo_rows,sizeof(halo_rows));
+    p+=(ptrdiff_t) sizeof(halo_rows);
+    (void) memcpy(p,&colorspace,sizeof(colorspace));
+    p+=(ptrdiff_t) sizeof(colorspace);
+    (void) memcpy(p,&channel_mask,sizeof(channel_mask));
+    p+=(ptrdiff_t) sizeof(channel_mask);
+    (void) memcpy(p,&method,sizeof(method));
+    p+=(ptrdiff_t) sizeof(method);
+    (void) memcpy(p,&image->depth,sizeof(image->depth));
+    p+=(ptrdiff_t) sizeof(image->depth);
+    (void) memcpy(p,&image->resolution,sizeof(image->resolution));
+    p+=(ptrdiff_t) sizeof(image->resolution);
+    (void) memcpy(p,&image->page,sizeof(image->page));
+    p+=(ptrdiff_t) sizeof(image->page);
+    (void) memcpy(p,&extent,sizeof(extent));
+    p+=(ptrdiff_t) sizeof(extent);
+    (void) memcpy(p,&length[i],sizeof(length[i]));
+    p+=(ptrdiff_t) sizeof(length[i]);
+    if ((dpc_send(stripe->file,(MagickSizeType) (p-message),message) !=
+         (MagickOffsetType) (p-message)) ||
+        (dpc_send(stripe->file,extent,(const unsigned char *) operation) !=
+         (MagickOffsetType) extent) ||
+        (dpc_send(stripe->file,length[i],pixels[i]) !=
+         (MagickOffsetType) length[i]))
+      {
+        UnlockSemaphoreInfo(stripe->send_semaphore);
+        status=MagickFalse;
+        break;
+      }
+    LockSemaphoreInfo(stripe->receive_semaphore);
+    UnlockSemaphoreInfo(stripe->send_semaphore);
+  }
+  number_bands=i;
+  for (i=0; i < number_bands; i++)
+  {
+    MagickBooleanType
+      reply;
+
+    MagickOffsetType
+      count;
+
+    size_t
+      reply_id;
+
+    stripe=GetDistributeCacheStripe(server_info,i);
+    count=dpc_read(stripe->file,sizeof(reply_id),(unsigned char *) &reply_id);
+    if ((count != (MagickOffsetType) sizeof(reply_id)) ||
+        (reply_id != requests[i]))
+      status=MagickFalse;
+    else
+      {
+        reply=MagickFalse;
+        count=dpc_read(stripe->file,sizeof(reply),(unsigned char *) &reply);
+        if ((count != (MagickOffsetType) sizeof(reply)) ||
+            (reply == MagickFalse))
+          status=MagickFalse;
+      }
+    UnlockSemaphoreInfo(stripe->receive_semaphore);
+  }
+  /*
+    Commit the results only if every stripe succeeded.
+  */
+  for (i=0; i < number_bands; i++)
+  {
+    stripe=GetDistributeCacheStripe(server_info,i);
+    p=message;
+    *p++='c';  /* commit */
+    (void) memcpy(p,&stripe->session_key,sizeof(stripe->session_key));
+    p+=(ptrdiff_t) sizeof(stripe->session_key);
+    (void) memcpy(p,&status,sizeof(status));
+    p+=(ptrdiff_t) sizeof(status);
+    LockSemaphoreInfo(stripe->send_semaphore);
+    if (dpc_send(stripe->file,(MagickSizeType) (p-message),message) !=
+        (MagickOffsetType) (p-message))
+      status=MagickFalse;
+    UnlockSemaphoreInfo(stripe->send_semaphore);
+  }
+  for (i=0; i < server_info->number_stripes; i++)
+    if (pixels[i] != (unsigned char *) NULL)
+      pixels[i]=(unsigned char *) RelinquishMagickMemory(pixels[i]);
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   D e s t r o y D i s t r i b u t e C a c h e I n f o                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DestroyDistributeCacheInfo() deallocates memory associated with an
+%  DistributeCacheInfo structure.
+%
+%  The format of the DestroyDistributeCacheInfo method is:
+%
+%      DistributeCacheInfo *DestroyDistributeCacheInfo(
+%        DistributeCacheInfo *server_info)
+%
 %  A description of each parameter follows:
 %
 %    o server_info: the distributed cache info.
@@ -430,9 +1275,25 @@ MagickPrivate DistributeCacheInfo *DestroyDistributeCacheInfo(
   assert(server_info != (DistributeCacheInfo *) NULL);
   assert(server_info->signature == MagickCoreSignature);
 #if defined(MAGICKCORE_HAVE_DISTRIBUTE_CACHE)
+  if (server_info->stripes != (DistributeCacheInfo **) NULL)
+    {
+      ssize_t
+        i;
+
+      for (i=1; i < (ssize_t) server_info->number_stripes; i++)
+        if (server_info->stripes[i] != (DistributeCacheInfo *) NULL)
+          server_info->stripes[i]=DestroyDistributeCacheInfo(
+            server_info->stripes[i]);
+      server_info->stripes=(DistributeCacheInfo **) RelinquishMagickMemory(
+        server_info->stripes);
+    }
   if (server_info->file > 0)
     CLOSE_SOCKET(server_info->file);
 #endif
+  if (server_info->send_semaphore != (SemaphoreInfo *) NULL)
+    RelinquishSemaphoreInfo(&server_info->send_semaphore);
+  if (server_info->receive_semaphore != (SemaphoreInfo *) NULL)
+    RelinquishSemaphoreInfo(&server_info->receive_semaphore);
   server_info->signature=(~MagickCoreSignature);
   server_info=(DistributeCacheInfo *) RelinquishMagickMemory(server_info);
   return(server_info);
@@ -451,6 +1312,8 @@ MagickPrivate DistributeCacheInfo *DestroyDistributeCacheInfo(
 %
 %  DistributePixelCacheServer() waits on the specified port for commands to
 %  create, read, update, or destroy a pixel cache.
+%  Connections are multiplexed onto a pool of worker threads bounded by the
+%  thread resource limit.
 %
 %  The format of the DistributePixelCacheServer() method is:
 %
@@ -464,46 +1327,6 @@ MagickPrivate DistributeCacheInfo *DestroyDistributeCacheInfo(
 %
 */
 
-#if !defined(MAGICKCORE_HAVE_DISTRIBUTE_CACHE)
-static inline MagickOffsetType dpc_send(SOCKET_TYPE magick_unused(file),
-  const MagickSizeType magick_unused(length),
-  const void *magick_restrict magick_unused(message))
-{
-  magick_unreferenced(file);
-  magick_unreferenced(length);
-  magick_unreferenced(message);
-  return(-1);
-}
-#else
-static inline MagickOffsetType dpc_send(SOCKET_TYPE file,const MagickSizeType length,
-  const void *magick_restrict message)
-{
-  MagickOffsetType
-    i;
-
-  ssize_t
-    count;
-
-  /*
-    Ensure a complete message is sent.
-  */
-  count=0;
-  for (i=0; i < (MagickOffsetType) length; i+=count)
-  {
-    count=(ssize_t) send(file,(char *) message+i,(LENGTH_TYPE)
-      MagickMin(length-(MagickSizeType) i,(MagickSizeType) MagickMaxBufferExtent),
-      MSG_NOSIGNAL);
-    if (count <= 0)
-      {
-        count=0;
-        if (errno != EINTR)
-          break;
-      }
-  }
-  return(i);
-}
-#endif
-
 #if !defined(MAGICKCORE_HAVE_DISTRIBUTE_CACHE)
 MagickExport void DistributePixelCacheServer(const int magick_unused(port),
   ExceptionInfo *magick_unused(exception))
@@ -513,6 +1336,55 @@ MagickExport void DistributePixelCacheServer(const int magick_unused(port),
   ThrowFatalException(MissingDelegateError,"DelegateLibrarySupportNotBuiltIn");
 }
 #else
+typedef struct _DistributeCacheClient
+{
+  SOCKET_TYPE
+    file;
+
+  char
+    hostname[MagickPathExtent];
+
+  size_t
+    session_key,
+    version,
+    owner,
+    cache_id;
+
+  int
+    codec;
+
+  SplayTreeInfo
+    *registry;
+
+  Image
+    *pending;
+
+  ExceptionInfo
+    *exception;
+
+  MagickBooleanType
+    status,
+    busy;
+
+  MagickSizeType
+    requests,
+    bytes_received,
+    bytes_sent,
+    zero_copy_bytes;
+
+  time_t
+    timestamp;
+} DistributeCacheClient;
+
+typedef struct _DistributeCacheEntry
+{
+  Image
+    *image;
+
+  size_t
+    owner;
+} DistributeCacheEntry;
+
 static MagickBooleanType DestroyDistributeCache(SplayTreeInfo *registry,
   const size_t session_key)
 {
@@ -589,78 +1461,146 @@ static MagickBooleanType OpenDistributeCache(SplayTreeInfo *registry,
   return(status);
 }
 
-static MagickBooleanType ReadDistributeCacheMetacontent(SplayTreeInfo *registry,
-  SOCKET_TYPE file,const size_t session_key,ExceptionInfo *exception)
+static MagickBooleanType ReadDistributeCacheRequest(SOCKET_TYPE file,
+  const size_t version,size_t *id,RectangleInfo *region,MagickSizeType *length)
 {
-  const Quantum
-    *p;
-
-  const unsigned char
-    *metacontent;
-
-  Image
-    *image;
-
-  MagickAddressType
-    key = (MagickAddressType) session_key;
-
   MagickOffsetType
     count;
 
   MagickSizeType
-    length;
-
-  RectangleInfo
-    region;
+    extent;
 
   unsigned char
     message[MagickPathExtent],
-    *q;
+    *p;
 
   /*
-    Read distributed pixel cache metacontent.
+    Read the request identifier (protocol version 2), region, and length.
   */
-  image=(Image *) GetValueFromSplayTree(registry,(const void *) key);
-  if (image == (Image *) NULL)
-    return(MagickFalse);
-  length=sizeof(region.width)+sizeof(region.height)+sizeof(region.x)+
-    sizeof(region.y)+sizeof(length);
-  count=dpc_read(file,length,message);
-  if (count != (MagickOffsetType) length)
-    return(MagickFalse);
-  q=message;
-  (void) memcpy(&region.width,q,sizeof(region.width));
-  q+=(ptrdiff_t) sizeof(region.width);
-  (void) memcpy(&region.height,q,sizeof(region.height));
-  q+=(ptrdiff_t) sizeof(region.height);
-  (void) memcpy(&region.x,q,sizeof(region.x));
-  q+=(ptrdiff_t) sizeof(region.x);
-  (void) memcpy(&region.y,q,sizeof(region.y));
-  q+=(ptrdiff_t) sizeof(region.y);
-  (void) memcpy(&length,q,sizeof(length));
-  q+=(ptrdiff_t) sizeof(length);
-  p=GetVirtualPixels(image,region.x,region.y,region.width,region.height,
-    exception);
-  if (p == (const Quantum *) NULL)
-    return(MagickFalse);
-  metacontent=(const unsigned char *) GetVirtualMetacontent(image);
-  count=dpc_send(file,length,metacontent);
-  if (count != (MagickOffsetType) length)
+  extent=sizeof(region->width)+sizeof(region->height)+sizeof(region->x)+
+    sizeof(region->y)+sizeof(*length);
+  if (version > 1)
+    extent+=sizeof(*id);
+  count=dpc_read(file,extent,message);
+  if (count != (MagickOffsetType) extent)
     return(MagickFalse);
+  p=message;
+  *id=0;
+  if (version > 1)
+    {
+      (void) memcpy(id,p,sizeof(*id));
+      p+=(ptrdiff_t) sizeof(*id);
+    }
+  (void) memcpy(&region->width,p,sizeof(region->width));
+  p+=(ptrdiff_t) sizeof(region->width);
+  (void) memcpy(&region->height,p,sizeof(region->height));
+  p+=(ptrdiff_t) sizeof(region->height);
+  (void) memcpy(&region->x,p,sizeof(region->x));
+  p+=(ptrdiff_t) sizeof(region->x);
+  (void) memcpy(&region->y,p,sizeof(region->y));
+  p+=(ptrdiff_t) sizeof(region->y);
+  (void) memcpy(length,p,sizeof(*length));
   return(MagickTrue);
 }
 
-static MagickBooleanType ReadDistributeCachePixels(SplayTreeInfo *registry,
-  SOCKET_TYPE file,const size_t session_key,ExceptionInfo *exception)
+static MagickBooleanType SendDistributeCacheReply(SOCKET_TYPE file,
+  const size_t version,const size_t id,const MagickBooleanType status)
 {
-  const Quantum
-    *p;
+  MagickOffsetType
+    count;
+
+  unsigned char
+    message[MagickPathExtent],
+    *p;
+
+  /*
+    Protocol version 2 precedes the pixels of a read with the request
+    identifier and status.
+  */
+  if (version < 2)
+    return(status);
+  p=message;
+  (void) memcpy(p,&id,sizeof(id));
+  p+=(ptrdiff_t) sizeof(id);
+  (void) memcpy(p,&status,sizeof(status));
+  p+=(ptrdiff_t) sizeof(status);
+  count=dpc_send(file,(MagickSizeType) (p-message),message);
+  if (count != (MagickOffsetType) (p-message))
+    return(MagickFalse);
+  return(status);
+}
+
+static MagickBooleanType ReadDistributeCachePayload(
+  DistributeCacheClient *client,const MagickSizeType length,
+  unsigned char *message)
+{
+  MagickOffsetType
+    count;
+
+  unsigned char
+    *buffer;
+
+  /*
+    Read a compressed pixel payload from the client.
+  */
+  buffer=(unsigned char *) NULL;
+  if (dpc_compress_bound(client->codec,length) != 0)
+    buffer=(unsigned char *) AcquireQuantumMemory(dpc_compress_bound(
+      client->codec,length),sizeof(*buffer));
+  if (buffer == (unsigned char *) NULL)
+    return(MagickFalse);
+  count=dpc_read_compressed(client->file,client->codec,length,message,buffer);
+  buffer=(unsigned char *) RelinquishMagickMemory(buffer);
+  if (count < 0)
+    return(MagickFalse);
+  client->bytes_received+=(MagickSizeType) count;
+  return(MagickTrue);
+}
+
+static MagickBooleanType SendDistributeCachePayload(
+  DistributeCacheClient *client,const MagickSizeType length,
+  const unsigned char *message)
+{
+  MagickOffsetType
+    count;
+
+  unsigned char
+    *buffer;
+
+  /*
+    Send a compressed pixel payload to the client.
+  */
+  buffer=(unsigned char *) NULL;
+  if (dpc_compress_bound(client->codec,length) != 0)
+    buffer=(unsigned char *) AcquireQuantumMemory(dpc_compress_bound(
+      client->codec,length),sizeof(*buffer));
+  if (buffer == (unsigned char *) NULL)
+    return(MagickFalse);
+  count=dpc_send_compressed(client->file,client->codec,length,message,buffer);
+  buffer=(unsigned char *) RelinquishMagickMemory(buffer);
+  if (count < 0)
+    return(MagickFalse);
+  client->bytes_sent+=(MagickSizeType) count;
+  return(MagickTrue);
+}
+
+static MagickBooleanType ReadDistributeCacheMetacontent(
+  DistributeCacheClient *client)
+{
+  const Quantum
+    *p;
+
+  const unsigned char
+    *metacontent;
 
   Image
     *image;
 
   MagickAddressType
-    key = (MagickAddressType) session_key;
+    key = (MagickAddressType) client->session_key;
+
+  MagickBooleanType
+    status;
 
   MagickOffsetType
     count;
@@ -671,56 +1611,143 @@ static MagickBooleanType ReadDistributeCachePixels(SplayTreeInfo *registry,
   RectangleInfo
     region;
 
-  unsigned char
-    message[MagickPathExtent],
-    *q;
+  size_t
+    id;
 
   /*
-    Read distributed pixel cache pixels.
+    Read distributed pixel cache metacontent.
   */
-  image=(Image *) GetValueFromSplayTree(registry,(const void *) key);
+  image=(Image *) GetValueFromSplayTree(client->registry,(const void *) key);
   if (image == (Image *) NULL)
     return(MagickFalse);
-  length=sizeof(region.width)+sizeof(region.height)+sizeof(region.x)+
-    sizeof(region.y)+sizeof(length);
-  count=dpc_read(file,length,message);
+  status=ReadDistributeCacheRequest(client->file,client->version,&id,&region,
+    &length);
+  if (status == MagickFalse)
+    return(MagickFalse);
+  p=GetVirtualPixels(image,region.x,region.y,region.width,region.height,
+    client->exception);
+  if (SendDistributeCacheReply(client->file,client->version,id,p !=
+      (const Quantum *) NULL ? MagickTrue : MagickFalse) == MagickFalse)
+    return(MagickFalse);
+  metacontent=(const unsigned char *) GetVirtualMetacontent(image);
+  count=dpc_send(client->file,length,metacontent);
+  if (count > 0)
+    client->bytes_sent+=(MagickSizeType) count;
   if (count != (MagickOffsetType) length)
     return(MagickFalse);
-  q=message;
-  (void) memcpy(&region.width,q,sizeof(region.width));
-  q+=(ptrdiff_t) sizeof(region.width);
-  (void) memcpy(&region.height,q,sizeof(region.height));
-  q+=(ptrdiff_t) sizeof(region.height);
-  (void) memcpy(&region.x,q,sizeof(region.x));
-  q+=(ptrdiff_t) sizeof(region.x);
-  (void) memcpy(&region.y,q,sizeof(region.y));
-  q+=(ptrdiff_t) sizeof(region.y);
-  (void) memcpy(&length,q,sizeof(length));
-  q+=(ptrdiff_t) sizeof(length);
+  return(MagickTrue);
+}
+
+static MagickBooleanType ReadDistributeCachePixels(
+  DistributeCacheClient *client,const MagickBooleanType compress)
+{
+  const Quantum
+    *p;
+
+  Image
+    *image;
+
+  MagickAddressType
+    key = (MagickAddressType) client->session_key;
+
+  MagickBooleanType
+    status;
+
+  MagickOffsetType
+    count;
+
+  MagickSizeType
+    length;
+
+  RectangleInfo
+    region;
+
+  size_t
+    id;
+
+  /*
+    Read distributed pixel cache pixels.
+  */
+  image=(Image *) GetValueFromSplayTree(client->registry,(const void *) key);
+  if (image == (Image *) NULL)
+    return(MagickFalse);
+  status=ReadDistributeCacheRequest(client->file,client->version,&id,&region,
+    &length);
+  if (status == MagickFalse)
+    return(MagickFalse);
+#if defined(MAGICKCORE_HAVE_LINUX_SENDFILE)
+  if (compress == MagickFalse)
+    {
+      int
+        file;
+
+      MagickOffsetType
+        offset;
+
+      /*
+        Send pixels held in a disk cache straight from the cache file.
+      */
+      file=GetPixelCacheRegionFile(image,&region,&offset);
+      if ((file != -1) && (length == ((MagickSizeType) region.width*
+          region.height*image->number_channels*sizeof(Quantum))))
+        {
+          if (SendDistributeCacheReply(client->file,client->version,id,
+              MagickTrue) == MagickFalse)
+            return(MagickFalse);
+          count=dpc_sendfile(client->file,file,offset,length);
+          if (count > 0)
+            {
+              client->bytes_sent+=(MagickSizeType) count;
+              client->zero_copy_bytes+=(MagickSizeType) count;
+            }
+          if (count != (MagickOffsetType) length)
+            return(MagickFalse);
+          return(MagickTrue);
+        }
+    }
+#endif
   p=GetVirtualPixels(image,region.x,region.y,region.width,region.height,
-    exception);
-  if (p == (const Quantum *) NULL)
+    client->exception);
+  if (SendDistributeCacheReply(client->file,client->version,id,p !=
+      (const Quantum *) NULL ? MagickTrue : MagickFalse) == MagickFalse)
     return(MagickFalse);
-  count=dpc_send(file,length,p);
+  if (compress != MagickFalse)
+    return(SendDistributeCachePayload(client,length,(const unsigned char *)
+      p));
+  count=dpc_send(client->file,length,p);
+  if (count > 0)
+    client->bytes_sent+=(MagickSizeType) count;
   if (count != (MagickOffsetType) length)
     return(MagickFalse);
   return(MagickTrue);
 }
 
+static void *RelinquishDistributeCacheEntry(void *entry)
+{
+  DistributeCacheEntry
+    *cache_entry;
+
+  cache_entry=(DistributeCacheEntry *) entry;
+  cache_entry->image=DestroyImageList(cache_entry->image);
+  return(RelinquishMagickMemory(cache_entry));
+}
+
 static void *RelinquishImageRegistry(void *image)
 {
   return((void *) DestroyImageList((Image *) image));
 }
 
 static MagickBooleanType WriteDistributeCacheMetacontent(
-  SplayTreeInfo *registry,SOCKET_TYPE file,const size_t session_key,
-  ExceptionInfo *exception)
+  DistributeCacheClient *client)
 {
   Image
     *image;
 
   MagickAddressType
-    key = (MagickAddressType) session_key;
+    key = (MagickAddressType) client->session_key;
+
+  MagickBooleanType
+    status;
 
   MagickOffsetType
     count;
@@ -734,53 +1761,46 @@ static MagickBooleanType WriteDistributeCacheMetacontent(
   RectangleInfo
     region;
 
+  size_t
+    id;
+
   unsigned char
-    message[MagickPathExtent],
-    *metacontent,
-    *p;
+    *metacontent;
 
   /*
     Write distributed pixel cache metacontent.
   */
-  key=session_key;
-  image=(Image *) GetValueFromSplayTree(registry,(const void *) key);
+  image=(Image *) GetValueFromSplayTree(client->registry,(const void *) key);
   if (image == (Image *) NULL)
     return(MagickFalse);
-  length=sizeof(region.width)+sizeof(region.height)+sizeof(region.x)+
-    sizeof(region.y)+sizeof(length);
-  count=dpc_read(file,length,message);
-  if (count != (MagickOffsetType) length)
+  status=ReadDistributeCacheRequest(client->file,client->version,&id,&region,
+    &length);
+  if (status == MagickFalse)
     return(MagickFalse);
-  p=message;
-  (void) memcpy(&region.width,p,sizeof(region.width));
-  p+=(ptrdiff_t) sizeof(region.width);
-  (void) memcpy(&region.height,p,sizeof(region.height));
-  p+=(ptrdiff_t) sizeof(region.height);
-  (void) memcpy(&region.x,p,sizeof(region.x));
-  p+=(ptrdiff_t) sizeof(region.x);
-  (void) memcpy(&region.y,p,sizeof(region.y));
-  p+=(ptrdiff_t) sizeof(region.y);
-  (void) memcpy(&length,p,sizeof(length));
-  p+=(ptrdiff_t) sizeof(length);
   q=GetAuthenticPixels(image,region.x,region.y,region.width,region.height,
-    exception);
+    client->exception);
   if (q == (Quantum *) NULL)
     return(MagickFalse);
   metacontent=(unsigned char *) GetAuthenticMetacontent(image);
-  count=dpc_read(file,length,metacontent);
+  count=dpc_read(client->file,length,metacontent);
+  if (count > 0)
+    client->bytes_received+=(MagickSizeType) count;
   if (count != (MagickOffsetType) length)
     return(MagickFalse);
-  return(SyncAuthenticPixels(image,exception));
+  return(SyncAuthenticPixels(image,client->exception));
 }
 
-static MagickBooleanType WriteDistributeCachePixels(SplayTreeInfo *registry,
-  SOCKET_TYPE file,const size_t session_key,ExceptionInfo *exception)
+static MagickBooleanType WriteDistributeCachePixels(
+  DistributeCacheClient *client,const MagickBooleanType compress)
 {
   Image
     *image;
 
   MagickAddressType
-    key = (MagickAddressType) session_key;
+    key = (MagickAddressType) client->session_key;
+
+  MagickBooleanType
+    status;
 
   MagickOffsetType
     count;
@@ -794,161 +1814,886 @@ static MagickBooleanType WriteDistributeCachePixels(SplayTreeInfo *registry,
   RectangleInfo
     region;
 
-  unsigned char
-    message[MagickPathExtent],
-    *p;
+  size_t
+    id;
 
   /*
     Write distributed pixel cache pixels.
   */
-  image=(Image *) GetValueFromSplayTree(registry,(const void *) key);
+  image=(Image *) GetValueFromSplayTree(client->registry,(const void *) key);
   if (image == (Image *) NULL)
     return(MagickFalse);
-  length=sizeof(region.width)+sizeof(region.height)+sizeof(region.x)+
-    sizeof(region.y)+sizeof(length);
-  count=dpc_read(file,length,message);
-  if (count != (MagickOffsetType) length)
+  status=ReadDistributeCacheRequest(client->file,client->version,&id,&region,
+    &length);
+  if (status == MagickFalse)
     return(MagickFalse);
-  p=message;
-  (void) memcpy(&region.width,p,sizeof(region.width));
-  p+=(ptrdiff_t) sizeof(region.width);
-  (void) memcpy(&region.height,p,sizeof(region.height));
-  p+=(ptrdiff_t) sizeof(region.height);
-  (void) memcpy(&region.x,p,sizeof(region.x));
-  p+=(ptrdiff_t) sizeof(region.x);
-  (void) memcpy(&region.y,p,sizeof(region.y));
-  p+=(ptrdiff_t) sizeof(region.y);
-  (void) memcpy(&length,p,sizeof(length));
-  p+=(ptrdiff_t) sizeof(length);
   q=GetAuthenticPixels(image,region.x,region.y,region.width,region.height,
-    exception);
+    client->exception);
   if (q == (Quantum *) NULL)
     return(MagickFalse);
-  count=dpc_read(file,length,(unsigned char *) q);
+  if (compress != MagickFalse)
+    {
+      if (ReadDistributeCachePayload(client,length,(unsigned char *) q) ==
+          MagickFalse)
+        return(MagickFalse);
+      return(SyncAuthenticPixels(image,client->exception));
+    }
+  count=dpc_read(client->file,length,(unsigned char *) q);
+  if (count > 0)
+    client->bytes_received+=(MagickSizeType) count;
   if (count != (MagickOffsetType) length)
     return(MagickFalse);
-  return(SyncAuthenticPixels(image,exception));
+  return(SyncAuthenticPixels(image,client->exception));
 }
 
-static HANDLER_RETURN_TYPE DistributePixelCacheClient(void *socket)
+static Image *AcquireDistributeCacheImage(const size_t cache_id,
+  const size_t owner)
 {
-  char
-    *shared_secret;
+  const DistributeCacheEntry
+    *entry;
 
-  ExceptionInfo
-    *exception;
+  Image
+    *image;
 
-  MagickBooleanType
-    status = MagickFalse;
+  MagickAddressType
+    key = (MagickAddressType) cache_id;
 
-  MagickOffsetType
-    count;
+  /*
+    Reference a cache opened by any connection to this server with the same
+    owner as the connection that asks for it.
+  */
+  image=(Image *) NULL;
+  LockSemaphoreInfo(cache_semaphore);
+  entry=(const DistributeCacheEntry *) GetValueFromSplayTree(cache_registry,
+    (const void *) key);
+  if ((entry != (const DistributeCacheEntry *) NULL) &&
+      (entry->owner == owner))
+    image=ReferenceImage(entry->image);
+  UnlockSemaphoreInfo(cache_semaphore);
+  return(image);
+}
 
-  size_t
-    key,
-    session_key;
+static Image *ExecuteDistributeCacheOperation(const Image *image,
+  const char *operation,ExceptionInfo *exception)
+{
+  char
+    keyword[MagickPathExtent],
+    *q,
+    token[MagickPathExtent];
 
-  SOCKET_TYPE
-    client_socket;
+  const char
+    *p;
 
-  SplayTreeInfo
-    *registry;
+  Image
+    *result;
 
-  StringInfo
-    *nonce;
+  MagickBooleanType
+    status;
 
-  unsigned char
-    command;
+  ssize_t
+    option;
 
   /*
-    Generate session key.
+    Parse an operation (e.g. level 0 65535 1) and return its result.
   */
-  shared_secret=GetPolicyValue("cache:shared-secret");
-  if (shared_secret == (char *) NULL)
-    ThrowFatalException(CacheFatalError,"shared secret required");
-  nonce=StringToStringInfo(shared_secret);
-  shared_secret=DestroyString(shared_secret);
-  session_key=GetMagickSignature(nonce);
-  nonce=DestroyStringInfo(nonce);
-  exception=AcquireExceptionInfo();
+  p=operation;
+  (void) GetNextToken(p,&p,MagickPathExtent,keyword);
+  if (LocaleCompare(keyword,"fx") == 0)
+    {
+      while (isspace((int) ((unsigned char) *p)) != 0)
+        p++;
+      if (IsFxRemoteExpression(image,p) == MagickFalse)
+        return((Image *) NULL);
+      return(FxImage(image,p,exception));
+    }
+  if (LocaleCompare(keyword,"morphology") == 0)
+    {
+      KernelInfo
+        *kernel;
+
+      (void) GetNextToken(p,&p,MagickPathExtent,token);
+      option=ParseCommandOption(MagickMorphologyOptions,MagickFalse,token);
+      if (option < 0)
+        return((Image *) NULL);
+      kernel=AcquireKernelInfo(p,exception);
+      if (kernel == (KernelInfo *) NULL)
+        return((Image *) NULL);
+      result=MorphologyImage(image,(MorphologyMethod) option,1,kernel,
+        exception);
+      kernel=DestroyKernelInfo(kernel);
+      return(result);
+    }
+  result=CloneImage(image,0,0,MagickTrue,exception);
+  if (result == (Image *) NULL)
+    return(result);
+  status=MagickFalse;
+  if (LocaleCompare(keyword,"colorspace") == 0)
+    {
+      (void) GetNextToken(p,&p,MagickPathExtent,token);
+      option=ParseCommandOption(MagickColorspaceOptions,MagickFalse,token);
+      (void) GetNextToken(p,&p,MagickPathExtent,token);
+      if (*token != '\0')
+        (void) SetImageArtifact(result,"color:illuminant",token);
+      if (option >= 0)
+        status=TransformImageColorspace(result,(ColorspaceType) option,
+          exception);
+    }
+  if (LocaleCompare(keyword,"evaluate") == 0)
+    {
+      double
+        value;
+
+      (void) GetNextToken(p,&p,MagickPathExtent,token);
+      option=ParseCommandOption(MagickEvaluateOptions,MagickFalse,token);
+      value=InterpretLocaleValue(p,&q);
+      p=q;
+      (void) GetNextToken(p,&p,MagickPathExtent,token);
+      (void) SetImageArtifact(result,"evaluate:clamp",token);
+      if (option >= 0)
+        status=EvaluateImage(result,(MagickEvaluateOperator) option,value,
+          exception);
+    }
+  if (LocaleCompare(keyword,"gamma") == 0)
+    status=GammaImage(result,InterpretLocaleValue(p,(char **) NULL),
+      exception);
+  if (LocaleCompare(keyword,"level") == 0)
+    {
+      double
+        black_point,
+        gamma,
+        white_point;
+
+      black_point=InterpretLocaleValue(p,&q);
+      white_point=InterpretLocaleValue(q,&q);
+      gamma=InterpretLocaleValue(q,&q);
+      status=LevelImage(result,black_point,white_point,gamma,exception);
+    }
+  if (LocaleCompare(keyword,"negate") == 0)
+    {
+      (void) GetNextToken(p,&p,MagickPathExtent,token);
+      status=NegateImage(result,IsStringTrue(token),exception);
+    }
+  if (status == MagickFalse)
+    result=DestroyImage(result);
+  return(result);
+}
+
+static Image *ExecuteDistributeCacheBands(const Image *image,
+  const char *operation,const size_t rows,const size_t stripe_rows,
+  const size_t number_stripes,const size_t stripe,const size_t halo,
+  const unsigned char *pixels,ExceptionInfo *exception)
+{
+  CacheView
+    *image_view,
+    *result_view;
+
+  Image
+    *result;
+
+  MagickBooleanType
+    status;
+
+  size_t
+    band,
+    extent,
+    number_bands;
+
+  ssize_t
+    y;
+
   /*
-    Process client commands.
+    Apply an operation on a neighborhood to each band of a stripe in turn,
+    framed by the rows of the adjacent bands the client read from the other
+    stripes.
   */
-  registry=NewSplayTree((int (*)(const void *,const void *)) NULL,
-    (void *(*)(void *)) NULL,RelinquishImageRegistry);
-  client_socket=(*(SOCKET_TYPE *) socket);
-  count=dpc_send(client_socket,sizeof(session_key),&session_key);
-  for (status=MagickFalse; ; )
+  result=CloneImage(image,0,0,MagickTrue,exception);
+  if (result == (Image *) NULL)
+    return(result);
+  status=MagickTrue;
+  extent=image->columns*image->number_channels*sizeof(Quantum);
+  number_bands=(rows+stripe_rows-1)/stripe_rows;
+  image_view=AcquireVirtualCacheView(image,exception);
+  result_view=AcquireAuthenticCacheView(result,exception);
+  y=0;
+  for (band=stripe; band < number_bands; band+=number_stripes)
   {
-    count=dpc_read(client_socket,1,(unsigned char *) &command);
-    if (count <= 0)
-      break;
-    count=dpc_read(client_socket,sizeof(key),(unsigned char *) &key);
-    if ((count != (MagickOffsetType) sizeof(key)) || (key != session_key))
-      break;
-    switch (command)
-    {
-      case 'o':
+    CacheView
+      *band_view;
+
+    const Quantum
+      *p;
+
+    Image
+      *band_image,
+      *transform_image;
+
+    Quantum
+      *q;
+
+    size_t
+      band_rows,
+      bottom,
+      top;
+
+    band_rows=GetDistributeCacheHalo(rows,stripe_rows,band,halo,&top,&bottom);
+    band_image=CloneImage(image,image->columns,top+band_rows+bottom,
+      MagickTrue,exception);
+    if (band_image == (Image *) NULL)
       {
-        status=OpenDistributeCache(registry,client_socket,session_key,
-          exception);
-        count=dpc_send(client_socket,sizeof(status),&status);
+        status=MagickFalse;
         break;
       }
-      case 'r':
+    band_view=AcquireAuthenticCacheView(band_image,exception);
+    p=GetCacheViewVirtualPixels(image_view,0,y,image->columns,band_rows,
+      exception);
+    q=QueueCacheViewAuthenticPixels(band_view,0,0,band_image->columns,
+      band_image->rows,exception);
+    if ((p == (const Quantum *) NULL) || (q == (Quantum *) NULL))
+      status=MagickFalse;
+    else
       {
-        status=ReadDistributeCachePixels(registry,client_socket,session_key,
-          exception);
-        break;
+        (void) memcpy(q,pixels,top*extent);
+        pixels+=(ptrdiff_t) top*extent;
+        (void) memcpy((unsigned char *) q+top*extent,p,band_rows*extent);
+        (void) memcpy((unsigned char *) q+(top+band_rows)*extent,pixels,
+          bottom*extent);
+        pixels+=(ptrdiff_t) bottom*extent;
+        status=SyncCacheViewAuthenticPixels(band_view,exception);
       }
-      case 'R':
+    band_view=DestroyCacheView(band_view);
+    transform_image=(Image *) NULL;
+    if (status != MagickFalse)
+      transform_image=ExecuteDistributeCacheOperation(band_image,operation,
+        exception);
+    band_image=DestroyImage(band_image);
+    if (transform_image == (Image *) NULL)
       {
-        status=ReadDistributeCacheMetacontent(registry,client_socket,
-          session_key,exception);
+        status=MagickFalse;
         break;
       }
-      case 'w':
+    /*
+      Keep the rows of the band itself.
+    */
+    band_view=AcquireVirtualCacheView(transform_image,exception);
+    p=GetCacheViewVirtualPixels(band_view,0,(ssize_t) top,
+      transform_image->columns,band_rows,exception);
+    q=GetCacheViewAuthenticPixels(result_view,0,y,result->columns,band_rows,
+      exception);
+    if ((p == (const Quantum *) NULL) || (q == (Quantum *) NULL) ||
+        (transform_image->number_channels != result->number_channels))
+      status=MagickFalse;
+    else
       {
-        status=WriteDistributeCachePixels(registry,client_socket,session_key,
-          exception);
-        break;
+        (void) memcpy(q,p,band_rows*extent);
+        status=SyncCacheViewAuthenticPixels(result_view,exception);
       }
-      case 'W':
+    band_view=DestroyCacheView(band_view);
+    transform_image=DestroyImage(transform_image);
+    if (status == MagickFalse)
+      break;
+    y+=(ssize_t) stripe_rows;
+  }
+  result_view=DestroyCacheView(result_view);
+  image_view=DestroyCacheView(image_view);
+  if (status == MagickFalse)
+    result=DestroyImage(result);
+  return(result);
+}
+
+static MagickBooleanType ApplyDistributeCacheOperation(
+  DistributeCacheClient *client)
+{
+  ChannelType
+    channel_mask;
+
+  char
+    *operation;
+
+  ColorspaceType
+    colorspace;
+
+  Image
+    *image,
+    *result,
+    *source;
+
+  MagickAddressType
+    key = (MagickAddressType) client->session_key;
+
+  MagickOffsetType
+    count;
+
+  MagickSizeType
+    extent,
+    length,
+    number_bytes;
+
+  PointInfo
+    resolution;
+
+  RectangleInfo
+    page;
+
+  size_t
+    band,
+    bottom,
+    depth,
+    halo,
+    id,
+    number_bands,
+    number_stripes,
+    rows,
+    source_id,
+    stripe,
+    stripe_rows,
+    top;
+
+  unsigned char
+    message[MagickPathExtent],
+    *p,
+    *pixels;
+
+  VirtualPixelMethod
+    method;
+
+  /*
+    Read the operation, the cache it reads (this or another cache on this
+    server), the stripe geometry, the image settings it depends on, and the
+    rows of the adjacent bands held by the other stripes.
+  */
+  image=(Image *) GetValueFromSplayTree(client->registry,(const void *) key);
+  if (image == (Image *) NULL)
+    return(MagickFalse);
+  number_bytes=sizeof(id)+sizeof(source_id)+sizeof(rows)+sizeof(stripe_rows)+
+    sizeof(number_stripes)+sizeof(stripe)+sizeof(halo)+sizeof(colorspace)+
+    sizeof(channel_mask)+sizeof(method)+sizeof(depth)+sizeof(resolution)+
+    sizeof(page)+sizeof(extent)+sizeof(length);
+  count=dpc_read(client->file,number_bytes,message);
+  if (count != (MagickOffsetType) number_bytes)
+    return(MagickFalse);
+  p=message;
+  (void) memcpy(&id,p,sizeof(id));
+  p+=(ptrdiff_t) sizeof(id);
+  (void) memcpy(&source_id,p,sizeof(source_id));
+  p+=(ptrdiff_t) sizeof(source_id);
+  (void) memcpy(&rows,p,sizeof(rows));
+  p+=(ptrdiff_t) sizeof(rows);
+  (void) memcpy(&stripe_rows,p,sizeof(stripe_rows));
+  p+=(ptrdiff_t) sizeof(stripe_rows);
+  (void) memcpy(&number_stripes,p,sizeof(number_stripes));
+  p+=(ptrdiff_t) sizeof(number_stripes);
+  (void) memcpy(&stripe,p,sizeof(stripe));
+  p+=(ptrdiff_t) sizeof(stripe);
+  (void) memcpy(&halo,p,sizeof(halo));
+  p+=(ptrdiff_t) sizeof(halo);
+  (void) memcpy(&colorspace,p,sizeof(colorspace));
+  p+=(ptrdiff_t) sizeof(colorspace);
+  (void) memcpy(&channel_mask,p,sizeof(channel_mask));
+  p+=(ptrdiff_t) sizeof(channel_mask);
+  (void) memcpy(&method,p,sizeof(method));
+  p+=(ptrdiff_t) sizeof(method);
+  (void) memcpy(&depth,p,sizeof(depth));
+  p+=(ptrdiff_t) sizeof(depth);
+  (void) memcpy(&resolution,p,sizeof(resolution));
+  p+=(ptrdiff_t) sizeof(resolution);
+  (void) memcpy(&page,p,sizeof(page));
+  p+=(ptrdiff_t) sizeof(page);
+  (void) memcpy(&extent,p,sizeof(extent));
+  p+=(ptrdiff_t) sizeof(extent);
+  (void) memcpy(&length,p,sizeof(length));
+  if ((extent > MagickMaxBufferExtent) || (stripe_rows == 0) ||
+      (number_stripes == 0) || (stripe >= number_stripes) ||
+      (rows > (number_stripes*image->rows)))
+    return(MagickFalse);
+  number_bytes=0;
+  if ((number_stripes > 1) && (halo != 0))
+    {
+      number_bands=(rows+stripe_rows-1)/stripe_rows;
+      for (band=stripe; band < number_bands; band+=number_stripes)
       {
-        status=WriteDistributeCacheMetacontent(registry,client_socket,
-          session_key,exception);
-        break;
+        (void) GetDistributeCacheHalo(rows,stripe_rows,band,halo,&top,
+          &bottom);
+        number_bytes+=(MagickSizeType) (top+bottom)*image->columns*
+          image->number_channels*sizeof(Quantum);
       }
-      case 'd':
-      {
-        status=DestroyDistributeCache(registry,session_key);
+    }
+  if (length != number_bytes)
+    return(MagickFalse);
+  operation=(char *) AcquireQuantumMemory((size_t) extent+1,
+    sizeof(*operation));
+  pixels=(unsigned char *) AcquireQuantumMemory((size_t) length+1,
+    sizeof(*pixels));
+  if ((operation == (char *) NULL) || (pixels == (unsigned char *) NULL))
+    {
+      if (pixels != (unsigned char *) NULL)
+        pixels=(unsigned char *) RelinquishMagickMemory(pixels);
+      if (operation != (char *) NULL)
+        operation=DestroyString(operation);
+      return(MagickFalse);
+    }
+  count=dpc_read(client->file,extent,(unsigned char *) operation);
+  if (count == (MagickOffsetType) extent)
+    count=dpc_read(client->file,length,pixels)-(MagickOffsetType) length;
+  else
+    count=(-1);
+  if (count != 0)
+    {
+      pixels=(unsigned char *) RelinquishMagickMemory(pixels);
+      operation=DestroyString(operation);
+      return(MagickFalse);
+    }
+  client->bytes_received+=extent+length;
+  operation[extent]='\0';
+  /*
+    Apply the operation to a copy of the cache; it is staged until every
+    stripe reports its status and the client commits or discards it.
+  */
+  result=(Image *) NULL;
+  source=AcquireDistributeCacheImage(source_id,client->owner);
+  if ((source != (Image *) NULL) && (source->columns == image->columns) &&
+      (source->rows == image->rows) &&
+      (source->number_channels == image->number_channels))
+    {
+      Image
+        *work;
+
+      work=CloneImage(source,0,0,MagickTrue,client->exception);
+      if (work != (Image *) NULL)
+        {
+          work->colorspace=colorspace;
+          work->depth=depth;
+          work->resolution=resolution;
+          work->page=page;
+          (void) SetImageChannelMask(work,channel_mask);
+          (void) SetImageVirtualPixelMethod(work,method,client->exception);
+          if ((number_stripes > 1) && (halo != 0))
+            result=ExecuteDistributeCacheBands(work,operation,rows,
+              stripe_rows,number_stripes,stripe,halo,pixels,
+              client->exception);
+          else
+            result=ExecuteDistributeCacheOperation(work,operation,
+              client->exception);
+          work=DestroyImage(work);
+        }
+    }
+  if (source != (Image *) NULL)
+    source=DestroyImage(source);
+  pixels=(unsigned char *) RelinquishMagickMemory(pixels);
+  operation=DestroyString(operation);
+  if (result != (Image *) NULL)
+    {
+      ssize_t
+        i;
+
+      /*
+        The result must keep the morphology of the cache.
+      */
+      if ((result->columns != image->columns) ||
+          (result->rows != image->rows) ||
+          (result->number_channels != image->number_channels))
+        result=DestroyImage(result);
+      else
+        for (i=0; i < (ssize_t) image->number_channels; i++)
+          if (GetPixelChannelChannel(result,i) !=
+              GetPixelChannelChannel(image,i))
+            {
+              result=DestroyImage(result);
+              break;
+            }
+      if (result != (Image *) NULL)
+        (void) SetImageChannelMask(result,image->channel_mask);
+    }
+  if (client->pending != (Image *) NULL)
+    client->pending=DestroyImage(client->pending);
+  client->pending=result;
+  (void) SendDistributeCacheReply(client->file,client->version,id,result !=
+    (Image *) NULL ? MagickTrue : MagickFalse);
+  return(MagickTrue);
+}
+
+static MagickBooleanType AddDistributeCacheEntry(
+  const DistributeCacheClient *client,Image *image)
+{
+  DistributeCacheEntry
+    *entry;
+
+  /*
+    Add (or replace) the registry entry of the cache of this connection; the
+    caller holds the cache semaphore.
+  */
+  entry=(DistributeCacheEntry *) AcquireMagickMemory(sizeof(*entry));
+  if (entry == (DistributeCacheEntry *) NULL)
+    return(MagickFalse);
+  entry->image=ReferenceImage(image);
+  entry->owner=client->owner;
+  if (AddValueToSplayTree(cache_registry,(const void *) (MagickAddressType)
+      client->cache_id,entry) == MagickFalse)
+    {
+      (void) RelinquishDistributeCacheEntry(entry);
+      return(MagickFalse);
+    }
+  return(MagickTrue);
+}
+
+static MagickBooleanType CommitDistributeCacheOperation(
+  DistributeCacheClient *client)
+{
+  MagickAddressType
+    key = (MagickAddressType) client->session_key;
+
+  MagickBooleanType
+    commit;
+
+  MagickOffsetType
+    count;
+
+  /*
+    Replace the cache with the staged result of an operation, or discard it.
+  */
+  count=dpc_read(client->file,sizeof(commit),(unsigned char *) &commit);
+  if (count != (MagickOffsetType) sizeof(commit))
+    return(MagickFalse);
+  if (client->pending == (Image *) NULL)
+    return(MagickTrue);
+  if (commit == MagickFalse)
+    {
+      client->pending=DestroyImage(client->pending);
+      return(MagickTrue);
+    }
+  if (client->cache_id != 0)
+    {
+      LockSemaphoreInfo(cache_semaphore);
+      (void) AddDistributeCacheEntry(client,client->pending);
+      UnlockSemaphoreInfo(cache_semaphore);
+    }
+  commit=AddValueToSplayTree(client->registry,(const void *) key,
+    client->pending);
+  client->pending=(Image *) NULL;
+  return(commit);
+}
+
+static void UnregisterDistributeCache(DistributeCacheClient *client)
+{
+  /*
+    Withdraw the cache of this connection from the server registry.
+  */
+  if (client->pending != (Image *) NULL)
+    client->pending=DestroyImage(client->pending);
+  if (client->cache_id == 0)
+    return;
+  LockSemaphoreInfo(cache_semaphore);
+  (void) DeleteNodeFromSplayTree(cache_registry,(const void *)
+    (MagickAddressType) client->cache_id);
+  UnlockSemaphoreInfo(cache_semaphore);
+  client->cache_id=0;
+}
+
+static void RegisterDistributeCache(DistributeCacheClient *client)
+{
+  Image
+    *image;
+
+  MagickAddressType
+    key = (MagickAddressType) client->session_key;
+
+  /*
+    Publish the cache of this connection to the server registry so that
+    operations sent over other connections with the same owner can read it.
+    The identifier is random so it cannot be guessed.
+  */
+  UnregisterDistributeCache(client);
+  image=(Image *) GetValueFromSplayTree(client->registry,(const void *) key);
+  if (image == (Image *) NULL)
+    return;
+  LockSemaphoreInfo(cache_semaphore);
+  do
+  {
+    client->cache_id=GetDistributeCacheKey();
+  } while (GetValueFromSplayTree(cache_registry,(const void *)
+             (MagickAddressType) client->cache_id) != (const void *) NULL);
+  if (AddDistributeCacheEntry(client,image) == MagickFalse)
+    client->cache_id=0;
+  UnlockSemaphoreInfo(cache_semaphore);
+}
+
+static DistributeCacheClient *AcquireDistributeCacheClient(SOCKET_TYPE file,
+  const struct sockaddr_in *address,const size_t session_key)
+{
+  DistributeCacheClient
+    *client;
+
+  /*
+    Greet a new connection with the session key.
+  */
+  client=(DistributeCacheClient *) AcquireCriticalMemory(sizeof(*client));
+  (void) memset(client,0,sizeof(*client));
+  client->file=file;
+  if (inet_ntop(AF_INET,(void *) &address->sin_addr,client->hostname,
+      (socklen_t) sizeof(client->hostname)) == (const char *) NULL)
+    (void) CopyMagickString(client->hostname,"unknown",MagickPathExtent);
+  client->session_key=session_key;
+  client->version=1;
+  client->registry=NewSplayTree((int (*)(const void *,const void *)) NULL,
+    (void *(*)(void *)) NULL,RelinquishImageRegistry);
+  client->exception=AcquireExceptionInfo();
+  client->status=MagickFalse;
+  client->timestamp=GetMagickTime();
+  dpc_nodelay(file);
+  (void) dpc_send(file,sizeof(session_key),&session_key);
+  return(client);
+}
+
+static void CloseDistributeCacheClient(DistributeCacheClient *client)
+{
+  /*
+    Report the final status, close the connection, and log its statistics.
+  */
+  (void) dpc_send(client->file,sizeof(client->status),&client->status);
+  CLOSE_SOCKET(client->file);
+  client->file=(SOCKET_TYPE) -1;
+  (void) LogMagickEvent(CacheEvent,GetMagickModule(),
+    "%s: %.20g requests, %.20g bytes received, %.20g bytes sent "
+    "(%.20g zero-copy), %.20g seconds",client->hostname,(double)
+    client->requests,(double) client->bytes_received,(double)
+    client->bytes_sent,(double) client->zero_copy_bytes,(double)
+    (GetMagickTime()-client->timestamp));
+  UnregisterDistributeCache(client);
+  client->exception=DestroyExceptionInfo(client->exception);
+  client->registry=DestroySplayTree(client->registry);
+}
+
+static MagickBooleanType ProcessDistributeCacheRequest(
+  DistributeCacheClient *client)
+{
+  MagickOffsetType
+    count;
+
+  size_t
+    key;
+
+  unsigned char
+    command;
+
+  /*
+    Serve one client command; false once the connection should be closed.
+  */
+  count=dpc_read(client->file,1,(unsigned char *) &command);
+  if (count <= 0)
+    return(MagickFalse);
+  count=dpc_read(client->file,sizeof(key),(unsigned char *) &key);
+  if ((count != (MagickOffsetType) sizeof(key)) ||
+      (key != client->session_key))
+    return(MagickFalse);
+  client->requests++;
+  switch (command)
+  {
+    case 'v':
+    {
+      int
+        client_codecs,
+        client_version;
+
+      /*
+        Agree on the highest protocol version both ends speak, and on a
+        payload codec from those the client offers.
+      */
+      client->status=MagickFalse;
+      count=dpc_read(client->file,sizeof(client_version),(unsigned char *)
+        &client_version);
+      if (count != (MagickOffsetType) sizeof(client_version))
         break;
-      }
-      default:
+      count=dpc_read(client->file,sizeof(client_codecs),(unsigned char *)
+        &client_codecs);
+      if (count != (MagickOffsetType) sizeof(client_codecs))
+        break;
+      count=dpc_read(client->file,sizeof(client->owner),(unsigned char *)
+        &client->owner);
+      if (count != (MagickOffsetType) sizeof(client->owner))
+        break;
+      client_version=MagickMax(MagickMin(client_version,DPCProtocolVersion),
+        1);
+      client->version=(size_t) client_version;
+      client->codec=client_version > 2 ? dpc_select_codec(client_codecs) : 0;
+      count=dpc_send(client->file,sizeof(client_version),&client_version);
+      if (count != (MagickOffsetType) sizeof(client_version))
         break;
+      count=dpc_send(client->file,sizeof(client->codec),&client->codec);
+      client->status=count == (MagickOffsetType) sizeof(client->codec) ?
+        MagickTrue : MagickFalse;
+      break;
     }
-    if (status == MagickFalse)
+    case 'o':
+    {
+      client->status=OpenDistributeCache(client->registry,client->file,
+        client->session_key,client->exception);
+      count=dpc_send(client->file,sizeof(client->status),&client->status);
+      if ((client->status != MagickFalse) && (client->version > 3))
+        {
+          /*
+            Protocol version 4 names the cache for operations that read it.
+          */
+          RegisterDistributeCache(client);
+          count=dpc_send(client->file,sizeof(client->cache_id),
+            &client->cache_id);
+        }
+      break;
+    }
+    case 'p':
+    case 'r':
+    {
+      client->status=ReadDistributeCachePixels(client,command == 'p' ?
+        MagickTrue : MagickFalse);
       break;
-    if (command == 'd')
+    }
+    case 'R':
+    {
+      client->status=ReadDistributeCacheMetacontent(client);
       break;
+    }
+    case 'P':
+    case 'w':
+    {
+      client->status=WriteDistributeCachePixels(client,command == 'P' ?
+        MagickTrue : MagickFalse);
+      break;
+    }
+    case 'W':
+    {
+      client->status=WriteDistributeCacheMetacontent(client);
+      break;
+    }
+    case 'x':
+    {
+      client->status=ApplyDistributeCacheOperation(client);
+      break;
+    }
+    case 'c':
+    {
+      client->status=CommitDistributeCacheOperation(client);
+      break;
+    }
+    case 'd':
+    {
+      client->status=DestroyDistributeCache(client->registry,
+        client->session_key);
+      break;
+    }
+    default:
+      break;
+  }
+  if (client->status == MagickFalse)
+    return(MagickFalse);
+  if (command == 'd')
+    return(MagickFalse);
+  return(MagickTrue);
+}
+
+#if defined(MAGICKCORE_HAVE_DISTRIBUTE_CACHE_EVENTS)
+static HANDLER_RETURN_TYPE DistributePixelCacheWorker(void *pipes)
+{
+  int
+    *files;
+
+  /*
+    Serve connections handed over by the dispatcher, then hand them back.
+  */
+  files=(int *) pipes;
+  for ( ; ; )
+  {
+    DistributeCacheClient
+      *client;
+
+    ssize_t
+      count;
+
+    count=read(files[0],&client,sizeof(client));
+    if (count != (ssize_t) sizeof(client))
+      {
+        if ((count == -1) && (errno == EINTR))
+          continue;
+        break;
+      }
+    for ( ; ; )
+    {
+      struct pollfd
+        event;
+
+      if (ProcessDistributeCacheRequest(client) == MagickFalse)
+        {
+          CloseDistributeCacheClient(client);
+          break;
+        }
+      /*
+        Keep serving pipelined requests that are already waiting.
+      */
+      event.fd=client->file;
+      event.events=POLLIN;
+      event.revents=0;
+      if (poll(&event,1,0) <= 0)
+        break;
+    }
+    while ((write(files[1],&client,sizeof(client)) == -1) && (errno == EINTR))
+      ;
   }
-  count=dpc_send(client_socket,sizeof(status),&status);
-  CLOSE_SOCKET(client_socket);
-  exception=DestroyExceptionInfo(exception);
-  registry=DestroySplayTree(registry);
   return(HANDLER_RETURN_VALUE);
 }
+#else
+static HANDLER_RETURN_TYPE DistributePixelCacheClient(void *socket)
+{
+  DistributeCacheClient
+    *client;
+
+  /*
+    Serve one connection until it closes.
+  */
+  client=(DistributeCacheClient *) socket;
+  while (ProcessDistributeCacheRequest(client) != MagickFalse)
+    ;
+  CloseDistributeCacheClient(client);
+  client=(DistributeCacheClient *) RelinquishMagickMemory(client);
+  return(HANDLER_RETURN_VALUE);
+}
+#endif
 
 MagickExport void DistributePixelCacheServer(const int port,
   ExceptionInfo *exception)
 {
   char
-    service[MagickPathExtent];
+    service[MagickPathExtent],
+    *shared_secret;
 
   int
     status;
 
-#if defined(MAGICKCORE_THREAD_SUPPORT)
+#if defined(MAGICKCORE_HAVE_DISTRIBUTE_CACHE_EVENTS)
+  DistributeCacheClient
+    **clients,
+    **polled;
+
+  pthread_attr_t
+    attributes;
+
+  pthread_t
+    threads;
+
+  size_t
+    extent,
+    number_clients,
+    number_workers;
+
+  ssize_t
+    i;
+
+  int
+    ready[2],
+    work[2];
+
+  static int
+    pipes[2];
+
+  struct pollfd
+    *events;
+#elif defined(MAGICKCORE_THREAD_SUPPORT)
   pthread_attr_t
     attributes;
 
@@ -961,6 +2706,12 @@ MagickExport void DistributePixelCacheServer(const int port,
   Not implemented!
 #endif
 
+  size_t
+    session_key;
+
+  StringInfo
+    *nonce;
+
   struct addrinfo
     *p;
 
@@ -983,6 +2734,20 @@ MagickExport void DistributePixelCacheServer(const int port,
 #if defined(MAGICKCORE_HAVE_WINSOCK2)
   InitializeWinsock2(MagickFalse);
 #endif
+  shared_secret=GetPolicyValue("cache:shared-secret");
+  if (shared_secret == (char *) NULL)
+    ThrowFatalException(CacheFatalError,"shared secret required");
+  nonce=StringToStringInfo(shared_secret);
+  shared_secret=DestroyString(shared_secret);
+  session_key=GetMagickSignature(nonce);
+  nonce=DestroyStringInfo(nonce);
+  if (cache_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&cache_semaphore);
+  LockSemaphoreInfo(cache_semaphore);
+  if (cache_registry == (SplayTreeInfo *) NULL)
+    cache_registry=NewSplayTree((int (*)(const void *,const void *)) NULL,
+      (void *(*)(void *)) NULL,RelinquishDistributeCacheEntry);
+  UnlockSemaphoreInfo(cache_semaphore);
   (void) memset(&hint,0,sizeof(hint));
   hint.ai_family=AF_INET;
   hint.ai_socktype=SOCK_STREAM;
@@ -1005,28 +2770,150 @@ MagickExport void DistributePixelCacheServer(const int port,
       (socklen_t) sizeof(one));
     if (status == -1)
       {
-        CLOSE_SOCKET(server_socket);
-        continue;
+        CLOSE_SOCKET(server_socket);
+        continue;
+      }
+    status=bind(server_socket,p->ai_addr,(socklen_t) p->ai_addrlen);
+    if (status == -1)
+      {
+        CLOSE_SOCKET(server_socket);
+        continue;
+      }
+    break;
+  }
+  if (p == (struct addrinfo *) NULL)
+    ThrowFatalException(CacheFatalError,"UnableToBind");
+  freeaddrinfo(result);
+  status=listen(server_socket,DPCPendingConnections);
+  if (status != 0)
+    ThrowFatalException(CacheFatalError,"UnableToListen");
+#if defined(MAGICKCORE_HAVE_DISTRIBUTE_CACHE_EVENTS)
+  /*
+    A dispatcher polls the idle connections and hands each one with pending
+    requests to a bounded pool of workers over a pipe; workers hand it back
+    over a second pipe when its requests are drained.
+  */
+#if defined(SIGPIPE)
+  (void) signal(SIGPIPE,SIG_IGN);
+#endif
+  if ((pipe(work) == -1) || (pipe(ready) == -1))
+    ThrowFatalException(CacheFatalError,"UnableToCreateClientThread");
+  pipes[0]=work[0];
+  pipes[1]=ready[1];
+  number_workers=(size_t) MagickMax(MagickMin(GetMagickResourceLimit(
+    ThreadResource),DPCMaxWorkers),1);
+  pthread_attr_init(&attributes);
+  for (i=0; i < (ssize_t) number_workers; i++)
+  {
+    status=pthread_create(&threads,&attributes,DistributePixelCacheWorker,
+      (void *) pipes);
+    if (status != 0)
+      ThrowFatalException(CacheFatalError,"UnableToCreateClientThread");
+  }
+  clients=(DistributeCacheClient **) NULL;
+  polled=(DistributeCacheClient **) NULL;
+  events=(struct pollfd *) NULL;
+  extent=0;
+  number_clients=0;
+  for ( ; ; )
+  {
+    size_t
+      number_events;
+
+    if ((number_clients+2) > extent)
+      {
+        extent=2*(number_clients+2);
+        clients=(DistributeCacheClient **) ResizeQuantumMemory(clients,extent,
+          sizeof(*clients));
+        polled=(DistributeCacheClient **) ResizeQuantumMemory(polled,extent,
+          sizeof(*polled));
+        events=(struct pollfd *) ResizeQuantumMemory(events,extent,
+          sizeof(*events));
+        if ((clients == (DistributeCacheClient **) NULL) ||
+            (polled == (DistributeCacheClient **) NULL) ||
+            (events == (struct pollfd *) NULL))
+          ThrowFatalException(ResourceLimitFatalError,
+            "MemoryAllocationFailed");
       }
-    status=bind(server_socket,p->ai_addr,(socklen_t) p->ai_addrlen);
+    events[0].fd=server_socket;
+    events[1].fd=ready[0];
+    number_events=2;
+    for (i=0; i < (ssize_t) number_clients; i++)
+      if (clients[i]->busy == MagickFalse)
+        {
+          polled[number_events]=clients[i];
+          events[number_events++].fd=clients[i]->file;
+        }
+    for (i=0; i < (ssize_t) number_events; i++)
+    {
+      events[i].events=POLLIN;
+      events[i].revents=0;
+    }
+    status=poll(events,(nfds_t) number_events,-1);
     if (status == -1)
       {
-        CLOSE_SOCKET(server_socket);
-        continue;
+        if (errno == EINTR)
+          continue;
+        ThrowFatalException(CacheFatalError,"UnableToEstablishConnection");
+      }
+    for (i=2; i < (ssize_t) number_events; i++)
+      if (events[i].revents != 0)
+        {
+          polled[i]->busy=MagickTrue;
+          while ((write(work[1],&polled[i],sizeof(*polled)) == -1) &&
+                 (errno == EINTR))
+            ;
+        }
+    if (events[1].revents != 0)
+      {
+        DistributeCacheClient
+          *idle[DPCPipelineDepth];
+
+        ssize_t
+          count,
+          j;
+
+        count=read(ready[0],idle,sizeof(idle));
+        for (j=0; j < (count/(ssize_t) sizeof(*idle)); j++)
+        {
+          idle[j]->busy=MagickFalse;
+          if (idle[j]->file != (SOCKET_TYPE) -1)
+            continue;
+          for (i=0; i < (ssize_t) number_clients; i++)
+            if (clients[i] == idle[j])
+              {
+                clients[i]=clients[--number_clients];
+                break;
+              }
+          idle[j]=(DistributeCacheClient *) RelinquishMagickMemory(idle[j]);
+        }
+      }
+    if (events[0].revents != 0)
+      {
+        SOCKET_TYPE
+          client_socket;
+
+        socklen_t
+          length;
+
+        length=(socklen_t) sizeof(address);
+        client_socket=accept(server_socket,(struct sockaddr *) &address,
+          &length);
+        if (client_socket == -1)
+          continue;
+        clients[number_clients++]=AcquireDistributeCacheClient(client_socket,
+          &address,session_key);
       }
-    break;
   }
-  if (p == (struct addrinfo *) NULL)
-    ThrowFatalException(CacheFatalError,"UnableToBind");
-  freeaddrinfo(result);
-  status=listen(server_socket,DPCPendingConnections);
-  if (status != 0)
-    ThrowFatalException(CacheFatalError,"UnableToListen");
+#else
 #if defined(MAGICKCORE_THREAD_SUPPORT)
   pthread_attr_init(&attributes);
 #endif
   for ( ; ; )
   {
+    DistributeCacheClient
+      *client;
+
     SOCKET_TYPE
       client_socket;
 
@@ -1037,18 +2924,20 @@ MagickExport void DistributePixelCacheServer(const int port,
     client_socket=accept(server_socket,(struct sockaddr *) &address,&length);
     if (client_socket == -1)
       ThrowFatalException(CacheFatalError,"UnableToEstablishConnection");
+    client=AcquireDistributeCacheClient(client_socket,&address,session_key);
 #if defined(MAGICKCORE_THREAD_SUPPORT)
     status=pthread_create(&threads,&attributes,DistributePixelCacheClient,
-      (void *) &client_socket);
+      (void *) client);
     if (status == -1)
       ThrowFatalException(CacheFatalError,"UnableToCreateClientThread");
 #elif defined(_MSC_VER)
-    if (CreateThread(0,0,DistributePixelCacheClient,(void*) &client_socket,0,&threadID) == (HANDLE) NULL)
+    if (CreateThread(0,0,DistributePixelCacheClient,(void*) client,0,&threadID) == (HANDLE) NULL)
       ThrowFatalException(CacheFatalError,"UnableToCreateClientThread");
 #else
     Not implemented!
 #endif
   }
+#endif
 }
 #endif
 
@@ -1068,6 +2957,12 @@ MagickExport void DistributePixelCacheServer(const int port,
 */
 MagickPrivate void DistributeCacheTerminus(void)
 {
+  if (owner_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&owner_semaphore);
+  LockSemaphoreInfo(owner_semaphore);
+  cache_owner=0;
+  UnlockSemaphoreInfo(owner_semaphore);
+  RelinquishSemaphoreInfo(&owner_semaphore);
 #ifdef MAGICKCORE_HAVE_WINSOCK2
   if (winsock2_semaphore == (SemaphoreInfo *) NULL)
     ActivateSemaphoreInfo(&winsock2_semaphore);
@@ -1199,8 +3094,9 @@ MagickPrivate int GetDistributeCachePort(const DistributeCacheInfo *server_info)
 %    o image: the image.
 %
 */
-MagickPrivate MagickBooleanType OpenDistributePixelCache(
-  DistributeCacheInfo *server_info,Image *image)
+static MagickBooleanType SendDistributeCacheCommand(
+  DistributeCacheInfo *server_info,const unsigned char *message,
+  const size_t length,unsigned char *reply,const size_t extent)
 {
   MagickBooleanType
     status;
@@ -1208,17 +3104,43 @@ MagickPrivate MagickBooleanType OpenDistributePixelCache(
   MagickOffsetType
     count;
 
+  /*
+    Send a command and wait for its status.  The receive lock is taken before
+    the send lock is released so replies are read in request order.
+  */
+  LockSemaphoreInfo(server_info->send_semaphore);
+  count=dpc_send(server_info->file,(MagickSizeType) length,message);
+  if (count != (MagickOffsetType) length)
+    {
+      UnlockSemaphoreInfo(server_info->send_semaphore);
+      return(MagickFalse);
+    }
+  LockSemaphoreInfo(server_info->receive_semaphore);
+  UnlockSemaphoreInfo(server_info->send_semaphore);
+  status=MagickFalse;
+  count=dpc_read(server_info->file,sizeof(status),(unsigned char *) &status);
+  if ((count == (MagickOffsetType) sizeof(status)) &&
+      (status != MagickFalse) && (extent != 0))
+    {
+      /*
+        Read the rest of the reply.
+      */
+      if (dpc_read(server_info->file,extent,reply) != (MagickOffsetType) extent)
+        status=MagickFalse;
+    }
+  UnlockSemaphoreInfo(server_info->receive_semaphore);
+  if (count != (MagickOffsetType) sizeof(status))
+    return(MagickFalse);
+  return(status);
+}
+
+static MagickBooleanType OpenDistributeCacheStripe(
+  DistributeCacheInfo *server_info,const Image *image,const size_t rows)
+{
   unsigned char
     message[MagickPathExtent],
     *p;
 
-  /*
-    Open distributed pixel cache.
-  */
-  assert(server_info != (DistributeCacheInfo *) NULL);
-  assert(server_info->signature == MagickCoreSignature);
-  assert(image != (Image *) NULL);
-  assert(image->signature == MagickCoreSignature);
   p=message;
   *p++='o';  /* open */
   /*
@@ -1236,8 +3158,8 @@ MagickPrivate MagickBooleanType OpenDistributePixelCache(
   p+=(ptrdiff_t) sizeof(image->channels);
   (void) memcpy(p,&image->columns,sizeof(image->columns));
   p+=(ptrdiff_t) sizeof(image->columns);
-  (void) memcpy(p,&image->rows,sizeof(image->rows));
-  p+=(ptrdiff_t) sizeof(image->rows);
+  (void) memcpy(p,&rows,sizeof(rows));
+  p+=(ptrdiff_t) sizeof(rows);
   (void) memcpy(p,&image->number_channels,sizeof(image->number_channels));
   p+=(ptrdiff_t) sizeof(image->number_channels);
   (void) memcpy(p,image->channel_map,MaxPixelChannels*
@@ -1245,13 +3167,51 @@ MagickPrivate MagickBooleanType OpenDistributePixelCache(
   p+=(ptrdiff_t) MaxPixelChannels*sizeof(*image->channel_map);
   (void) memcpy(p,&image->metacontent_extent,sizeof(image->metacontent_extent));
   p+=(ptrdiff_t) sizeof(image->metacontent_extent);
-  count=dpc_send(server_info->file,(MagickSizeType) (p-message),message);
-  if (count != (MagickOffsetType) (p-message))
-    return(MagickFalse);
-  status=MagickFalse;
-  count=dpc_read(server_info->file,sizeof(status),(unsigned char *) &status);
-  if (count != (MagickOffsetType) sizeof(status))
-    return(MagickFalse);
+  if (server_info->version < 4)
+    return(SendDistributeCacheCommand(server_info,message,(size_t)
+      (p-message),(unsigned char *) NULL,0));
+  return(SendDistributeCacheCommand(server_info,message,(size_t) (p-message),
+    (unsigned char *) &server_info->cache_id,sizeof(server_info->cache_id)));
+}
+
+MagickPrivate MagickBooleanType OpenDistributePixelCache(
+  DistributeCacheInfo *server_info,Image *image)
+{
+  MagickBooleanType
+    status;
+
+  size_t
+    number_bands,
+    stripe;
+
+  /*
+    Open distributed pixel cache.  Striped caches deal bands of stripe_rows
+    rows to the servers in turn; each server holds only its own bands.
+  */
+  assert(server_info != (DistributeCacheInfo *) NULL);
+  assert(server_info->signature == MagickCoreSignature);
+  assert(image != (Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  server_info->stripe_rows=MagickMax(image->rows,1);
+  if (server_info->number_stripes > 1)
+    server_info->stripe_rows=MagickMax(MagickMaxBufferExtent/MagickMax(
+      image->columns*image->number_channels*sizeof(Quantum),1),1);
+  number_bands=(image->rows+server_info->stripe_rows-1)/
+    server_info->stripe_rows;
+  status=MagickTrue;
+  for (stripe=0; stripe < server_info->number_stripes; stripe++)
+  {
+    size_t
+      rows;
+
+    rows=server_info->stripe_rows*MagickMax((number_bands+
+      server_info->number_stripes-stripe-1)/server_info->number_stripes,1);
+    if (server_info->number_stripes == 1)
+      rows=image->rows;
+    if (OpenDistributeCacheStripe(GetDistributeCacheStripe(server_info,stripe),
+        image,rows) == MagickFalse)
+      status=MagickFalse;
+  }
   return(status);
 }
 
@@ -1288,30 +3248,24 @@ MagickPrivate MagickBooleanType OpenDistributePixelCache(
 %    o metacontent: read these metacontent from the pixel cache.
 %
 */
-MagickPrivate MagickOffsetType ReadDistributePixelCacheMetacontent(
-  DistributeCacheInfo *server_info,const RectangleInfo *region,
-  const MagickSizeType length,unsigned char *metacontent)
-{
-  MagickOffsetType
-    count;
 
+static size_t FormatDistributeCacheRequest(
+  const DistributeCacheInfo *server_info,const int command,const size_t id,
+  const RectangleInfo *region,const MagickSizeType length,
+  unsigned char *message)
+{
   unsigned char
-    message[MagickPathExtent],
     *p;
 
-  /*
-    Read distributed pixel cache metacontent.
-  */
-  assert(server_info != (DistributeCacheInfo *) NULL);
-  assert(server_info->signature == MagickCoreSignature);
-  assert(region != (RectangleInfo *) NULL);
-  assert(metacontent != (unsigned char *) NULL);
-  if (length > (MagickSizeType) MAGICK_SSIZE_MAX)
-    return(-1);
   p=message;
-  *p++='R';
+  *p++=(unsigned char) command;
   (void) memcpy(p,&server_info->session_key,sizeof(server_info->session_key));
   p+=(ptrdiff_t) sizeof(server_info->session_key);
+  if (server_info->version > 1)
+    {
+      (void) memcpy(p,&id,sizeof(id));
+      p+=(ptrdiff_t) sizeof(id);
+    }
   (void) memcpy(p,&region->width,sizeof(region->width));
   p+=(ptrdiff_t) sizeof(region->width);
   (void) memcpy(p,&region->height,sizeof(region->height));
@@ -1322,10 +3276,273 @@ MagickPrivate MagickOffsetType ReadDistributePixelCacheMetacontent(
   p+=(ptrdiff_t) sizeof(region->y);
   (void) memcpy(p,&length,sizeof(length));
   p+=(ptrdiff_t) sizeof(length);
-  count=dpc_send(server_info->file,(MagickSizeType) (p-message),message);
-  if (count != (MagickOffsetType) (p-message))
+  return((size_t) (p-message));
+}
+
+static size_t GetDistributeCacheBand(const DistributeCacheInfo *server_info,
+  const ssize_t y,const size_t rows,const size_t band_rows,size_t *stripe,
+  ssize_t *local_y)
+{
+  size_t
+    band,
+    offset;
+
+  /*
+    Map an image row to its stripe and to the row on that stripe's server.
+  */
+  band=(size_t) y/server_info->stripe_rows;
+  offset=(size_t) y % server_info->stripe_rows;
+  *stripe=band % server_info->number_stripes;
+  *local_y=(ssize_t) ((band/server_info->number_stripes)*
+    server_info->stripe_rows+offset);
+  return(MagickMin(MagickMin(band_rows,server_info->stripe_rows-offset),rows));
+}
+
+static MagickOffsetType TransferDistributePixelCache(
+  DistributeCacheInfo *server_info,const int command,
+  const RectangleInfo *region,const MagickSizeType length,
+  unsigned char *magick_restrict buffer)
+{
+  DistributeCacheInfo
+    *stripe;
+
+  MagickBooleanType
+    status,
+    write;
+
+  MagickOffsetType
+    count;
+
+  MagickSizeType
+    extent;
+
+  RectangleInfo
+    band;
+
+  size_t
+    band_rows,
+    bands[DPCMaxStripes],
+    i,
+    requests[DPCMaxStripes],
+    rows;
+
+  ssize_t
+    local_y,
+    y,
+    y_end;
+
+  unsigned char
+    *compressed,
+    message[MagickPathExtent];
+
+  /*
+    Transfer the region in bands of rows.  Each round deals bands to the
+    stripes and sends up to DPCPipelineDepth requests to every stripe before
+    any reply is read, so the round trips to all servers overlap.
+  */
+  if (length > (MagickSizeType) MAGICK_SSIZE_MAX)
+    return(-1);
+  if ((length == 0) || (region->height == 0))
+    return(0);
+  if ((length % region->height) != 0)
+    return(-1);
+  extent=length/region->height;
+  band_rows=(size_t) MagickMax(MagickMaxBufferExtent/extent,1);
+  write=(command == 'w') || (command == 'W') ? MagickTrue : MagickFalse;
+  compressed=(unsigned char *) NULL;
+  if ((command == 'r') || (command == 'w'))
+    {
+      size_t
+        bound;
+
+      /*
+        Each stripe agreed on its own codec; size for the largest.
+      */
+      bound=0;
+      for (i=0; i < server_info->number_stripes; i++)
+      {
+        stripe=GetDistributeCacheStripe(server_info,i);
+        if (stripe->codec != 0)
+          bound=MagickMax(bound,dpc_compress_bound(stripe->codec,
+            band_rows*extent));
+      }
+      if (bound != 0)
+        {
+          compressed=(unsigned char *) AcquireQuantumMemory(bound,
+            sizeof(*compressed));
+          if (compressed == (unsigned char *) NULL)
+            return(-1);
+        }
+    }
+  status=MagickTrue;
+  y_end=region->y;
+  for (y=region->y; y < (region->y+(ssize_t) region->height); y=y_end)
+  {
+    size_t
+      stripe_index;
+
+    for (i=0; i < (DPCPipelineDepth*server_info->number_stripes); i++)
+    {
+      if (y_end >= (region->y+(ssize_t) region->height))
+        break;
+      y_end+=(ssize_t) GetDistributeCacheBand(server_info,y_end,(size_t)
+        (region->y+(ssize_t) region->height-y_end),band_rows,&stripe_index,
+        &local_y);
+    }
+    for (i=0; i < server_info->number_stripes; i++)
+    {
+      ssize_t
+        row;
+
+      bands[i]=0;
+      stripe=GetDistributeCacheStripe(server_info,i);
+      for (row=y; (status != MagickFalse) && (row < y_end); row+=(ssize_t) rows)
+      {
+        int
+          request;
+
+        unsigned char
+          *payload;
+
+        rows=GetDistributeCacheBand(server_info,row,(size_t) (y_end-row),
+          band_rows,&stripe_index,&local_y);
+        if (stripe_index != i)
+          continue;
+        if (bands[i]++ == 0)
+          {
+            LockSemaphoreInfo(stripe->send_semaphore);
+            requests[i]=stripe->request;
+          }
+        band=(*region);
+        band.y=local_y;
+        band.height=rows;
+        payload=buffer+(size_t) (row-region->y)*extent;
+        request=command;
+        if ((compressed != (unsigned char *) NULL) &&
+            (stripe->codec != 0))
+          request=command == 'r' ? 'p' : 'P';
+        count=(MagickOffsetType) FormatDistributeCacheRequest(stripe,request,
+          stripe->request++,&band,rows*extent,message);
+        if (dpc_send(stripe->file,(MagickSizeType) count,message) != count)
+          status=MagickFalse;
+        else
+          if (request == 'P')
+            {
+              if (dpc_send_compressed(stripe->file,stripe->codec,rows*extent,
+                  payload,compressed) < 0)
+                status=MagickFalse;
+            }
+          else
+            if (write != MagickFalse)
+              {
+                count=(MagickOffsetType) (rows*extent);
+                if (dpc_send(stripe->file,(MagickSizeType) count,payload) !=
+                    count)
+                  status=MagickFalse;
+              }
+      }
+      if (bands[i] == 0)
+        continue;
+      if ((write != MagickFalse) || (status == MagickFalse))
+        {
+          UnlockSemaphoreInfo(stripe->send_semaphore);
+          bands[i]=0;
+          continue;
+        }
+      LockSemaphoreInfo(stripe->receive_semaphore);
+      UnlockSemaphoreInfo(stripe->send_semaphore);
+    }
+    if (write != MagickFalse)
+      continue;
+    for (i=0; i < server_info->number_stripes; i++)
+    {
+      size_t
+        id;
+
+      ssize_t
+        row;
+
+      if (bands[i] == 0)
+        continue;
+      stripe=GetDistributeCacheStripe(server_info,i);
+      id=requests[i];
+      for (row=y; (status != MagickFalse) && (row < y_end); row+=(ssize_t) rows)
+      {
+        MagickBooleanType
+          reply;
+
+        size_t
+          reply_id,
+          stripe_index;
+
+        unsigned char
+          *payload;
+
+        rows=GetDistributeCacheBand(server_info,row,(size_t) (y_end-row),
+          band_rows,&stripe_index,&local_y);
+        if (stripe_index != i)
+          continue;
+        if (stripe->version > 1)
+          {
+            count=dpc_read(stripe->file,sizeof(reply_id),(unsigned char *)
+              &reply_id);
+            if ((count != (MagickOffsetType) sizeof(reply_id)) ||
+                (reply_id != id))
+              {
+                status=MagickFalse;
+                break;
+              }
+            reply=MagickFalse;
+            count=dpc_read(stripe->file,sizeof(reply),(unsigned char *)
+              &reply);
+            if ((count != (MagickOffsetType) sizeof(reply)) ||
+                (reply == MagickFalse))
+              {
+                status=MagickFalse;
+                break;
+              }
+          }
+        id++;
+        payload=buffer+(size_t) (row-region->y)*extent;
+        if ((compressed != (unsigned char *) NULL) &&
+            (stripe->codec != 0))
+          {
+            if (dpc_read_compressed(stripe->file,stripe->codec,rows*extent,
+                payload,compressed) < 0)
+              status=MagickFalse;
+          }
+        else
+          {
+            count=(MagickOffsetType) (rows*extent);
+            if (dpc_read(stripe->file,(MagickSizeType) count,payload) != count)
+              status=MagickFalse;
+          }
+      }
+      UnlockSemaphoreInfo(stripe->receive_semaphore);
+    }
+    if (status == MagickFalse)
+      break;
+  }
+  if (compressed != (unsigned char *) NULL)
+    compressed=(unsigned char *) RelinquishMagickMemory(compressed);
+  if (status == MagickFalse)
     return(-1);
-  return(dpc_read(server_info->file,length,metacontent));
+  return((MagickOffsetType) length);
+}
+
+MagickPrivate MagickOffsetType ReadDistributePixelCacheMetacontent(
+  DistributeCacheInfo *server_info,const RectangleInfo *region,
+  const MagickSizeType length,unsigned char *metacontent)
+{
+  /*
+    Read distributed pixel cache metacontent.
+  */
+  assert(server_info != (DistributeCacheInfo *) NULL);
+  assert(server_info->signature == MagickCoreSignature);
+  assert(region != (RectangleInfo *) NULL);
+  assert(metacontent != (unsigned char *) NULL);
+  return(TransferDistributePixelCache(server_info,'R',region,length,
+    metacontent));
 }
 
 /*
@@ -1365,13 +3582,6 @@ MagickPrivate MagickOffsetType ReadDistributePixelCachePixels(
   DistributeCacheInfo *server_info,const RectangleInfo *region,
   const MagickSizeType length,unsigned char *magick_restrict pixels)
 {
-  MagickOffsetType
-    count;
-
-  unsigned char
-    message[MagickPathExtent],
-    *p;
-
   /*
     Read distributed pixel cache pixels.
   */
@@ -1379,26 +3589,8 @@ MagickPrivate MagickOffsetType ReadDistributePixelCachePixels(
   assert(server_info->signature == MagickCoreSignature);
   assert(region != (RectangleInfo *) NULL);
   assert(pixels != (unsigned char *) NULL);
-  if (length > (MagickSizeType) MAGICK_SSIZE_MAX)
-    return(-1);
-  p=message;
-  *p++='r';
-  (void) memcpy(p,&server_info->session_key,sizeof(server_info->session_key));
-  p+=(ptrdiff_t) sizeof(server_info->session_key);
-  (void) memcpy(p,&region->width,sizeof(region->width));
-  p+=(ptrdiff_t) sizeof(region->width);
-  (void) memcpy(p,&region->height,sizeof(region->height));
-  p+=(ptrdiff_t) sizeof(region->height);
-  (void) memcpy(p,&region->x,sizeof(region->x));
-  p+=(ptrdiff_t) sizeof(region->x);
-  (void) memcpy(p,&region->y,sizeof(region->y));
-  p+=(ptrdiff_t) sizeof(region->y);
-  (void) memcpy(p,&length,sizeof(length));
-  p+=(ptrdiff_t) sizeof(length);
-  count=dpc_send(server_info->file,(MagickSizeType) (p-message),message);
-  if (count != (MagickOffsetType) (p-message))
-    return(-1);
-  return(dpc_read(server_info->file,length,pixels));
+  return(TransferDistributePixelCache(server_info,'r',region,length,
+    pixels));
 }
 
 /*
@@ -1431,8 +3623,8 @@ MagickPrivate MagickBooleanType RelinquishDistributePixelCache(
   MagickBooleanType
     status;
 
-  MagickOffsetType
-    count;
+  ssize_t
+    i;
 
   unsigned char
     message[MagickPathExtent],
@@ -1443,17 +3635,21 @@ MagickPrivate MagickBooleanType RelinquishDistributePixelCache(
   */
   assert(server_info != (DistributeCacheInfo *) NULL);
   assert(server_info->signature == MagickCoreSignature);
-  p=message;
-  *p++='d';
-  (void) memcpy(p,&server_info->session_key,sizeof(server_info->session_key));
-  p+=(ptrdiff_t) sizeof(server_info->session_key);
-  count=dpc_send(server_info->file,(MagickSizeType) (p-message),message);
-  if (count != (MagickOffsetType) (p-message))
-    return(MagickFalse);
-  status=MagickFalse;
-  count=dpc_read(server_info->file,sizeof(status),(unsigned char *) &status);
-  if (count != (MagickOffsetType) sizeof(status))
-    return(MagickFalse);
+  status=MagickTrue;
+  for (i=0; i < (ssize_t) server_info->number_stripes; i++)
+  {
+    DistributeCacheInfo
+      *stripe;
+
+    stripe=GetDistributeCacheStripe(server_info,(size_t) i);
+    p=message;
+    *p++='d';
+    (void) memcpy(p,&stripe->session_key,sizeof(stripe->session_key));
+    p+=(ptrdiff_t) sizeof(stripe->session_key);
+    if (SendDistributeCacheCommand(stripe,message,(size_t) (p-message),
+        (unsigned char *) NULL,0) == MagickFalse)
+      status=MagickFalse;
+  }
   return(status);
 }
 
@@ -1494,40 +3690,15 @@ MagickPrivate MagickOffsetType WriteDistributePixelCacheMetacontent(
   DistributeCacheInfo *server_info,const RectangleInfo *region,
   const MagickSizeType length,const unsigned char *metacontent)
 {
-  MagickOffsetType
-    count;
-
-  unsigned char
-    message[MagickPathExtent],
-    *p;
-
   /*
     Write distributed pixel cache metacontent.
   */
   assert(server_info != (DistributeCacheInfo *) NULL);
   assert(server_info->signature == MagickCoreSignature);
   assert(region != (RectangleInfo *) NULL);
-  assert(metacontent != (unsigned char *) NULL);
-  if (length > (MagickSizeType) MAGICK_SSIZE_MAX)
-    return(-1);
-  p=message;
-  *p++='W';
-  (void) memcpy(p,&server_info->session_key,sizeof(server_info->session_key));
-  p+=(ptrdiff_t) sizeof(server_info->session_key);
-  (void) memcpy(p,&region->width,sizeof(region->width));
-  p+=(ptrdiff_t) sizeof(region->width);
-  (void) memcpy(p,&region->height,sizeof(region->height));
-  p+=(ptrdiff_t) sizeof(region->height);
-  (void) memcpy(p,&region->x,sizeof(region->x));
-  p+=(ptrdiff_t) sizeof(region->x);
-  (void) memcpy(p,&region->y,sizeof(region->y));
-  p+=(ptrdiff_t) sizeof(region->y);
-  (void) memcpy(p,&length,sizeof(length));
-  p+=(ptrdiff_t) sizeof(length);
-  count=dpc_send(server_info->file,(MagickSizeType) (p-message),message);
-  if (count != (MagickOffsetType) (p-message))
-    return(-1);
-  return(dpc_send(server_info->file,length,metacontent));
+  assert(metacontent != (const unsigned char *) NULL);
+  return(TransferDistributePixelCache(server_info,'W',region,length,
+    (unsigned char *) metacontent));
 }
 
 /*
@@ -1568,13 +3739,6 @@ MagickPrivate MagickOffsetType WriteDistributePixelCachePixels(
   DistributeCacheInfo *server_info,const RectangleInfo *region,
   const MagickSizeType length,const unsigned char *magick_restrict pixels)
 {
-  MagickOffsetType
-    count;
-
-  unsigned char
-    message[MagickPathExtent],
-    *p;
-
   /*
     Write distributed pixel cache pixels.
   */
@@ -1582,24 +3746,6 @@ MagickPrivate MagickOffsetType WriteDistributePixelCachePixels(
   assert(server_info->signature == MagickCoreSignature);
   assert(region != (RectangleInfo *) NULL);
   assert(pixels != (const unsigned char *) NULL);
-  if (length > (MagickSizeType) MAGICK_SSIZE_MAX)
-    return(-1);
-  p=message;
-  *p++='w';
-  (void) memcpy(p,&server_info->session_key,sizeof(server_info->session_key));
-  p+=(ptrdiff_t) sizeof(server_info->session_key);
-  (void) memcpy(p,&region->width,sizeof(region->width));
-  p+=(ptrdiff_t) sizeof(region->width);
-  (void) memcpy(p,&region->height,sizeof(region->height));
-  p+=(ptrdiff_t) sizeof(region->height);
-  (void) memcpy(p,&region->x,sizeof(region->x));
-  p+=(ptrdiff_t) sizeof(region->x);
-  (void) memcpy(p,&region->y,sizeof(region->y));
-  p+=(ptrdiff_t) sizeof(region->y);
-  (void) memcpy(p,&length,sizeof(length));
-  p+=(ptrdiff_t) sizeof(length);
-  count=dpc_send(server_info->file,(MagickSizeType) (p-message),message);
-  if (count != (MagickOffsetType) (p-message))
-    return(-1);
-  return(dpc_send(server_info->file,length,pixels));
+  return(TransferDistributePixelCache(server_info,'w',region,length,
+    (unsigned char *) pixels));
 }
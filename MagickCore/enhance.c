@@ -2378,6 +2378,25 @@ MagickExport MagickBooleanType GammaImage(Image *image,const double gamma,
         image->colormap[i].alpha=(double) gamma_map[ScaleQuantumToMap(
           ClampToQuantum(image->colormap[i].alpha))];
     }
+  if (GetImagePixelCacheType(image) == DistributedCache)
+    {
+      char
+        operation[MagickPathExtent];
+
+      /*
+        Gamma-correct the pixels on the distributed cache servers.
+      */
+      (void) FormatLocaleString(operation,MagickPathExtent,"gamma %.20g",
+        gamma);
+      if (ApplyPixelCacheOperation(image,image,operation,0,exception) !=
+          MagickFalse)
+        {
+          gamma_map=(Quantum *) RelinquishMagickMemory(gamma_map);
+          if (image->gamma != 0.0)
+            image->gamma*=gamma;
+          return(MagickTrue);
+        }
+    }
   /*
     Gamma-correct image.
   */
@@ -2917,6 +2936,10 @@ MagickExport MagickBooleanType LevelImage(Image *image,const double black_point,
   CacheView
     *image_view;
 
+  double
+    exponent,
+    scale;
+
   MagickBooleanType
     status;
 
@@ -2953,11 +2976,27 @@ MagickExport MagickBooleanType LevelImage(Image *image,const double black_point,
         image->colormap[i].alpha=(double) ClampToQuantum(LevelPixel(black_point,
           white_point,gamma,image->colormap[i].alpha));
     }
+  if (GetImagePixelCacheType(image) == DistributedCache)
+    {
+      char
+        operation[MagickPathExtent];
+
+      /*
+        Level the pixels on the distributed cache servers.
+      */
+      (void) FormatLocaleString(operation,MagickPathExtent,
+        "level %.20g %.20g %.20g",black_point,white_point,gamma);
+      if (ApplyPixelCacheOperation(image,image,operation,0,exception) !=
+          MagickFalse)
+        return(MagickTrue);
+    }
   /*
-    Level image.
+    Level image, one channel plane of a row at a time.
   */
   status=MagickTrue;
   progress=0;
+  scale=MagickSafeReciprocal(white_point-black_point);
+  exponent=MagickSafeReciprocal(gamma);
   image_view=AcquireAuthenticCacheView(image,exception);
 #if defined(MAGICKCORE_OPENMP_SUPPORT)
   #pragma omp parallel for schedule(static) shared(progress,status) \
@@ -2965,38 +3004,45 @@ MagickExport MagickBooleanType LevelImage(Image *image,const double black_point,
 #endif
   for (y=0; y < (ssize_t) image->rows; y++)
   {
-    Quantum
-      *magick_restrict q;
-
     ssize_t
-      x;
+      j;
 
     if (status == MagickFalse)
       continue;
-    q=GetCacheViewAuthenticPixels(image_view,0,y,image->columns,1,exception);
-    if (q == (Quantum *) NULL)
-      {
-        status=MagickFalse;
-        continue;
-      }
-    for (x=0; x < (ssize_t) image->columns; x++)
+    for (j=0; j < (ssize_t) GetPixelChannels(image); j++)
     {
+      PixelChannel channel = GetPixelChannelChannel(image,j);
+      PixelTrait traits = GetPixelChannelTraits(image,channel);
+
+      Quantum
+        *magick_restrict q;
+
       ssize_t
-        j;
+        x;
 
-      for (j=0; j < (ssize_t) GetPixelChannels(image); j++)
-      {
-        PixelChannel channel = GetPixelChannelChannel(image,j);
-        PixelTrait traits = GetPixelChannelTraits(image,channel);
-        if ((traits & UpdatePixelTrait) == 0)
-          continue;
-        q[j]=ClampToQuantum(LevelPixel(black_point,white_point,gamma,
-          (double) q[j]));
-      }
-      q+=(ptrdiff_t) GetPixelChannels(image);
+      if ((traits & UpdatePixelTrait) == 0)
+        continue;
+      q=GetCacheViewAuthenticChannel(image_view,channel,0,y,image->columns,1,
+        exception);
+      if (q == (Quantum *) NULL)
+        {
+          status=MagickFalse;
+          break;
+        }
+      if (exponent == 1.0)
+        for (x=0; x < (ssize_t) image->columns; x++)
+          q[x]=ClampToQuantum((double) QuantumRange*(scale*((double) q[x]-
+            black_point)));
+      else
+        for (x=0; x < (ssize_t) image->columns; x++)
+          q[x]=ClampToQuantum((double) QuantumRange*gamma_pow(scale*((double)
+            q[x]-black_point),exponent));
+      if (SyncCacheViewAuthenticChannel(image_view,exception) == MagickFalse)
+        {
+          status=MagickFalse;
+          break;
+        }
     }
-    if (SyncCacheViewAuthenticPixels(image_view,exception) == MagickFalse)
-      status=MagickFalse;
     if (image->progress_monitor != (MagickProgressMonitor) NULL)
       {
         MagickBooleanType
@@ -3977,6 +4023,20 @@ MagickExport MagickBooleanType NegateImage(Image *image,
       if ((GetPixelBlueTraits(image) & UpdatePixelTrait) != 0)
         image->colormap[i].blue=(double) QuantumRange-image->colormap[i].blue;
     }
+  if (GetImagePixelCacheType(image) == DistributedCache)
+    {
+      char
+        operation[MagickPathExtent];
+
+      /*
+        Negate the pixels on the distributed cache servers.
+      */
+      (void) FormatLocaleString(operation,MagickPathExtent,"negate %s",
+        CommandOptionToMnemonic(MagickBooleanOptions,(ssize_t) grayscale));
+      if (ApplyPixelCacheOperation(image,image,operation,0,exception) !=
+          MagickFalse)
+        return(MagickTrue);
+    }
   /*
     Negate image.
   */
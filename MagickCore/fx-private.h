@@ -31,7 +31,8 @@ extern MagickPrivate FxInfo
 
 extern MagickPrivate MagickBooleanType
   FxEvaluateChannelExpression(FxInfo *,const PixelChannel,const ssize_t,
-   const ssize_t,double *,ExceptionInfo *);
+   const ssize_t,double *,ExceptionInfo *),
+  IsFxRemoteExpression(const Image *,const char *);
 
 #if defined(__cplusplus) || defined(c_plusplus)
 }
@@ -47,6 +47,7 @@
 #include "MagickCore/artifact.h"
 #include "MagickCore/attribute.h"
 #include "MagickCore/cache.h"
+#include "MagickCore/cache-private.h"
 #include "MagickCore/cache-view.h"
 #include "MagickCore/channel.h"
 #include "MagickCore/color.h"
@@ -4323,6 +4324,60 @@ FxInfo *DestroyFxInfo (FxInfo * pfx)
   return NULL;
 }
 
+/* Whether an expression may run on a distributed pixel cache server:
+   it must compile, and the compiled program must not print (debug()).
+   An @file expression is refused so a server never reads its own files.
+*/
+MagickPrivate MagickBooleanType IsFxRemoteExpression (const Image * image,
+  const char * expression)
+{
+  char chLimit;
+
+  ExceptionInfo * exception;
+
+  FxInfo * pfx;
+
+  MagickBooleanType status;
+
+  int i;
+
+  if ((expression == (const char *) NULL) || (*expression == '@'))
+    return MagickFalse;
+  exception = AcquireExceptionInfo ();
+  pfx = (FxInfo*) AcquireCriticalMemory (sizeof (*pfx));
+  memset (pfx, 0, sizeof (*pfx));
+  if (!InitFx (pfx, image, MagickFalse, exception)) {
+    pfx = (FxInfo*) RelinquishMagickMemory(pfx);
+    exception = DestroyExceptionInfo (exception);
+    return MagickFalse;
+  }
+  if (!BuildRPN (pfx)) {
+    (void) DeInitFx (pfx);
+    pfx = (FxInfo*) RelinquishMagickMemory(pfx);
+    exception = DestroyExceptionInfo (exception);
+    return MagickFalse;
+  }
+  pfx->expression = ConstantString (expression);
+  pfx->pex = (char *) pfx->expression;
+  pfx->teDepth = 0;
+  status = TranslateStatementList (pfx, ";", &chLimit);
+  if (pfx->teDepth || (chLimit != '\0' && chLimit != ';'))
+    status = MagickFalse;
+  if (pfx->DebugOpt)
+    status = MagickFalse;
+  for (i=0; (status != MagickFalse) && (i < pfx->usedElements); i++) {
+    if (pfx->Elements[i].operator_index == fDebug)
+      status = MagickFalse;
+  }
+  (void) DestroyRPN (pfx);
+  pfx->expression = DestroyString (pfx->expression);
+  pfx->pex = NULL;
+  (void) DeInitFx (pfx);
+  pfx = (FxInfo*) RelinquishMagickMemory(pfx);
+  exception = DestroyExceptionInfo (exception);
+  return status;
+}
+
 /* Following is substitute for FxImage().
 */
 MagickExport Image *FxImage(const Image *image,const char *expression,
@@ -4357,6 +4412,40 @@ MagickExport Image *FxImage(const Image *image,const char *expression,
     return(CloneImage(image,0,0,MagickTrue,exception));
   fx_image=CloneImage(image,0,0,MagickTrue,exception);
   if (!fx_image) return NULL;
+  if ((GetImagePixelCacheType(image) == DistributedCache) &&
+      (GetPreviousImageInList(image) == (Image *) NULL) &&
+      (GetNextImageInList(image) == (Image *) NULL))
+    {
+      char
+        *operation,
+        *program;
+
+      /*
+        Evaluate the expression on the distributed cache servers, unless its
+        compiled program prints.  An @file expression is read here and its
+        text sent instead.
+      */
+      program=(char *) NULL;
+      if ((*expression == '@') && (strlen(expression) > 1))
+        program=FileToString(expression,~0UL,exception);
+      if (program == (char *) NULL)
+        program=ConstantString(expression);
+      if (IsFxRemoteExpression(image,program) != MagickFalse)
+        {
+          operation=AcquireString("fx ");
+          (void) ConcatenateString(&operation,program);
+          fx_image->storage_class=DirectClass;
+          status=ApplyPixelCacheOperation(fx_image,image,operation,-1,
+            exception);
+          operation=DestroyString(operation);
+          if (status != MagickFalse)
+            {
+              program=DestroyString(program);
+              return(fx_image);
+            }
+        }
+      program=DestroyString(program);
+    }
   if (SetImageStorageClass(fx_image,DirectClass,exception) == MagickFalse) {
     fx_image=DestroyImage(fx_image);
     return NULL;
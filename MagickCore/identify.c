@@ -478,6 +478,9 @@ MagickExport MagickBooleanType IdentifyImage(Image *image,FILE *file,
     color[MagickPathExtent],
     key[MagickPathExtent];
 
+  CacheStatistics
+    cache_statistics;
+
   ChannelFeatures
     *channel_features;
 
@@ -1660,6 +1663,36 @@ MagickExport MagickBooleanType IdentifyImage(Image *image,FILE *file,
     CommandOptionToMnemonic(MagickCacheOptions,(ssize_t)
     GetImagePixelCacheType(image)));
   (void) FormatLocaleFile(file,"  Pixel cache type: %s\n",buffer);
+  artifact=GetImageArtifact(image,"identify:cache-statistics");
+  if ((((artifact != (const char *) NULL) &&
+        (IsStringTrue(artifact) != MagickFalse)) ||
+       ((GetLogEventMask() & CacheEvent) != 0)) &&
+      (GetImagePixelCacheStatistics(image,&cache_statistics) != MagickFalse))
+    {
+      (void) FormatLocaleFile(file,"  Pixel cache statistics:\n");
+      (void) FormatLocaleFile(file,"    Direct requests: %.20g\n",(double)
+        cache_statistics.direct_requests);
+      (void) FormatLocaleFile(file,"    Buffered requests: %.20g\n",(double)
+        cache_statistics.buffered_requests);
+      (void) FormatLocaleFile(file,"    Virtual requests: %.20g\n",(double)
+        cache_statistics.virtual_requests);
+      (void) FormatMagickSize(cache_statistics.disk_bytes_read,MagickTrue,"B",
+        MagickPathExtent,buffer);
+      (void) FormatLocaleFile(file,"    Disk read: %s\n",buffer);
+      (void) FormatMagickSize(cache_statistics.disk_bytes_written,MagickTrue,
+        "B",MagickPathExtent,buffer);
+      (void) FormatLocaleFile(file,"    Disk written: %s\n",buffer);
+      (void) FormatLocaleFile(file,"    Read-ahead requests: %.20g\n",
+        (double) cache_statistics.read_ahead_requests);
+      (void) FormatLocaleFile(file,"    Write-behind requests: %.20g\n",
+        (double) cache_statistics.write_behind_requests);
+      (void) FormatLocaleFile(file,"    Clones: %.20g\n",(double)
+        cache_statistics.clones);
+      (void) FormatLocaleFile(file,"    Promotions: %.20g\n",(double)
+        cache_statistics.promotions);
+      (void) FormatLocaleFile(file,"    Demotions: %.20g\n",(double)
+        cache_statistics.demotions);
+    }
   if (elapsed_time > MagickEpsilon)
     {
       (void) FormatMagickSize((MagickSizeType) ((double) image->columns*
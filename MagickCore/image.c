@@ -2247,28 +2247,15 @@ MagickExport MagickBooleanType ResetImagePixels(Image *image,
   MagickBooleanType
     status;
 
-  size_t
-    length;
-
   ssize_t
     y;
 
-  void
-    *pixels;
-
   assert(image != (Image *) NULL);
   assert(image->signature == MagickCoreSignature);
   if (IsEventLogging() != MagickFalse)
     (void) LogMagickEvent(TraceEvent,GetMagickModule(),"...");
-  pixels=AcquirePixelCachePixels(image,&length,exception);
-  if (pixels != (void *) NULL)
-    {
-      /*
-        Reset in-core image pixels.
-      */
-      (void) memset(pixels,0,length);
-      return(MagickTrue);
-    }
+  if (ResetPixelCachePixels(image) != MagickFalse)
+    return(MagickTrue);
   /*
     Reset image pixels.
   */
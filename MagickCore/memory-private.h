@@ -43,6 +43,15 @@ extern "C" {
 #define MagickAssumeAligned(address)  (address)
 #endif
 
+typedef enum
+{
+  UndefinedMemoryAdvice = 0x0000,
+  HugePageMemoryAdvice = 0x0001,
+  SequentialMemoryAdvice = 0x0002,
+  RandomMemoryAdvice = 0x0004,
+  PopulateMemoryAdvice = 0x0008
+} MemoryAdvice;
+
 static inline size_t OverAllocateMemory(const size_t length)
 {
   size_t
@@ -60,6 +69,9 @@ static inline size_t OverAllocateMemory(const size_t length)
 extern MagickPrivate MagickBooleanType
   ShredMagickMemory(void *,const size_t);
 
+extern MagickPrivate MemoryAdvice
+  AdviseMagickMemory(void *,const size_t,const MemoryAdvice);
+
 extern MagickPrivate void
   ResetVirtualAnonymousMemory(void),
   SetMaxMemoryRequest(const MagickSizeType),
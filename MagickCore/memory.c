@@ -75,6 +75,15 @@
 %  to allocate memory with private anonymous mapping rather than from the
 %  heap.
 %
+%  Alternatively, configure with --enable-thread-cache-memory (or define
+%  MAGICKCORE_THREAD_CACHE_MEMORY_SUPPORT) to front the standard library with
+%  a thread-caching allocator.  Requests up to 64K are rounded to one of four
+%  size classes per power of two and recycled through per-thread free lists,
+%  which exchange blocks in batches with a global depot so the per-row and
+%  per-thread buffers our filters acquire and relinquish rarely reach malloc()
+%  or contend for a lock.  The cache is installed as the
+%  default memory methods, so SetMagickMemoryMethods() still overrides it.
+%
 */
 
 /*
@@ -93,7 +102,14 @@
 #include "MagickCore/semaphore.h"
 #include "MagickCore/string_.h"
 #include "MagickCore/string-private.h"
+#include "MagickCore/thread_.h"
 #include "MagickCore/utility-private.h"
+
+#if defined(MAGICKCORE_THREAD_CACHE_MEMORY_SUPPORT) && \
+    (defined(MAGICKCORE_ANONYMOUS_MEMORY_SUPPORT) || \
+     !defined(MAGICKCORE_THREAD_SUPPORT))
+#undef MAGICKCORE_THREAD_CACHE_MEMORY_SUPPORT
+#endif
 
 /*
   Define declarations.
@@ -102,11 +118,20 @@
   ((size_t *) ((char *) (block)+(size)-2*sizeof(size_t)))
 #define BlockHeader(block)  ((size_t *) (block)-1)
 #define BlockThreshold  1024
+#define CachedBlockClass(memory) \
+  (*(size_t *) ((char *) (memory)-CacheHeaderSize))
+#define CacheClasses  44
+#define CacheHeaderSize  16
 #define MaxBlockExponent  16
 #define MaxBlocks ((BlockThreshold/(4*sizeof(size_t)))+MaxBlockExponent+1)
+#define MaxCacheBlocks  256
+#define MaxCacheExtent  65536
+#define MaxCacheLength  (128*1024)
+#define MaxDepotFactor  8
 #define MaxSegments  1024
 #define NextBlock(block)  ((char *) (block)+SizeOfBlock(block))
 #define NextBlockInList(block)  (*(void **) (block))
+#define NextCachedBlock(block)  (*(void **) (block))
 #define PreviousBlock(block)  ((char *) (block)-(*((size_t *) (block)-2)))
 #define PreviousBlockBit  0x01
 #define PreviousBlockInList(block)  (*((void **) (block)+1))
@@ -160,6 +185,19 @@ typedef struct _MagickMemoryMethods
     relinquish_aligned_memory_handler;
 } MagickMemoryMethods;
 
+typedef struct _MemoryCacheInfo
+{
+  void
+    *blocks[CacheClasses];
+
+  size_t
+    number_blocks[CacheClasses];
+
+  struct _MemoryCacheInfo
+    *previous,
+    *next;
+} MemoryCacheInfo;
+
 struct _MemoryInfo
 {
   char
@@ -202,6 +240,29 @@ static size_t
   max_profile_size = 0,
   virtual_anonymous_memory = 0;
 
+#if defined(MAGICKCORE_THREAD_CACHE_MEMORY_SUPPORT)
+static MemoryCacheInfo
+  memory_depot,
+  *memory_caches = (MemoryCacheInfo *) NULL;
+
+static MagickThreadKey
+  memory_cache_key;
+
+static SemaphoreInfo
+  *depot_semaphore = (SemaphoreInfo *) NULL;
+
+static volatile MagickBooleanType
+  memory_cache_instantiated = MagickFalse;
+
+/*
+  Forward declarations.
+*/
+static void
+  *AcquireCachedMemory(size_t),
+  RelinquishCachedMemory(void *),
+  *ResizeCachedMemory(void *,size_t);
+#endif
+
 #if defined _MSC_VER
 static void *MSCMalloc(size_t size)
 {
@@ -222,7 +283,11 @@ static void MSCFree(void* ptr)
 static MagickMemoryMethods
   memory_methods =
   {
-#if defined _MSC_VER
+#if defined(MAGICKCORE_THREAD_CACHE_MEMORY_SUPPORT)
+    (AcquireMemoryHandler) AcquireCachedMemory,
+    (ResizeMemoryHandler) ResizeCachedMemory,
+    (DestroyMemoryHandler) RelinquishCachedMemory,
+#elif defined _MSC_VER
     (AcquireMemoryHandler) MSCMalloc,
     (ResizeMemoryHandler) MSCRealloc,
     (DestroyMemoryHandler) MSCFree,
@@ -526,6 +591,279 @@ static void *AcquireBlock(size_t size)
   return(block);
 }
 #endif
+
+#if defined(MAGICKCORE_THREAD_CACHE_MEMORY_SUPPORT)
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   A c q u i r e C a c h e d M e m o r y                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  AcquireCachedMemory() returns a pointer to a block of memory at least size
+%  bytes suitably aligned for any use.  Small requests are served from the
+%  free list of the calling thread, which is refilled from the global depot
+%  before falling back to malloc().
+%
+%  The format of the AcquireCachedMemory method is:
+%
+%      void *AcquireCachedMemory(size_t size)
+%
+%  A description of each parameter follows:
+%
+%    o size: the size of the memory in bytes to allocate.
+%
+*/
+
+static inline size_t CacheClass(const size_t size)
+{
+  size_t
+    exponent;
+
+  /*
+    Four size classes per power of two: 16, 32, 48, 64, 80, 96, 112, 128, ...
+  */
+  assert((size != 0) && (size <= MaxCacheExtent));
+  if (size <= 64)
+    return((size-1)/16);
+  for (exponent=6; ((size-1) >> (exponent+1)) != 0; exponent++) ;
+  return(4*(exponent-5)+(((size-1) >> (exponent-2)) & 0x03));
+}
+
+static inline size_t CacheClassExtent(const size_t i)
+{
+  size_t
+    exponent;
+
+  if (i < 4)
+    return(16*(i+1));
+  exponent=i/4+5;
+  return(((size_t) 1 << exponent)+(i % 4+1)*((size_t) 1 << (exponent-2)));
+}
+
+static inline size_t CacheLimit(const size_t i)
+{
+  /*
+    Cache up to 128K per size class and thread.
+  */
+  return(MagickMin(MagickMax(MaxCacheLength/CacheClassExtent(i),4),
+    MaxCacheBlocks));
+}
+
+static void RelinquishCachedBlocks(void *block)
+{
+  void
+    *next;
+
+  for ( ; block != (void *) NULL; block=next)
+  {
+    next=NextCachedBlock(block);
+    free((char *) block-CacheHeaderSize);
+  }
+}
+
+static void FlushMemoryCache(MemoryCacheInfo *cache,const size_t i,
+  const size_t count)
+{
+  size_t
+    j;
+
+  void
+    *head,
+    *tail;
+
+  /*
+    Move a batch of blocks from the thread cache to the depot, or back to the
+    system if the depot already holds its share.
+  */
+  if ((count == 0) || (cache->blocks[i] == (void *) NULL))
+    return;
+  head=cache->blocks[i];
+  tail=head;
+  for (j=1; (j < count) && (NextCachedBlock(tail) != (void *) NULL); j++)
+    tail=NextCachedBlock(tail);
+  cache->blocks[i]=NextCachedBlock(tail);
+  cache->number_blocks[i]-=j;
+  NextCachedBlock(tail)=(void *) NULL;
+  LockSemaphoreInfo(depot_semaphore);
+  if ((memory_depot.number_blocks[i]+j) <= (MaxDepotFactor*CacheLimit(i)))
+    {
+      NextCachedBlock(tail)=memory_depot.blocks[i];
+      memory_depot.blocks[i]=head;
+      memory_depot.number_blocks[i]+=j;
+      head=(void *) NULL;
+    }
+  UnlockSemaphoreInfo(depot_semaphore);
+  RelinquishCachedBlocks(head);
+}
+
+static void DestroyMemoryCache(void *value)
+{
+  MemoryCacheInfo
+    *cache,
+    *p;
+
+  size_t
+    i;
+
+  /*
+    Return the blocks of an exiting thread to the depot, unless
+    DestroyMagickMemory() already reclaimed them.
+  */
+  cache=(MemoryCacheInfo *) value;
+  if (cache == (MemoryCacheInfo *) NULL)
+    return;
+  LockSemaphoreInfo(depot_semaphore);
+  for (p=memory_caches; p != (MemoryCacheInfo *) NULL; p=p->next)
+    if (p == cache)
+      break;
+  if (p == (MemoryCacheInfo *) NULL)
+    {
+      UnlockSemaphoreInfo(depot_semaphore);
+      return;
+    }
+  if (cache->previous != (MemoryCacheInfo *) NULL)
+    cache->previous->next=cache->next;
+  else
+    memory_caches=cache->next;
+  if (cache->next != (MemoryCacheInfo *) NULL)
+    cache->next->previous=cache->previous;
+  UnlockSemaphoreInfo(depot_semaphore);
+  for (i=0; i < CacheClasses; i++)
+    FlushMemoryCache(cache,i,cache->number_blocks[i]);
+  free(cache);
+}
+
+static MemoryCacheInfo *GetMemoryCache(void)
+{
+  MemoryCacheInfo
+    *cache;
+
+  if (memory_cache_instantiated == MagickFalse)
+    {
+      ActivateSemaphoreInfo(&depot_semaphore);
+      LockSemaphoreInfo(depot_semaphore);
+      if (memory_cache_instantiated == MagickFalse)
+        {
+          (void) memset(&memory_depot,0,sizeof(memory_depot));
+          if (CreateMagickThreadKey(&memory_cache_key,DestroyMemoryCache) !=
+              MagickFalse)
+            memory_cache_instantiated=MagickTrue;
+        }
+      UnlockSemaphoreInfo(depot_semaphore);
+      if (memory_cache_instantiated == MagickFalse)
+        return((MemoryCacheInfo *) NULL);
+    }
+  cache=(MemoryCacheInfo *) GetMagickThreadValue(memory_cache_key);
+  if (cache == (MemoryCacheInfo *) NULL)
+    {
+      cache=(MemoryCacheInfo *) calloc(1,sizeof(*cache));
+      if (cache == (MemoryCacheInfo *) NULL)
+        return((MemoryCacheInfo *) NULL);
+      if (SetMagickThreadValue(memory_cache_key,cache) == MagickFalse)
+        {
+          free(cache);
+          return((MemoryCacheInfo *) NULL);
+        }
+      /*
+        Track the thread caches so DestroyMagickMemory() can reclaim them.
+      */
+      LockSemaphoreInfo(depot_semaphore);
+      cache->next=memory_caches;
+      if (memory_caches != (MemoryCacheInfo *) NULL)
+        memory_caches->previous=cache;
+      memory_caches=cache;
+      UnlockSemaphoreInfo(depot_semaphore);
+    }
+  return(cache);
+}
+
+static void RefillMemoryCache(MemoryCacheInfo *cache,const size_t i)
+{
+  size_t
+    j;
+
+  void
+    *head,
+    *tail;
+
+  /*
+    Move up to half a thread cache worth of blocks from the depot.
+  */
+  LockSemaphoreInfo(depot_semaphore);
+  head=memory_depot.blocks[i];
+  if (head == (void *) NULL)
+    {
+      UnlockSemaphoreInfo(depot_semaphore);
+      return;
+    }
+  tail=head;
+  for (j=1; j < (CacheLimit(i)/2); j++)
+  {
+    if (NextCachedBlock(tail) == (void *) NULL)
+      break;
+    tail=NextCachedBlock(tail);
+  }
+  memory_depot.blocks[i]=NextCachedBlock(tail);
+  memory_depot.number_blocks[i]-=j;
+  UnlockSemaphoreInfo(depot_semaphore);
+  NextCachedBlock(tail)=cache->blocks[i];
+  cache->blocks[i]=head;
+  cache->number_blocks[i]+=j;
+}
+
+static void *AcquireCachedMemory(size_t size)
+{
+  MemoryCacheInfo
+    *cache;
+
+  size_t
+    i;
+
+  void
+    *block;
+
+  if (size > MaxCacheExtent)
+    {
+      /*
+        Large requests go straight to the system.
+      */
+      if (size > (SIZE_MAX-CacheHeaderSize))
+        {
+          errno=ENOMEM;
+          return((void *) NULL);
+        }
+      block=malloc(size+CacheHeaderSize);
+      if (block == (void *) NULL)
+        return((void *) NULL);
+      *(size_t *) block=CacheClasses;
+      return((char *) block+CacheHeaderSize);
+    }
+  i=CacheClass(size == 0 ? 1UL : size);
+  cache=GetMemoryCache();
+  if (cache != (MemoryCacheInfo *) NULL)
+    {
+      if (cache->blocks[i] == (void *) NULL)
+        RefillMemoryCache(cache,i);
+      block=cache->blocks[i];
+      if (block != (void *) NULL)
+        {
+          cache->blocks[i]=NextCachedBlock(block);
+          cache->number_blocks[i]--;
+          return(block);
+        }
+    }
+  block=malloc(CacheClassExtent(i)+CacheHeaderSize);
+  if (block == (void *) NULL)
+    return((void *) NULL);
+  *(size_t *) block=i;
+  return((char *) block+CacheHeaderSize);
+}
+#endif
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -806,6 +1144,102 @@ MagickExport MemoryInfo *AcquireVirtualMemory(const size_t count,
   return(memory_info);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   A d v i s e M a g i c k M e m o r y                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  AdviseMagickMemory() advises the kernel how a large memory region is
+%  expected to be used: backed by transparent huge pages, accessed
+%  sequentially or randomly, or pre-faulted so the page faults are taken up
+%  front rather than while the region is processed.  The region must be
+%  writable to pre-fault.  It returns the advice that was applied.
+%
+%  The format of the AdviseMagickMemory method is:
+%
+%      MemoryAdvice AdviseMagickMemory(void *memory,const size_t length,
+%        const MemoryAdvice advice)
+%
+%  A description of each parameter follows:
+%
+%    o memory: A pointer to a memory allocation.
+%
+%    o length: the length of the memory allocation in bytes.
+%
+%    o advice: the memory advice.
+%
+*/
+MagickPrivate MemoryAdvice AdviseMagickMemory(void *memory,const size_t length,
+  const MemoryAdvice advice)
+{
+  MemoryAdvice
+    status;
+
+  size_t
+    extent,
+    page_size;
+
+  unsigned char
+    *p;
+
+  status=UndefinedMemoryAdvice;
+  if ((memory == (void *) NULL) || (advice == UndefinedMemoryAdvice))
+    return(status);
+  /*
+    Advice applies to whole pages within the memory region.
+  */
+  page_size=(size_t) GetMagickPageSize();
+  p=(unsigned char *) MAGICKCORE_ALIGN_UP((size_t) memory,page_size);
+  if ((size_t) (p-(unsigned char *) memory) >= length)
+    return(status);
+  extent=(length-(size_t) (p-(unsigned char *) memory)) & ~(page_size-1);
+  if (extent == 0)
+    return(status);
+#if defined(MAGICKCORE_HAVE_MMAP) && defined(MADV_HUGEPAGE)
+  if (((advice & HugePageMemoryAdvice) != 0) &&
+      (madvise(p,extent,MADV_HUGEPAGE) == 0))
+    status=(MemoryAdvice) (status | HugePageMemoryAdvice);
+#endif
+#if defined(MAGICKCORE_HAVE_POSIX_MADVISE)
+  if (((advice & SequentialMemoryAdvice) != 0) &&
+      (posix_madvise(p,extent,POSIX_MADV_SEQUENTIAL) == 0))
+    status=(MemoryAdvice) (status | SequentialMemoryAdvice);
+  else
+    if (((advice & RandomMemoryAdvice) != 0) &&
+        (posix_madvise(p,extent,POSIX_MADV_RANDOM) == 0))
+      status=(MemoryAdvice) (status | RandomMemoryAdvice);
+#endif
+  if ((advice & PopulateMemoryAdvice) != 0)
+    {
+#if defined(MAGICKCORE_HAVE_MMAP) && defined(MADV_POPULATE_WRITE)
+      if (madvise(p,extent,MADV_POPULATE_WRITE) == 0)
+        return((MemoryAdvice) (status | PopulateMemoryAdvice));
+#endif
+      {
+        volatile unsigned char
+          *q;
+
+        size_t
+          i;
+
+        /*
+          Pre-fault by touching each page.
+        */
+        q=(volatile unsigned char *) p;
+        for (i=0; i < extent; i+=page_size)
+          q[i]=q[i];
+        status=(MemoryAdvice) (status | PopulateMemoryAdvice);
+      }
+    }
+  return(status);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -903,6 +1337,44 @@ MagickExport void DestroyMagickMemory(void)
   (void) memset(&memory_pool,0,sizeof(memory_pool));
   UnlockSemaphoreInfo(memory_semaphore);
   RelinquishSemaphoreInfo(&memory_semaphore);
+#elif defined(MAGICKCORE_THREAD_CACHE_MEMORY_SUPPORT)
+  MemoryCacheInfo
+    *cache;
+
+  ssize_t
+    i;
+
+  if (memory_cache_instantiated == MagickFalse)
+    return;
+  /*
+    Reclaim the caches of all threads, not just this one, and the depot.
+    Deleting the key keeps the destructor from running for threads that exit
+    later; their next request starts a new cache.
+  */
+  LockSemaphoreInfo(depot_semaphore);
+  if (memory_cache_instantiated == MagickFalse)
+    {
+      UnlockSemaphoreInfo(depot_semaphore);
+      return;
+    }
+  (void) SetMagickThreadValue(memory_cache_key,(void *) NULL);
+  (void) DeleteMagickThreadKey(memory_cache_key);
+  while (memory_caches != (MemoryCacheInfo *) NULL)
+  {
+    cache=memory_caches;
+    memory_caches=cache->next;
+    for (i=0; i < CacheClasses; i++)
+      RelinquishCachedBlocks(cache->blocks[i]);
+    free(cache);
+  }
+  for (i=0; i < CacheClasses; i++)
+  {
+    RelinquishCachedBlocks(memory_depot.blocks[i]);
+    memory_depot.blocks[i]=(void *) NULL;
+    memory_depot.number_blocks[i]=0;
+  }
+  memory_cache_instantiated=MagickFalse;
+  UnlockSemaphoreInfo(depot_semaphore);
 #endif
 }
 
@@ -1218,6 +1690,38 @@ MagickExport void *RelinquishAlignedMemory(void *memory)
 %    o memory: A pointer to a block of memory to free for reuse.
 %
 */
+
+#if defined(MAGICKCORE_THREAD_CACHE_MEMORY_SUPPORT)
+static void RelinquishCachedMemory(void *memory)
+{
+  MemoryCacheInfo
+    *cache;
+
+  size_t
+    i;
+
+  if (memory == (void *) NULL)
+    return;
+  i=CachedBlockClass(memory);
+  if (i >= CacheClasses)
+    {
+      free((char *) memory-CacheHeaderSize);
+      return;
+    }
+  cache=GetMemoryCache();
+  if (cache == (MemoryCacheInfo *) NULL)
+    {
+      free((char *) memory-CacheHeaderSize);
+      return;
+    }
+  NextCachedBlock(memory)=cache->blocks[i];
+  cache->blocks[i]=memory;
+  cache->number_blocks[i]++;
+  if (cache->number_blocks[i] > CacheLimit(i))
+    FlushMemoryCache(cache,i,CacheLimit(i)/2);
+}
+#endif
+
 MagickExport void *RelinquishMagickMemory(void *memory)
 {
   if (memory == (void *) NULL)
@@ -1432,6 +1936,45 @@ static inline void *ResizeBlock(void *block,size_t size)
 }
 #endif
 
+#if defined(MAGICKCORE_THREAD_CACHE_MEMORY_SUPPORT)
+static void *ResizeCachedMemory(void *memory,size_t size)
+{
+  size_t
+    i;
+
+  void
+    *block;
+
+  if (memory == (void *) NULL)
+    return(AcquireCachedMemory(size));
+  i=CachedBlockClass(memory);
+  if ((i >= CacheClasses) && (size > MaxCacheExtent))
+    {
+      if (size > (SIZE_MAX-CacheHeaderSize))
+        {
+          errno=ENOMEM;
+          return((void *) NULL);
+        }
+      block=realloc((char *) memory-CacheHeaderSize,size+CacheHeaderSize);
+      if (block == (void *) NULL)
+        return((void *) NULL);
+      return((char *) block+CacheHeaderSize);
+    }
+  if ((i < CacheClasses) && (size != 0) && (size <= MaxCacheExtent) &&
+      (CacheClass(size) == i))
+    return(memory);
+  block=AcquireCachedMemory(size);
+  if (block == (void *) NULL)
+    return((void *) NULL);
+  if (i < CacheClasses)
+    (void) memcpy(block,memory,MagickMin(CacheClassExtent(i),size));
+  else
+    (void) memcpy(block,memory,size);
+  RelinquishCachedMemory(memory);
+  return(block);
+}
+#endif
+
 MagickExport void *ResizeMagickMemory(void *memory,const size_t size)
 {
   void
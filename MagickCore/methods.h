@@ -67,6 +67,7 @@ extern "C" {
 #define AcquireRandomInfo  PrependMagickMethod(AcquireRandomInfo)
 #define AcquireResampleFilter  PrependMagickMethod(AcquireResampleFilter)
 #define AcquireResizeFilter  PrependMagickMethod(AcquireResizeFilter)
+#define AcquireResizeStreamInfo  PrependMagickMethod(AcquireResizeStreamInfo)
 #define AcquireSemaphoreInfo  PrependMagickMethod(AcquireSemaphoreInfo)
 #define AcquireSignatureInfo  PrependMagickMethod(AcquireSignatureInfo)
 #define AcquireStreamInfo  PrependMagickMethod(AcquireStreamInfo)
@@ -97,6 +98,7 @@ extern "C" {
 #define AppendImageFormat  PrependMagickMethod(AppendImageFormat)
 #define AppendImages  PrependMagickMethod(AppendImages)
 #define AppendImageToList  PrependMagickMethod(AppendImageToList)
+#define AppendStreamInfoOperation  PrependMagickMethod(AppendStreamInfoOperation)
 #define AppendValueToLinkedList  PrependMagickMethod(AppendValueToLinkedList)
 #define Ascii85Encode  PrependMagickMethod(Ascii85Encode)
 #define Ascii85Flush  PrependMagickMethod(Ascii85Flush)
@@ -276,6 +278,7 @@ extern "C" {
 #define DestroyRandomInfo  PrependMagickMethod(DestroyRandomInfo)
 #define DestroyResampleFilter  PrependMagickMethod(DestroyResampleFilter)
 #define DestroyResizeFilter  PrependMagickMethod(DestroyResizeFilter)
+#define DestroyResizeStreamInfo  PrependMagickMethod(DestroyResizeStreamInfo)
 #define DestroySignatureInfo  PrependMagickMethod(DestroySignatureInfo)
 #define DestroySplayTree  PrependMagickMethod(DestroySplayTree)
 #define DestroyStreamInfo  PrependMagickMethod(DestroyStreamInfo)
@@ -365,6 +368,7 @@ extern "C" {
 #define GetBlobSize  PrependMagickMethod(GetBlobSize)
 #define GetBlobStreamData  PrependMagickMethod(GetBlobStreamData)
 #define GetBlobStreamHandler  PrependMagickMethod(GetBlobStreamHandler)
+#define GetCacheViewAuthenticChannel  PrependMagickMethod(GetCacheViewAuthenticChannel)
 #define GetCacheViewAuthenticMetacontent  PrependMagickMethod(GetCacheViewAuthenticMetacontent)
 #define GetCacheViewAuthenticPixelQueue  PrependMagickMethod(GetCacheViewAuthenticPixelQueue)
 #define GetCacheViewAuthenticPixels  PrependMagickMethod(GetCacheViewAuthenticPixels)
@@ -372,6 +376,7 @@ extern "C" {
 #define GetCacheViewExtent  PrependMagickMethod(GetCacheViewExtent)
 #define GetCacheViewImage  PrependMagickMethod(GetCacheViewImage)
 #define GetCacheViewStorageClass  PrependMagickMethod(GetCacheViewStorageClass)
+#define GetCacheViewVirtualChannel  PrependMagickMethod(GetCacheViewVirtualChannel)
 #define GetCacheViewVirtualMetacontent  PrependMagickMethod(GetCacheViewVirtualMetacontent)
 #define GetCacheViewVirtualPixelQueue  PrependMagickMethod(GetCacheViewVirtualPixelQueue)
 #define GetCacheViewVirtualPixels  PrependMagickMethod(GetCacheViewVirtualPixels)
@@ -443,6 +448,7 @@ extern "C" {
 #define GetImageMoments  PrependMagickMethod(GetImageMoments)
 #define GetImageOption  PrependMagickMethod(GetImageOption)
 #define GetImagePerceptualHash  PrependMagickMethod(GetImagePerceptualHash)
+#define GetImagePixelCacheStatistics  PrependMagickMethod(GetImagePixelCacheStatistics)
 #define GetImagePixelCacheType  PrependMagickMethod(GetImagePixelCacheType)
 #define GetImageProfile  PrependMagickMethod(GetImageProfile)
 #define GetImageProperty  PrependMagickMethod(GetImageProperty)
@@ -571,6 +577,7 @@ extern "C" {
 #define GetPixelCacheMethods  PrependMagickMethod(GetPixelCacheMethods)
 #define GetPixelCacheNexusExtent  PrependMagickMethod(GetPixelCacheNexusExtent)
 #define GetPixelCachePixels  PrependMagickMethod(GetPixelCachePixels)
+#define GetPixelCacheStatistics  PrependMagickMethod(GetPixelCacheStatistics)
 #define GetPixelCacheStorageClass  PrependMagickMethod(GetPixelCacheStorageClass)
 #define GetPixelCacheTileSize  PrependMagickMethod(GetPixelCacheTileSize)
 #define GetPixelCacheVirtualMethod  PrependMagickMethod(GetPixelCacheVirtualMethod)
@@ -873,6 +880,7 @@ extern "C" {
 #define ReadImages  PrependMagickMethod(ReadImages)
 #define ReadInlineImage  PrependMagickMethod(ReadInlineImage)
 #define ReadPSDLayers  PrependMagickMethod(ReadPSDLayers)
+#define ReadResizeStream  PrependMagickMethod(ReadResizeStream)
 #define ReadStream  PrependMagickMethod(ReadStream)
 #define ReferenceBlob  PrependMagickMethod(ReferenceBlob)
 #define ReferenceImage  PrependMagickMethod(ReferenceImage)
@@ -1178,6 +1186,7 @@ extern "C" {
 #define SetSignatureDigest  PrependMagickMethod(SetSignatureDigest)
 #define SetStreamInfoClientData  PrependMagickMethod(SetStreamInfoClientData)
 #define SetStreamInfoMap  PrependMagickMethod(SetStreamInfoMap)
+#define SetStreamInfoResize  PrependMagickMethod(SetStreamInfoResize)
 #define SetStreamInfoStorageType  PrependMagickMethod(SetStreamInfoStorageType)
 #define SetStringInfoDatum  PrependMagickMethod(SetStringInfoDatum)
 #define SetStringInfoLength  PrependMagickMethod(SetStringInfoLength)
@@ -1205,6 +1214,7 @@ extern "C" {
 #define SortColormapByIntensity  PrependMagickMethod(SortColormapByIntensity)
 #define SortImagePixels  PrependMagickMethod(SortImagePixels)
 #define SparseColorImage  PrependMagickMethod(SparseColorImage)
+#define SpillPixelCache  PrependMagickMethod(SpillPixelCache)
 #define SpliceImageIntoList  PrependMagickMethod(SpliceImageIntoList)
 #define SpliceImage  PrependMagickMethod(SpliceImage)
 #define SplitImageList  PrependMagickMethod(SplitImageList)
@@ -1232,6 +1242,7 @@ extern "C" {
 #define SwirlImage  PrependMagickMethod(SwirlImage)
 #define SyncAuthenticPixelCacheNexus  PrependMagickMethod(SyncAuthenticPixelCacheNexus)
 #define SyncAuthenticPixels  PrependMagickMethod(SyncAuthenticPixels)
+#define SyncCacheViewAuthenticChannel  PrependMagickMethod(SyncCacheViewAuthenticChannel)
 #define SyncCacheViewAuthenticPixels  PrependMagickMethod(SyncCacheViewAuthenticPixels)
 #define SyncImageList  PrependMagickMethod(SyncImageList)
 #define SyncImagePixelCache  PrependMagickMethod(SyncImagePixelCache)
@@ -1430,6 +1441,7 @@ extern "C" {
 #define WriteImage  PrependMagickMethod(WriteImage)
 #define WriteImages  PrependMagickMethod(WriteImages)
 #define WritePSDLayers  PrependMagickMethod(WritePSDLayers)
+#define WriteResizeStream  PrependMagickMethod(WriteResizeStream)
 #define WriteStream  PrependMagickMethod(WriteStream)
 #define XAnimateBackgroundImage  PrependMagickMethod(XAnimateBackgroundImage)
 #define XAnimateImages  PrependMagickMethod(XAnimateImages)
@@ -51,6 +51,7 @@
 */
 #include "MagickCore/studio.h"
 #include "MagickCore/artifact.h"
+#include "MagickCore/cache-private.h"
 #include "MagickCore/cache-view.h"
 #include "MagickCore/channel.h"
 #include "MagickCore/color-private.h"
@@ -4215,9 +4216,55 @@ MagickExport Image *MorphologyImage(const Image *image,
         compose=(CompositeOperator)parse;
     }
   }
+  /* Convolve on the distributed cache servers that hold the pixels */
+  morphology_image=(Image *) NULL;
+  if ((GetImagePixelCacheType(image) == DistributedCache) &&
+      ((method == ConvolveMorphology) || (method == CorrelateMorphology)) &&
+      (iterations == 1) && (curr_kernel->next == (KernelInfo *) NULL) &&
+      (compose == UndefinedCompositeOp) && (fabs(bias) < MagickEpsilon))
+    {
+      char
+        buffer[MagickPathExtent],
+        *operation;
+
+      size_t
+        i;
+
+      ssize_t
+        halo;
+
+      (void) FormatLocaleString(buffer,MagickPathExtent,
+        "morphology %s %.20gx%.20g+%.20g+%.20g:",CommandOptionToMnemonic(
+        MagickMorphologyOptions,(ssize_t) method),(double) curr_kernel->width,
+        (double) curr_kernel->height,(double) curr_kernel->x,(double)
+        curr_kernel->y);
+      operation=AcquireString(buffer);
+      for (i=0; i < (curr_kernel->width*curr_kernel->height); i++)
+      {
+        if (IsNaN(curr_kernel->values[i]) != 0)
+          (void) FormatLocaleString(buffer,MagickPathExtent,"%snan",
+            i == 0 ? " " : ",");
+        else
+          (void) FormatLocaleString(buffer,MagickPathExtent,"%s%.20g",
+            i == 0 ? " " : ",",(double) curr_kernel->values[i]);
+        (void) ConcatenateString(&operation,buffer);
+      }
+      halo=MagickMax(curr_kernel->y,(ssize_t) curr_kernel->height-
+        curr_kernel->y-1);
+      morphology_image=CloneImage(image,0,0,MagickTrue,exception);
+      if (morphology_image != (Image *) NULL)
+        {
+          morphology_image->storage_class=DirectClass;
+          if (ApplyPixelCacheOperation(morphology_image,image,operation,halo,
+                exception) == MagickFalse)
+            morphology_image=DestroyImage(morphology_image);
+        }
+      operation=DestroyString(operation);
+    }
   /* Apply the Morphology */
-  morphology_image = MorphologyApply(image,method,iterations,
-    curr_kernel,compose,bias,exception);
+  if (morphology_image == (Image *) NULL)
+    morphology_image = MorphologyApply(image,method,iterations,
+      curr_kernel,compose,bias,exception);
 
   /* Cleanup and Exit */
   if ( curr_kernel != kernel )
@@ -18,6 +18,11 @@
 #ifndef MAGICKCORE_PIXEL_PRIVATE_H
 #define MAGICKCORE_PIXEL_PRIVATE_H
 
+#include "MagickCore/locale_.h"
+#include "MagickCore/pixel-accessor.h"
+#include "MagickCore/quantum.h"
+#include "MagickCore/quantum-private.h"
+
 #if defined(__cplusplus) || defined(c_plusplus)
 extern "C" {
 #endif
@@ -25,6 +30,572 @@ extern "C" {
 extern MagickPrivate MagickBooleanType
   ResetPixelChannelMap(Image *,ExceptionInfo *);
 
+static inline size_t GetPixelKernelOffsets(const Image *magick_restrict image,
+  const char *magick_restrict map,ssize_t *magick_restrict offsets)
+{
+  size_t
+    length;
+
+  ssize_t
+    i;
+
+  /*
+    Return the channel offsets for the maps the pixel kernels convert (any
+    order of R, G, B, and optionally A, or I for a grayscale image), or 0 if
+    the map requires the generic per-quantum path.
+  */
+  length=strlen(map);
+  if (length == 1)
+    {
+      if ((LocaleCompare(map,"I") != 0) || (image->number_channels != 1))
+        return(0);
+      offsets[0]=(ssize_t) GetPixelChannelOffset(image,GrayPixelChannel);
+      return(1);
+    }
+  if ((length != 3) && (length != 4))
+    return(0);
+  for (i=0; i < (ssize_t) length; i++)
+  {
+    PixelChannel
+      channel;
+
+    switch (map[i])
+    {
+      case 'R': case 'r': channel=RedPixelChannel; break;
+      case 'G': case 'g': channel=GreenPixelChannel; break;
+      case 'B': case 'b': channel=BluePixelChannel; break;
+      case 'A': case 'a': channel=AlphaPixelChannel; break;
+      default: return(0);
+    }
+    if (GetPixelChannelTraits(image,channel) == UndefinedPixelTrait)
+      return(0);
+    offsets[i]=(ssize_t) GetPixelChannelOffset(image,channel);
+  }
+  return(length);
+}
+
+static inline MagickBooleanType IsPixelKernelPacked(
+  const size_t number_channels,const ssize_t *magick_restrict offsets,
+  const size_t number_offsets)
+{
+  ssize_t
+    i;
+
+  if (number_channels != number_offsets)
+    return(MagickFalse);
+  for (i=0; i < (ssize_t) number_offsets; i++)
+    if (offsets[i] != i)
+      return(MagickFalse);
+  return(MagickTrue);
+}
+
+static inline void ExportCharPixelKernel(
+  const Quantum *magick_restrict p,const size_t number_channels,
+  const ssize_t *magick_restrict offsets,const size_t number_offsets,
+  const size_t number_pixels,unsigned char *magick_restrict q)
+{
+  ssize_t
+    x;
+
+  if (IsPixelKernelPacked(number_channels,offsets,number_offsets) !=
+      MagickFalse)
+    {
+      const ssize_t
+        extent = (ssize_t) (number_offsets*number_pixels);
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < extent; x++)
+        q[x]=ScaleQuantumToChar(p[x]);
+      return;
+    }
+  switch (number_offsets)
+  {
+    case 1:
+    {
+      const ssize_t
+        o0 = offsets[0];
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < (ssize_t) number_pixels; x++)
+        q[x]=ScaleQuantumToChar(p[x*(ssize_t) number_channels+o0]);
+      break;
+    }
+    case 3:
+    {
+      const ssize_t
+        o0 = offsets[0],
+        o1 = offsets[1],
+        o2 = offsets[2];
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < (ssize_t) number_pixels; x++)
+      {
+        const Quantum
+          *magick_restrict r = p+x*(ssize_t) number_channels;
+
+        q[3*x]=ScaleQuantumToChar(r[o0]);
+        q[3*x+1]=ScaleQuantumToChar(r[o1]);
+        q[3*x+2]=ScaleQuantumToChar(r[o2]);
+      }
+      break;
+    }
+    case 4:
+    {
+      const ssize_t
+        o0 = offsets[0],
+        o1 = offsets[1],
+        o2 = offsets[2],
+        o3 = offsets[3];
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < (ssize_t) number_pixels; x++)
+      {
+        const Quantum
+          *magick_restrict r = p+x*(ssize_t) number_channels;
+
+        q[4*x]=ScaleQuantumToChar(r[o0]);
+        q[4*x+1]=ScaleQuantumToChar(r[o1]);
+        q[4*x+2]=ScaleQuantumToChar(r[o2]);
+        q[4*x+3]=ScaleQuantumToChar(r[o3]);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+static inline void ExportShortPixelKernel(
+  const Quantum *magick_restrict p,const size_t number_channels,
+  const ssize_t *magick_restrict offsets,const size_t number_offsets,
+  const size_t number_pixels,unsigned short *magick_restrict q)
+{
+  ssize_t
+    x;
+
+  if (IsPixelKernelPacked(number_channels,offsets,number_offsets) !=
+      MagickFalse)
+    {
+      const ssize_t
+        extent = (ssize_t) (number_offsets*number_pixels);
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < extent; x++)
+        q[x]=ScaleQuantumToShort(p[x]);
+      return;
+    }
+  switch (number_offsets)
+  {
+    case 1:
+    {
+      const ssize_t
+        o0 = offsets[0];
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < (ssize_t) number_pixels; x++)
+        q[x]=ScaleQuantumToShort(p[x*(ssize_t) number_channels+o0]);
+      break;
+    }
+    case 3:
+    {
+      const ssize_t
+        o0 = offsets[0],
+        o1 = offsets[1],
+        o2 = offsets[2];
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < (ssize_t) number_pixels; x++)
+      {
+        const Quantum
+          *magick_restrict r = p+x*(ssize_t) number_channels;
+
+        q[3*x]=ScaleQuantumToShort(r[o0]);
+        q[3*x+1]=ScaleQuantumToShort(r[o1]);
+        q[3*x+2]=ScaleQuantumToShort(r[o2]);
+      }
+      break;
+    }
+    case 4:
+    {
+      const ssize_t
+        o0 = offsets[0],
+        o1 = offsets[1],
+        o2 = offsets[2],
+        o3 = offsets[3];
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < (ssize_t) number_pixels; x++)
+      {
+        const Quantum
+          *magick_restrict r = p+x*(ssize_t) number_channels;
+
+        q[4*x]=ScaleQuantumToShort(r[o0]);
+        q[4*x+1]=ScaleQuantumToShort(r[o1]);
+        q[4*x+2]=ScaleQuantumToShort(r[o2]);
+        q[4*x+3]=ScaleQuantumToShort(r[o3]);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+static inline void ExportFloatPixelKernel(
+  const Quantum *magick_restrict p,const size_t number_channels,
+  const ssize_t *magick_restrict offsets,const size_t number_offsets,
+  const size_t number_pixels,const double scale,const double minimum,
+  float *magick_restrict q)
+{
+  ssize_t
+    x;
+
+  if (IsPixelKernelPacked(number_channels,offsets,number_offsets) !=
+      MagickFalse)
+    {
+      const ssize_t
+        extent = (ssize_t) (number_offsets*number_pixels);
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < extent; x++)
+        q[x]=(float) ((QuantumScale*(double) p[x])*scale+minimum);
+      return;
+    }
+  switch (number_offsets)
+  {
+    case 1:
+    {
+      const ssize_t
+        o0 = offsets[0];
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < (ssize_t) number_pixels; x++)
+        q[x]=(float) ((QuantumScale*(double)
+          p[x*(ssize_t) number_channels+o0])*scale+minimum);
+      break;
+    }
+    case 3:
+    {
+      const ssize_t
+        o0 = offsets[0],
+        o1 = offsets[1],
+        o2 = offsets[2];
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < (ssize_t) number_pixels; x++)
+      {
+        const Quantum
+          *magick_restrict r = p+x*(ssize_t) number_channels;
+
+        q[3*x]=(float) ((QuantumScale*(double) r[o0])*scale+minimum);
+        q[3*x+1]=(float) ((QuantumScale*(double) r[o1])*scale+minimum);
+        q[3*x+2]=(float) ((QuantumScale*(double) r[o2])*scale+minimum);
+      }
+      break;
+    }
+    case 4:
+    {
+      const ssize_t
+        o0 = offsets[0],
+        o1 = offsets[1],
+        o2 = offsets[2],
+        o3 = offsets[3];
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < (ssize_t) number_pixels; x++)
+      {
+        const Quantum
+          *magick_restrict r = p+x*(ssize_t) number_channels;
+
+        q[4*x]=(float) ((QuantumScale*(double) r[o0])*scale+minimum);
+        q[4*x+1]=(float) ((QuantumScale*(double) r[o1])*scale+minimum);
+        q[4*x+2]=(float) ((QuantumScale*(double) r[o2])*scale+minimum);
+        q[4*x+3]=(float) ((QuantumScale*(double) r[o3])*scale+minimum);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+static inline void ImportCharPixelKernel(
+  const unsigned char *magick_restrict p,const size_t number_offsets,
+  const ssize_t *magick_restrict offsets,const size_t number_channels,
+  const size_t number_pixels,Quantum *magick_restrict q)
+{
+  ssize_t
+    x;
+
+  if (IsPixelKernelPacked(number_channels,offsets,number_offsets) !=
+      MagickFalse)
+    {
+      const ssize_t
+        extent = (ssize_t) (number_offsets*number_pixels);
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < extent; x++)
+        q[x]=ScaleCharToQuantum(p[x]);
+      return;
+    }
+  switch (number_offsets)
+  {
+    case 1:
+    {
+      const ssize_t
+        o0 = offsets[0];
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < (ssize_t) number_pixels; x++)
+        q[x*(ssize_t) number_channels+o0]=ScaleCharToQuantum(p[x]);
+      break;
+    }
+    case 3:
+    {
+      const ssize_t
+        o0 = offsets[0],
+        o1 = offsets[1],
+        o2 = offsets[2];
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < (ssize_t) number_pixels; x++)
+      {
+        Quantum
+          *magick_restrict r = q+x*(ssize_t) number_channels;
+
+        r[o0]=ScaleCharToQuantum(p[3*x]);
+        r[o1]=ScaleCharToQuantum(p[3*x+1]);
+        r[o2]=ScaleCharToQuantum(p[3*x+2]);
+      }
+      break;
+    }
+    case 4:
+    {
+      const ssize_t
+        o0 = offsets[0],
+        o1 = offsets[1],
+        o2 = offsets[2],
+        o3 = offsets[3];
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < (ssize_t) number_pixels; x++)
+      {
+        Quantum
+          *magick_restrict r = q+x*(ssize_t) number_channels;
+
+        r[o0]=ScaleCharToQuantum(p[4*x]);
+        r[o1]=ScaleCharToQuantum(p[4*x+1]);
+        r[o2]=ScaleCharToQuantum(p[4*x+2]);
+        r[o3]=ScaleCharToQuantum(p[4*x+3]);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+static inline void ImportShortPixelKernel(
+  const unsigned short *magick_restrict p,const size_t number_offsets,
+  const ssize_t *magick_restrict offsets,const size_t number_channels,
+  const size_t number_pixels,Quantum *magick_restrict q)
+{
+  ssize_t
+    x;
+
+  if (IsPixelKernelPacked(number_channels,offsets,number_offsets) !=
+      MagickFalse)
+    {
+      const ssize_t
+        extent = (ssize_t) (number_offsets*number_pixels);
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < extent; x++)
+        q[x]=ScaleShortToQuantum(p[x]);
+      return;
+    }
+  switch (number_offsets)
+  {
+    case 1:
+    {
+      const ssize_t
+        o0 = offsets[0];
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < (ssize_t) number_pixels; x++)
+        q[x*(ssize_t) number_channels+o0]=ScaleShortToQuantum(p[x]);
+      break;
+    }
+    case 3:
+    {
+      const ssize_t
+        o0 = offsets[0],
+        o1 = offsets[1],
+        o2 = offsets[2];
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < (ssize_t) number_pixels; x++)
+      {
+        Quantum
+          *magick_restrict r = q+x*(ssize_t) number_channels;
+
+        r[o0]=ScaleShortToQuantum(p[3*x]);
+        r[o1]=ScaleShortToQuantum(p[3*x+1]);
+        r[o2]=ScaleShortToQuantum(p[3*x+2]);
+      }
+      break;
+    }
+    case 4:
+    {
+      const ssize_t
+        o0 = offsets[0],
+        o1 = offsets[1],
+        o2 = offsets[2],
+        o3 = offsets[3];
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < (ssize_t) number_pixels; x++)
+      {
+        Quantum
+          *magick_restrict r = q+x*(ssize_t) number_channels;
+
+        r[o0]=ScaleShortToQuantum(p[4*x]);
+        r[o1]=ScaleShortToQuantum(p[4*x+1]);
+        r[o2]=ScaleShortToQuantum(p[4*x+2]);
+        r[o3]=ScaleShortToQuantum(p[4*x+3]);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+static inline void ImportFloatPixelKernel(
+  const float *magick_restrict p,const size_t number_offsets,
+  const ssize_t *magick_restrict offsets,const size_t number_channels,
+  const size_t number_pixels,Quantum *magick_restrict q)
+{
+  ssize_t
+    x;
+
+  if (IsPixelKernelPacked(number_channels,offsets,number_offsets) !=
+      MagickFalse)
+    {
+      const ssize_t
+        extent = (ssize_t) (number_offsets*number_pixels);
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < extent; x++)
+        q[x]=ClampToQuantum((double) QuantumRange*(double) p[x]);
+      return;
+    }
+  switch (number_offsets)
+  {
+    case 1:
+    {
+      const ssize_t
+        o0 = offsets[0];
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < (ssize_t) number_pixels; x++)
+        q[x*(ssize_t) number_channels+o0]=ClampToQuantum((double)
+          QuantumRange*(double) p[x]);
+      break;
+    }
+    case 3:
+    {
+      const ssize_t
+        o0 = offsets[0],
+        o1 = offsets[1],
+        o2 = offsets[2];
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < (ssize_t) number_pixels; x++)
+      {
+        Quantum
+          *magick_restrict r = q+x*(ssize_t) number_channels;
+
+        r[o0]=ClampToQuantum((double) QuantumRange*(double) p[3*x]);
+        r[o1]=ClampToQuantum((double) QuantumRange*(double) p[3*x+1]);
+        r[o2]=ClampToQuantum((double) QuantumRange*(double) p[3*x+2]);
+      }
+      break;
+    }
+    case 4:
+    {
+      const ssize_t
+        o0 = offsets[0],
+        o1 = offsets[1],
+        o2 = offsets[2],
+        o3 = offsets[3];
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp simd
+#endif
+      for (x=0; x < (ssize_t) number_pixels; x++)
+      {
+        Quantum
+          *magick_restrict r = q+x*(ssize_t) number_channels;
+
+        r[o0]=ClampToQuantum((double) QuantumRange*(double) p[4*x]);
+        r[o1]=ClampToQuantum((double) QuantumRange*(double) p[4*x+1]);
+        r[o2]=ClampToQuantum((double) QuantumRange*(double) p[4*x+2]);
+        r[o3]=ClampToQuantum((double) QuantumRange*(double) p[4*x+3]);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
 #if defined(__cplusplus) || defined(c_plusplus)
 }
 #endif
@@ -519,12 +519,28 @@ static MagickBooleanType ExportCharPixel(const Image *image,
     *magick_restrict q;
 
   size_t
-    length;
+    length,
+    number_offsets;
 
   ssize_t
+    offsets[MaxPixelChannels],
     y;
 
   q=(unsigned char *) pixels;
+  number_offsets=GetPixelKernelOffsets(image,map,offsets);
+  if (number_offsets != 0)
+    {
+      for (y=0; y < (ssize_t) roi->height; y++)
+      {
+        p=GetVirtualPixels(image,roi->x,roi->y+y,roi->width,1,exception);
+        if (p == (const Quantum *) NULL)
+          break;
+        ExportCharPixelKernel(p,GetPixelChannels(image),offsets,number_offsets,
+          roi->width,q);
+        q+=(ptrdiff_t) (number_offsets*roi->width);
+      }
+      return(y < (ssize_t) roi->height ? MagickFalse : MagickTrue);
+    }
   if (LocaleCompare(map,"BGR") == 0)
     {
       for (y=0; y < (ssize_t) roi->height; y++)
@@ -933,12 +949,28 @@ static MagickBooleanType ExportFloatPixel(const Image *image,
     x;
 
   size_t
-    length;
+    length,
+    number_offsets;
 
   ssize_t
+    offsets[MaxPixelChannels],
     y;
 
   q=(float *) pixels;
+  number_offsets=GetPixelKernelOffsets(image,map,offsets);
+  if (number_offsets != 0)
+    {
+      for (y=0; y < (ssize_t) roi->height; y++)
+      {
+        p=GetVirtualPixels(image,roi->x,roi->y+y,roi->width,1,exception);
+        if (p == (const Quantum *) NULL)
+          break;
+        ExportFloatPixelKernel(p,GetPixelChannels(image),offsets,number_offsets,
+          roi->width,1.0,0.0,q);
+        q+=(ptrdiff_t) (number_offsets*roi->width);
+      }
+      return(y < (ssize_t) roi->height ? MagickFalse : MagickTrue);
+    }
   if (LocaleCompare(map,"BGR") == 0)
     {
       for (y=0; y < (ssize_t) roi->height; y++)
@@ -1766,12 +1798,28 @@ static MagickBooleanType ExportShortPixel(const Image *image,
     *magick_restrict q;
 
   size_t
-    length;
+    length,
+    number_offsets;
 
   ssize_t
+    offsets[MaxPixelChannels],
     y;
 
   q=(unsigned short *) pixels;
+  number_offsets=GetPixelKernelOffsets(image,map,offsets);
+  if (number_offsets != 0)
+    {
+      for (y=0; y < (ssize_t) roi->height; y++)
+      {
+        p=GetVirtualPixels(image,roi->x,roi->y+y,roi->width,1,exception);
+        if (p == (const Quantum *) NULL)
+          break;
+        ExportShortPixelKernel(p,GetPixelChannels(image),offsets,number_offsets,
+          roi->width,q);
+        q+=(ptrdiff_t) (number_offsets*roi->width);
+      }
+      return(y < (ssize_t) roi->height ? MagickFalse : MagickTrue);
+    }
   if (LocaleCompare(map,"BGR") == 0)
     {
       for (y=0; y < (ssize_t) roi->height; y++)
@@ -2520,12 +2568,30 @@ static MagickBooleanType ImportCharPixel(Image *image,const RectangleInfo *roi,
     x;
 
   size_t
-    length;
+    length,
+    number_offsets;
 
   ssize_t
+    offsets[MaxPixelChannels],
     y;
 
   p=(const unsigned char *) pixels;
+  number_offsets=GetPixelKernelOffsets(image,map,offsets);
+  if (number_offsets != 0)
+    {
+      for (y=0; y < (ssize_t) roi->height; y++)
+      {
+        q=GetAuthenticPixels(image,roi->x,roi->y+y,roi->width,1,exception);
+        if (q == (Quantum *) NULL)
+          break;
+        ImportCharPixelKernel(p,number_offsets,offsets,GetPixelChannels(image),
+          roi->width,q);
+        p+=(ptrdiff_t) (number_offsets*roi->width);
+        if (SyncAuthenticPixels(image,exception) == MagickFalse)
+          break;
+      }
+      return(y < (ssize_t) roi->height ? MagickFalse : MagickTrue);
+    }
   if (LocaleCompare(map,"BGR") == 0)
     {
       for (y=0; y < (ssize_t) roi->height; y++)
@@ -3022,12 +3088,30 @@ static MagickBooleanType ImportFloatPixel(Image *image,const RectangleInfo *roi,
     x;
 
   size_t
-    length;
+    length,
+    number_offsets;
 
   ssize_t
+    offsets[MaxPixelChannels],
     y;
 
   p=(const float *) pixels;
+  number_offsets=GetPixelKernelOffsets(image,map,offsets);
+  if (number_offsets != 0)
+    {
+      for (y=0; y < (ssize_t) roi->height; y++)
+      {
+        q=GetAuthenticPixels(image,roi->x,roi->y+y,roi->width,1,exception);
+        if (q == (Quantum *) NULL)
+          break;
+        ImportFloatPixelKernel(p,number_offsets,offsets,GetPixelChannels(image),
+          roi->width,q);
+        p+=(ptrdiff_t) (number_offsets*roi->width);
+        if (SyncAuthenticPixels(image,exception) == MagickFalse)
+          break;
+      }
+      return(y < (ssize_t) roi->height ? MagickFalse : MagickTrue);
+    }
   if (LocaleCompare(map,"BGR") == 0)
     {
       for (y=0; y < (ssize_t) roi->height; y++)
@@ -3954,12 +4038,30 @@ static MagickBooleanType ImportShortPixel(Image *image,const RectangleInfo *roi,
     x;
 
   size_t
-    length;
+    length,
+    number_offsets;
 
   ssize_t
+    offsets[MaxPixelChannels],
     y;
 
   p=(const unsigned short *) pixels;
+  number_offsets=GetPixelKernelOffsets(image,map,offsets);
+  if (number_offsets != 0)
+    {
+      for (y=0; y < (ssize_t) roi->height; y++)
+      {
+        q=GetAuthenticPixels(image,roi->x,roi->y+y,roi->width,1,exception);
+        if (q == (Quantum *) NULL)
+          break;
+        ImportShortPixelKernel(p,number_offsets,offsets,GetPixelChannels(image),
+          roi->width,q);
+        p+=(ptrdiff_t) (number_offsets*roi->width);
+        if (SyncAuthenticPixels(image,exception) == MagickFalse)
+          break;
+      }
+      return(y < (ssize_t) roi->height ? MagickFalse : MagickTrue);
+    }
   if (LocaleCompare(map,"BGR") == 0)
     {
       for (y=0; y < (ssize_t) roi->height; y++)
@@ -22,6 +22,9 @@
 extern "C" {
 #endif
 
+typedef struct _ResizeStreamInfo
+  ResizeStreamInfo;
+
 typedef enum
 {
   BoxWeightingFunction = 0,
@@ -44,6 +47,9 @@ typedef enum
   LastWeightingFunction
 } ResizeWeightingFunctionType;
 
+extern MagickPrivate const Image
+  *ReadResizeStream(ResizeStreamInfo *,ExceptionInfo *);
+
 extern MagickPrivate double
   *GetResizeFilterCoefficient(const ResizeFilter*),
   GetResizeFilterBlur(const ResizeFilter *),
@@ -52,11 +58,20 @@ extern MagickPrivate double
   GetResizeFilterSupport(const ResizeFilter *),
   GetResizeFilterWeight(const ResizeFilter *,const double);
 
+extern MagickPrivate MagickBooleanType
+  WriteResizeStream(ResizeStreamInfo *,const Image *,const Quantum *,
+    ExceptionInfo *);
+
 extern MagickPrivate ResizeFilter
   *AcquireResizeFilter(const Image *,const FilterType,const MagickBooleanType,
     ExceptionInfo *),
   *DestroyResizeFilter(ResizeFilter *);
 
+extern MagickPrivate ResizeStreamInfo
+  *AcquireResizeStreamInfo(const Image *,const size_t,const size_t,
+    const FilterType,ExceptionInfo *),
+  *DestroyResizeStreamInfo(ResizeStreamInfo *);
+
 extern MagickPrivate ResizeWeightingFunctionType
   GetResizeFilterWeightingType(const ResizeFilter *),
   GetResizeFilterWindowWeightingType(const ResizeFilter *);
@@ -3331,6 +3331,89 @@ static ContributionInfo **AcquireContributionTLS(const size_t count)
   return(contribution);
 }
 
+static FilterType GetResizeFilterType(const Image *image,const double x_factor,
+  const double y_factor,const FilterType filter)
+{
+  /*
+    Lanczos unless the caller chose a filter; point if the size does not
+    change; Mitchell for colormapped or alpha images and for enlargements.
+  */
+  if (filter != UndefinedFilter)
+    return(filter);
+  if ((x_factor == 1.0) && (y_factor == 1.0))
+    return(PointFilter);
+  if ((image->storage_class == PseudoClass) ||
+      (image->alpha_trait != UndefinedPixelTrait) ||
+      ((x_factor*y_factor) > 1.0))
+    return(MitchellFilter);
+  return(LanczosFilter);
+}
+
+static double GetResizeContributionSupport(
+  const ResizeFilter *magick_restrict resize_filter,const double factor,
+  double *scale)
+{
+  double
+    support;
+
+  /*
+    Return the filter support in source pixels for a resize by factor, and
+    the scale from source pixels to filter units.
+  */
+  *scale=MagickMax(1.0/factor+MagickEpsilon,1.0);
+  support=(*scale)*GetResizeFilterSupport(resize_filter);
+  if (support < 0.5)
+    {
+      /*
+        Support too small even for nearest neighbour: Reduce to point sampling.
+      */
+      support=(double) 0.5;
+      *scale=1.0;
+    }
+  *scale=MagickSafeReciprocal(*scale);
+  return(support);
+}
+
+static ssize_t SetResizeContributions(
+  const ResizeFilter *magick_restrict resize_filter,const double bisect,
+  const double support,const double scale,const size_t extent,
+  ContributionInfo *magick_restrict contribution,ssize_t *start,ssize_t *stop)
+{
+  double
+    density;
+
+  ssize_t
+    n;
+
+  /*
+    Weigh the source pixels within the support of bisect and normalize their
+    weights; return the number of contributing pixels.
+  */
+  *start=(ssize_t) MagickMax(bisect-support+0.5,0.0);
+  *stop=(ssize_t) MagickMin(bisect+support+0.5,(double) extent);
+  density=0.0;
+  for (n=0; n < (*stop-*start); n++)
+  {
+    contribution[n].pixel=(*start)+n;
+    contribution[n].weight=GetResizeFilterWeight(resize_filter,scale*
+      ((double) (*start+n)-bisect+0.5));
+    density+=contribution[n].weight;
+  }
+  if ((n != 0) && (density != 0.0) && (density != 1.0))
+    {
+      ssize_t
+        i;
+
+      /*
+        Normalize.
+      */
+      density=MagickSafeReciprocal(density);
+      for (i=0; i < n; i++)
+        contribution[i].weight*=density;
+    }
+  return(n);
+}
+
 static MagickBooleanType HorizontalFilter(
   const ResizeFilter *magick_restrict resize_filter,
   const Image *magick_restrict image,Image *magick_restrict resize_image,
@@ -3362,19 +3445,10 @@ static MagickBooleanType HorizontalFilter(
   /*
     Apply filter to resize horizontally from image to resize image.
   */
-  scale=MagickMax(1.0/x_factor+MagickEpsilon,1.0);
-  support=scale*GetResizeFilterSupport(resize_filter);
+  support=GetResizeContributionSupport(resize_filter,x_factor,&scale);
   storage_class=support > 0.5 ? DirectClass : image->storage_class;
   if (SetImageStorageClass(resize_image,storage_class,exception) == MagickFalse)
     return(MagickFalse);
-  if (support < 0.5)
-    {
-      /*
-        Support too small even for nearest neighbour: Reduce to point sampling.
-      */
-      support=(double) 0.5;
-      scale=1.0;
-    }
   contributions=AcquireContributionTLS((size_t) (2.0*support+3.0));
   if (contributions == (ContributionInfo **) NULL)
     {
@@ -3383,7 +3457,6 @@ static MagickBooleanType HorizontalFilter(
       return(MagickFalse);
     }
   status=MagickTrue;
-  scale=MagickSafeReciprocal(scale);
   image_view=AcquireVirtualCacheView(image,exception);
   resize_view=AcquireAuthenticCacheView(resize_image,exception);
 #if defined(MAGICKCORE_OPENMP_SUPPORT)
@@ -3402,8 +3475,7 @@ static MagickBooleanType HorizontalFilter(
       *magick_restrict contribution;
 
     double
-      bisect,
-      density;
+      bisect;
 
     Quantum
       *magick_restrict q;
@@ -3417,31 +3489,11 @@ static MagickBooleanType HorizontalFilter(
     if (status == MagickFalse)
       continue;
     bisect=(double) (x+0.5)/x_factor+MagickEpsilon;
-    start=(ssize_t) MagickMax(bisect-support+0.5,0.0);
-    stop=(ssize_t) MagickMin(bisect+support+0.5,(double) image->columns);
-    density=0.0;
     contribution=contributions[id];
-    for (n=0; n < (stop-start); n++)
-    {
-      contribution[n].pixel=start+n;
-      contribution[n].weight=GetResizeFilterWeight(resize_filter,scale*
-        ((double) (start+n)-bisect+0.5));
-      density+=contribution[n].weight;
-    }
+    n=SetResizeContributions(resize_filter,bisect,support,scale,image->columns,
+      contribution,&start,&stop);
     if (n == 0)
       continue;
-    if ((density != 0.0) && (density != 1.0))
-      {
-        ssize_t
-          i;
-
-        /*
-          Normalize.
-        */
-        density=MagickSafeReciprocal(density);
-        for (i=0; i < n; i++)
-          contribution[i].weight*=density;
-      }
     p=GetCacheViewVirtualPixels(image_view,contribution[0].pixel,0,(size_t)
       (contribution[n-1].pixel-contribution[0].pixel+1),image->rows,exception);
     q=QueueCacheViewAuthenticPixels(resize_view,x,0,1,resize_image->rows,
@@ -3576,19 +3628,10 @@ static MagickBooleanType VerticalFilter(
   /*
     Apply filter to resize vertically from image to resize image.
   */
-  scale=MagickMax(1.0/y_factor+MagickEpsilon,1.0);
-  support=scale*GetResizeFilterSupport(resize_filter);
+  support=GetResizeContributionSupport(resize_filter,y_factor,&scale);
   storage_class=support > 0.5 ? DirectClass : image->storage_class;
   if (SetImageStorageClass(resize_image,storage_class,exception) == MagickFalse)
     return(MagickFalse);
-  if (support < 0.5)
-    {
-      /*
-        Support too small even for nearest neighbour: Reduce to point sampling.
-      */
-      support=(double) 0.5;
-      scale=1.0;
-    }
   contributions=AcquireContributionTLS((size_t) (2.0*support+3.0));
   if (contributions == (ContributionInfo **) NULL)
     {
@@ -3597,7 +3640,6 @@ static MagickBooleanType VerticalFilter(
       return(MagickFalse);
     }
   status=MagickTrue;
-  scale=MagickSafeReciprocal(scale);
   image_view=AcquireVirtualCacheView(image,exception);
   resize_view=AcquireAuthenticCacheView(resize_image,exception);
 #if defined(MAGICKCORE_OPENMP_SUPPORT)
@@ -3616,8 +3658,7 @@ static MagickBooleanType VerticalFilter(
       *magick_restrict contribution;
 
     double
-      bisect,
-      density;
+      bisect;
 
     Quantum
       *magick_restrict q;
@@ -3631,31 +3672,11 @@ static MagickBooleanType VerticalFilter(
     if (status == MagickFalse)
       continue;
     bisect=(double) (y+0.5)/y_factor+MagickEpsilon;
-    start=(ssize_t) MagickMax(bisect-support+0.5,0.0);
-    stop=(ssize_t) MagickMin(bisect+support+0.5,(double) image->rows);
-    density=0.0;
     contribution=contributions[id];
-    for (n=0; n < (stop-start); n++)
-    {
-      contribution[n].pixel=start+n;
-      contribution[n].weight=GetResizeFilterWeight(resize_filter,scale*
-        ((double) (start+n)-bisect+0.5));
-      density+=contribution[n].weight;
-    }
+    n=SetResizeContributions(resize_filter,bisect,support,scale,image->rows,
+      contribution,&start,&stop);
     if (n == 0)
       continue;
-    if ((density != 0.0) && (density != 1.0))
-      {
-        ssize_t
-          i;
-
-        /*
-          Normalize.
-        */
-        density=MagickSafeReciprocal(density);
-        for (i=0; i < n; i++)
-          contribution[i].weight*=density;
-      }
     p=GetCacheViewVirtualPixels(image_view,0,contribution[0].pixel,
       image->columns,(size_t) (contribution[n-1].pixel-contribution[0].pixel+1),
       exception);
@@ -3804,17 +3825,7 @@ MagickExport Image *ResizeImage(const Image *image,const size_t columns,
   */
   x_factor=(double) (columns*MagickSafeReciprocal((double) image->columns));
   y_factor=(double) (rows*MagickSafeReciprocal((double) image->rows));
-  filter_type=LanczosFilter;
-  if (filter != UndefinedFilter)
-    filter_type=filter;
-  else
-    if ((x_factor == 1.0) && (y_factor == 1.0))
-      filter_type=PointFilter;
-    else
-      if ((image->storage_class == PseudoClass) ||
-          (image->alpha_trait != UndefinedPixelTrait) ||
-          ((x_factor*y_factor) > 1.0))
-        filter_type=MitchellFilter;
+  filter_type=GetResizeFilterType(image,x_factor,y_factor,filter);
   resize_filter=AcquireResizeFilter(image,filter_type,MagickFalse,exception);
 #if defined(MAGICKCORE_OPENCL_SUPPORT)
   resize_image=AccelerateResizeImage(image,columns,rows,resize_filter,
@@ -3874,6 +3885,561 @@ MagickExport Image *ResizeImage(const Image *image,const size_t columns,
   return(resize_image);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   A c q u i r e R e s i z e S t r e a m I n f o                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  AcquireResizeStreamInfo() allocates a resize stream: it accepts the rows of
+%  an image one at a time, from top to bottom, and returns the rows of the
+%  resized image as soon as the filter support of each is complete.  Only a
+%  ring of horizontally filtered rows, as many as the vertical filter support
+%  spans, is kept so a stream resize needs memory proportional to the image
+%  width rather than its area.
+%
+%  The format of the AcquireResizeStreamInfo method is:
+%
+%      ResizeStreamInfo *AcquireResizeStreamInfo(const Image *image,
+%        const size_t columns,const size_t rows,const FilterType filter,
+%        ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o image: the image.
+%
+%    o columns: the number of columns in the resized image.
+%
+%    o rows: the number of rows in the resized image.
+%
+%    o filter: Image filter to use.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+struct _ResizeStreamInfo
+{
+  ResizeFilter
+    *resize_filter;
+
+  Image
+    *image;
+
+  size_t
+    columns,
+    rows,
+    resize_rows;
+
+  ContributionInfo
+    *x_contributions,
+    *y_contributions;
+
+  size_t
+    *x_counts,
+    x_extent;
+
+  ssize_t
+    *x_nearest;
+
+  double
+    y_factor,
+    y_scale,
+    y_support;
+
+  Quantum
+    *pixels;
+
+  size_t
+    number_rows;
+
+  ssize_t
+    y,
+    resize_y;
+
+  size_t
+    signature;
+};
+
+MagickPrivate ResizeStreamInfo *AcquireResizeStreamInfo(const Image *image,
+  const size_t columns,const size_t rows,const FilterType filter,
+  ExceptionInfo *exception)
+{
+  double
+    scale,
+    support,
+    x_factor;
+
+  FilterType
+    filter_type;
+
+  ResizeStreamInfo
+    *resize_stream;
+
+  ssize_t
+    x;
+
+  assert(image != (Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  assert(exception != (ExceptionInfo *) NULL);
+  assert(exception->signature == MagickCoreSignature);
+  if ((columns == 0) || (rows == 0) || (image->columns == 0) ||
+      (image->rows == 0))
+    {
+      (void) ThrowMagickException(exception,GetMagickModule(),ImageError,
+        "NegativeOrZeroImageSize","`%s'",image->filename);
+      return((ResizeStreamInfo *) NULL);
+    }
+  resize_stream=(ResizeStreamInfo *) AcquireMagickMemory(
+    sizeof(*resize_stream));
+  if (resize_stream == (ResizeStreamInfo *) NULL)
+    {
+      (void) ThrowMagickException(exception,GetMagickModule(),
+        ResourceLimitError,"MemoryAllocationFailed","`%s'",image->filename);
+      return((ResizeStreamInfo *) NULL);
+    }
+  (void) memset(resize_stream,0,sizeof(*resize_stream));
+  resize_stream->signature=MagickCoreSignature;
+  resize_stream->columns=image->columns;
+  resize_stream->rows=image->rows;
+  resize_stream->resize_rows=rows;
+  x_factor=(double) (columns*MagickSafeReciprocal((double) image->columns));
+  resize_stream->y_factor=(double) (rows*MagickSafeReciprocal((double)
+    image->rows));
+  filter_type=GetResizeFilterType(image,x_factor,resize_stream->y_factor,
+    filter);
+  resize_stream->resize_filter=AcquireResizeFilter(image,filter_type,
+    MagickFalse,exception);
+  resize_stream->image=CloneImage(image,columns,1,MagickTrue,exception);
+  if ((resize_stream->resize_filter == (ResizeFilter *) NULL) ||
+      (resize_stream->image == (Image *) NULL))
+    return(DestroyResizeStreamInfo(resize_stream));
+  if (SetImageStorageClass(resize_stream->image,DirectClass,exception) ==
+      MagickFalse)
+    return(DestroyResizeStreamInfo(resize_stream));
+  /*
+    The horizontal contributions are the same for every row.
+  */
+  support=GetResizeContributionSupport(resize_stream->resize_filter,x_factor,
+    &scale);
+  resize_stream->x_extent=(size_t) (2.0*support+3.0);
+  resize_stream->x_contributions=(ContributionInfo *) AcquireQuantumMemory(
+    columns*resize_stream->x_extent,sizeof(*resize_stream->x_contributions));
+  resize_stream->x_counts=(size_t *) AcquireQuantumMemory(columns,
+    sizeof(*resize_stream->x_counts));
+  resize_stream->x_nearest=(ssize_t *) AcquireQuantumMemory(columns,
+    sizeof(*resize_stream->x_nearest));
+  if ((resize_stream->x_contributions == (ContributionInfo *) NULL) ||
+      (resize_stream->x_counts == (size_t *) NULL) ||
+      (resize_stream->x_nearest == (ssize_t *) NULL))
+    {
+      (void) ThrowMagickException(exception,GetMagickModule(),
+        ResourceLimitError,"MemoryAllocationFailed","`%s'",image->filename);
+      return(DestroyResizeStreamInfo(resize_stream));
+    }
+  for (x=0; x < (ssize_t) columns; x++)
+  {
+    double
+      bisect;
+
+    ssize_t
+      n,
+      start,
+      stop;
+
+    bisect=(double) (x+0.5)/x_factor+MagickEpsilon;
+    n=SetResizeContributions(resize_stream->resize_filter,bisect,support,scale,
+      image->columns,resize_stream->x_contributions+x*(ssize_t)
+      resize_stream->x_extent,&start,&stop);
+    resize_stream->x_counts[x]=(size_t) n;
+    resize_stream->x_nearest[x]=(ssize_t) (MagickMin(MagickMax(bisect,
+      (double) start),(double) stop-1.0)+0.5);
+  }
+  /*
+    Keep as many filtered rows as the vertical support spans.
+  */
+  support=GetResizeContributionSupport(resize_stream->resize_filter,
+    resize_stream->y_factor,&scale);
+  resize_stream->y_scale=scale;
+  resize_stream->y_support=support;
+  resize_stream->number_rows=(size_t) (2.0*support+3.0);
+  resize_stream->y_contributions=(ContributionInfo *) AcquireQuantumMemory(
+    resize_stream->number_rows,sizeof(*resize_stream->y_contributions));
+  resize_stream->pixels=(Quantum *) AcquireQuantumMemory(
+    resize_stream->number_rows,columns*GetPixelChannels(resize_stream->image)*
+    sizeof(*resize_stream->pixels));
+  if ((resize_stream->y_contributions == (ContributionInfo *) NULL) ||
+      (resize_stream->pixels == (Quantum *) NULL))
+    {
+      (void) ThrowMagickException(exception,GetMagickModule(),
+        ResourceLimitError,"MemoryAllocationFailed","`%s'",image->filename);
+      return(DestroyResizeStreamInfo(resize_stream));
+    }
+  return(resize_stream);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   D e s t r o y R e s i z e S t r e a m I n f o                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DestroyResizeStreamInfo() deallocates memory associated with the resize
+%  stream.
+%
+%  The format of the DestroyResizeStreamInfo method is:
+%
+%      ResizeStreamInfo *DestroyResizeStreamInfo(
+%        ResizeStreamInfo *resize_stream)
+%
+%  A description of each parameter follows:
+%
+%    o resize_stream: the resize stream.
+%
+*/
+MagickPrivate ResizeStreamInfo *DestroyResizeStreamInfo(
+  ResizeStreamInfo *resize_stream)
+{
+  assert(resize_stream != (ResizeStreamInfo *) NULL);
+  assert(resize_stream->signature == MagickCoreSignature);
+  if (resize_stream->pixels != (Quantum *) NULL)
+    resize_stream->pixels=(Quantum *) RelinquishMagickMemory(
+      resize_stream->pixels);
+  if (resize_stream->y_contributions != (ContributionInfo *) NULL)
+    resize_stream->y_contributions=(ContributionInfo *)
+      RelinquishMagickMemory(resize_stream->y_contributions);
+  if (resize_stream->x_nearest != (ssize_t *) NULL)
+    resize_stream->x_nearest=(ssize_t *) RelinquishMagickMemory(
+      resize_stream->x_nearest);
+  if (resize_stream->x_counts != (size_t *) NULL)
+    resize_stream->x_counts=(size_t *) RelinquishMagickMemory(
+      resize_stream->x_counts);
+  if (resize_stream->x_contributions != (ContributionInfo *) NULL)
+    resize_stream->x_contributions=(ContributionInfo *)
+      RelinquishMagickMemory(resize_stream->x_contributions);
+  if (resize_stream->image != (Image *) NULL)
+    resize_stream->image=DestroyImage(resize_stream->image);
+  if (resize_stream->resize_filter != (ResizeFilter *) NULL)
+    resize_stream->resize_filter=DestroyResizeFilter(
+      resize_stream->resize_filter);
+  resize_stream->signature=(~MagickCoreSignature);
+  resize_stream=(ResizeStreamInfo *) RelinquishMagickMemory(resize_stream);
+  return(resize_stream);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   R e a d R e s i z e S t r e a m                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ReadResizeStream() returns the next row of the resized image as a one row
+%  image owned by the resize stream, or NULL if more rows must be written to
+%  the stream first or every row has already been returned.
+%
+%  The format of the ReadResizeStream method is:
+%
+%      const Image *ReadResizeStream(ResizeStreamInfo *resize_stream,
+%        ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o resize_stream: the resize stream.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+MagickPrivate const Image *ReadResizeStream(ResizeStreamInfo *resize_stream,
+  ExceptionInfo *exception)
+{
+  ContributionInfo
+    *magick_restrict contribution;
+
+  double
+    bisect;
+
+  Image
+    *resize_image;
+
+  Quantum
+    *magick_restrict q;
+
+  size_t
+    extent;
+
+  ssize_t
+    n,
+    start,
+    stop,
+    x;
+
+  assert(resize_stream != (ResizeStreamInfo *) NULL);
+  assert(resize_stream->signature == MagickCoreSignature);
+  resize_image=resize_stream->image;
+  if (resize_stream->resize_y >= (ssize_t) resize_stream->resize_rows)
+    return((const Image *) NULL);
+  bisect=(double) (resize_stream->resize_y+0.5)/resize_stream->y_factor+
+    MagickEpsilon;
+  contribution=resize_stream->y_contributions;
+  n=SetResizeContributions(resize_stream->resize_filter,bisect,
+    resize_stream->y_support,resize_stream->y_scale,resize_stream->rows,
+    contribution,&start,&stop);
+  if (stop > resize_stream->y)
+    return((const Image *) NULL);
+  q=QueueAuthenticPixels(resize_image,0,0,resize_image->columns,1,exception);
+  if (q == (Quantum *) NULL)
+    return((const Image *) NULL);
+  extent=resize_image->columns*GetPixelChannels(resize_image);
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  #pragma omp parallel for schedule(static) \
+    magick_number_threads(resize_image,resize_image,resize_image->columns,1)
+#endif
+  for (x=0; x < (ssize_t) resize_image->columns; x++)
+  {
+    Quantum
+      *magick_restrict r;
+
+    ssize_t
+      i;
+
+    r=q+x*(ssize_t) GetPixelChannels(resize_image);
+    for (i=0; i < (ssize_t) GetPixelChannels(resize_image); i++)
+    {
+      const Quantum
+        *magick_restrict p;
+
+      double
+        alpha,
+        gamma,
+        pixel;
+
+      PixelChannel
+        channel;
+
+      PixelTrait
+        traits;
+
+      ssize_t
+        j,
+        k;
+
+      channel=GetPixelChannelChannel(resize_image,i);
+      traits=GetPixelChannelTraits(resize_image,channel);
+      if (traits == UndefinedPixelTrait)
+        continue;
+      if ((traits & CopyPixelTrait) != 0)
+        {
+          j=(ssize_t) (MagickMin(MagickMax(bisect,(double) start),(double)
+            stop-1.0)+0.5);
+          p=resize_stream->pixels+(j % (ssize_t) resize_stream->number_rows)*
+            (ssize_t) extent+x*(ssize_t) GetPixelChannels(resize_image);
+          r[i]=p[i];
+          continue;
+        }
+      pixel=0.0;
+      if ((traits & BlendPixelTrait) == 0)
+        {
+          /*
+            No alpha blending.
+          */
+          for (j=0; j < n; j++)
+          {
+            k=contribution[j].pixel % (ssize_t) resize_stream->number_rows;
+            p=resize_stream->pixels+k*(ssize_t) extent+x*(ssize_t)
+              GetPixelChannels(resize_image);
+            alpha=contribution[j].weight;
+            pixel+=alpha*(double) p[i];
+          }
+          r[i]=ClampToQuantum(pixel);
+          continue;
+        }
+      /*
+        Alpha blending.
+      */
+      gamma=0.0;
+      for (j=0; j < n; j++)
+      {
+        k=contribution[j].pixel % (ssize_t) resize_stream->number_rows;
+        p=resize_stream->pixels+k*(ssize_t) extent+x*(ssize_t)
+          GetPixelChannels(resize_image);
+        alpha=contribution[j].weight*QuantumScale*(double)
+          GetPixelAlpha(resize_image,p);
+        pixel+=alpha*(double) p[i];
+        gamma+=alpha;
+      }
+      gamma=MagickSafeReciprocal(gamma);
+      r[i]=ClampToQuantum(gamma*pixel);
+    }
+  }
+  if (SyncAuthenticPixels(resize_image,exception) == MagickFalse)
+    return((const Image *) NULL);
+  resize_stream->resize_y++;
+  return(resize_image);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   W r i t e R e s i z e S t r e a m                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  WriteResizeStream() filters the next row of the image horizontally and adds
+%  it to the resize stream.  Call ReadResizeStream() until it returns NULL
+%  after each row, the stream only keeps the rows the next resized row needs.
+%
+%  The format of the WriteResizeStream method is:
+%
+%      MagickBooleanType WriteResizeStream(ResizeStreamInfo *resize_stream,
+%        const Image *image,const Quantum *pixels,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o resize_stream: the resize stream.
+%
+%    o image: the image.
+%
+%    o pixels: one row of image pixels.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+MagickPrivate MagickBooleanType WriteResizeStream(
+  ResizeStreamInfo *resize_stream,const Image *image,const Quantum *pixels,
+  ExceptionInfo *exception)
+{
+  Image
+    *resize_image;
+
+  Quantum
+    *magick_restrict q;
+
+  ssize_t
+    x;
+
+  assert(resize_stream != (ResizeStreamInfo *) NULL);
+  assert(resize_stream->signature == MagickCoreSignature);
+  assert(image != (const Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  resize_image=resize_stream->image;
+  if ((resize_stream->y >= (ssize_t) resize_stream->rows) ||
+      (image->columns != resize_stream->columns))
+    {
+      (void) ThrowMagickException(exception,GetMagickModule(),StreamError,
+        "ImageDoesNotContainTheStreamGeometry","`%s'",image->filename);
+      return(MagickFalse);
+    }
+  q=resize_stream->pixels+(resize_stream->y % (ssize_t)
+    resize_stream->number_rows)*(ssize_t) (resize_image->columns*
+    GetPixelChannels(resize_image));
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  #pragma omp parallel for schedule(static) \
+    magick_number_threads(resize_image,resize_image,resize_image->columns,1)
+#endif
+  for (x=0; x < (ssize_t) resize_image->columns; x++)
+  {
+    const ContributionInfo
+      *magick_restrict contribution;
+
+    Quantum
+      *magick_restrict r;
+
+    ssize_t
+      i,
+      n;
+
+    contribution=resize_stream->x_contributions+x*(ssize_t)
+      resize_stream->x_extent;
+    n=(ssize_t) resize_stream->x_counts[x];
+    r=q+x*(ssize_t) GetPixelChannels(resize_image);
+    if (n == 0)
+      continue;
+    for (i=0; i < (ssize_t) GetPixelChannels(image); i++)
+    {
+      double
+        alpha,
+        gamma,
+        pixel;
+
+      PixelChannel
+        channel;
+
+      PixelTrait
+        resize_traits,
+        traits;
+
+      ssize_t
+        j,
+        k,
+        offset;
+
+      channel=GetPixelChannelChannel(image,i);
+      traits=GetPixelChannelTraits(image,channel);
+      resize_traits=GetPixelChannelTraits(resize_image,channel);
+      if ((traits == UndefinedPixelTrait) ||
+          (resize_traits == UndefinedPixelTrait))
+        continue;
+      offset=(ssize_t) GetPixelChannelOffset(resize_image,channel);
+      if ((resize_traits & CopyPixelTrait) != 0)
+        {
+          k=resize_stream->x_nearest[x];
+          r[offset]=pixels[k*(ssize_t) GetPixelChannels(image)+i];
+          continue;
+        }
+      pixel=0.0;
+      if ((resize_traits & BlendPixelTrait) == 0)
+        {
+          /*
+            No alpha blending.
+          */
+          for (j=0; j < n; j++)
+          {
+            k=contribution[j].pixel;
+            alpha=contribution[j].weight;
+            pixel+=alpha*(double) pixels[k*(ssize_t) GetPixelChannels(image)+i];
+          }
+          r[offset]=ClampToQuantum(pixel);
+          continue;
+        }
+      /*
+        Alpha blending.
+      */
+      gamma=0.0;
+      for (j=0; j < n; j++)
+      {
+        k=contribution[j].pixel;
+        alpha=contribution[j].weight*QuantumScale*(double)
+          GetPixelAlpha(image,pixels+k*(ssize_t) GetPixelChannels(image));
+        pixel+=alpha*(double) pixels[k*(ssize_t) GetPixelChannels(image)+i];
+        gamma+=alpha;
+      }
+      gamma=MagickSafeReciprocal(gamma);
+      r[offset]=ClampToQuantum(gamma*pixel);
+    }
+  }
+  resize_stream->y++;
+  return(MagickTrue);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
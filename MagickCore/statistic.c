@@ -865,6 +865,21 @@ MagickExport MagickBooleanType EvaluateImage(Image *image,
   artifact=GetImageArtifact(image,"evaluate:clamp");
   if (artifact != (const char *) NULL)
     clamp=IsStringTrue(artifact);
+  if (GetImagePixelCacheType(image) == DistributedCache)
+    {
+      char
+        operation[MagickPathExtent];
+
+      /*
+        Evaluate the pixels on the distributed cache servers.
+      */
+      (void) FormatLocaleString(operation,MagickPathExtent,
+        "evaluate %s %.20g %s",CommandOptionToMnemonic(MagickEvaluateOptions,
+        (ssize_t) op),value,clamp != MagickFalse ? "true" : "false");
+      if (ApplyPixelCacheOperation(image,image,operation,0,exception) !=
+          MagickFalse)
+        return(MagickTrue);
+    }
   random_info=AcquireRandomInfoTLS();
   image_view=AcquireAuthenticCacheView(image,exception);
 #if defined(MAGICKCORE_OPENMP_SUPPORT)
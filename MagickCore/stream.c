@@ -46,27 +46,44 @@
 #include "MagickCore/cache.h"
 #include "MagickCore/cache-private.h"
 #include "MagickCore/color-private.h"
+#include "MagickCore/colorspace.h"
 #include "MagickCore/composite-private.h"
 #include "MagickCore/constitute.h"
+#include "MagickCore/enhance.h"
 #include "MagickCore/exception.h"
 #include "MagickCore/exception-private.h"
 #include "MagickCore/geometry.h"
 #include "MagickCore/memory_.h"
 #include "MagickCore/memory-private.h"
+#include "MagickCore/morphology.h"
+#include "MagickCore/option.h"
 #include "MagickCore/pixel.h"
 #include "MagickCore/pixel-accessor.h"
 #include "MagickCore/pixel-private.h"
 #include "MagickCore/policy.h"
+#include "MagickCore/profile.h"
+#include "MagickCore/property.h"
 #include "MagickCore/quantum.h"
 #include "MagickCore/quantum-private.h"
+#include "MagickCore/resize-private.h"
 #include "MagickCore/semaphore.h"
 #include "MagickCore/stream.h"
 #include "MagickCore/stream-private.h"
 #include "MagickCore/string_.h"
+#include "MagickCore/string-private.h"
+#include "MagickCore/threshold.h"
+#include "MagickCore/visual-effects.h"
 
 /*
   Typedef declarations.
 */
+typedef struct _StreamOperationInfo
+{
+  char
+    *option,
+    *arguments;
+} StreamOperationInfo;
+
 struct _StreamInfo
 {
   const ImageInfo
@@ -87,6 +104,31 @@ struct _StreamInfo
   StorageType
     storage_type;
 
+  char
+    *resize;
+
+  ResizeStreamInfo
+    *resize_stream;
+
+  RectangleInfo
+    resize_geometry;
+
+  StreamOperationInfo
+    *operations;
+
+  size_t
+    number_operations;
+
+  Image
+    *operation_template,
+    *operation_image;
+
+  ssize_t
+    operation_y;
+
+  size_t
+    operation_rows;
+
   unsigned char
     *pixels;
 
@@ -172,6 +214,90 @@ MagickExport StreamInfo *AcquireStreamInfo(const ImageInfo *image_info,
   stream_info->signature=MagickCoreSignature;
   return(stream_info);
 }
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   A p p e n d S t r e a m I n f o O p e r a t i o n                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  AppendStreamInfoOperation() appends a point operation to the chain applied
+%  to the pixels as they are streamed (e.g. -level 10%,90% or +negate).  The
+%  operations are applied in order to small batches of rows after they are
+%  decoded (and resized), so memory use does not grow with the image.  The
+%  supported operations are -channel, -clamp, -color-matrix, -colorspace,
+%  -gamma, -level, -negate, and -threshold.  MagickFalse is returned if the
+%  option is not a point operation or its argument is missing.
+%
+%  The format of the AppendStreamInfoOperation method is:
+%
+%      MagickBooleanType AppendStreamInfoOperation(StreamInfo *stream_info,
+%        const char *option,const char *arguments)
+%
+%  A description of each parameter follows:
+%
+%    o stream_info: the stream info.
+%
+%    o option: the option, including its - or + prefix.
+%
+%    o arguments: the option arguments, or NULL if it takes none.
+%
+*/
+MagickExport MagickBooleanType AppendStreamInfoOperation(
+  StreamInfo *stream_info,const char *option,const char *arguments)
+{
+  static const char
+    *const operations[] =
+    {
+      "channel",
+      "clamp",
+      "color-matrix",
+      "colorspace",
+      "gamma",
+      "level",
+      "negate",
+      "threshold",
+      (const char *) NULL
+    };
+
+  ssize_t
+    count,
+    i;
+
+  StreamOperationInfo
+    *operation;
+
+  assert(stream_info != (StreamInfo *) NULL);
+  assert(stream_info->signature == MagickCoreSignature);
+  assert(option != (const char *) NULL);
+  if ((*option != '-') && (*option != '+'))
+    return(MagickFalse);
+  for (i=0; operations[i] != (const char *) NULL; i++)
+    if (LocaleCompare(operations[i],option+1) == 0)
+      break;
+  if (operations[i] == (const char *) NULL)
+    return(MagickFalse);
+  count=ParseCommandOption(MagickCommandOptions,MagickFalse,option);
+  if ((count > 0) && (arguments == (const char *) NULL))
+    return(MagickFalse);
+  stream_info->operations=(StreamOperationInfo *) ResizeQuantumMemory(
+    stream_info->operations,stream_info->number_operations+1,
+    sizeof(*stream_info->operations));
+  if (stream_info->operations == (StreamOperationInfo *) NULL)
+    ThrowFatalException(ResourceLimitFatalError,"MemoryAllocationFailed");
+  operation=stream_info->operations+stream_info->number_operations;
+  operation->option=ConstantString(option);
+  operation->arguments=(char *) NULL;
+  if (count > 0)
+    operation->arguments=ConstantString(arguments);
+  stream_info->number_operations++;
+  return(MagickTrue);
+}
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -279,6 +405,34 @@ MagickExport StreamInfo *DestroyStreamInfo(StreamInfo *stream_info)
     (void) LogMagickEvent(TraceEvent,GetMagickModule(),"...");
   if (stream_info->map != (char *) NULL)
     stream_info->map=DestroyString(stream_info->map);
+  if (stream_info->resize != (char *) NULL)
+    stream_info->resize=DestroyString(stream_info->resize);
+  if (stream_info->resize_stream != (ResizeStreamInfo *) NULL)
+    stream_info->resize_stream=DestroyResizeStreamInfo(
+      stream_info->resize_stream);
+  if (stream_info->operations != (StreamOperationInfo *) NULL)
+    {
+      ssize_t
+        i;
+
+      for (i=0; i < (ssize_t) stream_info->number_operations; i++)
+      {
+        StreamOperationInfo
+          *operation;
+
+        operation=stream_info->operations+i;
+        operation->option=DestroyString(operation->option);
+        if (operation->arguments != (char *) NULL)
+          operation->arguments=DestroyString(operation->arguments);
+      }
+      stream_info->operations=(StreamOperationInfo *) RelinquishMagickMemory(
+        stream_info->operations);
+    }
+  if (stream_info->operation_template != (Image *) NULL)
+    stream_info->operation_template=DestroyImage(
+      stream_info->operation_template);
+  if (stream_info->operation_image != (Image *) NULL)
+    stream_info->operation_image=DestroyImage(stream_info->operation_image);
   if (stream_info->pixels != (unsigned char *) NULL)
     stream_info->pixels=(unsigned char *) RelinquishAlignedMemory(
       stream_info->pixels);
@@ -1146,6 +1300,41 @@ MagickExport void SetStreamInfoMap(StreamInfo *stream_info,const char *map)
   (void) CloneString(&stream_info->map,map);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   S e t S t r e a m I n f o R e s i z e                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SetStreamInfoResize() sets the geometry the streamed pixels are resized to
+%  (e.g. 640x480 or 25%).  The rows are resized as they are decoded, so the
+%  image is never held in a pixel cache.  A NULL geometry streams the pixels
+%  at their original size.
+%
+%  The format of the SetStreamInfoResize method is:
+%
+%      void SetStreamInfoResize(StreamInfo *stream_info,const char *geometry)
+%
+%  A description of each parameter follows:
+%
+%    o stream_info: the stream info.
+%
+%    o geometry: the resize geometry.
+%
+*/
+MagickExport void SetStreamInfoResize(StreamInfo *stream_info,
+  const char *geometry)
+{
+  assert(stream_info != (StreamInfo *) NULL);
+  assert(stream_info->signature == MagickCoreSignature);
+  (void) CloneString(&stream_info->resize,geometry);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -1212,27 +1401,197 @@ MagickExport void SetStreamInfoStorageType(StreamInfo *stream_info,
 extern "C" {
 #endif
 
-static size_t WriteStreamImage(const Image *image,const void *pixels,
-  const size_t columns)
+static MagickBooleanType ApplyStreamOperation(Image **image,
+  const StreamOperationInfo *operation,ExceptionInfo *exception)
 {
-  CacheInfo
-    *cache_info;
+  const char
+    *option;
 
+  option=operation->option;
+  switch (*(option+1))
+  {
+    case 'c':
+    {
+      if (LocaleCompare("channel",option+1) == 0)
+        {
+          ssize_t
+            channel;
+
+          if (*option == '+')
+            {
+              (void) SetPixelChannelMask(*image,DefaultChannels);
+              return(MagickTrue);
+            }
+          channel=ParseChannelOption(operation->arguments);
+          if (channel < 0)
+            return(MagickFalse);
+          (void) SetPixelChannelMask(*image,(ChannelType) channel);
+          return(MagickTrue);
+        }
+      if (LocaleCompare("clamp",option+1) == 0)
+        return(ClampImage(*image,exception));
+      if (LocaleCompare("color-matrix",option+1) == 0)
+        {
+          Image
+            *color_image;
+
+          KernelInfo
+            *kernel;
+
+          kernel=AcquireKernelInfo(operation->arguments,exception);
+          if (kernel == (KernelInfo *) NULL)
+            return(MagickFalse);
+          color_image=ColorMatrixImage(*image,kernel,exception);
+          kernel=DestroyKernelInfo(kernel);
+          if (color_image == (Image *) NULL)
+            return(MagickFalse);
+          *image=DestroyImage(*image);
+          *image=color_image;
+          return(MagickTrue);
+        }
+      if (LocaleCompare("colorspace",option+1) == 0)
+        {
+          ssize_t
+            colorspace;
+
+          if (*option == '+')
+            return(TransformImageColorspace(*image,sRGBColorspace,exception));
+          colorspace=ParseCommandOption(MagickColorspaceOptions,MagickFalse,
+            operation->arguments);
+          if (colorspace < 0)
+            return(MagickFalse);
+          return(TransformImageColorspace(*image,(ColorspaceType) colorspace,
+            exception));
+        }
+      break;
+    }
+    case 'g':
+    {
+      if (LocaleCompare("gamma",option+1) == 0)
+        {
+          if (*option == '+')
+            {
+              (*image)->gamma=StringToDouble(operation->arguments,(char **)
+                NULL);
+              return(MagickTrue);
+            }
+          return(GammaImage(*image,StringToDouble(operation->arguments,
+            (char **) NULL),exception));
+        }
+      break;
+    }
+    case 'l':
+    {
+      if (LocaleCompare("level",option+1) == 0)
+        {
+          double
+            black_point,
+            gamma,
+            white_point;
+
+          GeometryInfo
+            geometry_info;
+
+          MagickStatusType
+            flags;
+
+          flags=ParseGeometry(operation->arguments,&geometry_info);
+          black_point=geometry_info.rho;
+          white_point=(double) QuantumRange;
+          if ((flags & SigmaValue) != 0)
+            white_point=geometry_info.sigma;
+          gamma=1.0;
+          if ((flags & XiValue) != 0)
+            gamma=geometry_info.xi;
+          if ((flags & PercentValue) != 0)
+            {
+              black_point*=(double) QuantumRange/100.0;
+              white_point*=(double) QuantumRange/100.0;
+            }
+          if ((flags & SigmaValue) == 0)
+            white_point=(double) QuantumRange-black_point;
+          if ((*option == '+') || ((flags & AspectValue) != 0))
+            return(LevelizeImage(*image,black_point,white_point,gamma,
+              exception));
+          return(LevelImage(*image,black_point,white_point,gamma,exception));
+        }
+      break;
+    }
+    case 'n':
+    {
+      if (LocaleCompare("negate",option+1) == 0)
+        return(NegateImage(*image,*option == '+' ? MagickTrue : MagickFalse,
+          exception));
+      break;
+    }
+    case 't':
+    {
+      if (LocaleCompare("threshold",option+1) == 0)
+        {
+          double
+            threshold;
+
+          if (*option == '+')
+            threshold=(double) QuantumRange/2;
+          else
+            threshold=StringToDoubleInterval(operation->arguments,(double)
+              QuantumRange+1.0);
+          return(BilevelImage(*image,threshold,exception));
+        }
+      break;
+    }
+    default:
+      break;
+  }
+  return(MagickFalse);
+}
+
+static MagickBooleanType WriteStreamPixels(StreamInfo *stream_info,
+  const Image *image,const size_t packet_size)
+{
   RectangleInfo
     extract_info;
 
   size_t
-    length,
-    packet_size;
+    length;
 
   ssize_t
     count;
 
-  StreamInfo
-    *stream_info;
+  length=packet_size*(size_t) GetImageExtent(image);
+  extract_info=stream_info->extract_info;
+  if ((extract_info.width == 0) || (extract_info.height == 0))
+    {
+      /*
+        Write all pixels to stream.
+      */
+      (void) StreamImagePixels(stream_info,image,stream_info->exception);
+      count=WriteBlob(stream_info->stream,length,stream_info->pixels);
+      stream_info->y++;
+      return(count == 0 ? MagickFalse : MagickTrue);
+    }
+  if ((stream_info->y < extract_info.y) ||
+      (stream_info->y >= (extract_info.y+(ssize_t) extract_info.height)))
+    {
+      stream_info->y++;
+      return(MagickTrue);
+    }
+  /*
+    Write a portion of the pixel row to the stream.
+  */
+  (void) StreamImagePixels(stream_info,image,stream_info->exception);
+  length=packet_size*extract_info.width;
+  count=WriteBlob(stream_info->stream,length,stream_info->pixels+(ssize_t)
+    packet_size*extract_info.x);
+  stream_info->y++;
+  return(count == 0 ? MagickFalse : MagickTrue);
+}
+
+static size_t GetStreamPacketSize(const StreamInfo *stream_info)
+{
+  size_t
+    packet_size;
 
-  (void) pixels;
-  stream_info=(StreamInfo *) image->client_data;
   switch (stream_info->storage_type)
   {
     default: packet_size=sizeof(unsigned char); break;
@@ -1244,9 +1603,187 @@ static size_t WriteStreamImage(const Image *image,const void *pixels,
     case QuantumPixel: packet_size=sizeof(Quantum); break;
     case ShortPixel: packet_size=sizeof(unsigned short); break;
   }
+  return(packet_size*strlen(stream_info->map));
+}
+
+static MagickBooleanType FlushStreamOperations(StreamInfo *stream_info,
+  const size_t packet_size)
+{
+  ExceptionInfo
+    *exception;
+
+  MagickBooleanType
+    status;
+
+  ssize_t
+    i,
+    y;
+
+  if (stream_info->operation_image == (Image *) NULL)
+    return(MagickTrue);
+  exception=stream_info->exception;
+  status=MagickTrue;
+  for (i=0; i < (ssize_t) stream_info->number_operations; i++)
+  {
+    status=ApplyStreamOperation(&stream_info->operation_image,
+      stream_info->operations+i,exception);
+    if (status == MagickFalse)
+      break;
+  }
+  for (y=0; (status != MagickFalse) && (y < stream_info->operation_y); y++)
+  {
+    /*
+      An operation may reallocate the pixel cache (e.g. a new channel mask),
+      so fetch each row again before StreamImagePixels() exports it.
+    */
+    if (GetAuthenticPixels(stream_info->operation_image,0,y,
+          stream_info->operation_image->columns,1,exception) ==
+        (Quantum *) NULL)
+      status=MagickFalse;
+    else
+      status=WriteStreamPixels(stream_info,stream_info->operation_image,
+        packet_size);
+  }
+  stream_info->operation_image=DestroyImage(stream_info->operation_image);
+  stream_info->operation_y=0;
+  return(status);
+}
+
+static MagickBooleanType WriteStreamOperations(StreamInfo *stream_info,
+  const Image *image,const Quantum *pixels,const size_t rows,
+  const size_t packet_size)
+{
+#define StreamOperationExtent  (8*1024*1024)
+
+  CacheInfo
+    *cache_info;
+
+  ExceptionInfo
+    *exception;
+
+  size_t
+    columns,
+    extent;
+
+  ssize_t
+    y;
+
+  if ((stream_info->number_operations == 0) ||
+      (pixels == (const Quantum *) NULL))
+    return(WriteStreamPixels(stream_info,image,packet_size));
+  exception=stream_info->exception;
+  cache_info=(CacheInfo *) image->cache;
+  assert(cache_info->signature == MagickCoreSignature);
+  columns=cache_info->columns;
+  extent=StreamOperationExtent/(columns*GetPixelChannels(image)*
+    sizeof(Quantum));
+  extent=MagickMin(MagickMax(extent,1),rows);
+  if ((stream_info->operation_template != (Image *) NULL) &&
+      ((stream_info->operation_template->columns != columns) ||
+       (stream_info->operation_template->rows != extent)))
+    stream_info->operation_template=DestroyImage(
+      stream_info->operation_template);
+  if (stream_info->operation_template == (Image *) NULL)
+    {
+      Image
+        *operation_template;
+
+      /*
+        The operations run on batches of streamed rows; the template is
+        stripped of profiles and properties so it is cheap to clone.
+      */
+      operation_template=CloneImage(image,columns,extent,MagickTrue,
+        exception);
+      if (operation_template == (Image *) NULL)
+        return(MagickFalse);
+      DestroyImageProfiles(operation_template);
+      DestroyImageProperties(operation_template);
+      operation_template->progress_monitor=(MagickProgressMonitor) NULL;
+      if (SetImageStorageClass(operation_template,DirectClass,exception) ==
+          MagickFalse)
+        {
+          operation_template=DestroyImage(operation_template);
+          return(MagickFalse);
+        }
+      stream_info->operation_template=operation_template;
+    }
+  for (y=0; y < (ssize_t) cache_info->rows; y++)
+  {
+    Quantum
+      *q;
+
+    ssize_t
+      x;
+
+    if (stream_info->operation_image == (Image *) NULL)
+      {
+        stream_info->operation_image=CloneImage(
+          stream_info->operation_template,columns,extent,MagickTrue,
+          exception);
+        if (stream_info->operation_image == (Image *) NULL)
+          return(MagickFalse);
+        stream_info->operation_y=0;
+      }
+    q=QueueAuthenticPixels(stream_info->operation_image,0,
+      stream_info->operation_y,columns,1,exception);
+    if (q == (Quantum *) NULL)
+      return(MagickFalse);
+    for (x=0; x < (ssize_t) columns; x++)
+    {
+      ssize_t
+        i;
+
+      for (i=0; i < (ssize_t) GetPixelChannels(image); i++)
+      {
+        PixelChannel
+          channel;
+
+        channel=GetPixelChannelChannel(image,i);
+        if (GetPixelChannelTraits(stream_info->operation_image,channel) ==
+            UndefinedPixelTrait)
+          continue;
+        SetPixelChannel(stream_info->operation_image,channel,pixels[i],q);
+      }
+      pixels+=(ptrdiff_t) GetPixelChannels(image);
+      q+=(ptrdiff_t) GetPixelChannels(stream_info->operation_image);
+    }
+    if (SyncAuthenticPixels(stream_info->operation_image,exception) ==
+        MagickFalse)
+      return(MagickFalse);
+    stream_info->operation_y++;
+    stream_info->operation_rows++;
+    if ((stream_info->operation_y ==
+         (ssize_t) stream_info->operation_image->rows) ||
+        (stream_info->operation_rows >= rows))
+      if (FlushStreamOperations(stream_info,packet_size) == MagickFalse)
+        return(MagickFalse);
+  }
+  return(MagickTrue);
+}
+
+static size_t WriteStreamImage(const Image *image,const void *pixels,
+  const size_t columns)
+{
+  CacheInfo
+    *cache_info;
+
+  const Image
+    *resize_image;
+
+  size_t
+    length,
+    packet_size;
+
+  ssize_t
+    y;
+
+  StreamInfo
+    *stream_info;
+
+  stream_info=(StreamInfo *) image->client_data;
+  packet_size=GetStreamPacketSize(stream_info);
   cache_info=(CacheInfo *) image->cache;
   assert(cache_info->signature == MagickCoreSignature);
-  packet_size*=strlen(stream_info->map);
   length=packet_size*cache_info->columns*cache_info->rows;
   if (image != stream_info->image)
     {
@@ -1256,6 +1793,8 @@ static size_t WriteStreamImage(const Image *image,const void *pixels,
       /*
         Prepare stream for writing.
       */
+      if (FlushStreamOperations(stream_info,packet_size) == MagickFalse)
+        return(0);
       (void) RelinquishAlignedMemory(stream_info->pixels);
       stream_info->pixels=(unsigned char *) AcquireAlignedMemory(1,length);
       if (stream_info->pixels == (unsigned char *) NULL)
@@ -1269,33 +1808,61 @@ static size_t WriteStreamImage(const Image *image,const void *pixels,
           &stream_info->extract_info);
       stream_info->y=0;
       write_info=DestroyImageInfo(write_info);
+      if (stream_info->resize_stream != (ResizeStreamInfo *) NULL)
+        stream_info->resize_stream=DestroyResizeStreamInfo(
+          stream_info->resize_stream);
+      if (stream_info->operation_template != (Image *) NULL)
+        stream_info->operation_template=DestroyImage(
+          stream_info->operation_template);
+      stream_info->operation_rows=0;
     }
-  extract_info=stream_info->extract_info;
-  if ((extract_info.width == 0) || (extract_info.height == 0))
+  if (stream_info->resize == (char *) NULL)
+    return(WriteStreamOperations(stream_info,image,(const Quantum *) pixels,
+      image->rows,packet_size) == MagickFalse ? 0 : columns);
+  if (pixels == (const void *) NULL)
+    return(columns);
+  if (stream_info->resize_stream == (ResizeStreamInfo *) NULL)
     {
+      RectangleInfo
+        *geometry;
+
       /*
-        Write all pixels to stream.
+        Resize the rows as they are decoded.
       */
-      (void) StreamImagePixels(stream_info,image,stream_info->exception);
-      count=WriteBlob(stream_info->stream,length,stream_info->pixels);
-      stream_info->y++;
-      return(count == 0 ? 0 : columns);
+      geometry=(&stream_info->resize_geometry);
+      SetGeometry(image,geometry);
+      (void) ParseRegionGeometry(image,stream_info->resize,geometry,
+        stream_info->exception);
+      stream_info->resize_stream=AcquireResizeStreamInfo(image,geometry->width,
+        geometry->height,image->filter,stream_info->exception);
+      if (stream_info->resize_stream == (ResizeStreamInfo *) NULL)
+        return(0);
+      (void) RelinquishAlignedMemory(stream_info->pixels);
+      length=packet_size*geometry->width;
+      stream_info->pixels=(unsigned char *) AcquireAlignedMemory(1,length);
+      if (stream_info->pixels == (unsigned char *) NULL)
+        return(0);
+      (void) memset(stream_info->pixels,0,length);
     }
-  if ((stream_info->y < extract_info.y) ||
-      (stream_info->y >= (extract_info.y+(ssize_t) extract_info.height)))
+  for (y=0; y < (ssize_t) cache_info->rows; y++)
+  {
+    if (WriteResizeStream(stream_info->resize_stream,image,(const Quantum *)
+        pixels+y*(ssize_t) (cache_info->columns*GetPixelChannels(image)),
+        stream_info->exception) == MagickFalse)
+      return(0);
+    for ( ; ; )
     {
-      stream_info->y++;
-      return(columns);
+      resize_image=ReadResizeStream(stream_info->resize_stream,
+        stream_info->exception);
+      if (resize_image == (const Image *) NULL)
+        break;
+      if (WriteStreamOperations(stream_info,resize_image,
+            GetVirtualPixelQueue(resize_image),
+            stream_info->resize_geometry.height,packet_size) == MagickFalse)
+        return(0);
     }
-  /*
-    Write a portion of the pixel row to the stream.
-  */
-  (void) StreamImagePixels(stream_info,image,stream_info->exception);
-  length=packet_size*extract_info.width;
-  count=WriteBlob(stream_info->stream,length,stream_info->pixels+(ssize_t)
-    packet_size*extract_info.x);
-  stream_info->y++;
-  return(count == 0 ? 0 : columns);
+  }
+  return(columns);
 }
 
 #if defined(__cplusplus) || defined(c_plusplus)
@@ -1332,6 +1899,9 @@ MagickExport Image *StreamImage(const ImageInfo *image_info,
   read_info->client_data=(void *) stream_info;
   image=ReadStream(read_info,&WriteStreamImage,exception);
   read_info=DestroyImageInfo(read_info);
+  if ((FlushStreamOperations(stream_info,GetStreamPacketSize(stream_info)) ==
+       MagickFalse) && (image != (Image *) NULL))
+    image=DestroyImage(image);
   stream_info->quantum_info=DestroyQuantumInfo(stream_info->quantum_info);
   stream_info->quantum_info=AcquireQuantumInfo(image_info,image);
   if (stream_info->quantum_info == (QuantumInfo *) NULL)
@@ -1382,10 +1952,12 @@ static MagickBooleanType StreamImagePixels(const StreamInfo *stream_info,
 
   ssize_t
     i,
+    offsets[MaxPixelChannels],
     x;
 
   size_t
-    length;
+    length,
+    number_offsets;
 
   assert(stream_info != (StreamInfo *) NULL);
   assert(stream_info->signature == MagickCoreSignature);
@@ -1502,6 +2074,7 @@ static MagickBooleanType StreamImagePixels(const StreamInfo *stream_info,
     }
   }
   quantum_info=stream_info->quantum_info;
+  number_offsets=GetPixelKernelOffsets(image,stream_info->map,offsets);
   switch (stream_info->storage_type)
   {
     case CharPixel:
@@ -1510,6 +2083,15 @@ static MagickBooleanType StreamImagePixels(const StreamInfo *stream_info,
         *q;
 
       q=(unsigned char *) stream_info->pixels;
+      if (number_offsets != 0)
+        {
+          p=GetAuthenticPixelQueue(image);
+          if (p == (const Quantum *) NULL)
+            break;
+          ExportCharPixelKernel(p,GetPixelChannels(image),offsets,
+            number_offsets,GetImageExtent(image),q);
+          break;
+        }
       if (LocaleCompare(stream_info->map,"BGR") == 0)
         {
           p=GetAuthenticPixelQueue(image);
@@ -1866,6 +2448,16 @@ static MagickBooleanType StreamImagePixels(const StreamInfo *stream_info,
         *q;
 
       q=(float *) stream_info->pixels;
+      if (number_offsets != 0)
+        {
+          p=GetAuthenticPixelQueue(image);
+          if (p == (const Quantum *) NULL)
+            break;
+          ExportFloatPixelKernel(p,GetPixelChannels(image),offsets,
+            number_offsets,GetImageExtent(image),quantum_info->scale,
+            quantum_info->minimum,q);
+          break;
+        }
       if (LocaleCompare(stream_info->map,"BGR") == 0)
         {
           p=GetAuthenticPixelQueue(image);
@@ -2552,6 +3144,15 @@ static MagickBooleanType StreamImagePixels(const StreamInfo *stream_info,
         *q;
 
       q=(unsigned short *) stream_info->pixels;
+      if (number_offsets != 0)
+        {
+          p=GetAuthenticPixelQueue(image);
+          if (p == (const Quantum *) NULL)
+            break;
+          ExportShortPixelKernel(p,GetPixelChannels(image),offsets,
+            number_offsets,GetImageExtent(image),q);
+          break;
+        }
       if (LocaleCompare(stream_info->map,"BGR") == 0)
         {
           p=GetAuthenticPixelQueue(image);
@@ -35,6 +35,7 @@ extern MagickExport Image
   *StreamImage(const ImageInfo *,StreamInfo *,ExceptionInfo *);
 
 extern MagickExport MagickBooleanType
+  AppendStreamInfoOperation(StreamInfo *,const char *,const char *),
   OpenStream(const ImageInfo *,StreamInfo *,const char *,ExceptionInfo *),
   WriteStream(const ImageInfo *,Image *,StreamHandler,ExceptionInfo *);
 
@@ -44,6 +45,7 @@ extern MagickExport StreamInfo
 
 extern MagickExport void
   SetStreamInfoMap(StreamInfo *,const char *),
+  SetStreamInfoResize(StreamInfo *,const char *),
   SetStreamInfoStorageType(StreamInfo *,const StorageType);
 
 #if defined(__cplusplus) || defined(c_plusplus)
@@ -304,8 +304,10 @@ MagickExport void AppendImageFormat(const char *format,char *filename)
   if ((LocaleCompare(extension,"Z") == 0) ||
       (LocaleCompare(extension,"bz2") == 0) ||
       (LocaleCompare(extension,"gz") == 0) ||
+      (LocaleCompare(extension,"lz4") == 0) ||
       (LocaleCompare(extension,"wmz") == 0) ||
-      (LocaleCompare(extension,"svgz") == 0))
+      (LocaleCompare(extension,"svgz") == 0) ||
+      (LocaleCompare(extension,"zst") == 0))
     {
       GetPathComponent(filename,RootPath,root);
       (void) CopyMagickString(filename,root,MagickPathExtent);
@@ -1376,9 +1378,11 @@ MagickExport void GetPathComponent(const char *path,PathType type,
       GetPathComponent(path,ExtensionPath,extension);
       if ((LocaleCompare(extension,"bz2") == 0) ||
           (LocaleCompare(extension,"gz") == 0) ||
+          (LocaleCompare(extension,"lz4") == 0) ||
           (LocaleCompare(extension,"svgz") == 0) ||
           (LocaleCompare(extension,"wmz") == 0) ||
-          (LocaleCompare(extension,"Z") == 0))
+          (LocaleCompare(extension,"Z") == 0) ||
+          (LocaleCompare(extension,"zst") == 0))
         GetPathComponent(path,BasePath,component);
       break;
     }
@@ -171,6 +171,9 @@ MagickExport const char *GetMagickDelegates(void)
 #if defined(MAGICKCORE_LTDL_DELEGATE)
   " ltdl"
 #endif
+#if defined(MAGICKCORE_LZ4_DELEGATE)
+  " lz4"
+#endif
 #if defined(MAGICKCORE_LZMA_DELEGATE)
   " lzma"
 #endif
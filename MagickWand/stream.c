@@ -94,6 +94,13 @@ static MagickBooleanType StreamUsage(void)
       "  -list type           print a list of supported option arguments\n"
       "  -log format          format of debugging information\n"
       "  -version             print version information",
+    operators[] =
+      "  -clamp               keep pixel values in range (0-QuantumRange)\n"
+      "  -color-matrix matrix apply color correction to the image\n"
+      "  -gamma value         level of gamma correction\n"
+      "  -level value         adjust the level of image contrast\n"
+      "  -negate              replace every pixel with its complementary color \n"
+      "  -threshold value     threshold the image",
     settings[] =
       "  -authenticate password\n"
       "                       decipher image with this password\n"
@@ -113,6 +120,7 @@ static MagickBooleanType StreamUsage(void)
       "  -quantize colorspace reduce colors in this colorspace\n"
       "  -quiet               suppress all warning messages\n"
       "  -regard-warnings     pay attention to warning messages\n"
+      "  -resize geometry     resize the image as it is streamed\n"
       "  -respect-parentheses settings remain in effect until parenthesis boundary\n"
       "  -sampling-factor geometry\n"
       "                       horizontal and vertical sampling factor\n"
@@ -133,6 +141,8 @@ static MagickBooleanType StreamUsage(void)
     GetClientName());
   (void) printf("\nImage Settings:\n");
   (void) puts(settings);
+  (void) printf("\nImage Operators:\n");
+  (void) puts(operators);
   (void) printf("\nMiscellaneous Options:\n");
   (void) puts(miscellaneous);
   (void) printf(
@@ -332,7 +342,11 @@ WandExport MagickBooleanType StreamImageCommand(ImageInfo *image_info,
               channel;
 
             if (*option == '+')
-              break;
+              {
+                (void) AppendStreamInfoOperation(stream_info,option,
+                  (const char *) NULL);
+                break;
+              }
             i++;
             if (i == (ssize_t) argc)
               ThrowStreamException(OptionError,"MissingArgument",option);
@@ -340,6 +354,32 @@ WandExport MagickBooleanType StreamImageCommand(ImageInfo *image_info,
             if (channel < 0)
               ThrowStreamException(OptionError,"UnrecognizedChannelType",
                 argv[i]);
+            (void) AppendStreamInfoOperation(stream_info,option,argv[i]);
+            break;
+          }
+        if (LocaleCompare("clamp",option+1) == 0)
+          {
+            (void) AppendStreamInfoOperation(stream_info,option,
+              (const char *) NULL);
+            (void) CopyMagickString(argv[i]+1,"sans0",MagickPathExtent);
+            break;
+          }
+        if (LocaleCompare("color-matrix",option+1) == 0)
+          {
+            KernelInfo
+              *kernel_info;
+
+            if (*option == '+')
+              break;
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowStreamException(OptionError,"MissingArgument",option);
+            kernel_info=AcquireKernelInfo(argv[i],exception);
+            if (kernel_info == (KernelInfo *) NULL)
+              ThrowStreamInvalidArgumentException(option,argv[i]);
+            kernel_info=DestroyKernelInfo(kernel_info);
+            (void) AppendStreamInfoOperation(stream_info,option,argv[i]);
+            (void) CopyMagickString(argv[i-1]+1,"sans",MagickPathExtent);
             break;
           }
         if (LocaleCompare("colorspace",option+1) == 0)
@@ -413,6 +453,22 @@ WandExport MagickBooleanType StreamImageCommand(ImageInfo *image_info,
                   ThrowStreamException(OptionError,"NoSuchOption",argv[i]);
                 break;
               }
+            if (LocaleNCompare("stream:colorspace=",argv[i],18) == 0)
+              {
+                ssize_t
+                  colorspace;
+
+                /*
+                  Convert the streamed pixels to this colorspace.
+                */
+                colorspace=ParseCommandOption(MagickColorspaceOptions,
+                  MagickFalse,argv[i]+18);
+                if (colorspace < 0)
+                  ThrowStreamException(OptionError,"UnrecognizedColorspace",
+                    argv[i]+18);
+                (void) AppendStreamInfoOperation(stream_info,"-colorspace",
+                  argv[i]+18);
+              }
             break;
           }
         if (LocaleCompare("density",option+1) == 0)
@@ -465,6 +521,21 @@ WandExport MagickBooleanType StreamImageCommand(ImageInfo *image_info,
           }
         ThrowStreamException(OptionError,"UnrecognizedOption",option)
       }
+      case 'g':
+      {
+        if (LocaleCompare("gamma",option+1) == 0)
+          {
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowStreamException(OptionError,"MissingArgument",option);
+            if (IsGeometry(argv[i]) == MagickFalse)
+              ThrowStreamInvalidArgumentException(option,argv[i]);
+            (void) AppendStreamInfoOperation(stream_info,option,argv[i]);
+            (void) CopyMagickString(argv[i-1]+1,"sans",MagickPathExtent);
+            break;
+          }
+        ThrowStreamException(OptionError,"UnrecognizedOption",option)
+      }
       case 'h':
       {
         if ((LocaleCompare("help",option+1) == 0) ||
@@ -517,6 +588,17 @@ WandExport MagickBooleanType StreamImageCommand(ImageInfo *image_info,
       }
       case 'l':
       {
+        if (LocaleCompare("level",option+1) == 0)
+          {
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowStreamException(OptionError,"MissingArgument",option);
+            if (IsGeometry(argv[i]) == MagickFalse)
+              ThrowStreamInvalidArgumentException(option,argv[i]);
+            (void) AppendStreamInfoOperation(stream_info,option,argv[i]);
+            (void) CopyMagickString(argv[i-1]+1,"sans",MagickPathExtent);
+            break;
+          }
         if (LocaleCompare("limit",option+1) == 0)
           {
             char
@@ -591,6 +673,17 @@ WandExport MagickBooleanType StreamImageCommand(ImageInfo *image_info,
           break;
         ThrowStreamException(OptionError,"UnrecognizedOption",option)
       }
+      case 'n':
+      {
+        if (LocaleCompare("negate",option+1) == 0)
+          {
+            (void) AppendStreamInfoOperation(stream_info,option,
+              (const char *) NULL);
+            (void) CopyMagickString(argv[i]+1,"sans0",MagickPathExtent);
+            break;
+          }
+        ThrowStreamException(OptionError,"UnrecognizedOption",option)
+      }
       case 'q':
       {
         if (LocaleCompare("quantize",option+1) == 0)
@@ -618,6 +711,23 @@ WandExport MagickBooleanType StreamImageCommand(ImageInfo *image_info,
       {
         if (LocaleCompare("regard-warnings",option+1) == 0)
           break;
+        if (LocaleCompare("resize",option+1) == 0)
+          {
+            if (*option == '+')
+              {
+                (void) CopyMagickString(argv[i]+1,"sans0",MagickPathExtent);
+                SetStreamInfoResize(stream_info,(const char *) NULL);
+                break;
+              }
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowStreamException(OptionError,"MissingArgument",option);
+            if (IsGeometry(argv[i]) == MagickFalse)
+              ThrowStreamInvalidArgumentException(option,argv[i]);
+            SetStreamInfoResize(stream_info,argv[i]);
+            (void) CopyMagickString(argv[i-1]+1,"sans",MagickPathExtent);
+            break;
+          }
         if (LocaleNCompare("respect-parentheses",option+1,17) == 0)
           {
             respect_parentheses=(*option == '-') ? MagickTrue : MagickFalse;
@@ -697,6 +807,24 @@ WandExport MagickBooleanType StreamImageCommand(ImageInfo *image_info,
       {
         if (LocaleCompare("taint",option+1) == 0)
           break;
+        if (LocaleCompare("threshold",option+1) == 0)
+          {
+            if (*option == '+')
+              {
+                (void) AppendStreamInfoOperation(stream_info,option,
+                  (const char *) NULL);
+                (void) CopyMagickString(argv[i]+1,"sans0",MagickPathExtent);
+                break;
+              }
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowStreamException(OptionError,"MissingArgument",option);
+            if (IsGeometry(argv[i]) == MagickFalse)
+              ThrowStreamInvalidArgumentException(option,argv[i]);
+            (void) AppendStreamInfoOperation(stream_info,option,argv[i]);
+            (void) CopyMagickString(argv[i-1]+1,"sans",MagickPathExtent);
+            break;
+          }
         if (LocaleCompare("transparent-color",option+1) == 0)
           {
             if (*option == '+')
@@ -583,6 +583,10 @@ static Image *ReadBMPImage(const ImageInfo *image_info,ExceptionInfo *exception)
   BMPInfo
     bmp_info;
 
+  const unsigned char
+    *p,
+    *raster;
+
   Image
     *image;
 
@@ -619,7 +623,6 @@ static Image *ReadBMPImage(const ImageInfo *image_info,ExceptionInfo *exception)
 
   unsigned char
     magick[12],
-    *p,
     *pixels;
 
   unsigned int
@@ -1127,7 +1130,8 @@ static Image *ReadBMPImage(const ImageInfo *image_info,ExceptionInfo *exception)
         if (image->debug != MagickFalse)
           (void) LogMagickEvent(CoderEvent,GetMagickModule(),
             "  Reading pixels (%.20g bytes)",(double) length);
-        count=ReadBlob(image,length,pixels);
+        raster=(const unsigned char *) ReadBlobStream(image,length,pixels,
+          &count);
         if (count != (ssize_t) length)
           {
             pixel_info=RelinquishVirtualMemory(pixel_info);
@@ -1148,6 +1152,7 @@ static Image *ReadBMPImage(const ImageInfo *image_info,ExceptionInfo *exception)
             ThrowReaderException(CorruptImageError,
               "UnableToRunlengthDecodeImage");
           }
+        raster=pixels;
       }
     /*
       Convert BMP raster image to pixel packets.
@@ -1167,7 +1172,7 @@ static Image *ReadBMPImage(const ImageInfo *image_info,ExceptionInfo *exception)
             bytes_per_line=4*(image->columns);
             for (y=(ssize_t) image->rows-1; y >= 0; y--)
             {
-              p=pixels+((ssize_t) image->rows-y-1)*(ssize_t) bytes_per_line;
+              p=raster+((ssize_t) image->rows-y-1)*(ssize_t) bytes_per_line;
               for (x=0; x < (ssize_t) image->columns; x++)
               {
                 if (*(p+3) != 0)
@@ -1275,7 +1280,7 @@ static Image *ReadBMPImage(const ImageInfo *image_info,ExceptionInfo *exception)
         */
         for (y=(ssize_t) image->rows-1; y >= 0; y--)
         {
-          p=pixels+((ssize_t) image->rows-y-1)*(ssize_t) bytes_per_line;
+          p=raster+((ssize_t) image->rows-y-1)*(ssize_t) bytes_per_line;
           q=QueueAuthenticPixels(image,0,y,image->columns,1,exception);
           if (q == (Quantum *) NULL)
             break;
@@ -1319,7 +1324,7 @@ static Image *ReadBMPImage(const ImageInfo *image_info,ExceptionInfo *exception)
         */
         for (y=(ssize_t) image->rows-1; y >= 0; y--)
         {
-          p=pixels+((ssize_t) image->rows-y-1)*(ssize_t) bytes_per_line;
+          p=raster+((ssize_t) image->rows-y-1)*(ssize_t) bytes_per_line;
           q=QueueAuthenticPixels(image,0,y,image->columns,1,exception);
           if (q == (Quantum *) NULL)
             break;
@@ -1368,7 +1373,7 @@ static Image *ReadBMPImage(const ImageInfo *image_info,ExceptionInfo *exception)
           bytes_per_line=image->columns;
         for (y=(ssize_t) image->rows-1; y >= 0; y--)
         {
-          p=pixels+((ssize_t) image->rows-y-1)*(ssize_t) bytes_per_line;
+          p=raster+((ssize_t) image->rows-y-1)*(ssize_t) bytes_per_line;
           q=QueueAuthenticPixels(image,0,y,image->columns,1,exception);
           if (q == (Quantum *) NULL)
             break;
@@ -1412,7 +1417,7 @@ static Image *ReadBMPImage(const ImageInfo *image_info,ExceptionInfo *exception)
         image->storage_class=DirectClass;
         for (y=(ssize_t) image->rows-1; y >= 0; y--)
         {
-          p=pixels+((ssize_t) image->rows-y-1)*(ssize_t) bytes_per_line;
+          p=raster+((ssize_t) image->rows-y-1)*(ssize_t) bytes_per_line;
           q=QueueAuthenticPixels(image,0,y,image->columns,1,exception);
           if (q == (Quantum *) NULL)
             break;
@@ -1472,7 +1477,7 @@ static Image *ReadBMPImage(const ImageInfo *image_info,ExceptionInfo *exception)
         bytes_per_line=4*((image->columns*24+31)/32);
         for (y=(ssize_t) image->rows-1; y >= 0; y--)
         {
-          p=pixels+((ssize_t) image->rows-y-1)*(ssize_t) bytes_per_line;
+          p=raster+((ssize_t) image->rows-y-1)*(ssize_t) bytes_per_line;
           q=QueueAuthenticPixels(image,0,y,image->columns,1,exception);
           if (q == (Quantum *) NULL)
             break;
@@ -1516,7 +1521,7 @@ static Image *ReadBMPImage(const ImageInfo *image_info,ExceptionInfo *exception)
             alpha,
             pixel;
 
-          p=pixels+((ssize_t) image->rows-y-1)*(ssize_t) bytes_per_line;
+          p=raster+((ssize_t) image->rows-y-1)*(ssize_t) bytes_per_line;
           q=QueueAuthenticPixels(image,0,y,image->columns,1,exception);
           if (q == (Quantum *) NULL)
             break;
@@ -84,6 +84,9 @@
 #if defined(MAGICKCORE_ZLIB_DELEGATE)
 #include "zlib.h"
 #endif
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+#include "zstd.h"
+#endif
 
 /*
   Forward declarations.
@@ -497,6 +500,17 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
     zip_info;
 #endif
 
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+  ZSTD_DCtx
+    *zstd_info;
+
+  ZSTD_inBuffer
+    zstd_input;
+
+  ZSTD_outBuffer
+    zstd_output;
+#endif
+
   /*
     Open image file.
   */
@@ -1400,6 +1414,10 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
 #endif
 #if defined(MAGICKCORE_ZLIB_DELEGATE)
     (void) memset(&zip_info,0,sizeof(zip_info));
+#endif
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+    zstd_info=(ZSTD_DCtx *) NULL;
+    (void) memset(&zstd_input,0,sizeof(zstd_input));
 #endif
     switch (image->compression)
     {
@@ -1451,6 +1469,15 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
           status=MagickFalse;
         break;
       }
+#endif
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+      case ZstdCompression:
+      {
+        zstd_info=ZSTD_createDCtx();
+        if (zstd_info == (ZSTD_DCtx *) NULL)
+          status=MagickFalse;
+        break;
+      }
 #endif
       case RLECompression:
         break;
@@ -1487,13 +1514,15 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
 
             if (bzip_info.avail_in == 0)
               {
-                bzip_info.next_in=(char *) compress_pixels;
                 length=(size_t) BZipMaxExtent(packet_size*image->columns);
                 if (version != 0.0)
                   length=(size_t) ReadBlobMSBLong(image);
                 if (length <= compress_extent)
-                  bzip_info.avail_in=(unsigned int) ReadBlob(image,length,
-                    (unsigned char *) bzip_info.next_in);
+                  {
+                    bzip_info.next_in=(char *) ReadBlobStream(image,length,
+                      compress_pixels,&count);
+                    bzip_info.avail_in=(unsigned int) count;
+                  }
                 if ((length > compress_extent) ||
                     ((size_t) bzip_info.avail_in != length))
                   {
@@ -1528,11 +1557,13 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
 
             if (lzma_info.avail_in == 0)
               {
-                lzma_info.next_in=compress_pixels;
                 length=(size_t) ReadBlobMSBLong(image);
                 if (length <= compress_extent)
-                  lzma_info.avail_in=(unsigned int) ReadBlob(image,length,
-                    (unsigned char *) lzma_info.next_in);
+                  {
+                    lzma_info.next_in=(const uint8_t *) ReadBlobStream(image,
+                      length,compress_pixels,&count);
+                    lzma_info.avail_in=(size_t) count;
+                  }
                 if ((length > compress_extent) ||
                     (lzma_info.avail_in != length))
                   {
@@ -1568,13 +1599,15 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
 
             if (zip_info.avail_in == 0)
               {
-                zip_info.next_in=compress_pixels;
                 length=(size_t) ZipMaxExtent(packet_size*image->columns);
                 if (version != 0.0)
                   length=(size_t) ReadBlobMSBLong(image);
                 if (length <= compress_extent)
-                  zip_info.avail_in=(unsigned int) ReadBlob(image,length,
-                    zip_info.next_in);
+                  {
+                    zip_info.next_in=(Bytef *) ReadBlobStream(image,length,
+                      compress_pixels,&count);
+                    zip_info.avail_in=(uInt) count;
+                  }
                 if ((length > compress_extent) ||
                     ((size_t) zip_info.avail_in != length))
                   {
@@ -1596,6 +1629,49 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
             quantum_type,pixels,exception);
           break;
         }
+#endif
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+        case ZstdCompression:
+        {
+          zstd_output.dst=pixels;
+          zstd_output.size=packet_size*image->columns;
+          zstd_output.pos=0;
+          for ( ; ; )
+          {
+            size_t
+              code;
+
+            code=ZSTD_decompressStream(zstd_info,&zstd_output,&zstd_input);
+            if (ZSTD_isError(code) != 0)
+              {
+                status=MagickFalse;
+                break;
+              }
+            if ((zstd_output.pos == zstd_output.size) || (code == 0))
+              break;
+            if (zstd_input.pos == zstd_input.size)
+              {
+                length=(size_t) ReadBlobMSBLong(image);
+                if ((length != 0) && (length <= compress_extent))
+                  {
+                    zstd_input.src=ReadBlobStream(image,length,
+                      compress_pixels,&count);
+                    zstd_input.size=(size_t) MagickMax(count,0);
+                    zstd_input.pos=0;
+                  }
+                if ((length == 0) || (length > compress_extent) ||
+                    (zstd_input.size != length))
+                  {
+                    (void) ZSTD_freeDCtx(zstd_info);
+                    ThrowMIFFException(CorruptImageError,
+                      "UnableToReadImageData");
+                  }
+              }
+          }
+          extent=ImportQuantumPixels(image,(CacheView *) NULL,quantum_info,
+            quantum_type,pixels,exception);
+          break;
+        }
 #endif
         case RLECompression:
         {
@@ -1603,10 +1679,14 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
           {
             if (length == 0)
               {
-                count=ReadBlob(image,packet_size,pixels);
+                const unsigned char
+                  *packet;
+
+                packet=(const unsigned char *) ReadBlobStream(image,packet_size,
+                  pixels,&count);
                 if (count != (ssize_t) packet_size)
                   ThrowMIFFException(CorruptImageError,"UnableToReadImageData");
-                PushRunlengthPacket(image,pixels,&length,&pixel,exception);
+                PushRunlengthPacket(image,packet,&length,&pixel,exception);
               }
             length--;
             if (image->storage_class == PseudoClass)
@@ -1710,6 +1790,45 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
           status=MagickFalse;
         break;
       }
+#endif
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+      case ZstdCompression:
+      {
+        /*
+          Consume the end of the frame so the next image starts in sync.
+        */
+        while (status != MagickFalse)
+        {
+          size_t
+            code;
+
+          zstd_output.dst=pixels;
+          zstd_output.size=packet_size*image->columns;
+          zstd_output.pos=0;
+          code=ZSTD_decompressStream(zstd_info,&zstd_output,&zstd_input);
+          if ((ZSTD_isError(code) != 0) || (zstd_output.pos != 0))
+            status=MagickFalse;
+          if ((status == MagickFalse) || (code == 0))
+            break;
+          if (zstd_input.pos == zstd_input.size)
+            {
+              length=(size_t) ReadBlobMSBLong(image);
+              if ((length == 0) || (length > compress_extent))
+                {
+                  status=MagickFalse;
+                  break;
+                }
+              zstd_input.src=ReadBlobStream(image,length,compress_pixels,
+                &count);
+              zstd_input.size=(size_t) MagickMax(count,0);
+              zstd_input.pos=0;
+              if (zstd_input.size != length)
+                status=MagickFalse;
+            }
+        }
+        (void) ZSTD_freeDCtx(zstd_info);
+        break;
+      }
 #endif
       default:
         break;
@@ -2092,6 +2211,17 @@ static MagickBooleanType WriteMIFFImage(const ImageInfo *image_info,
     zip_info;
 #endif
 
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+  ZSTD_CCtx
+    *zstd_info;
+
+  ZSTD_inBuffer
+    zstd_input;
+
+  ZSTD_outBuffer
+    zstd_output;
+#endif
+
   /*
     Open output image file.
   */
@@ -2152,6 +2282,9 @@ static MagickBooleanType WriteMIFFImage(const ImageInfo *image_info,
 #endif
 #if !defined(MAGICKCORE_BZLIB_DELEGATE)
       case BZipCompression: compression=NoCompression; break;
+#endif
+#if !defined(MAGICKCORE_ZSTD_DELEGATE)
+      case ZstdCompression: compression=NoCompression; break;
 #endif
       case RLECompression:
       {
@@ -2549,6 +2682,9 @@ static MagickBooleanType WriteMIFFImage(const ImageInfo *image_info,
       Write image pixels to file.
     */
     status=MagickTrue;
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+    zstd_info=(ZSTD_CCtx *) NULL;
+#endif
     switch (compression)
     {
 #if defined(MAGICKCORE_BZLIB_DELEGATE)
@@ -2603,6 +2739,21 @@ static MagickBooleanType WriteMIFFImage(const ImageInfo *image_info,
           status=MagickFalse;
         break;
       }
+#endif
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+      case ZstdCompression:
+      {
+        zstd_info=ZSTD_createCCtx();
+        if (zstd_info == (ZSTD_CCtx *) NULL)
+          {
+            status=MagickFalse;
+            break;
+          }
+        if (image->quality != UndefinedCompressionQuality)
+          (void) ZSTD_CCtx_setParameter(zstd_info,ZSTD_c_compressionLevel,
+            (int) MagickMax(22*image->quality/100,1));
+        break;
+      }
 #endif
       default:
         break;
@@ -2712,6 +2863,37 @@ static MagickBooleanType WriteMIFFImage(const ImageInfo *image_info,
           } while (zip_info.avail_in != 0);
           break;
         }
+#endif
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+        case ZstdCompression:
+        {
+          size_t
+            code;
+
+          zstd_input.src=pixels;
+          zstd_input.size=packet_size*image->columns;
+          zstd_input.pos=0;
+          (void) ExportQuantumPixels(image,(CacheView *) NULL,quantum_info,
+            quantum_type,pixels,exception);
+          do
+          {
+            zstd_output.dst=compress_pixels;
+            zstd_output.size=ZipMaxExtent(packet_size*image->columns);
+            zstd_output.pos=0;
+            code=ZSTD_compressStream2(zstd_info,&zstd_output,&zstd_input,
+              ZSTD_e_flush);
+            if (ZSTD_isError(code) != 0)
+              status=MagickFalse;
+            length=zstd_output.pos;
+            count=0;
+            if (length != 0)
+              {
+                (void) WriteBlobMSBLong(image,(unsigned int) length);
+                count=WriteBlob(image,length,compress_pixels);
+              }
+          } while ((status != MagickFalse) && (code != 0));
+          break;
+        }
 #endif
         case RLECompression:
         {
@@ -2844,6 +3026,42 @@ static MagickBooleanType WriteMIFFImage(const ImageInfo *image_info,
           status=MagickFalse;
         break;
       }
+#endif
+#if defined(MAGICKCORE_ZSTD_DELEGATE)
+      case ZstdCompression:
+      {
+        size_t
+          code;
+
+        zstd_input.src=(const void *) NULL;
+        zstd_input.size=0;
+        zstd_input.pos=0;
+        for ( ; ; )
+        {
+          if (status == MagickFalse)
+            break;
+          zstd_output.dst=compress_pixels;
+          zstd_output.size=ZipMaxExtent(packet_size*image->columns);
+          zstd_output.pos=0;
+          code=ZSTD_compressStream2(zstd_info,&zstd_output,&zstd_input,
+            ZSTD_e_end);
+          if (ZSTD_isError(code) != 0)
+            {
+              status=MagickFalse;
+              break;
+            }
+          length=zstd_output.pos;
+          if (length != 0)
+            {
+              (void) WriteBlobMSBLong(image,(unsigned int) length);
+              (void) WriteBlob(image,length,compress_pixels);
+            }
+          if (code == 0)
+            break;
+        }
+        (void) ZSTD_freeCCtx(zstd_info);
+        break;
+      }
 #endif
       default:
         break;
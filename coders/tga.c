@@ -148,6 +148,9 @@ static Image *ReadTGAImage(const ImageInfo *image_info,ExceptionInfo *exception)
   const char
     *option;
 
+  const unsigned char
+    *p;
+
   Image
     *image;
 
@@ -481,10 +484,12 @@ static Image *ReadTGAImage(const ImageInfo *image_info,ExceptionInfo *exception)
           {
             if ((x & 0x07) == 0)
               {
-                if (ReadBlob(image,1,pixels) != 1)
+                p=(const unsigned char *) ReadBlobStream(image,1,pixels,
+                  &count);
+                if (count != 1)
                   ThrowReaderException(CorruptImageError,
                     "UnableToReadImageData");
-                index=(Quantum) pixels[0];
+                index=(Quantum) p[0];
               }
             else
               index=(Quantum) ((size_t) index << 1);
@@ -506,9 +511,10 @@ static Image *ReadTGAImage(const ImageInfo *image_info,ExceptionInfo *exception)
             /*
               Gray scale.
             */
-            if (ReadBlob(image,1,pixels) != 1)
+            p=(const unsigned char *) ReadBlobStream(image,1,pixels,&count);
+            if (count != 1)
               ThrowReaderException(CorruptImageError,"UnableToReadImageData");
-            index=(Quantum) pixels[0];
+            index=(Quantum) p[0];
             if (tga_info.colormap_type != 0)
               pixel=image->colormap[(ssize_t) ConstrainColormapIndex(image,
                 (ssize_t) index,exception)];
@@ -530,10 +536,11 @@ static Image *ReadTGAImage(const ImageInfo *image_info,ExceptionInfo *exception)
             /*
               5 bits each of RGB.
             */
-            if (ReadBlob(image,2,pixels) != 2)
+            p=(const unsigned char *) ReadBlobStream(image,2,pixels,&count);
+            if (count != 2)
               ThrowReaderException(CorruptImageError,"UnableToReadImageData");
-            j=pixels[0];
-            k=pixels[1];
+            j=p[0];
+            k=p[1];
             range=GetQuantumRange(5UL);
             pixel.red=(MagickRealType) ScaleAnyToQuantum(1UL*(k & 0x7c) >> 2,
               range);
@@ -553,11 +560,12 @@ static Image *ReadTGAImage(const ImageInfo *image_info,ExceptionInfo *exception)
             /*
               BGR pixels.
             */
-            if (ReadBlob(image,3,pixels) != 3)
+            p=(const unsigned char *) ReadBlobStream(image,3,pixels,&count);
+            if (count != 3)
               ThrowReaderException(CorruptImageError,"UnableToReadImageData");
-            pixel.blue=(MagickRealType) ScaleCharToQuantum(pixels[0]);
-            pixel.green=(MagickRealType) ScaleCharToQuantum(pixels[1]);
-            pixel.red=(MagickRealType) ScaleCharToQuantum(pixels[2]);
+            pixel.blue=(MagickRealType) ScaleCharToQuantum(p[0]);
+            pixel.green=(MagickRealType) ScaleCharToQuantum(p[1]);
+            pixel.red=(MagickRealType) ScaleCharToQuantum(p[2]);
             break;
           }
           case 32:
@@ -565,12 +573,13 @@ static Image *ReadTGAImage(const ImageInfo *image_info,ExceptionInfo *exception)
             /*
               BGRA pixels.
             */
-            if (ReadBlob(image,4,pixels) != 4)
+            p=(const unsigned char *) ReadBlobStream(image,4,pixels,&count);
+            if (count != 4)
               ThrowReaderException(CorruptImageError,"UnableToReadImageData");
-            pixel.blue=(MagickRealType) ScaleCharToQuantum(pixels[0]);
-            pixel.green=(MagickRealType) ScaleCharToQuantum(pixels[1]);
-            pixel.red=(MagickRealType) ScaleCharToQuantum(pixels[2]);
-            pixel.alpha=(MagickRealType) ScaleCharToQuantum(pixels[3]);
+            pixel.blue=(MagickRealType) ScaleCharToQuantum(p[0]);
+            pixel.green=(MagickRealType) ScaleCharToQuantum(p[1]);
+            pixel.red=(MagickRealType) ScaleCharToQuantum(p[2]);
+            pixel.alpha=(MagickRealType) ScaleCharToQuantum(p[3]);
             break;
           }
         }
@@ -0,0 +1,605 @@
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%                       CCCC   AAA    CCCC  H   H  EEEEE                      %
+%                      C      A   A  C      H   H  E                          %
+%                      C      AAAAA  C      HHHHH  EEE                        %
+%                      C      A   A  C      H   H  E                          %
+%                       CCCC  A   A   CCCC  H   H  EEEEE                      %
+%                                                                             %
+%                         TTTTT  EEEEE  SSSSS  TTTTT                          %
+%                           T    E      SS       T                            %
+%                           T    EEE     SSS     T                            %
+%                           T    E         SS    T                            %
+%                           T    EEEEE  SSSSS    T                            %
+%                                                                             %
+%                                                                             %
+%                         MagickCore Pixel Cache Tests                        %
+%                                                                             %
+%                              Software Design                                %
+%                                   Cristy                                    %
+%                                October 2026                                 %
+%                                                                             %
+%                                                                             %
+%  Copyright 1999 ImageMagick Studio LLC, a non-profit organization           %
+%  dedicated to making software imaging solutions freely available.           %
+%                                                                             %
+%  You may not use this file except in compliance with the License.  You may  %
+%  obtain a copy of the License at                                            %
+%                                                                             %
+%    https://imagemagick.org/script/license.php                               %
+%                                                                             %
+%  Unless required by applicable law or agreed to in writing, software        %
+%  distributed under the License is distributed on an "AS IS" BASIS,          %
+%  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   %
+%  See the License for the specific language governing permissions and        %
+%  limitations under the License.                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%
+%
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <locale.h>
+#include <MagickCore/MagickCore.h>
+
+#define ThrowCacheTestException(message) \
+{ \
+  (void) FormatLocaleFile(stderr,"%s %s %lu %s\n",GetMagickModule(), \
+    message); \
+  exit(1); \
+}
+
+static Image *AcquireTestImage(const ImageInfo *image_info,
+  const size_t columns,const size_t rows,ExceptionInfo *exception)
+{
+  CacheView
+    *image_view;
+
+  Image
+    *image;
+
+  ssize_t
+    y;
+
+  /*
+    Create an image whose pixels encode their coordinates.
+  */
+  image=AcquireImage(image_info,exception);
+  if (SetImageExtent(image,columns,rows,exception) == MagickFalse)
+    return(DestroyImage(image));
+  image_view=AcquireAuthenticCacheView(image,exception);
+  for (y=0; y < (ssize_t) image->rows; y++)
+  {
+    Quantum
+      *magick_restrict q;
+
+    ssize_t
+      x;
+
+    q=QueueCacheViewAuthenticPixels(image_view,0,y,image->columns,1,exception);
+    if (q == (Quantum *) NULL)
+      break;
+    for (x=0; x < (ssize_t) image->columns; x++)
+    {
+      SetPixelRed(image,(Quantum) x,q);
+      SetPixelGreen(image,(Quantum) y,q);
+      SetPixelBlue(image,(Quantum) (x+y),q);
+      q+=GetPixelChannels(image);
+    }
+    if (SyncCacheViewAuthenticPixels(image_view,exception) == MagickFalse)
+      break;
+  }
+  image_view=DestroyCacheView(image_view);
+  if (y < (ssize_t) image->rows)
+    return(DestroyImage(image));
+  return(image);
+}
+
+static void ValidateCacheViewChannels(const ImageInfo *image_info,
+  const MagickBooleanType disk,ExceptionInfo *exception)
+{
+  CacheView
+    *image_view;
+
+  const Quantum
+    *p;
+
+  Image
+    *image;
+
+  MagickSizeType
+    map_limit,
+    memory_limit;
+
+  Quantum
+    *q;
+
+  ssize_t
+    i,
+    x,
+    y;
+
+  /*
+    Read and write one channel of a region as a plane.
+  */
+  (void) FormatLocaleFile(stdout,"Cache view channels of a %s cache...\n",
+    disk != MagickFalse ? "disk" : "memory");
+  memory_limit=GetMagickResourceLimit(MemoryResource);
+  map_limit=GetMagickResourceLimit(MapResource);
+  if (disk != MagickFalse)
+    {
+      (void) SetMagickResourceLimit(MemoryResource,0);
+      (void) SetMagickResourceLimit(MapResource,0);
+    }
+  image=AcquireTestImage(image_info,64,48,exception);
+  (void) SetMagickResourceLimit(MemoryResource,memory_limit);
+  (void) SetMagickResourceLimit(MapResource,map_limit);
+  if (image == (Image *) NULL)
+    ThrowCacheTestException("unable to create image");
+  if ((disk != MagickFalse) && (GetImagePixelCacheType(image) != DiskCache))
+    ThrowCacheTestException("expected a disk pixel cache");
+  image_view=AcquireAuthenticCacheView(image,exception);
+  p=GetCacheViewVirtualChannel(image_view,GreenPixelChannel,-2,-1,8,4,
+    exception);
+  if (p == (const Quantum *) NULL)
+    ThrowCacheTestException("unable to get the green plane");
+  for (y=(-1); y < 3; y++)
+    for (x=(-2); x < 6; x++)
+      if (*p++ != (Quantum) (y < 0 ? 0 : y))
+        ThrowCacheTestException("unexpected green plane");
+  if (GetCacheViewVirtualChannel(image_view,AlphaPixelChannel,0,0,8,4,
+        exception) != (const Quantum *) NULL)
+    ThrowCacheTestException("expected no alpha plane");
+  ClearMagickException(exception);
+  q=GetCacheViewAuthenticChannel(image_view,RedPixelChannel,10,20,30,5,
+    exception);
+  if (q == (Quantum *) NULL)
+    ThrowCacheTestException("unable to get the red plane");
+  for (i=0; i < (30*5); i++)
+  {
+    if (q[i] != (Quantum) (10+(i % 30)))
+      ThrowCacheTestException("unexpected red plane");
+    q[i]=(Quantum) 7;
+  }
+  /*
+    A virtual channel read before the sync must not disturb the red plane.
+  */
+  p=GetCacheViewVirtualChannel(image_view,BluePixelChannel,0,0,64,48,
+    exception);
+  if ((p == (const Quantum *) NULL) || (p[64*47+63] != (Quantum) (63+47)))
+    ThrowCacheTestException("unable to get the blue plane");
+  if (SyncCacheViewAuthenticChannel(image_view,exception) == MagickFalse)
+    ThrowCacheTestException("unable to sync the red plane");
+  /*
+    A failed request leaves nothing to sync.
+  */
+  if (GetCacheViewAuthenticChannel(image_view,AlphaPixelChannel,0,0,8,4,
+        exception) != (Quantum *) NULL)
+    ThrowCacheTestException("expected no alpha plane");
+  ClearMagickException(exception);
+  if (SyncCacheViewAuthenticChannel(image_view,exception) != MagickFalse)
+    ThrowCacheTestException("synced the plane of a failed request");
+  image_view=DestroyCacheView(image_view);
+  for (y=0; y < (ssize_t) image->rows; y++)
+  {
+    p=GetVirtualPixels(image,0,y,image->columns,1,exception);
+    if (p == (const Quantum *) NULL)
+      ThrowCacheTestException("unable to read pixels");
+    for (x=0; x < (ssize_t) image->columns; x++)
+    {
+      Quantum
+        red;
+
+      red=(Quantum) x;
+      if ((x >= 10) && (x < 40) && (y >= 20) && (y < 25))
+        red=(Quantum) 7;
+      if ((GetPixelRed(image,p) != red) ||
+          (GetPixelGreen(image,p) != (Quantum) y) ||
+          (GetPixelBlue(image,p) != (Quantum) (x+y)))
+        ThrowCacheTestException("red plane not synced");
+      p+=GetPixelChannels(image);
+    }
+  }
+  image=DestroyImage(image);
+}
+
+static void ValidateConcurrentPixelCache(const ImageInfo *image_info,
+  ExceptionInfo *exception)
+{
+  CacheView
+    *image_view;
+
+  double
+    distortion;
+
+  Image
+    *image,
+    *reference_image;
+
+  MagickBooleanType
+    status;
+
+  int
+    number_threads;
+
+  ssize_t
+    i,
+    y;
+
+  /*
+    Clone and sync the pixels of one image from many threads at once.
+  */
+  (void) FormatLocaleFile(stdout,"Concurrent pixel cache access...\n");
+  number_threads=(int) GetMagickResourceLimit(ThreadResource);
+  image=AcquireTestImage(image_info,256,256,exception);
+  reference_image=AcquireTestImage(image_info,256,256,exception);
+  if ((image == (Image *) NULL) || (reference_image == (Image *) NULL))
+    ThrowCacheTestException("unable to create image");
+  status=MagickTrue;
+#if defined(_OPENMP)
+  #pragma omp parallel for schedule(dynamic) num_threads(number_threads) \
+    shared(status)
+#endif
+  for (i=0; i < 512; i++)
+  {
+    const Quantum
+      *p;
+
+    Image
+      *clone_image;
+
+    Quantum
+      *q;
+
+    ssize_t
+      j,
+      x,
+      y;
+
+    /*
+      Each clone changes one row; the other rows must still match the image.
+    */
+    clone_image=CloneImage(image,0,0,MagickTrue,exception);
+    if (clone_image == (Image *) NULL)
+      {
+        status=MagickFalse;
+        continue;
+      }
+    for (j=0; j < 2; j++)
+    {
+      q=GetAuthenticPixels(clone_image,0,(i+j) % 256,256,1,exception);
+      if (q == (Quantum *) NULL)
+        break;
+      for (x=0; x < 256; x++)
+      {
+        SetPixelRed(clone_image,(Quantum) (i+j),q);
+        q+=GetPixelChannels(clone_image);
+      }
+      if (SyncAuthenticPixels(clone_image,exception) == MagickFalse)
+        break;
+    }
+    if (j < 2)
+      status=MagickFalse;
+    for (y=0; y < 256; y++)
+    {
+      p=GetVirtualPixels(clone_image,0,y,256,1,exception);
+      if (p == (const Quantum *) NULL)
+        {
+          status=MagickFalse;
+          break;
+        }
+      for (x=0; x < 256; x++)
+      {
+        Quantum
+          red;
+
+        red=(Quantum) x;
+        if ((y == (i % 256)) || (y == ((i+1) % 256)))
+          red=(Quantum) (y == (i % 256) ? i : i+1);
+        if ((GetPixelRed(clone_image,p) != red) ||
+            (GetPixelGreen(clone_image,p) != (Quantum) y))
+          status=MagickFalse;
+        p+=GetPixelChannels(clone_image);
+      }
+    }
+    clone_image=DestroyImage(clone_image);
+  }
+  if (status == MagickFalse)
+    ThrowCacheTestException("concurrent clones differ");
+  if (GetImageDistortion(image,reference_image,AbsoluteErrorMetric,
+        &distortion,exception) == MagickFalse)
+    ThrowCacheTestException("unable to compare images");
+  if (distortion != 0.0)
+    ThrowCacheTestException("clones changed the image");
+  /*
+    Threads sync their own rows of the image through one cache view.
+  */
+  image_view=AcquireAuthenticCacheView(image,exception);
+#if defined(_OPENMP)
+  #pragma omp parallel for schedule(static,1) num_threads(number_threads) \
+    shared(status)
+#endif
+  for (y=0; y < 256; y++)
+  {
+    Quantum
+      *q;
+
+    ssize_t
+      x;
+
+    q=GetCacheViewAuthenticPixels(image_view,0,y,256,1,exception);
+    if (q == (Quantum *) NULL)
+      {
+        status=MagickFalse;
+        continue;
+      }
+    for (x=0; x < 256; x++)
+    {
+      SetPixelBlue(image,(Quantum) (QuantumRange-x-y),q);
+      q+=GetPixelChannels(image);
+    }
+    if (SyncCacheViewAuthenticPixels(image_view,exception) == MagickFalse)
+      status=MagickFalse;
+  }
+  image_view=DestroyCacheView(image_view);
+  if (status == MagickFalse)
+    ThrowCacheTestException("unable to sync pixels");
+  for (y=0; y < 256; y++)
+  {
+    const Quantum
+      *p;
+
+    ssize_t
+      x;
+
+    p=GetVirtualPixels(image,0,y,256,1,exception);
+    if (p == (const Quantum *) NULL)
+      ThrowCacheTestException("unable to read pixels");
+    for (x=0; x < 256; x++)
+    {
+      if ((GetPixelRed(image,p) != (Quantum) x) ||
+          (GetPixelBlue(image,p) != (Quantum) (QuantumRange-x-y)))
+        ThrowCacheTestException("concurrent rows not synced");
+      p+=GetPixelChannels(image);
+    }
+  }
+  reference_image=DestroyImage(reference_image);
+  image=DestroyImage(image);
+}
+
+static void ValidatePixelCacheStatistics(const ImageInfo *image_info,
+  ExceptionInfo *exception)
+{
+  CacheStatistics
+    before,
+    statistics;
+
+  CacheView
+    *image_view;
+
+  Image
+    *image;
+
+  MagickSizeType
+    map_limit,
+    memory_limit;
+
+  ssize_t
+    y;
+
+  (void) FormatLocaleFile(stdout,"Pixel cache statistics...\n");
+  GetPixelCacheStatistics(&before);
+  memory_limit=GetMagickResourceLimit(MemoryResource);
+  map_limit=GetMagickResourceLimit(MapResource);
+  (void) SetMagickResourceLimit(MemoryResource,0);
+  (void) SetMagickResourceLimit(MapResource,0);
+  image=AcquireTestImage(image_info,320,240,exception);
+  (void) SetMagickResourceLimit(MemoryResource,memory_limit);
+  (void) SetMagickResourceLimit(MapResource,map_limit);
+  if (image == (Image *) NULL)
+    ThrowCacheTestException("unable to create a disk pixel cache");
+  if (GetImagePixelCacheType(image) != DiskCache)
+    ThrowCacheTestException("expected a disk pixel cache");
+  if (GetImagePixelCacheStatistics(image,&statistics) == MagickFalse)
+    ThrowCacheTestException("no pixel cache statistics");
+  if (statistics.disk_bytes_written < (MagickSizeType) image->columns*
+      image->rows*GetPixelChannels(image)*sizeof(Quantum))
+    ThrowCacheTestException("disk writes not counted");
+  /*
+    Requests made through a cache view are counted once it is destroyed.
+  */
+  image_view=AcquireVirtualCacheView(image,exception);
+  for (y=0; y < (ssize_t) image->rows; y++)
+    if (GetCacheViewVirtualPixels(image_view,0,y,image->columns,1,
+          exception) == (const Quantum *) NULL)
+      ThrowCacheTestException("unable to read pixels");
+  if (GetCacheViewVirtualPixels(image_view,-2,-2,4,4,exception) ==
+      (const Quantum *) NULL)
+    ThrowCacheTestException("unable to read virtual pixels");
+  image_view=DestroyCacheView(image_view);
+  (void) GetImagePixelCacheStatistics(image,&statistics);
+  if ((statistics.direct_requests+statistics.buffered_requests) <
+      (2*image->rows))
+    ThrowCacheTestException("cache view requests not counted");
+  if (statistics.virtual_requests == 0)
+    ThrowCacheTestException("virtual pixel requests not counted");
+  if (statistics.disk_bytes_read == 0)
+    ThrowCacheTestException("disk reads not counted");
+  image=DestroyImage(image);
+  /*
+    The counters of a destroyed pixel cache are added to the process totals.
+  */
+  GetPixelCacheStatistics(&statistics);
+  if (((statistics.direct_requests+statistics.buffered_requests) <
+       (before.direct_requests+before.buffered_requests+2*240)) ||
+      (statistics.disk_bytes_written <= before.disk_bytes_written))
+    ThrowCacheTestException("process statistics not accumulated");
+}
+
+static void ValidateSpillPixelCache(const ImageInfo *image_info,
+  ExceptionInfo *exception)
+{
+  CacheStatistics
+    statistics;
+
+  double
+    distortion;
+
+  Image
+    *clone_image,
+    *image,
+    *reference_image;
+
+  /*
+    Spill a memory cache to disk and bring it back.
+  */
+  (void) FormatLocaleFile(stdout,"Spill pixel cache...\n");
+  image=AcquireTestImage(image_info,320,240,exception);
+  reference_image=AcquireTestImage(image_info,320,240,exception);
+  if ((image == (Image *) NULL) || (reference_image == (Image *) NULL))
+    ThrowCacheTestException("unable to create image");
+  if (GetImagePixelCacheType(image) != MemoryCache)
+    ThrowCacheTestException("expected a memory pixel cache");
+  clone_image=CloneImage(image,0,0,MagickTrue,exception);
+  if (clone_image == (Image *) NULL)
+    ThrowCacheTestException("unable to clone image");
+  if (SpillPixelCache(image,exception) != MagickFalse)
+    ThrowCacheTestException("spilled a shared pixel cache");
+  clone_image=DestroyImage(clone_image);
+  if (SpillPixelCache(image,exception) == MagickFalse)
+    ThrowCacheTestException("unable to spill the pixel cache");
+  if (GetImagePixelCacheType(image) != DiskCache)
+    ThrowCacheTestException("expected a disk pixel cache");
+  if (SpillPixelCache(image,exception) != MagickFalse)
+    ThrowCacheTestException("spilled a disk pixel cache");
+  if (GetImageDistortion(image,reference_image,AbsoluteErrorMetric,
+        &distortion,exception) == MagickFalse)
+    ThrowCacheTestException("unable to compare images");
+  if (distortion != 0.0)
+    ThrowCacheTestException("spilled pixels differ");
+  if (GetAuthenticPixels(image,0,0,1,1,exception) == (Quantum *) NULL)
+    ThrowCacheTestException("unable to get pixels");
+  if (GetImagePixelCacheType(image) != MemoryCache)
+    ThrowCacheTestException("expected the pixel cache back in memory");
+  (void) GetImagePixelCacheStatistics(image,&statistics);
+  if ((statistics.demotions == 0) || (statistics.promotions == 0))
+    ThrowCacheTestException("spill not counted");
+  if (GetImageDistortion(image,reference_image,AbsoluteErrorMetric,
+        &distortion,exception) == MagickFalse)
+    ThrowCacheTestException("unable to compare images");
+  if (distortion != 0.0)
+    ThrowCacheTestException("promoted pixels differ");
+  reference_image=DestroyImage(reference_image);
+  image=DestroyImage(image);
+}
+
+static void ValidateSpillIdlePixelCaches(const ImageInfo *image_info,
+  ExceptionInfo *exception)
+{
+  CacheView
+    *image_view;
+
+  double
+    distortion;
+
+  Image
+    *images[5],
+    *reference_image;
+
+  MagickSizeType
+    extent,
+    limit;
+
+  ssize_t
+    i;
+
+  /*
+    At the memory limit, the least recently used idle cache moves to disk, but
+    not one a cache view still points into.
+  */
+  (void) FormatLocaleFile(stdout,"Spill idle pixel caches...\n");
+  limit=GetMagickResourceLimit(MemoryResource);
+  for (i=0; i < 3; i++)
+  {
+    images[i]=AcquireTestImage(image_info,320,240,exception);
+    if (images[i] == (Image *) NULL)
+      ThrowCacheTestException("unable to create image");
+  }
+  if ((GetAuthenticPixels(images[0],0,0,1,1,exception) == (Quantum *) NULL) ||
+      (SyncAuthenticPixels(images[0],exception) == MagickFalse))
+    ThrowCacheTestException("unable to get pixels");
+  image_view=AcquireVirtualCacheView(images[1],exception);
+  if (GetCacheViewVirtualPixels(image_view,0,0,320,1,exception) ==
+      (const Quantum *) NULL)
+    ThrowCacheTestException("unable to get pixels");
+  extent=320*240*GetPixelChannels(images[0])*sizeof(Quantum);
+  if (SetMagickResourceLimit(MemoryResource,GetMagickResource(MemoryResource)+
+        extent/2) == MagickFalse)
+    ThrowCacheTestException("unable to set the memory limit");
+  images[3]=AcquireTestImage(image_info,320,240,exception);
+  if (images[3] == (Image *) NULL)
+    ThrowCacheTestException("unable to create image");
+  if ((GetImagePixelCacheType(images[1]) != MemoryCache) ||
+      (GetImagePixelCacheType(images[2]) != DiskCache) ||
+      (GetImagePixelCacheType(images[0]) != MemoryCache) ||
+      (GetImagePixelCacheType(images[3]) != MemoryCache))
+    ThrowCacheTestException("expected the least recently used idle cache on "
+      "disk");
+  image_view=DestroyCacheView(image_view);
+  images[4]=AcquireTestImage(image_info,320,240,exception);
+  if (images[4] == (Image *) NULL)
+    ThrowCacheTestException("unable to create image");
+  if ((GetImagePixelCacheType(images[0]) != DiskCache) ||
+      (GetImagePixelCacheType(images[1]) != MemoryCache) ||
+      (GetImagePixelCacheType(images[3]) != MemoryCache) ||
+      (GetImagePixelCacheType(images[4]) != MemoryCache))
+    ThrowCacheTestException("expected the least recently used idle cache on "
+      "disk");
+  (void) SetMagickResourceLimit(MemoryResource,limit);
+  reference_image=AcquireTestImage(image_info,320,240,exception);
+  if (reference_image == (Image *) NULL)
+    ThrowCacheTestException("unable to create image");
+  for (i=0; i < 5; i++)
+  {
+    if (GetImageDistortion(images[i],reference_image,AbsoluteErrorMetric,
+          &distortion,exception) == MagickFalse)
+      ThrowCacheTestException("unable to compare images");
+    if (distortion != 0.0)
+      ThrowCacheTestException("spilled pixels differ");
+    images[i]=DestroyImage(images[i]);
+  }
+  reference_image=DestroyImage(reference_image);
+}
+
+int main(int argc,char **argv)
+{
+  ExceptionInfo
+    *exception;
+
+  ImageInfo
+    *image_info;
+
+  (void) argc;
+  MagickCoreGenesis(*argv,MagickTrue);
+  (void) setlocale(LC_ALL,"");
+  (void) setlocale(LC_NUMERIC,"C");
+  exception=AcquireExceptionInfo();
+  image_info=AcquireImageInfo();
+  ValidateCacheViewChannels(image_info,MagickFalse,exception);
+  ValidateCacheViewChannels(image_info,MagickTrue,exception);
+  ValidateConcurrentPixelCache(image_info,exception);
+  ValidatePixelCacheStatistics(image_info,exception);
+  ValidateSpillPixelCache(image_info,exception);
+  ValidateSpillIdlePixelCaches(image_info,exception);
+  image_info=DestroyImageInfo(image_info);
+  exception=DestroyExceptionInfo(exception);
+  (void) FormatLocaleFile(stdout,"Pixel cache tests pass.\n");
+  MagickCoreTerminus();
+  return(0);
+}
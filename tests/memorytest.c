@@ -0,0 +1,202 @@
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%                  M   M  EEEEE  M   M   OOO   RRRR   Y   Y                   %
+%                  MM MM  E      MM MM  O   O  R   R   Y Y                    %
+%                  M M M  EEE    M M M  O   O  RRRR     Y                     %
+%                  M   M  E      M   M  O   O  R R      Y                     %
+%                  M   M  EEEEE  M   M   OOO   R  RR    Y                     %
+%                                                                             %
+%                         TTTTT  EEEEE  SSSSS  TTTTT                          %
+%                           T    E      SS       T                            %
+%                           T    EEE     SSS     T                            %
+%                           T    E         SS    T                            %
+%                           T    EEEEE  SSSSS    T                            %
+%                                                                             %
+%                                                                             %
+%                           MagickCore Memory Tests                           %
+%                                                                             %
+%                              Software Design                                %
+%                                   Cristy                                    %
+%                                October 2026                                 %
+%                                                                             %
+%                                                                             %
+%  Copyright 1999 ImageMagick Studio LLC, a non-profit organization           %
+%  dedicated to making software imaging solutions freely available.           %
+%                                                                             %
+%  You may not use this file except in compliance with the License.  You may  %
+%  obtain a copy of the License at                                            %
+%                                                                             %
+%    https://imagemagick.org/script/license.php                               %
+%                                                                             %
+%  Unless required by applicable law or agreed to in writing, software        %
+%  distributed under the License is distributed on an "AS IS" BASIS,          %
+%  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   %
+%  See the License for the specific language governing permissions and        %
+%  limitations under the License.                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%
+%
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <locale.h>
+#include <MagickCore/MagickCore.h>
+
+#define ThrowMemoryTestException(message) \
+{ \
+  (void) FormatLocaleFile(stderr,"%s %s %lu %s\n",GetMagickModule(), \
+    message); \
+  exit(1); \
+}
+
+static inline size_t GetBlockExtent(const size_t slot,const size_t round)
+{
+  size_t
+    hash;
+
+  /*
+    Mostly small requests, some up to the largest cached size class, and a
+    few that bypass the thread cache.
+  */
+  hash=(size_t) ((slot*2654435761UL+round*40503UL) & 0xffffffffUL);
+  switch (hash % 8)
+  {
+    case 0: return(65537+(hash >> 3) % 32768);
+    case 1: case 2: return(1+(hash >> 3) % 65536);
+    default: break;
+  }
+  return(1+(hash >> 3) % 512);
+}
+
+static void ValidateConcurrentMemory(const size_t rounds)
+{
+  int
+    number_threads;
+
+  MagickBooleanType
+    status;
+
+  size_t
+    *extents,
+    number_slots,
+    round;
+
+  ssize_t
+    i;
+
+  unsigned char
+    **blocks;
+
+  /*
+    Acquire, resize, and relinquish blocks from many threads at once.  Each
+    round moves every slot to another thread, so most blocks are
+    relinquished by a thread other than the one that acquired them.
+  */
+  (void) FormatLocaleFile(stdout,"Concurrent memory requests...\n");
+  number_threads=(int) GetMagickResourceLimit(ThreadResource);
+  number_slots=256*(size_t) number_threads;
+  blocks=(unsigned char **) AcquireQuantumMemory(number_slots,
+    sizeof(*blocks));
+  extents=(size_t *) AcquireQuantumMemory(number_slots,sizeof(*extents));
+  if ((blocks == (unsigned char **) NULL) || (extents == (size_t *) NULL))
+    ThrowMemoryTestException("unable to allocate memory");
+  (void) memset(blocks,0,number_slots*sizeof(*blocks));
+  (void) memset(extents,0,number_slots*sizeof(*extents));
+  status=MagickTrue;
+  for (round=0; round < rounds; round++)
+  {
+#if defined(_OPENMP)
+    #pragma omp parallel for schedule(static,1) num_threads(number_threads) \
+      shared(status)
+#endif
+    for (i=0; i < (ssize_t) number_slots; i++)
+    {
+      size_t
+        extent,
+        j,
+        length,
+        slot;
+
+      unsigned char
+        *block,
+        value;
+
+      slot=((size_t) i+round) % number_slots;
+      block=blocks[slot];
+      if (block != (unsigned char *) NULL)
+        {
+          value=(unsigned char) (slot+round-1);
+          for (j=0; j < extents[slot]; j++)
+            if (block[j] != value)
+              break;
+          if (j < extents[slot])
+            status=MagickFalse;
+          block=(unsigned char *) RelinquishMagickMemory(block);
+        }
+      extent=GetBlockExtent(slot,round);
+      block=(unsigned char *) AcquireMagickMemory(extent);
+      if (block == (unsigned char *) NULL)
+        {
+          status=MagickFalse;
+          blocks[slot]=block;
+          continue;
+        }
+      if ((slot % 3) == 0)
+        {
+          /*
+            Grow or shrink the block, keeping its contents.
+          */
+          (void) memset(block,0xaa,extent);
+          length=GetBlockExtent(slot,round+rounds);
+          block=(unsigned char *) ResizeMagickMemory(block,length);
+          if (block == (unsigned char *) NULL)
+            {
+              status=MagickFalse;
+              blocks[slot]=block;
+              continue;
+            }
+          for (j=0; (j < extent) && (j < length); j++)
+            if (block[j] != 0xaa)
+              break;
+          if ((j < extent) && (j < length))
+            status=MagickFalse;
+          extent=length;
+        }
+      (void) memset(block,(int) (unsigned char) (slot+round),extent);
+      blocks[slot]=block;
+      extents[slot]=extent;
+    }
+    if (status == MagickFalse)
+      ThrowMemoryTestException("memory block corrupt");
+  }
+  for (i=0; i < (ssize_t) number_slots; i++)
+    blocks[i]=(unsigned char *) RelinquishMagickMemory(blocks[i]);
+  extents=(size_t *) RelinquishMagickMemory(extents);
+  blocks=(unsigned char **) RelinquishMagickMemory(blocks);
+}
+
+int main(int argc,char **argv)
+{
+  (void) argc;
+  MagickCoreGenesis(*argv,MagickTrue);
+  (void) setlocale(LC_ALL,"");
+  (void) setlocale(LC_NUMERIC,"C");
+  ValidateConcurrentMemory(64);
+  /*
+    Restart MagickCore; the worker threads outlive the memory manager, so
+    their next requests must start from fresh thread caches.
+  */
+  MagickCoreTerminus();
+  MagickCoreGenesis(*argv,MagickTrue);
+  ValidateConcurrentMemory(16);
+  (void) FormatLocaleFile(stdout,"Memory tests pass.\n");
+  MagickCoreTerminus();
+  return(0);
+}